@@ -15,12 +15,12 @@ namespace mx = MaterialX;
 
 EMSCRIPTEN_BINDINGS(document)
 {
-    ems::function("createDocument", &mx::createDocument);
+    ems::function("createDocument", (mx::DocumentPtr (*)()) &mx::createDocument);
     ems::class_<mx::Document, ems::base<mx::GraphElement>>("Document")
         .smart_ptr_constructor("Document", &std::make_shared<mx::Document, mx::ElementPtr, const std::string &>)
         .smart_ptr<std::shared_ptr<const mx::Document>>("Document")
             // At the moment only the Document type is used. Once more types are added this binding needs to be adapted accordingly.
-        .class_function("createDocument", &mx::Document::createDocument<mx::Document>)
+        .class_function("createDocument", (mx::DocumentPtr (*)()) &mx::Document::createDocument<mx::Document>)
         .function("initialize", &mx::Document::initialize)
         .function("copy", &mx::Document::copy)
         .function("setDataLibrary", &mx::Document::setDataLibrary)
@@ -106,6 +106,8 @@ EMSCRIPTEN_BINDINGS(document)
         .function("hasColorManagementConfig", &mx::Document::hasColorManagementConfig)
         .function("getColorManagementConfig", &mx::Document::getColorManagementConfig)
         .function("invalidateCache", &mx::Document::invalidateCache)
+        .function("freeze", &mx::Document::freeze)
+        .function("isFrozen", &mx::Document::isFrozen)
         .class_property("CATEGORY", &mx::Document::CATEGORY)
         .class_property("CMS_ATTRIBUTE", &mx::Document::CMS_ATTRIBUTE)
         .class_property("CMS_CONFIG_ATTRIBUTE", &mx::Document::CMS_CONFIG_ATTRIBUTE);
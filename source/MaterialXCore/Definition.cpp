@@ -134,7 +134,7 @@ StringMap NodeDef::getInputHints() const
 bool NodeDef::validate(string* message) const
 {
     bool res = true;
-    validateRequire(!hasType(), res, message, "Nodedef should not have a type but an explicit output");
+    validateRequire(!hasType(), res, message, "Nodedef should not have a type but an explicit output", "nodedef.type");
     return InterfaceElement::validate(message) && res;
 }
 
@@ -180,7 +180,7 @@ NodeDefPtr Implementation::getNodeDef() const
 bool Implementation::validate(string* message) const
 {
     bool res = true;
-    validateRequire(!hasVersionString(), res, message, "Implementation elements do not support version strings");
+    validateRequire(!hasVersionString(), res, message, "Implementation elements do not support version strings", "implementation.version");
     return InterfaceElement::validate(message) && res;
 }
 
@@ -206,7 +206,7 @@ vector<UnitDefPtr> UnitTypeDef::getUnitDefs() const
     vector<UnitDefPtr> unitDefs;
     for (UnitDefPtr unitDef : getDocument()->getChildrenOfType<UnitDef>())
     {
-        if (unitDef->getUnitType() == _name)
+        if (unitDef->getUnitType() == getName())
         {
             unitDefs.push_back(unitDef);
         }
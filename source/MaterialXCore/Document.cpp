@@ -4,7 +4,10 @@
 //
 
 #include <MaterialXCore/Document.h>
+#include <MaterialXCore/Util.h>
 
+#include <algorithm>
+#include <atomic>
 #include <mutex>
 #include <shared_mutex>
 
@@ -22,6 +25,182 @@ DocumentPtr createDocument()
     return Document::createDocument<Document>();
 }
 
+DocumentPtr createDocument(ElementArenaPtr arena)
+{
+    if (!arena)
+    {
+        return Document::createDocument<Document>();
+    }
+    return Document::createDocument<Document>(arena);
+}
+
+namespace
+{
+
+using InputSignature = vector<std::pair<string, string>>;
+
+// Return the sorted, unique set of targets in the given target string.
+StringVec getTargetSet(const string& target)
+{
+    StringVec targets = splitString(target, ARRAY_VALID_SEPARATORS);
+    std::sort(targets.begin(), targets.end());
+    targets.erase(std::unique(targets.begin(), targets.end()), targets.end());
+    return targets;
+}
+
+// Return true if the given name path is in the form stored by the name path
+// index, without leading, trailing, or repeated separators.
+bool isCanonicalNamePath(const string& namePath)
+{
+    return !stringStartsWith(namePath, NAME_PATH_SEPARATOR) &&
+           !stringEndsWith(namePath, NAME_PATH_SEPARATOR) &&
+           namePath.find(NAME_PATH_SEPARATOR + NAME_PATH_SEPARATOR) == string::npos;
+}
+
+// Return true if the given sorted target sets match, with an empty set
+// matching all targets.
+bool targetSetsMatch(const StringVec& targets1, const StringVec& targets2)
+{
+    if (targets1.empty() || targets2.empty())
+    {
+        return true;
+    }
+    auto it1 = targets1.begin();
+    auto it2 = targets2.begin();
+    while (it1 != targets1.end() && it2 != targets2.end())
+    {
+        if (*it1 < *it2)
+        {
+            ++it1;
+        }
+        else if (*it2 < *it1)
+        {
+            ++it2;
+        }
+        else
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Return true if the first element precedes the second in a pre-order
+// traversal of their shared document.
+bool precedesInDocument(ConstElementPtr elem1, ConstElementPtr elem2)
+{
+    vector<ConstElementPtr> path1, path2;
+    for (ConstElementPtr elem = elem1; elem; elem = elem->getParent())
+    {
+        path1.push_back(elem);
+    }
+    for (ConstElementPtr elem = elem2; elem; elem = elem->getParent())
+    {
+        path2.push_back(elem);
+    }
+
+    // Find the first ancestors at which the two paths diverge.
+    auto it1 = path1.rbegin();
+    auto it2 = path2.rbegin();
+    while (it1 != path1.rend() && it2 != path2.rend() && *it1 == *it2)
+    {
+        ++it1;
+        ++it2;
+    }
+    if (it1 == path1.rend() || it2 == path2.rend())
+    {
+        // An ancestor precedes its descendants.
+        return it1 == path1.rend() && it2 != path2.rend();
+    }
+
+    // Compare the positions of the diverging ancestors within their shared
+    // parent, scanning from the end to favor recently added elements.
+    const ElementVec& siblings = (*(it1 - 1))->getChildren();
+    for (auto it = siblings.rbegin(); it != siblings.rend(); ++it)
+    {
+        if (*it == *it1)
+        {
+            return false;
+        }
+        if (*it == *it2)
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+// The properties of a node that determine its matching nodedef.
+struct NodeDefQuery
+{
+    NodeDefQuery(ConstNodePtr node, const string& targetString) :
+        type(node->getType()),
+        version(node->getVersionString()),
+        target(targetString),
+        targets(getTargetSet(targetString)),
+        inputs(node->getActiveInputs())
+    {
+        for (const InputPtr& input : inputs)
+        {
+            signature.emplace_back(&input->getName(), &input->getType());
+        }
+    }
+
+    const string& type;
+    const string& version;
+    const string& target;
+    StringVec targets;
+    vector<InputPtr> inputs;
+    vector<std::pair<const string*, const string*>> signature;
+};
+
+// A nodedef with its matching properties precomputed for frozen lookups.
+struct FrozenNodeDef
+{
+    explicit FrozenNodeDef(NodeDefPtr def) :
+        nodeDef(def),
+        version(def->getVersionString()),
+        defaultVersion(def->getDefaultVersion()),
+        targets(getTargetSet(def->getTarget()))
+    {
+        for (InputPtr input : def->getActiveInputs())
+        {
+            signature.emplace_back(input->getName(), input->getType());
+        }
+        std::sort(signature.begin(), signature.end());
+    }
+
+    bool isVersionCompatible(const string& nodeVersion) const
+    {
+        return version == nodeVersion || (defaultVersion && nodeVersion.empty());
+    }
+
+    bool hasExactInputMatch(const NodeDefQuery& query) const
+    {
+        for (const auto& input : query.signature)
+        {
+            auto it = std::lower_bound(signature.begin(), signature.end(), *input.first,
+                                       [](const std::pair<string, string>& entry, const string& name)
+                                       {
+                                           return entry.first < name;
+                                       });
+            if (it == signature.end() || it->first != *input.first || it->second != *input.second)
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    NodeDefPtr nodeDef;
+    string version;
+    bool defaultVersion;
+    StringVec targets;
+    InputSignature signature;
+};
+
+} // anonymous namespace
+
 //
 // Document cache
 //
@@ -30,7 +209,11 @@ class Document::Cache
 {
   public:
     Cache() :
-        _valid(false)
+        _valid(false),
+        _frozen(false),
+        _revision(0),
+        _namePathIndexEnabled(false),
+        _mergedRevision(0)
     {
     }
     ~Cache() = default;
@@ -44,32 +227,338 @@ class Document::Cache
 
     void invalidate()
     {
+        checkMutable();
         std::unique_lock<std::shared_mutex> lock(_mutex);
         _valid = false;
     }
 
+    // Every modification of the document passes through this check, which
+    // also advances the revision counter of the document.
+    void checkMutable() const
+    {
+        if (isFrozen())
+        {
+            throw Exception("Cannot modify a frozen document");
+        }
+        _revision.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t getRevision() const
+    {
+        return _revision.load(std::memory_order_relaxed);
+    }
+
+    // Remove the entries for an element, and optionally its descendants,
+    // from a valid cache.
+    void removeElement(ElementPtr elem, bool recursive)
+    {
+        checkMutable();
+
+        // Skip locking when the cache is invalid, allowing separate subtrees
+        // of a document to be edited concurrently while it is being built.
+        if (!_valid)
+        {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        if (!_valid)
+        {
+            return;
+        }
+        if (!recursive)
+        {
+            updateEntries(elem.get(), false);
+            return;
+        }
+        for (Element* descendant : elem->traverseTreeRaw())
+        {
+            updateEntries(descendant, false);
+        }
+    }
+
+    // Add the entries for an element, and optionally its descendants, to a
+    // valid cache, preserving the document order of each entry vector.
+    void addElement(ElementPtr elem, bool recursive)
+    {
+        if (!_valid)
+        {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        if (!_valid || !isAttached(elem))
+        {
+            return;
+        }
+        if (!recursive)
+        {
+            updateEntries(elem.get(), true);
+            return;
+        }
+        for (Element* descendant : elem->traverseTreeRaw())
+        {
+            updateEntries(descendant, true);
+        }
+    }
+
+    void freeze()
+    {
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        if (isFrozen())
+        {
+            return;
+        }
+        auto doc = _doc.lock();
+        if (doc && !_valid)
+        {
+            rebuild(doc);
+        }
+
+        // Build nodedef tables indexed by node name and output type.
+        for (const auto& pair : _nodeDefMap)
+        {
+            for (NodeDefPtr nodeDef : pair.second)
+            {
+                _frozenNodeDefMap[pair.first][nodeDef->getType()].emplace_back(nodeDef);
+            }
+        }
+
+        _frozen.store(true, std::memory_order_release);
+    }
+
+    bool isFrozen() const
+    {
+        return _frozen.load(std::memory_order_acquire);
+    }
+
+    void setNamePathIndexEnabled(bool enable)
+    {
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        if (enable == _namePathIndexEnabled)
+        {
+            return;
+        }
+        _namePathIndex.clear();
+        auto doc = _doc.lock();
+        if (enable && doc)
+        {
+            updateNamePaths(doc, EMPTY_STRING, false, true);
+        }
+        _namePathIndexEnabled = enable;
+    }
+
+    bool isNamePathIndexEnabled() const
+    {
+        return _namePathIndexEnabled.load(std::memory_order_acquire);
+    }
+
+    // Add or remove the name path entries for an element and its
+    // descendants, optionally excluding the element itself.
+    void updateNamePathIndex(ElementPtr elem, bool includeElement, bool add)
+    {
+        if (!isNamePathIndexEnabled())
+        {
+            return;
+        }
+        std::unique_lock<std::shared_mutex> lock(_mutex);
+        if (!_namePathIndexEnabled || !isAttached(elem))
+        {
+            return;
+        }
+        updateNamePaths(elem, elem->getNamePath(), includeElement, add);
+    }
+
+    // Resolve a name path relative to the document, returning false if the
+    // index cannot answer the query.
+    bool resolveNamePath(const string& namePath, ElementPtr& elem) const
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        if (!_namePathIndexEnabled)
+        {
+            return false;
+        }
+        elem = findNamePath(namePath);
+        return elem || isCanonicalNamePath(namePath);
+    }
+
+    // Resolve name paths relative to the element at the given path prefix,
+    // returning false if the index is disabled.
+    bool resolveNamePaths(const string& prefix, const StringVec& namePaths, ElementVec& elements) const
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        if (!_namePathIndexEnabled)
+        {
+            return false;
+        }
+        elements.resize(namePaths.size());
+        string prefixedPath;
+        for (size_t i = 0; i < namePaths.size(); i++)
+        {
+            if (prefix.empty())
+            {
+                elements[i] = findNamePath(namePaths[i]);
+                continue;
+            }
+            prefixedPath.assign(prefix);
+            prefixedPath.append(NAME_PATH_SEPARATOR);
+            prefixedPath.append(namePaths[i]);
+            elements[i] = findNamePath(prefixedPath);
+        }
+        return true;
+    }
+
     vector<PortElementPtr> getMatchingPorts(const string& nodeName)
     {
+        if (isFrozen())
+        {
+            return findMatches(_portElementMap, nodeName);
+        }
         auto lock = refreshWithLock();
-        auto it = _portElementMap.find(nodeName);
-        return (it != _portElementMap.end()) ? it->second : vector<PortElementPtr>();
+        return findMatches(_portElementMap, nodeName);
     }
 
-    vector<NodeDefPtr> getMatchingNodeDefs(const string& nodeName)
+    // Return the cached vector of nodedefs with the given node name, which
+    // remains valid until the document is modified.
+    const vector<NodeDefPtr>& getMatchingNodeDefs(const string& nodeName)
     {
+        if (isFrozen())
+        {
+            return findMatches(_nodeDefMap, nodeName);
+        }
         auto lock = refreshWithLock();
-        auto it = _nodeDefMap.find(nodeName);
-        return (it != _nodeDefMap.end()) ? it->second : vector<NodeDefPtr>();
+        return findMatches(_nodeDefMap, nodeName);
     }
 
-    vector<InterfaceElementPtr> getMatchingImplementations(const string& nodeDef)
+    // Return the cached vector of implementations of the given nodedef, which
+    // remains valid until the document is modified.
+    const vector<InterfaceElementPtr>& getMatchingImplementations(const string& nodeDef)
     {
+        if (isFrozen())
+        {
+            return findMatches(_implementationMap, nodeDef);
+        }
         auto lock = refreshWithLock();
-        auto it = _implementationMap.find(nodeDef);
-        return (it != _implementationMap.end()) ? it->second : vector<InterfaceElementPtr>();
+        return findMatches(_implementationMap, nodeDef);
+    }
+
+    // Return the concatenation of the given data library and local nodedefs,
+    // which remains valid until either document is modified.
+    const vector<NodeDefPtr>& getMergedNodeDefs(const string& nodeName, const vector<NodeDefPtr>& libraryNodeDefs,
+                                                const vector<NodeDefPtr>& localNodeDefs, const Document& doc)
+    {
+        return getMergedMatches(_mergedNodeDefMap, nodeName, libraryNodeDefs, localNodeDefs, doc);
+    }
+
+    // Return the concatenation of the given data library and local
+    // implementations, which remains valid until either document is modified.
+    const vector<InterfaceElementPtr>& getMergedImplementations(const string& nodeDef, const vector<InterfaceElementPtr>& libraryImpls,
+                                                                const vector<InterfaceElementPtr>& localImpls, const Document& doc)
+    {
+        return getMergedMatches(_mergedImplementationMap, nodeDef, libraryImpls, localImpls, doc);
+    }
+
+    // Return the first nodedef with the given node name that exactly matches
+    // the given query, storing the first rough match if requested.
+    NodeDefPtr findNodeDef(const string& nodeName, const NodeDefQuery& query, NodeDefPtr* roughMatch)
+    {
+        if (!isFrozen())
+        {
+            for (const NodeDefPtr& nodeDef : getMatchingNodeDefs(nodeName))
+            {
+                if (!targetStringsMatch(nodeDef->getTarget(), query.target) ||
+                    !nodeDef->isVersionCompatible(query.version) ||
+                    nodeDef->getType() != query.type)
+                {
+                    continue;
+                }
+                bool exactMatch = true;
+                for (const InputPtr& input : query.inputs)
+                {
+                    InputPtr declarationInput = nodeDef->getActiveInput(input->getName());
+                    if (!declarationInput || declarationInput->getType() != input->getType())
+                    {
+                        exactMatch = false;
+                        break;
+                    }
+                }
+                if (exactMatch)
+                {
+                    return nodeDef;
+                }
+                if (roughMatch && !*roughMatch)
+                {
+                    *roughMatch = nodeDef;
+                }
+            }
+            return NodeDefPtr();
+        }
+
+        auto nameIt = _frozenNodeDefMap.find(nodeName);
+        if (nameIt == _frozenNodeDefMap.end())
+        {
+            return NodeDefPtr();
+        }
+        auto typeIt = nameIt->second.find(query.type);
+        if (typeIt == nameIt->second.end())
+        {
+            return NodeDefPtr();
+        }
+        for (const FrozenNodeDef& entry : typeIt->second)
+        {
+            if (!targetSetsMatch(entry.targets, query.targets) ||
+                !entry.isVersionCompatible(query.version))
+            {
+                continue;
+            }
+            if (entry.hasExactInputMatch(query))
+            {
+                return entry.nodeDef;
+            }
+            if (roughMatch && !*roughMatch)
+            {
+                *roughMatch = entry.nodeDef;
+            }
+        }
+        return NodeDefPtr();
     }
 
   private:
+    template <class T> static const vector<T>& findMatches(const std::unordered_map<string, vector<T>>& map, const string& key)
+    {
+        static const vector<T> EMPTY_MATCHES;
+        auto it = map.find(key);
+        return (it != map.end()) ? it->second : EMPTY_MATCHES;
+    }
+
+    template <class T> const vector<T>& getMergedMatches(std::unordered_map<string, vector<T>>& map, const string& key,
+                                                         const vector<T>& libraryMatches, const vector<T>& localMatches,
+                                                         const Document& doc)
+    {
+        // Merged vectors are discarded when the given document or any of
+        // its data libraries has been modified or replaced.
+        size_t revision = 0;
+        for (const Document* chainDoc = &doc; chainDoc; chainDoc = chainDoc->_dataLibrary.get())
+        {
+            hashCombine(revision, chainDoc);
+            hashCombine(revision, chainDoc->getRevision());
+        }
+
+        std::lock_guard<std::mutex> lock(_mergedMutex);
+        if (revision != _mergedRevision)
+        {
+            _mergedNodeDefMap.clear();
+            _mergedImplementationMap.clear();
+            _mergedRevision = revision;
+        }
+        auto it = map.find(key);
+        if (it == map.end())
+        {
+            vector<T> merged = libraryMatches;
+            merged.insert(merged.end(), localMatches.begin(), localMatches.end());
+            it = map.emplace(key, std::move(merged)).first;
+        }
+        return it->second;
+    }
+
     std::shared_lock<std::shared_mutex> refreshWithLock()
     {
         std::shared_lock<std::shared_mutex> lock(_mutex);
@@ -105,53 +594,141 @@ class Document::Cache
         _implementationMap.clear();
 
         // Traverse the document to build a new cache.
-        for (ElementPtr elem : doc->traverseTree())
+        _valid = false;
+        for (Element* elem : doc->traverseTreeRaw())
+        {
+            updateEntries(elem, true);
+        }
+
+        _valid = true;
+    }
+
+    // Return true if the given element is reachable from the cached document.
+    bool isAttached(ConstElementPtr elem) const
+    {
+        ConstElementPtr child = elem;
+        for (ConstElementPtr parent = elem->getParent(); parent; parent = parent->getParent())
         {
-            const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
-            const string& nodeGraphName = elem->getAttribute(PortElement::NODE_GRAPH_ATTRIBUTE);
-            const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
-            const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+            if (parent->getChild(child->getName()) != child)
+            {
+                return false;
+            }
+            child = parent;
+        }
+        return child == _doc.lock();
+    }
 
-            const string& portKey = !nodeName.empty() ? nodeName : nodeGraphName;
-            if (!portKey.empty())
+    void updateNamePaths(const ElementPtr& elem, const string& namePath, bool includeElement, bool add)
+    {
+        if (includeElement && !namePath.empty())
+        {
+            if (add)
             {
-                PortElementPtr portElem = elem->asA<PortElement>();
-                if (portElem)
-                {
-                    _portElementMap[portElem->getQualifiedName(portKey)].push_back(portElem);
-                }
+                _namePathIndex[namePath] = elem;
+            }
+            else
+            {
+                _namePathIndex.erase(namePath);
+            }
+        }
+        for (const ElementPtr& child : elem->getChildren())
+        {
+            const string& name = child->getName();
+            updateNamePaths(child, namePath.empty() ? name : namePath + NAME_PATH_SEPARATOR + name, true, add);
+        }
+    }
+
+    ElementPtr findNamePath(const string& namePath) const
+    {
+        auto it = _namePathIndex.find(namePath);
+        return (it != _namePathIndex.end()) ? it->second : ElementPtr();
+    }
+
+    // Add or remove the cache entries for a single element.  While the cache
+    // is valid, new entries are inserted in document order, matching the
+    // order produced by a full rebuild.
+    void updateEntries(Element* elem, bool add)
+    {
+        const string& nodeName = elem->getAttribute(PortElement::NODE_NAME_ATTRIBUTE);
+        const string& nodeGraphName = elem->getAttribute(PortElement::NODE_GRAPH_ATTRIBUTE);
+        const string& nodeString = elem->getAttribute(NodeDef::NODE_ATTRIBUTE);
+        const string& nodeDefString = elem->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+
+        const string& portKey = !nodeName.empty() ? nodeName : nodeGraphName;
+        if (!portKey.empty())
+        {
+            PortElementPtr portElem = elem->asA<PortElement>();
+            if (portElem)
+            {
+                updateEntry(_portElementMap, portElem->getQualifiedName(portKey), portElem, add);
             }
-            if (!nodeString.empty())
+        }
+        if (!nodeString.empty())
+        {
+            NodeDefPtr nodeDef = elem->asA<NodeDef>();
+            if (nodeDef)
             {
-                NodeDefPtr nodeDef = elem->asA<NodeDef>();
-                if (nodeDef)
+                updateEntry(_nodeDefMap, nodeDef->getQualifiedName(nodeString), nodeDef, add);
+            }
+        }
+        if (!nodeDefString.empty())
+        {
+            InterfaceElementPtr interface = elem->asA<InterfaceElement>();
+            if (interface)
+            {
+                if (interface->isA<Implementation>() || interface->isA<NodeGraph>())
                 {
-                    _nodeDefMap[nodeDef->getQualifiedName(nodeString)].push_back(nodeDef);
+                    updateEntry(_implementationMap, interface->getQualifiedName(nodeDefString), interface, add);
                 }
             }
-            if (!nodeDefString.empty())
+        }
+    }
+
+    template <class T> void updateEntry(std::unordered_map<string, vector<T>>& map, const string& key, const T& elem, bool add)
+    {
+        if (add)
+        {
+            vector<T>& entries = map[key];
+            auto it = entries.end();
+            if (_valid)
             {
-                InterfaceElementPtr interface = elem->asA<InterfaceElement>();
-                if (interface)
+                while (it != entries.begin() && precedesInDocument(elem, *(it - 1)))
                 {
-                    if (interface->isA<Implementation>() || interface->isA<NodeGraph>())
-                    {
-                        _implementationMap[interface->getQualifiedName(nodeDefString)].push_back(interface);
-                    }
+                    --it;
                 }
             }
+            entries.insert(it, elem);
+            return;
         }
 
-        _valid = true;
+        auto mapIt = map.find(key);
+        if (mapIt != map.end())
+        {
+            vector<T>& entries = mapIt->second;
+            entries.erase(std::remove(entries.begin(), entries.end(), elem), entries.end());
+            if (entries.empty())
+            {
+                map.erase(mapIt);
+            }
+        }
     }
 
   private:
     weak_ptr<Document> _doc;
     mutable std::shared_mutex _mutex;
-    bool _valid;
+    std::atomic<bool> _valid;
+    std::atomic<bool> _frozen;
+    mutable std::atomic<uint64_t> _revision;
     std::unordered_map<string, std::vector<PortElementPtr>> _portElementMap;
     std::unordered_map<string, std::vector<NodeDefPtr>> _nodeDefMap;
     std::unordered_map<string, std::vector<InterfaceElementPtr>> _implementationMap;
+    std::unordered_map<string, std::unordered_map<string, vector<FrozenNodeDef>>> _frozenNodeDefMap;
+    std::atomic<bool> _namePathIndexEnabled;
+    std::unordered_map<string, ElementPtr> _namePathIndex;
+    std::mutex _mergedMutex;
+    size_t _mergedRevision;
+    std::unordered_map<string, std::vector<NodeDefPtr>> _mergedNodeDefMap;
+    std::unordered_map<string, std::vector<InterfaceElementPtr>> _mergedImplementationMap;
 };
 
 //
@@ -310,7 +887,7 @@ void Document::importLibrary(const ConstDocumentPtr& library)
 StringSet Document::getReferencedSourceUris() const
 {
     StringSet sourceUris;
-    for (ElementPtr elem : traverseTree())
+    for (Element* elem : traverseTreeRaw())
     {
         if (elem->hasSourceUri())
         {
@@ -375,48 +952,215 @@ vector<OutputPtr> Document::getMaterialOutputs() const
     return materialOutputs;
 }
 
-vector<NodeDefPtr> Document::getMatchingNodeDefs(const string& nodeName) const
+const vector<NodeDefPtr>& Document::getMatchingNodeDefs(const string& nodeName) const
 {
-    // Recurse to data library if present.
-    vector<NodeDefPtr> matchingNodeDefs = hasDataLibrary() ?
-                                          getDataLibrary()->getMatchingNodeDefs(nodeName) :
-                                          vector<NodeDefPtr>();
-
-    // Append all nodedefs matching the given node name.
-    vector<NodeDefPtr> localNodeDefs = _cache->getMatchingNodeDefs(nodeName);
-    matchingNodeDefs.insert(matchingNodeDefs.end(), localNodeDefs.begin(), localNodeDefs.end());
+    const vector<NodeDefPtr>& localNodeDefs = _cache->getMatchingNodeDefs(nodeName);
+    if (!hasDataLibrary())
+    {
+        return localNodeDefs;
+    }
 
-    return matchingNodeDefs;
+    // Recurse to the data library, returning its vector directly unless both
+    // documents hold matching nodedefs.
+    const vector<NodeDefPtr>& libraryNodeDefs = getDataLibrary()->getMatchingNodeDefs(nodeName);
+    if (localNodeDefs.empty())
+    {
+        return libraryNodeDefs;
+    }
+    if (libraryNodeDefs.empty())
+    {
+        return localNodeDefs;
+    }
+    return _cache->getMergedNodeDefs(nodeName, libraryNodeDefs, localNodeDefs, *this);
 }
 
-vector<InterfaceElementPtr> Document::getMatchingImplementations(const string& nodeDef) const
+const vector<InterfaceElementPtr>& Document::getMatchingImplementations(const string& nodeDef) const
 {
-    // Recurse to data library if present.
-    vector<InterfaceElementPtr> matchingImplementations = hasDataLibrary() ?
-                                                          getDataLibrary()->getMatchingImplementations(nodeDef) :
-                                                          vector<InterfaceElementPtr>();
+    const vector<InterfaceElementPtr>& localImpls = _cache->getMatchingImplementations(nodeDef);
+    if (!hasDataLibrary())
+    {
+        return localImpls;
+    }
+
+    // Recurse to the data library, returning its vector directly unless both
+    // documents hold matching implementations.
+    const vector<InterfaceElementPtr>& libraryImpls = getDataLibrary()->getMatchingImplementations(nodeDef);
+    if (localImpls.empty())
+    {
+        return libraryImpls;
+    }
+    if (libraryImpls.empty())
+    {
+        return localImpls;
+    }
+    return _cache->getMergedImplementations(nodeDef, libraryImpls, localImpls, *this);
+}
 
-    // Append all implementations matching the given nodedef string.
-    vector<InterfaceElementPtr> localImpls = _cache->getMatchingImplementations(nodeDef);
-    matchingImplementations.insert(matchingImplementations.end(), localImpls.begin(), localImpls.end());
+NodeDefPtr Document::getMatchingNodeDef(ConstNodePtr node, const string& target, bool allowRoughMatch) const
+{
+    // Gather the documents to be searched, with data libraries first.
+    vector<const Document*> documents;
+    for (const Document* doc = this; doc; doc = doc->_dataLibrary.get())
+    {
+        documents.insert(documents.begin(), doc);
+    }
 
-    return matchingImplementations;
+    // Search for nodedefs matching the qualified category of the node,
+    // followed by its unqualified category.
+    const string& category = node->getCategory();
+    const string qualifiedCategory = node->getQualifiedName(category);
+    const NodeDefQuery query(node, target);
+    NodeDefPtr roughMatch;
+    for (const string* nodeName : { &qualifiedCategory, &category })
+    {
+        for (const Document* doc : documents)
+        {
+            NodeDefPtr nodeDef = doc->_cache->findNodeDef(*nodeName, query, allowRoughMatch ? &roughMatch : nullptr);
+            if (nodeDef)
+            {
+                return nodeDef;
+            }
+        }
+    }
+    return roughMatch;
 }
 
 bool Document::validate(string* message) const
 {
+    // Outside of a structured validation pass, run the document through the
+    // validation engine and format its diagnostics as text.
+    if (!isValidationInProgress())
+    {
+        vector<ValidationDiagnostic> diagnostics;
+        bool res = validate(diagnostics);
+        if (message)
+        {
+            for (const ValidationDiagnostic& diagnostic : diagnostics)
+            {
+                *message += diagnostic.asString() + "\n";
+            }
+        }
+        return res;
+    }
+
     bool res = true;
     std::pair<int, int> expectedVersion(MATERIALX_MAJOR_VERSION, MATERIALX_MINOR_VERSION);
-    validateRequire(getVersionIntegers() >= expectedVersion, res, message, "Unsupported document version");
-    validateRequire(getVersionIntegers() <= expectedVersion, res, message, "Future document version");
+    validateRequire(getVersionIntegers() >= expectedVersion, res, message, "Unsupported document version", "document.version");
+    validateRequire(getVersionIntegers() <= expectedVersion, res, message, "Future document version", "document.futureVersion");
     return GraphElement::validate(message) && res;
 }
 
+bool Document::validate(vector<ValidationDiagnostic>& diagnostics, unsigned int threadCount) const
+{
+    return validateTree(diagnostics, threadCount);
+}
+
 void Document::invalidateCache()
 {
     _cache->invalidate();
 }
 
+void Document::flattenAllSubgraphs(const string& target, NodePredicate filter, unsigned int threadCount)
+{
+    vector<GraphElementPtr> graphs = { getSelf()->asA<GraphElement>() };
+    for (NodeGraphPtr graph : getNodeGraphs())
+    {
+        if (graph->belongsToContentDocument())
+        {
+            graphs.push_back(graph);
+        }
+    }
+    flattenGraphElements(graphs, target, filter, threadCount);
+}
+
+void Document::checkMutable() const
+{
+    _cache->checkMutable();
+}
+
+void Document::removeFromCache(ElementPtr elem, bool recursive)
+{
+    _cache->removeElement(elem, recursive);
+}
+
+void Document::addToCache(ElementPtr elem, bool recursive)
+{
+    _cache->addElement(elem, recursive);
+}
+
+uint64_t Document::getRevision() const
+{
+    return _cache->getRevision();
+}
+
+bool Document::isCacheAttribute(const string& attrib)
+{
+    return attrib == PortElement::NODE_NAME_ATTRIBUTE ||
+           attrib == PortElement::NODE_GRAPH_ATTRIBUTE ||
+           attrib == NodeDef::NODE_ATTRIBUTE ||
+           attrib == InterfaceElement::NODE_DEF_ATTRIBUTE ||
+           attrib == Element::NAMESPACE_ATTRIBUTE;
+}
+
+void Document::freeze()
+{
+    _cache->freeze();
+}
+
+bool Document::isFrozen() const
+{
+    return _cache->isFrozen();
+}
+
+void Document::setNamePathIndexEnabled(bool enable)
+{
+    _cache->setNamePathIndexEnabled(enable);
+}
+
+bool Document::isNamePathIndexEnabled() const
+{
+    return _cache->isNamePathIndexEnabled();
+}
+
+ElementPtr Document::getDescendant(const string& namePath) const
+{
+    ElementPtr elem;
+    if (!namePath.empty() && _cache->resolveNamePath(namePath, elem))
+    {
+        return elem;
+    }
+    return Element::getDescendant(namePath);
+}
+
+void Document::addToNamePathIndex(ElementPtr elem, bool includeElement)
+{
+    _cache->updateNamePathIndex(elem, includeElement, true);
+}
+
+void Document::removeFromNamePathIndex(ElementPtr elem, bool includeElement)
+{
+    _cache->updateNamePathIndex(elem, includeElement, false);
+}
+
+bool Document::resolveNamePaths(ConstElementPtr elem, const StringVec& namePaths, ElementVec& elements) const
+{
+    const string prefix = (elem.get() != this) ? elem->getNamePath() : EMPTY_STRING;
+    if (!_cache->resolveNamePaths(prefix, namePaths, elements))
+    {
+        return false;
+    }
+
+    // Resolve empty and non-canonical paths, which are not stored in the index.
+    for (size_t i = 0; i < namePaths.size(); i++)
+    {
+        if (!elements[i] && (namePaths[i].empty() || !isCanonicalNamePath(namePaths[i])))
+        {
+            elements[i] = elem->Element::getDescendant(namePaths[i]);
+        }
+    }
+    return true;
+}
+
 //
 // Deprecated methods
 //
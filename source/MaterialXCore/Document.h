@@ -42,18 +42,36 @@ class MX_CORE_API Document : public GraphElement
         return doc;
     }
 
+    /// Create a new document of the given subclass, whose elements are
+    /// allocated from the given arena.
+    template <class T> static shared_ptr<T> createDocument(ElementArenaPtr arena)
+    {
+        shared_ptr<T> doc = std::allocate_shared<T>(ElementAllocator<T>(arena), ElementPtr(), EMPTY_STRING);
+        doc->_elementArena = arena;
+        doc->initialize();
+        return doc;
+    }
+
     /// Initialize the document, removing any existing content.
     virtual void initialize();
 
     /// Create a deep copy of the document.
     virtual DocumentPtr copy() const
     {
-        DocumentPtr doc = createDocument<Document>();
+        DocumentPtr doc = _elementArena ? createDocument<Document>(_elementArena) : createDocument<Document>();
         doc->copyContentFrom(getSelf());
         doc->setDataLibrary(getDataLibrary());
         return doc;
     }
 
+    /// Return the arena from which the elements of this document are
+    /// allocated, or an empty shared pointer if elements are allocated from
+    /// the heap.
+    ElementArenaPtr getElementArena() const override
+    {
+        return _elementArena;
+    }
+
     /// Get a list of source URIs referenced by the document
     StringSet getReferencedSourceUris() const;
 
@@ -383,8 +401,24 @@ class MX_CORE_API Document : public GraphElement
         removeChildOfType<NodeDef>(name);
     }
 
-    /// Return a vector of all NodeDef elements that match the given node name.
-    vector<NodeDefPtr> getMatchingNodeDefs(const string& nodeName) const;
+    /// Return a vector of all NodeDef elements that match the given node name,
+    /// with those of the data library first.  The returned vector is held by
+    /// the cache of the document, and remains valid until this document or
+    /// its data library is modified.
+    const vector<NodeDefPtr>& getMatchingNodeDefs(const string& nodeName) const;
+
+    /// Return the first NodeDef, if any, in this document or its data library
+    /// that matches the category, type, version and inputs of the given node,
+    /// using the same search order as Node::getNodeDef.  Lookups within frozen
+    /// documents use precomputed tables and proceed without locking.
+    /// @param node The node whose declaration is requested.
+    /// @param target An optional target name, which will be used to filter
+    ///    the nodedefs that are considered.
+    /// @param allowRoughMatch If specified, then a rough match will be allowed
+    ///    when an exact match is not found.
+    NodeDefPtr getMatchingNodeDef(ConstNodePtr node,
+                                  const string& target = EMPTY_STRING,
+                                  bool allowRoughMatch = false) const;
 
     /// @}
     /// @name AttributeDef Elements
@@ -548,8 +582,10 @@ class MX_CORE_API Document : public GraphElement
 
     /// Return a vector of all node implementations that match the given
     /// NodeDef string.  Note that a node implementation may be either an
-    /// Implementation element or NodeGraph element.
-    vector<InterfaceElementPtr> getMatchingImplementations(const string& nodeDef) const;
+    /// Implementation element or NodeGraph element.  The returned vector is
+    /// held by the cache of the document, and remains valid until this
+    /// document or its data library is modified.
+    const vector<InterfaceElementPtr>& getMatchingImplementations(const string& nodeDef) const;
 
     /// @}
     /// @name UnitDef Elements
@@ -679,6 +715,19 @@ class MX_CORE_API Document : public GraphElement
     /// @return True if the document passes all tests, false otherwise.
     bool validate(string* message = nullptr) const override;
 
+    /// Validate that the given document is consistent with the MaterialX
+    /// specification, returning a structured diagnostic for each failed
+    /// check.  The top-level elements of the document are validated as
+    /// independent tasks, which may be run in parallel.
+    /// @param diagnostics A vector to which a diagnostic is appended for each
+    ///    failed check, in the order in which they would be reported by the
+    ///    message string of validate.
+    /// @param threadCount The number of threads used to validate top-level
+    ///    elements, where a value of zero selects the number of hardware
+    ///    threads.  Defaults to one, validating serially.
+    /// @return True if the document passes all tests, false otherwise.
+    bool validate(vector<ValidationDiagnostic>& diagnostics, unsigned int threadCount = 1) const;
+
     /// @}
     /// @name Utility
     /// @{
@@ -686,6 +735,60 @@ class MX_CORE_API Document : public GraphElement
     /// Invalidate cached data for optimized lookups within the given document.
     void invalidateCache();
 
+    /// Flatten all subgraphs at the root scope of this document and within
+    /// each top-level node graph that belongs to the content document,
+    /// recursively replacing each graph-defined node with its equivalent
+    /// node network.  Each graph implementation is prepared once and shared
+    /// across all of its instances, and independent node graphs may be
+    /// flattened concurrently.
+    /// @param target An optional target string to be used in specifying
+    ///     which node definitions are used in this process.
+    /// @param filter An optional node predicate specifying which nodes
+    ///     should be included and excluded from this process.  The predicate
+    ///     is only called from the calling thread, before any node graphs are
+    ///     flattened concurrently, and is applied to the nodes of each graph
+    ///     implementation as it is prepared.
+    /// @param threadCount The number of threads used to flatten node graphs,
+    ///     where a value of zero selects the number of hardware threads.
+    ///     Defaults to one, flattening serially.
+    void flattenAllSubgraphs(const string& target = EMPTY_STRING,
+                             NodePredicate filter = nullptr,
+                             unsigned int threadCount = 1);
+
+    /// @}
+    /// @name Frozen Documents
+    /// @{
+
+    /// Freeze the document, sealing it as read-only and precomputing tables
+    /// for the resolution of nodedefs and implementations.  This is intended
+    /// for data libraries that are shared across threads with setDataLibrary,
+    /// allowing definition lookups from any number of threads to proceed
+    /// without locks.  Freezing cannot be reversed, and any later attempt to
+    /// modify the document throws an Exception.
+    void freeze();
+
+    /// Return true if this document has been frozen.
+    bool isFrozen() const;
+
+    /// @}
+    /// @name Name Path Index
+    /// @{
+
+    /// Enable or disable the name path index of the document.  While enabled,
+    /// the document maintains a table from the name path of each element to
+    /// the element itself, allowing getDescendant and getDescendants to
+    /// resolve name paths from the document with a single hash lookup.  The
+    /// table is updated incrementally as elements are added, removed, and
+    /// renamed.  The index is disabled by default.
+    void setNamePathIndexEnabled(bool enable);
+
+    /// Return true if the name path index of the document is enabled.
+    bool isNamePathIndexEnabled() const;
+
+    /// Return the element specified by the given hierarchical name path,
+    /// relative to the document, using the name path index if it is enabled.
+    ElementPtr getDescendant(const string& namePath) const override;
+
     /// @}
 
     //
@@ -700,18 +803,54 @@ class MX_CORE_API Document : public GraphElement
     static const string CMS_ATTRIBUTE;
     static const string CMS_CONFIG_ATTRIBUTE;
 
+  private:
+    friend class Collection;
+    friend class Element;
+    friend class GraphElement;
+
+    // Cache maintenance hooks, called by Element methods that modify the
+    // document.  Modifications that may affect cached lookups are bracketed
+    // by calls to removeFromCache and addToCache, allowing the cache to be
+    // updated in place rather than rebuilt.  Other modifications need only
+    // call checkMutable.
+    void checkMutable() const;
+    void removeFromCache(ElementPtr elem, bool recursive);
+    void addToCache(ElementPtr elem, bool recursive);
+    static bool isCacheAttribute(const string& attrib);
+
+    // Name path index maintenance hooks, called by Element methods that add,
+    // remove, or rename elements.  Removals are reported before an element
+    // is detached or renamed, and additions after it is attached or renamed.
+    void addToNamePathIndex(ElementPtr elem, bool includeElement);
+    void removeFromNamePathIndex(ElementPtr elem, bool includeElement);
+
+    // Resolve name paths relative to the given element through the name path
+    // index, returning false if the index is disabled.
+    bool resolveNamePaths(ConstElementPtr elem, const StringVec& namePaths, ElementVec& elements) const;
+
+    // Return a counter that is advanced by every modification of the
+    // document, allowing derived data such as graph indices to detect edits.
+    uint64_t getRevision() const;
+
   private:
     class Cache;
 
   private:
     ConstDocumentPtr _dataLibrary;
     std::unique_ptr<Cache> _cache;
+    ElementArenaPtr _elementArena;
 };
 
 /// Create a new Document.
 /// @relates Document
 MX_CORE_API DocumentPtr createDocument();
 
+/// Create a new Document whose elements are allocated from the given arena.
+/// An arena may be shared by several documents, and is released once the
+/// last element allocated from it has been destroyed.
+/// @relates Document
+MX_CORE_API DocumentPtr createDocument(ElementArenaPtr arena);
+
 MATERIALX_NAMESPACE_END
 
 #endif
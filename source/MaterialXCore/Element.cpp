@@ -8,6 +8,7 @@
 #include <MaterialXCore/Document.h>
 #include <MaterialXCore/Util.h>
 
+#include <algorithm>
 #include <iterator>
 
 MATERIALX_NAMESPACE_BEGIN
@@ -42,6 +43,338 @@ const string ValueElement::UNIFORM_ATTRIBUTE = "uniform";
 
 Element::CreatorMap Element::_creatorMap;
 
+namespace
+{
+
+// The state of a structured validation pass on the current thread.
+struct ValidationScope
+{
+    // The vector to which diagnostics are appended.
+    vector<ValidationDiagnostic>* diagnostics = nullptr;
+
+    // An element whose children are validated separately, and the position
+    // within the diagnostics vector at which their diagnostics belong.
+    const Element* deferredParent = nullptr;
+    size_t deferredPosition = 0;
+    bool deferred = false;
+};
+
+thread_local ValidationScope* currentValidationScope = nullptr;
+
+// Install a validation scope on the current thread for the lifetime of this
+// object, restoring the previous scope on destruction.
+class ValidationScopeGuard
+{
+  public:
+    explicit ValidationScopeGuard(ValidationScope* scope) :
+        _previous(currentValidationScope)
+    {
+        currentValidationScope = scope;
+    }
+    ~ValidationScopeGuard()
+    {
+        currentValidationScope = _previous;
+    }
+
+  private:
+    ValidationScope* _previous;
+};
+
+} // anonymous namespace
+
+//
+// AttributeStore methods
+//
+
+AttributeStore::AttributeStore() :
+    _data(inlineData()),
+    _size(0),
+    _capacity(INLINE_CAPACITY)
+{
+}
+
+AttributeStore::~AttributeStore()
+{
+    clear();
+    if (_data != inlineData())
+    {
+        ::operator delete(_data);
+    }
+}
+
+AttributeStore::AttributeStore(const AttributeStore& other) :
+    AttributeStore()
+{
+    *this = other;
+}
+
+AttributeStore& AttributeStore::operator=(const AttributeStore& other)
+{
+    if (this != &other)
+    {
+        clear();
+        for (const Attribute& attr : other)
+        {
+            append(attr.first, attr.second);
+        }
+    }
+    return *this;
+}
+
+AttributeStore::AttributeStore(AttributeStore&& other) noexcept :
+    AttributeStore()
+{
+    moveFrom(other);
+}
+
+AttributeStore& AttributeStore::operator=(AttributeStore&& other) noexcept
+{
+    if (this != &other)
+    {
+        clear();
+        if (_data != inlineData())
+        {
+            ::operator delete(_data);
+            _data = inlineData();
+            _capacity = INLINE_CAPACITY;
+        }
+        moveFrom(other);
+    }
+    return *this;
+}
+
+const string* AttributeStore::find(const string& name) const
+{
+    size_t index = findIndex(name);
+    return (index < _size) ? &_data[index].second : nullptr;
+}
+
+void AttributeStore::set(const string& name, const string& value)
+{
+    size_t index = findIndex(name);
+    if (index < _size)
+    {
+        _data[index].second = value;
+    }
+    else
+    {
+        append(&internString(name), value);
+    }
+}
+
+bool AttributeStore::remove(const string& name)
+{
+    size_t index = findIndex(name);
+    if (index >= _size)
+    {
+        return false;
+    }
+    for (size_t i = index + 1; i < _size; i++)
+    {
+        _data[i - 1] = std::move(_data[i]);
+    }
+    _data[--_size].~Attribute();
+    if (_index)
+    {
+        buildIndex();
+    }
+    return true;
+}
+
+void AttributeStore::clear()
+{
+    for (size_t i = 0; i < _size; i++)
+    {
+        _data[i].~Attribute();
+    }
+    _size = 0;
+    _index.reset();
+}
+
+size_t AttributeStore::findIndex(const string& name) const
+{
+    if (_index)
+    {
+        auto it = _index->find(name);
+        return (it != _index->end()) ? it->second : _size;
+    }
+    for (size_t i = 0; i < _size; i++)
+    {
+        if (_data[i].first == &name || *_data[i].first == name)
+        {
+            return i;
+        }
+    }
+    return _size;
+}
+
+void AttributeStore::append(const string* name, const string& value)
+{
+    if (_size == _capacity)
+    {
+        // Construct the new attribute before moving existing attributes, in
+        // case the given value refers to one of them.
+        size_t capacity = _capacity * 2;
+        Attribute* data = static_cast<Attribute*>(::operator new(capacity * sizeof(Attribute)));
+        new (data + _size) Attribute(name, value);
+        for (size_t i = 0; i < _size; i++)
+        {
+            new (data + i) Attribute(std::move(_data[i]));
+            _data[i].~Attribute();
+        }
+        if (_data != inlineData())
+        {
+            ::operator delete(_data);
+        }
+        _data = data;
+        _capacity = capacity;
+    }
+    else
+    {
+        new (_data + _size) Attribute(name, value);
+    }
+    _size++;
+
+    if (_index)
+    {
+        _index->emplace(*name, _size - 1);
+    }
+    else if (_size > INDEX_THRESHOLD)
+    {
+        buildIndex();
+    }
+}
+
+void AttributeStore::moveFrom(AttributeStore& other) noexcept
+{
+    // Heap storage is transferred directly, while inline attributes are
+    // moved individually.  The index refers only to interned names, so it
+    // remains valid in either case.
+    if (other._data != other.inlineData())
+    {
+        _data = other._data;
+        _capacity = other._capacity;
+    }
+    else
+    {
+        for (size_t i = 0; i < other._size; i++)
+        {
+            new (_data + i) Attribute(std::move(other._data[i]));
+            other._data[i].~Attribute();
+        }
+    }
+    _size = other._size;
+    _index = std::move(other._index);
+
+    other._data = other.inlineData();
+    other._size = 0;
+    other._capacity = INLINE_CAPACITY;
+}
+
+void AttributeStore::buildIndex()
+{
+    if (_size <= INDEX_THRESHOLD)
+    {
+        _index.reset();
+        return;
+    }
+    if (!_index)
+    {
+        _index = std::make_unique<std::unordered_map<std::string_view, size_t>>();
+    }
+    _index->clear();
+    for (size_t i = 0; i < _size; i++)
+    {
+        _index->emplace(*_data[i].first, i);
+    }
+}
+
+//
+// ElementArena methods
+//
+
+ElementArena::ElementArena(size_t chunkSize) :
+    _chunkSize(chunkSize),
+    _next(nullptr),
+    _end(nullptr),
+    _reservedBytes(0),
+    _allocatedBytes(0)
+{
+}
+
+ElementArena::~ElementArena()
+{
+}
+
+void* ElementArena::allocate(size_t size)
+{
+    size = std::max((size + ALIGNMENT - 1) / ALIGNMENT, (size_t) 1) * ALIGNMENT;
+    size_t sizeClass = size / ALIGNMENT;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _allocatedBytes += size;
+
+    // Reuse a released block of the same size if one is available.
+    if (sizeClass < _freeLists.size() && _freeLists[sizeClass])
+    {
+        FreeBlock* block = _freeLists[sizeClass];
+        _freeLists[sizeClass] = block->next;
+        return block;
+    }
+
+    // Blocks larger than a chunk receive a chunk of their own.
+    if (size > _chunkSize)
+    {
+        _chunks.emplace_back(new char[size]);
+        _reservedBytes += size;
+        return _chunks.back().get();
+    }
+
+    // Otherwise carve the block from the current chunk.
+    if (size > (size_t) (_end - _next))
+    {
+        _chunks.emplace_back(new char[_chunkSize]);
+        _reservedBytes += _chunkSize;
+        _next = _chunks.back().get();
+        _end = _next + _chunkSize;
+    }
+    void* ptr = _next;
+    _next += size;
+    return ptr;
+}
+
+void ElementArena::deallocate(void* ptr, size_t size)
+{
+    if (!ptr)
+    {
+        return;
+    }
+    size = std::max((size + ALIGNMENT - 1) / ALIGNMENT, (size_t) 1) * ALIGNMENT;
+    size_t sizeClass = size / ALIGNMENT;
+
+    std::lock_guard<std::mutex> lock(_mutex);
+    _allocatedBytes -= size;
+    if (sizeClass >= _freeLists.size())
+    {
+        _freeLists.resize(sizeClass + 1, nullptr);
+    }
+    FreeBlock* block = static_cast<FreeBlock*>(ptr);
+    block->next = _freeLists[sizeClass];
+    _freeLists[sizeClass] = block;
+}
+
+size_t ElementArena::getReservedBytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _reservedBytes;
+}
+
+size_t ElementArena::getAllocatedBytes() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _allocatedBytes;
+}
+
 //
 // Element methods
 //
@@ -55,13 +388,9 @@ bool Element::operator==(const Element& rhs) const
     }
 
     // Compare attributes.
-    if (getAttributeNames() != rhs.getAttributeNames())
+    if (!std::equal(_attributes.begin(), _attributes.end(),
+                    rhs._attributes.begin(), rhs._attributes.end()))
         return false;
-    for (const string& attr : rhs.getAttributeNames())
-    {
-        if (getAttribute(attr) != rhs.getAttribute(attr))
-            return false;
-    }
 
     // Compare children.
     const ElementVec& c1 = getChildren();
@@ -89,7 +418,10 @@ void Element::setName(const string& name)
         throw Exception("Element name is not unique at the given scope: " + name);
     }
 
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    doc->checkMutable();
+    doc->removeFromNamePathIndex(getSelf(), true);
+    clearContentHash();
 
     if (parent)
     {
@@ -97,6 +429,8 @@ void Element::setName(const string& name)
         parent->_childMap[name] = getSelf();
     }
     _name = name;
+
+    doc->addToNamePathIndex(getSelf(), true);
 }
 
 string Element::getNamePath(ConstElementPtr relativeTo) const
@@ -133,17 +467,42 @@ ElementPtr Element::getDescendant(const string& namePath) const
     return elem;
 }
 
+ElementVec Element::getDescendants(const StringVec& namePaths) const
+{
+    ElementVec elements;
+    ConstDocumentPtr doc = !_root.expired() ? getDocument() : nullptr;
+    if (doc && doc->resolveNamePaths(getSelf(), namePaths, elements))
+    {
+        return elements;
+    }
+
+    elements.reserve(namePaths.size());
+    for (const string& namePath : namePaths)
+    {
+        elements.push_back(getDescendant(namePath));
+    }
+    return elements;
+}
+
 void Element::registerChildElement(ElementPtr child)
 {
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    doc->checkMutable();
+    clearContentHash();
 
     _childMap[child->getName()] = child;
     _childOrder.push_back(child);
+
+    doc->addToCache(child, true);
+    doc->addToNamePathIndex(child, true);
 }
 
 void Element::unregisterChildElement(ElementPtr child)
 {
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    doc->removeFromCache(child, true);
+    doc->removeFromNamePathIndex(child, true);
+    clearContentHash();
 
     _childMap.erase(child->getName());
     _childOrder.erase(
@@ -175,8 +534,14 @@ void Element::setChildIndex(const string& name, int index)
         throw Exception("Invalid child index");
     }
 
+    DocumentPtr doc = getDocument();
+    doc->removeFromCache(child, true);
+    clearContentHash();
+
     _childOrder.erase(it);
     _childOrder.insert(_childOrder.begin() + (size_t) index, child);
+
+    doc->addToCache(child, true);
 }
 
 void Element::removeChild(const string& name)
@@ -192,28 +557,66 @@ void Element::removeChild(const string& name)
 
 void Element::setAttribute(const string& attrib, const string& value)
 {
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    const bool cacheAttribute = Document::isCacheAttribute(attrib);
+    const bool recursive = (attrib == NAMESPACE_ATTRIBUTE);
+    if (cacheAttribute)
+    {
+        doc->removeFromCache(getSelf(), recursive);
+    }
+    else
+    {
+        doc->checkMutable();
+    }
 
-    if (!_attributeMap.count(attrib))
+    _attributes.set(attrib, value);
+    clearAttributeCache(attrib);
+    clearContentHash();
+
+    if (cacheAttribute)
     {
-        _attributeOrder.push_back(attrib);
+        doc->addToCache(getSelf(), recursive);
     }
-    _attributeMap[attrib] = value;
 }
 
 void Element::removeAttribute(const string& attrib)
 {
-    StringMap::iterator it = _attributeMap.find(attrib);
-    if (it != _attributeMap.end())
+    if (_attributes.find(attrib))
     {
-        getDocument()->invalidateCache();
+        DocumentPtr doc = getDocument();
+        const bool cacheAttribute = Document::isCacheAttribute(attrib);
+        const bool recursive = (attrib == NAMESPACE_ATTRIBUTE);
+        if (cacheAttribute)
+        {
+            doc->removeFromCache(getSelf(), recursive);
+        }
+        else
+        {
+            doc->checkMutable();
+        }
 
-        _attributeMap.erase(it);
-        _attributeOrder.erase(
-            std::find(_attributeOrder.begin(), _attributeOrder.end(), attrib));
+        _attributes.remove(attrib);
+        clearAttributeCache(attrib);
+        clearContentHash();
+
+        if (cacheAttribute)
+        {
+            doc->addToCache(getSelf(), recursive);
+        }
     }
 }
 
+StringVec Element::getAttributeNames() const
+{
+    StringVec names;
+    names.reserve(_attributes.size());
+    for (const auto& attr : _attributes)
+    {
+        names.push_back(*attr.first);
+    }
+    return names;
+}
+
 template <class T> shared_ptr<T> Element::asA()
 {
     return std::dynamic_pointer_cast<T>(getSelf());
@@ -359,6 +762,17 @@ ConstDocumentPtr Element::getDocument() const
     return getRoot()->asA<Document>();
 }
 
+ElementArenaPtr Element::getElementArena() const
+{
+    // The root document owns the arena for its tree.
+    ElementPtr root = _root.lock();
+    if (!root || root.get() == this)
+    {
+        return nullptr;
+    }
+    return root->getElementArena();
+}
+
 bool Element::belongsToContentDocument() const
 {
     return getActiveSourceUri() == getDocument()->getSourceUri();
@@ -517,6 +931,106 @@ bool Element::isAttributeEquivalent(ConstElementPtr rhs, const string& attribute
     return true;
 }
 
+string Element::getEquivalentAttributeString(const string& attrib, const ElementEquivalenceOptions& /*options*/) const
+{
+    return getAttribute(attrib);
+}
+
+uint64_t Element::getContentHash() const
+{
+    return getContentHash(ElementEquivalenceOptions());
+}
+
+uint64_t Element::getContentHash(const ElementEquivalenceOptions& options) const
+{
+    uint64_t optionsKey = stableHashInteger(STABLE_HASH_BASIS, options.performValueComparisons);
+    optionsKey = stableHashInteger(optionsKey, (uint64_t) options.floatFormat);
+    optionsKey = stableHashInteger(optionsKey, (uint64_t) options.floatPrecision);
+    for (const string& attr : options.attributeExclusionList)
+    {
+        optionsKey = stableHashString(optionsKey, attr);
+    }
+
+    // A key of zero marks an element with no cached hash.
+    return computeContentHash(options, optionsKey ? optionsKey : 1);
+}
+
+uint64_t Element::computeContentHash(const ElementEquivalenceOptions& options, uint64_t optionsKey) const
+{
+    if (_contentHashKey.load(std::memory_order_acquire) == optionsKey)
+    {
+        return _contentHash.load(std::memory_order_relaxed);
+    }
+
+    uint64_t hash = stableHashString(STABLE_HASH_BASIS, getCategory());
+    hash = stableHashString(hash, getName());
+
+    // Attributes are compared independent of their order.
+    vector<std::pair<const string*, string>> attributes;
+    attributes.reserve(_attributes.size());
+    for (const auto& attr : _attributes)
+    {
+        if (!options.attributeExclusionList.count(*attr.first))
+        {
+            attributes.emplace_back(attr.first, getEquivalentAttributeString(*attr.first, options));
+        }
+    }
+    std::sort(attributes.begin(), attributes.end(),
+        [](const auto& lhs, const auto& rhs) { return *lhs.first < *rhs.first; });
+    hash = stableHashInteger(hash, attributes.size());
+    for (const auto& attr : attributes)
+    {
+        hash = stableHashString(hash, *attr.first);
+        hash = stableHashString(hash, attr.second);
+    }
+
+    // Combine the hashes of all children that affect functional equivalence.
+    // As in isEquivalent, the children of documents and compound graphs are
+    // compared independent of their order.
+    vector<uint64_t> childHashes;
+    childHashes.reserve(_childOrder.size());
+    for (const ElementPtr& child : _childOrder)
+    {
+        if (child->getCategory() != CommentElement::CATEGORY)
+        {
+            childHashes.push_back(child->computeContentHash(options, optionsKey));
+        }
+    }
+    const NodeGraph* nodeGraph = dynamic_cast<const NodeGraph*>(this);
+    if (dynamic_cast<const Document*>(this) || (nodeGraph && !nodeGraph->getNodeDef()))
+    {
+        std::sort(childHashes.begin(), childHashes.end());
+    }
+    hash = stableHashInteger(hash, childHashes.size());
+    for (uint64_t childHash : childHashes)
+    {
+        hash = stableHashInteger(hash, childHash);
+    }
+
+    _contentHash.store(hash, std::memory_order_relaxed);
+    _contentHashKey.store(optionsKey, std::memory_order_release);
+    return hash;
+}
+
+void Element::clearContentHash()
+{
+    // A cached hash implies cached hashes for all descendants, so ancestors
+    // need only be visited until one is found with no cached hash.
+    if (!_contentHashKey.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    _contentHashKey.store(0, std::memory_order_relaxed);
+    for (ElementPtr elem = getParent(); elem; elem = elem->getParent())
+    {
+        if (!elem->_contentHashKey.load(std::memory_order_relaxed))
+        {
+            break;
+        }
+        elem->_contentHashKey.store(0, std::memory_order_relaxed);
+    }
+}
+
 TreeIterator Element::traverseTree() const
 {
     return TreeIterator(getSelfNonConst());
@@ -527,6 +1041,16 @@ GraphIterator Element::traverseGraph() const
     return GraphIterator(getSelfNonConst());
 }
 
+RawTreeIterator Element::traverseTreeRaw() const
+{
+    return RawTreeIterator(const_cast<Element*>(this));
+}
+
+RawGraphIterator Element::traverseGraphRaw() const
+{
+    return RawGraphIterator(const_cast<Element*>(this));
+}
+
 Edge Element::getUpstreamEdge(size_t) const
 {
     return getNullEdge();
@@ -544,11 +1068,15 @@ InheritanceIterator Element::traverseInheritance() const
 
 void Element::copyContentFrom(const ConstElementPtr& source)
 {
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    doc->removeFromCache(getSelf(), true);
 
     _sourceUri = source->_sourceUri;
-    _attributeMap = source->_attributeMap;
-    _attributeOrder = source->_attributeOrder;
+    _attributes = source->_attributes;
+    clearAttributeCache(EMPTY_STRING);
+    clearContentHash();
+
+    doc->addToCache(getSelf(), true);
 
     for (auto child : source->getChildren())
     {
@@ -569,11 +1097,14 @@ void Element::copyContentFrom(const ConstElementPtr& source)
 
 void Element::clearContent()
 {
-    getDocument()->invalidateCache();
+    DocumentPtr doc = getDocument();
+    doc->removeFromCache(getSelf(), true);
+    doc->removeFromNamePathIndex(getSelf(), false);
 
     _sourceUri.clear();
-    _attributeMap.clear();
-    _attributeOrder.clear();
+    _attributes.clear();
+    clearAttributeCache(EMPTY_STRING);
+    clearContentHash();
     _childMap.clear();
     _childOrder.clear();
 }
@@ -581,17 +1112,26 @@ void Element::clearContent()
 bool Element::validate(string* message) const
 {
     bool res = true;
-    validateRequire(isValidName(getName()), res, message, "Invalid element name");
+    validateRequire(isValidName(getName()), res, message, "Invalid element name", "element.name");
     if (hasInheritString())
     {
         bool validInherit = getInheritsFrom() && getInheritsFrom()->getCategory() == getCategory();
-        validateRequire(validInherit, res, message, "Invalid element inheritance");
+        validateRequire(validInherit, res, message, "Invalid element inheritance", "element.inheritance");
+    }
+    ValidationScope* scope = currentValidationScope;
+    if (scope && scope->deferredParent == this)
+    {
+        scope->deferredPosition = scope->diagnostics->size();
+        scope->deferred = true;
     }
-    for (auto child : getChildren())
+    else
     {
-        res = child->validate(message) && res;
+        for (const ElementPtr& child : getChildren())
+        {
+            res = child->validate(message) && res;
+        }
     }
-    validateRequire(!hasInheritanceCycle(), res, message, "Cycle in element inheritance chain");
+    validateRequire(!hasInheritanceCycle(), res, message, "Cycle in element inheritance chain", "element.inheritanceCycle");
     return res;
 }
 
@@ -640,7 +1180,8 @@ string Element::asString() const
     return res;
 }
 
-void Element::validateRequire(bool expression, bool& res, string* message, const string& errorDesc) const
+void Element::validateRequire(bool expression, bool& res, string* message, const string& errorDesc,
+                              const string& ruleId, ValidationDiagnostic::Severity severity) const
 {
     if (!expression)
     {
@@ -649,9 +1190,62 @@ void Element::validateRequire(bool expression, bool& res, string* message, const
         {
             *message += errorDesc + ": " + asString() + "\n";
         }
+        if (currentValidationScope)
+        {
+            ValidationDiagnostic diagnostic;
+            diagnostic.elementPath = getNamePath();
+            diagnostic.elementString = asString();
+            diagnostic.ruleId = ruleId;
+            diagnostic.description = errorDesc;
+            diagnostic.severity = severity;
+            currentValidationScope->diagnostics->push_back(std::move(diagnostic));
+        }
     }
 }
 
+bool Element::validateTree(vector<ValidationDiagnostic>& diagnostics, unsigned int threadCount) const
+{
+    // Validate this element, deferring the validation of its children.
+    vector<ValidationDiagnostic> rootDiagnostics;
+    ValidationScope rootScope;
+    rootScope.diagnostics = &rootDiagnostics;
+    rootScope.deferredParent = this;
+    bool res;
+    {
+        ValidationScopeGuard guard(&rootScope);
+        res = validate(nullptr);
+    }
+
+    // Validate the children of this element as independent tasks.
+    const ElementVec& children = getChildren();
+    const size_t childCount = rootScope.deferred ? children.size() : 0;
+    vector<vector<ValidationDiagnostic>> childDiagnostics(childCount);
+    vector<char> childResults(childCount, 1);
+    parallelFor(childCount, threadCount, [&children, &childDiagnostics, &childResults](size_t i)
+    {
+        ValidationScope childScope;
+        childScope.diagnostics = &childDiagnostics[i];
+        ValidationScopeGuard guard(&childScope);
+        childResults[i] = children[i]->validate(nullptr);
+    });
+
+    // Merge diagnostics in the order of a serial traversal.
+    auto rootIt = rootDiagnostics.begin() + rootScope.deferredPosition;
+    std::move(rootDiagnostics.begin(), rootIt, std::back_inserter(diagnostics));
+    for (size_t i = 0; i < childCount; i++)
+    {
+        std::move(childDiagnostics[i].begin(), childDiagnostics[i].end(), std::back_inserter(diagnostics));
+        res = childResults[i] && res;
+    }
+    std::move(rootIt, rootDiagnostics.end(), std::back_inserter(diagnostics));
+    return res;
+}
+
+bool Element::isValidationInProgress()
+{
+    return currentValidationScope != nullptr;
+}
+
 //
 // TypedElement methods
 //
@@ -680,10 +1274,43 @@ string ValueElement::getResolvedValueString(StringResolverPtr resolver) const
 
 ValuePtr ValueElement::getValue() const
 {
+    ConstValuePtr value = std::atomic_load(&_valueCache);
+    if (value)
+        return value->copy();
+
     if (!hasValue())
         return ValuePtr();
 
-    return Value::createValueFromStrings(getValueString(), getType(), getDocument()->getTypeDef(getType()));
+    ValuePtr newValue = Value::createValueFromStrings(getValueString(), getType(), getDocument()->getTypeDef(getType()));
+    if (isCacheableValue(newValue))
+    {
+        std::atomic_store(&_valueCache, ConstValuePtr(newValue->copy()));
+    }
+    return newValue;
+}
+
+ConstValuePtr ValueElement::getCachedValue() const
+{
+    ConstValuePtr value = std::atomic_load(&_valueCache);
+    if (value)
+        return value;
+
+    if (!hasValue())
+        return ConstValuePtr();
+
+    value = Value::createValueFromStrings(getValueString(), getType(), getDocument()->getTypeDef(getType()));
+    if (isCacheableValue(value))
+    {
+        std::atomic_store(&_valueCache, value);
+    }
+    return value;
+}
+
+bool ValueElement::isCacheableValue(ConstValuePtr value) const
+{
+    // Only values of registered types are cached, as aggregate and unrecognized
+    // types also depend on the type definitions of the document.
+    return value && value->getTypeString() == getType() && !dynamic_cast<const AggregateValue*>(value.get());
 }
 
 ValuePtr ValueElement::getResolvedValue(StringResolverPtr resolver) const
@@ -691,6 +1318,9 @@ ValuePtr ValueElement::getResolvedValue(StringResolverPtr resolver) const
     if (!hasValue())
         return ValuePtr();
 
+    if (!StringResolver::isResolvedType(getType()))
+        return getValue();
+
     return Value::createValueFromStrings(getResolvedValueString(resolver), getType(), getDocument()->getTypeDef(getType()));
 }
 
@@ -802,17 +1432,50 @@ bool ValueElement::isAttributeEquivalent(ConstElementPtr rhs, const string& attr
     return true;
 }
 
+string ValueElement::getEquivalentAttributeString(const string& attrib, const ElementEquivalenceOptions& options) const
+{
+    // Mirror the value comparisons of isAttributeEquivalent.
+    if (options.performValueComparisons)
+    {
+        ScopedFloatFormatting fmt(options.floatFormat, options.floatPrecision);
+        ValuePtr value;
+        if (attrib == VALUE_ATTRIBUTE)
+        {
+            value = getValue();
+        }
+        else if (attrib == UI_MIN_ATTRIBUTE || attrib == UI_MAX_ATTRIBUTE ||
+                 attrib == UI_SOFT_MIN_ATTRIBUTE || attrib == UI_SOFT_MAX_ATTRIBUTE ||
+                 attrib == UI_STEP_ATTRIBUTE)
+        {
+            value = Value::createValueFromStrings(getAttribute(attrib), getType());
+        }
+        if (value)
+        {
+            return value->getValueString();
+        }
+    }
+    return Element::getEquivalentAttributeString(attrib, options);
+}
+
+void ValueElement::clearAttributeCache(const string& attrib)
+{
+    if (attrib.empty() || attrib == VALUE_ATTRIBUTE || attrib == TYPE_ATTRIBUTE)
+    {
+        std::atomic_store(&_valueCache, ConstValuePtr());
+    }
+}
+
 bool ValueElement::validate(string* message) const
 {
     bool res = true;
     if (hasType() && hasValueString())
     {
-        validateRequire(getValue() != nullptr, res, message, "Invalid value");
+        validateRequire(getValue() != nullptr, res, message, "Invalid value", "value.value");
     }
 
     if (hasInterfaceName())
     {
-        validateRequire(isA<Input>() || isA<Token>(), res, message, "Only input and token elements support interface names");
+        validateRequire(isA<Input>() || isA<Token>(), res, message, "Only input and token elements support interface names", "value.interfaceNameCategory");
         ConstGraphElementPtr graph = getAncestorOfType<GraphElement>();
         if (graph && graph == getParent())
         {
@@ -829,10 +1492,10 @@ bool ValueElement::validate(string* message) const
                 decl = graph;
             }
             ValueElementPtr valueElem = decl->getActiveValueElement(getInterfaceName());
-            validateRequire(valueElem != nullptr, res, message, "Interface name not found in referenced declaration");
+            validateRequire(valueElem != nullptr, res, message, "Interface name not found in referenced declaration", "value.interfaceName");
             if (valueElem)
             {
-                validateRequire(getType() == valueElem->getType(), res, message, "Interface name refers to value element of a different type");
+                validateRequire(getType() == valueElem->getType(), res, message, "Interface name refers to value element of a different type", "value.interfaceNameType");
             }
         }
     }
@@ -844,7 +1507,7 @@ bool ValueElement::validate(string* message) const
         if (!unittype.empty())
         {
             unitTypeDef = getDocument()->getUnitTypeDef(unittype);
-            validateRequire(unitTypeDef != nullptr, res, message, "Unit type definition does not exist in document");
+            validateRequire(unitTypeDef != nullptr, res, message, "Unit type definition does not exist in document", "value.unitType");
         }
     }
     if (hasUnit())
@@ -862,7 +1525,7 @@ bool ValueElement::validate(string* message) const
                 }
             }
         }
-        validateRequire(foundUnit, res, message, "Unit definition does not exist in document");
+        validateRequire(foundUnit, res, message, "Unit definition does not exist in document", "value.unit");
     }
     return TypedElement::validate(message) && res;
 }
@@ -15,6 +15,10 @@
 #include <MaterialXCore/Util.h>
 #include <MaterialXCore/Value.h>
 
+#include <atomic>
+#include <mutex>
+#include <string_view>
+
 MATERIALX_NAMESPACE_BEGIN
 
 class Element;
@@ -76,6 +80,222 @@ using ElementPredicate = std::function<bool(ConstElementPtr)>;
 
 class ElementEquivalenceOptions;
 
+/// @class AttributeStore
+/// Compact storage for the attributes of an element.
+///
+/// Attributes are held as (name, value) pairs in the order they were set,
+/// with each name interned to a process-wide string.  Storage for a small
+/// number of attributes is held inline, avoiding heap allocations for most
+/// elements.  Lookups scan the attributes linearly, switching to a hash index
+/// once the number of attributes exceeds a threshold.
+class MX_CORE_API AttributeStore
+{
+  public:
+    using Attribute = std::pair<const string*, string>;
+
+  public:
+    AttributeStore();
+    ~AttributeStore();
+    AttributeStore(const AttributeStore& other);
+    AttributeStore& operator=(const AttributeStore& other);
+    AttributeStore(AttributeStore&& other) noexcept;
+    AttributeStore& operator=(AttributeStore&& other) noexcept;
+
+    /// Return the value of the given attribute, or nullptr if the attribute
+    /// is not present.
+    const string* find(const string& name) const;
+
+    /// Set the value of the given attribute, appending it if not present.
+    void set(const string& name, const string& value);
+
+    /// Remove the given attribute, returning true if it was present.
+    bool remove(const string& name);
+
+    /// Remove all attributes.
+    void clear();
+
+    /// Return the number of attributes.
+    size_t size() const { return _size; }
+
+    /// Return true if there are no attributes.
+    bool empty() const { return _size == 0; }
+
+    /// Return an iterator to the first attribute.
+    const Attribute* begin() const { return _data; }
+
+    /// Return an iterator past the last attribute.
+    const Attribute* end() const { return _data + _size; }
+
+  private:
+    Attribute* inlineData()
+    {
+        return reinterpret_cast<Attribute*>(_inlineStorage);
+    }
+    size_t findIndex(const string& name) const;
+    void append(const string* name, const string& value);
+    void moveFrom(AttributeStore& other) noexcept;
+    void buildIndex();
+
+  private:
+    static const size_t INLINE_CAPACITY = 4;
+    static const size_t INDEX_THRESHOLD = 16;
+
+    Attribute* _data;
+    size_t _size;
+    size_t _capacity;
+    std::unique_ptr<std::unordered_map<std::string_view, size_t>> _index;
+    alignas(Attribute) unsigned char _inlineStorage[INLINE_CAPACITY * sizeof(Attribute)];
+};
+
+/// @class ElementArena
+/// A thread-safe memory pool from which the elements of a document may be
+/// allocated.
+///
+/// Storage is carved sequentially from large chunks, and blocks released by
+/// removed elements are recycled through per-size free lists.  Chunks are
+/// returned to the system together when the arena itself is destroyed, which
+/// occurs once the last element allocated from it has been released.
+///
+/// An arena is attached to a document at creation time, by passing it to
+/// createDocument, after which all elements added to the document are
+/// allocated from the arena.
+class MX_CORE_API ElementArena
+{
+  public:
+    explicit ElementArena(size_t chunkSize = DEFAULT_CHUNK_SIZE);
+    ~ElementArena();
+    ElementArena(const ElementArena&) = delete;
+    ElementArena& operator=(const ElementArena&) = delete;
+
+    /// Allocate a block of the given size, aligned to ALIGNMENT bytes.
+    void* allocate(size_t size);
+
+    /// Release a block of the given size, previously returned by allocate,
+    /// making it available for reuse.
+    void deallocate(void* ptr, size_t size);
+
+    /// Return the number of bytes reserved by the arena from the system.
+    size_t getReservedBytes() const;
+
+    /// Return the number of bytes currently allocated from the arena.
+    size_t getAllocatedBytes() const;
+
+  public:
+    static constexpr size_t ALIGNMENT = 16;
+    static constexpr size_t DEFAULT_CHUNK_SIZE = 256 * 1024;
+
+  private:
+    struct FreeBlock
+    {
+        FreeBlock* next;
+    };
+
+    mutable std::mutex _mutex;
+    size_t _chunkSize;
+    vector<std::unique_ptr<char[]>> _chunks;
+    char* _next;
+    char* _end;
+    vector<FreeBlock*> _freeLists;
+    size_t _reservedBytes;
+    size_t _allocatedBytes;
+};
+
+/// A shared pointer to an ElementArena
+using ElementArenaPtr = shared_ptr<ElementArena>;
+
+/// @class ElementAllocator
+/// A standard allocator drawing from an ElementArena, for use with
+/// std::allocate_shared.  Each shared control block holds a copy of its
+/// allocator, so that an arena outlives every element allocated from it.
+template <class T> class ElementAllocator
+{
+  public:
+    using value_type = T;
+
+    explicit ElementAllocator(ElementArenaPtr arena) :
+        _arena(std::move(arena))
+    {
+    }
+    template <class U> ElementAllocator(const ElementAllocator<U>& other) :
+        _arena(other.getArena())
+    {
+    }
+
+    T* allocate(size_t count)
+    {
+        static_assert(alignof(T) <= ElementArena::ALIGNMENT, "Unsupported alignment for arena allocation");
+        return static_cast<T*>(_arena->allocate(count * sizeof(T)));
+    }
+    void deallocate(T* ptr, size_t count)
+    {
+        _arena->deallocate(ptr, count * sizeof(T));
+    }
+
+    /// Return the arena from which this allocator draws.
+    const ElementArenaPtr& getArena() const
+    {
+        return _arena;
+    }
+
+    template <class U> bool operator==(const ElementAllocator<U>& rhs) const
+    {
+        return _arena == rhs.getArena();
+    }
+    template <class U> bool operator!=(const ElementAllocator<U>& rhs) const
+    {
+        return _arena != rhs.getArena();
+    }
+
+  private:
+    ElementArenaPtr _arena;
+};
+
+/// @class ValidationDiagnostic
+/// A structured description of a failed validation check.
+/// @sa Document::validate
+class MX_CORE_API ValidationDiagnostic
+{
+  public:
+    /// The severity of a failed validation check.  Warnings are reported for
+    /// checks that do not affect the interpretation of a document, but as
+    /// with errors, they cause validation to fail.
+    enum Severity
+    {
+        SeverityWarning = 0,
+        SeverityError = 1
+    };
+
+  public:
+    ValidationDiagnostic() :
+        severity(SeverityError)
+    {
+    }
+    ~ValidationDiagnostic() = default;
+
+    /// Return a single-line description of this diagnostic, in the format
+    /// used by the message string of Element::validate.
+    string asString() const
+    {
+        return description + ": " + elementString;
+    }
+
+    /// The name path of the element that failed validation.
+    string elementPath;
+
+    /// The string representation of the element that failed validation, as
+    /// returned by Element::asString.
+    string elementString;
+
+    /// A stable identifier for the failed check, such as "port.connection".
+    string ruleId;
+
+    /// A description of the failed check.
+    string description;
+
+    /// The severity of the failed check.
+    Severity severity;
+};
+
 /// @class Element
 /// The base class for MaterialX elements.
 ///
@@ -85,10 +305,12 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
 {
   protected:
     Element(ElementPtr parent, const string& category, const string& name) :
-        _category(category),
+        _category(&internString(category)),
         _name(name),
         _parent(parent),
-        _root(parent ? parent->getRoot() : nullptr)
+        _root(parent ? parent->getRoot() : nullptr),
+        _contentHash(0),
+        _contentHashKey(0)
     {
     }
 
@@ -118,7 +340,8 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// Set the element's category string.
     void setCategory(const string& category)
     {
-        _category = category;
+        clearContentHash();
+        _category = &internString(category);
     }
 
     /// Return the element's category string.  The category of a MaterialX
@@ -126,7 +349,7 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// being "material", "nodegraph", and "image".
     const string& getCategory() const
     {
-        return _category;
+        return *_category;
     }
 
     /// @}
@@ -157,7 +380,15 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// current element is returned.  If no element is found at the given path,
     /// then an empty shared pointer is returned.
     /// @param namePath The relative name path of the specified element.
-    ElementPtr getDescendant(const string& namePath) const;
+    virtual ElementPtr getDescendant(const string& namePath) const;
+
+    /// Return the elements specified by the given hierarchical name paths,
+    /// relative to the current element, in the order of the given paths.
+    /// Paths at which no element is found yield empty shared pointers.
+    /// If the name path index of the document is enabled, then all paths
+    /// are resolved through the index.
+    /// @param namePaths The relative name paths of the specified elements.
+    ElementVec getDescendants(const StringVec& namePaths) const;
 
     /// @}
     /// @name File Prefix
@@ -483,21 +714,25 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// Return true if the given attribute is present.
     bool hasAttribute(const string& attrib) const
     {
-        return _attributeMap.count(attrib) != 0;
+        return _attributes.find(attrib) != nullptr;
     }
 
     /// Return the value string of the given attribute.  If the given attribute
     /// is not present, then an empty string is returned.
     const string& getAttribute(const string& attrib) const
     {
-        StringMap::const_iterator it = _attributeMap.find(attrib);
-        return (it != _attributeMap.end()) ? it->second : EMPTY_STRING;
+        const string* value = _attributes.find(attrib);
+        return value ? *value : EMPTY_STRING;
     }
 
     /// Return a vector of stored attribute names, in the order they were set.
-    const StringVec& getAttributeNames() const
+    StringVec getAttributeNames() const;
+
+    /// Return the stored attributes as (name, value) pairs, in the order they
+    /// were set.  This provides access to attributes without copying.
+    const AttributeStore& getAttributes() const
     {
-        return _attributeOrder;
+        return _attributes;
     }
 
     /// Set the value of an implicitly typed attribute.  Since an attribute
@@ -569,6 +804,10 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// Return the root document of our tree.
     ConstDocumentPtr getDocument() const;
 
+    /// Return the arena from which the elements of our tree are allocated,
+    /// or an empty shared pointer if elements are allocated from the heap.
+    virtual ElementArenaPtr getElementArena() const;
+
     /// Return the first ancestor of the given subclass, or an empty shared
     /// pointer if no ancestor of this subclass is found.
     template <class T> shared_ptr<T> getAncestorOfType()
@@ -624,6 +863,29 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
                                        const ElementEquivalenceOptions& options, 
                                        string* message = nullptr) const;
 
+    /// Return a hash of the content of this element and all of its
+    /// descendants, using the default equivalence criteria.
+    /// @see getContentHash(const ElementEquivalenceOptions&)
+    uint64_t getContentHash() const;
+
+    /// Return a hash of the content of this element and all of its
+    /// descendants, such that elements found to be equivalent by isEquivalent
+    /// with the same options have equal hashes.
+    ///
+    /// The hash of each element is combined from the hashes of its children,
+    /// and is cached until the element or one of its descendants is edited,
+    /// so that rehashing a document after a local edit only revisits the
+    /// edited elements and their ancestors.  Hashes are stable across
+    /// processes and platforms for the same version of the library.
+    ///
+    /// Values that cannot be parsed as their declared type are hashed by
+    /// their strings, whereas isEquivalent skips the comparison of such values.
+    ///
+    /// Content hashes may be computed concurrently from multiple threads
+    /// with the same options, but not concurrently with edits to the tree.
+    /// @param options Equivalence criteria
+    uint64_t getContentHash(const ElementEquivalenceOptions& options) const;
+
     /// @}
     /// @name Traversal
     /// @{
@@ -673,6 +935,30 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     /// @sa getUpstreamElement
     GraphIterator traverseGraph() const;
 
+    /// Traverse the tree from the given element to each of its descendants,
+    /// visiting the same elements as traverseTree, but returning raw element
+    /// pointers to avoid reference count updates in performance-critical
+    /// code.  The traversed subtree must not be modified during traversal.
+    /// @return A RawTreeIterator object.
+    RawTreeIterator traverseTreeRaw() const;
+
+    /// Traverse the dataflow graph from the given element to each of its
+    /// upstream sources, visiting the same edges as traverseGraph, but
+    /// returning raw element pointers to avoid reference count updates in
+    /// performance-critical code.  The traversed graph must not be modified
+    /// during traversal.
+    /// @throws ExceptionFoundCycle if a cycle is encountered.
+    /// @return A RawGraphIterator object.
+    /// @details Example usage with an explicit iterator:
+    /// @code
+    /// for (mx::RawGraphIterator it = inputElem->traverseGraphRaw().begin(); it != mx::RawGraphIterator::end(); ++it)
+    /// {
+    ///     mx::Element* elem = it.getUpstreamElement();
+    ///     cout << elem->asString() << " at depth " << it.getElementDepth() << endl;
+    /// }
+    /// @endcode
+    RawGraphIterator traverseGraphRaw() const;
+
     /// Return the Edge with the given index that lies directly upstream from
     /// this element in the dataflow graph.
     /// @param index An optional index of the edge to be returned, where the
@@ -813,8 +1099,21 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     }
 
     // Enforce a requirement within a validate method, updating the validation
-    // state and optional output text if the requirement is not met.
-    void validateRequire(bool expression, bool& res, string* message, const string& errorDesc) const;
+    // state and optional output text if the requirement is not met.  When a
+    // structured validation pass is in progress, a diagnostic with the given
+    // rule identifier and severity is also recorded.
+    void validateRequire(bool expression, bool& res, string* message, const string& errorDesc,
+                         const string& ruleId = EMPTY_STRING,
+                         ValidationDiagnostic::Severity severity = ValidationDiagnostic::SeverityError) const;
+
+    // Validate this element and its descendants as a structured validation
+    // pass, appending a diagnostic for each failed check.  The children of
+    // this element are validated in parallel with the given thread count.
+    bool validateTree(vector<ValidationDiagnostic>& diagnostics, unsigned int threadCount) const;
+
+    // Return true if a structured validation pass is in progress on the
+    // current thread.
+    static bool isValidationInProgress();
 
   public:
     static const string NAME_ATTRIBUTE;
@@ -831,6 +1130,17 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     virtual void registerChildElement(ElementPtr child);
     virtual void unregisterChildElement(ElementPtr child);
 
+    // Discard any cached data derived from the given attribute, or from all
+    // attributes if the given name is empty.
+    virtual void clearAttributeCache(const string& /*attrib*/) { }
+
+    // Return the string form of the given attribute that is compared by
+    // isAttributeEquivalent under the given options.
+    virtual string getEquivalentAttributeString(const string& attrib, const ElementEquivalenceOptions& options) const;
+
+    // Discard the cached content hashes of this element and its ancestors.
+    void clearContentHash();
+
     // Return a non-const copy of our self pointer, for use in constructing
     // graph traversal objects that require non-const storage.
     ElementPtr getSelfNonConst() const
@@ -839,24 +1149,42 @@ class MX_CORE_API Element : public std::enable_shared_from_this<Element>
     }
 
   protected:
-    string _category;
+    const string* _category;
     string _name;
     string _sourceUri;
 
     ElementMap _childMap;
     ElementVec _childOrder;
 
-    StringMap _attributeMap;
-    StringVec _attributeOrder;
+    AttributeStore _attributes;
 
     weak_ptr<Element> _parent;
     weak_ptr<Element> _root;
 
   private:
-    template <class T> static ElementPtr createElement(ElementPtr parent, const string& name)
+    uint64_t computeContentHash(const ElementEquivalenceOptions& options, uint64_t optionsKey) const;
+
+  private:
+    // The cached content hash of this element, together with a key for the
+    // equivalence options from which it was computed, or zero if no hash is
+    // cached.
+    mutable std::atomic<uint64_t> _contentHash;
+    mutable std::atomic<uint64_t> _contentHashKey;
+
+  private:
+    template <class T> static shared_ptr<T> allocateElement(ElementPtr parent, const string& name)
     {
+        ElementArenaPtr arena = parent ? parent->getElementArena() : nullptr;
+        if (arena)
+        {
+            return std::allocate_shared<T>(ElementAllocator<T>(arena), parent, name);
+        }
         return std::make_shared<T>(parent, name);
     }
+    template <class T> static ElementPtr createElement(ElementPtr parent, const string& name)
+    {
+        return allocateElement<T>(parent, name);
+    }
 
   private:
     using CreatorFunction = ElementPtr (*)(ElementPtr, const string&);
@@ -1038,12 +1366,23 @@ class MX_CORE_API ValueElement : public TypedElement
     }
 
     /// Return the typed value of an element as a generic value object, which
-    /// may be queried to access its data.
+    /// may be queried to access its data.  The returned object is owned by
+    /// the caller, and may be modified without affecting the element.
     ///
     /// @return A shared pointer to the typed value of this element, or an
     ///    empty shared pointer if no value is present.
     ValuePtr getValue() const;
 
+    /// Return the typed value of an element as a shared constant value
+    /// object.  Values of registered types are parsed once and cached on the
+    /// element until its value or type string changes, so that repeated
+    /// lookups of an unchanged value neither re-parse the value string nor
+    /// allocate.  This method is safe to call from concurrent readers.
+    ///
+    /// @return A shared pointer to the typed value of this element, or an
+    ///    empty shared pointer if no value is present.
+    ConstValuePtr getCachedValue() const;
+
     /// Return the resolved value of an element as a generic value object, which
     /// may be queried to access its data.
     ///
@@ -1146,6 +1485,18 @@ class MX_CORE_API ValueElement : public TypedElement
 
     /// @}
 
+  protected:
+    void clearAttributeCache(const string& attrib) override;
+    string getEquivalentAttributeString(const string& attrib, const ElementEquivalenceOptions& options) const override;
+
+  private:
+    bool isCacheableValue(ConstValuePtr value) const;
+
+  private:
+    // The parsed value of this element, accessed with the atomic
+    // shared_ptr functions to support concurrent readers.
+    mutable ConstValuePtr _valueCache;
+
   public:
     static const string VALUE_ATTRIBUTE;
     static const string INTERFACE_NAME_ATTRIBUTE;
@@ -1414,7 +1765,7 @@ template <class T> shared_ptr<T> Element::addChild(const string& name)
     if (_childMap.count(childName))
         throw Exception("Child name is not unique: " + childName);
 
-    shared_ptr<T> child = std::make_shared<T>(getSelf(), childName);
+    shared_ptr<T> child = allocateElement<T>(getSelf(), childName);
     registerChildElement(child);
 
     return child;
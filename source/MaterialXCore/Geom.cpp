@@ -7,6 +7,8 @@
 
 #include <MaterialXCore/Document.h>
 
+#include <algorithm>
+
 MATERIALX_NAMESPACE_BEGIN
 
 const string GEOM_PATH_SEPARATOR = "/";
@@ -45,6 +47,268 @@ bool geomStringsMatch(const string& geom1, const string& geom2, bool contains)
     return false;
 }
 
+//
+// GeomPathSet methods
+//
+
+namespace
+{
+
+bool isArraySeparator(char c)
+{
+    return ARRAY_VALID_SEPARATORS.find(c) != string::npos;
+}
+
+bool isPathSeparator(char c)
+{
+    return GEOM_PATH_SEPARATOR.find(c) != string::npos;
+}
+
+} // anonymous namespace
+
+GeomPathSet::GeomPathSet() :
+    _nodes(1)
+{
+}
+
+GeomPathSet::GeomPathSet(const string& geom) :
+    _nodes(1)
+{
+    addGeomString(geom);
+}
+
+void GeomPathSet::addGeomString(const string& geom)
+{
+    for (const string& name : splitString(geom, ARRAY_VALID_SEPARATORS))
+    {
+        size_t index = 0;
+        for (const string& segment : splitString(name, GEOM_PATH_SEPARATOR))
+        {
+            bool found = false;
+            size_t position = findChild(index, segment, found);
+            if (found)
+            {
+                index = _nodes[index].children[position];
+                continue;
+            }
+            size_t child = _nodes.size();
+            _nodes.emplace_back();
+            _nodes[child].segment = segment;
+            _nodes[index].children.insert(_nodes[index].children.begin() + position, child);
+            index = child;
+        }
+        _nodes[index].terminal = true;
+    }
+}
+
+bool GeomPathSet::matchesGeomString(const string& geom, bool contains) const
+{
+    if (isEmpty())
+    {
+        return false;
+    }
+    const char* pos = geom.data();
+    const char* end = pos + geom.size();
+    while (pos < end)
+    {
+        if (isArraySeparator(*pos))
+        {
+            pos++;
+            continue;
+        }
+        const char* nameEnd = pos;
+        while (nameEnd < end && !isArraySeparator(*nameEnd))
+        {
+            nameEnd++;
+        }
+        if (matchesGeomName(pos, nameEnd, contains))
+        {
+            return true;
+        }
+        pos = nameEnd;
+    }
+    return false;
+}
+
+bool GeomPathSet::matchesGeomName(const char* begin, const char* end, bool contains) const
+{
+    size_t index = 0;
+    const char* pos = begin;
+    while (true)
+    {
+        // A path in this set is a prefix of the geometry name.
+        if (_nodes[index].terminal)
+        {
+            return true;
+        }
+
+        while (pos < end && isPathSeparator(*pos))
+        {
+            pos++;
+        }
+        if (pos == end)
+        {
+            // The geometry name is a prefix of a path in this set.
+            return !contains;
+        }
+
+        const char* segmentEnd = pos;
+        while (segmentEnd < end && !isPathSeparator(*segmentEnd))
+        {
+            segmentEnd++;
+        }
+        bool found = false;
+        size_t position = findChild(index, std::string_view(pos, (size_t) (segmentEnd - pos)), found);
+        if (!found)
+        {
+            return false;
+        }
+        index = _nodes[index].children[position];
+        pos = segmentEnd;
+    }
+}
+
+size_t GeomPathSet::findChild(size_t index, std::string_view segment, bool& found) const
+{
+    // Return the position of the child with the given segment, or the
+    // position at which it would be inserted.
+    const vector<size_t>& children = _nodes[index].children;
+    auto it = std::lower_bound(children.begin(), children.end(), segment,
+                               [this](size_t child, std::string_view value)
+                               {
+                                   return std::string_view(_nodes[child].segment) < value;
+                               });
+    found = (it != children.end() && _nodes[*it].segment == segment);
+    return (size_t) (it - children.begin());
+}
+
+//
+// GeomMatcher methods
+//
+
+GeomMatcher::GeomMatcher() :
+    _hasCollection(false),
+    _includeCycle(false),
+    _revision(0)
+{
+}
+
+GeomMatcher::GeomMatcher(ConstCollectionPtr collection) :
+    GeomMatcher()
+{
+    if (collection)
+    {
+        addCollection(collection);
+    }
+}
+
+GeomMatcher::GeomMatcher(ConstGeomElementPtr geomElem) :
+    GeomMatcher()
+{
+    if (!geomElem)
+    {
+        return;
+    }
+    _geom.addGeomString(geomElem->getActiveGeom());
+    CollectionPtr collection = geomElem->getCollection();
+    if (collection)
+    {
+        addCollection(collection);
+    }
+}
+
+GeomMatcher::GeomMatcher(const string& geom, ConstCollectionPtr collection) :
+    GeomMatcher()
+{
+    _geom.addGeomString(geom);
+    if (collection)
+    {
+        addCollection(collection);
+    }
+}
+
+void GeomMatcher::addCollection(ConstCollectionPtr collection)
+{
+    _hasCollection = true;
+    _collectionName = collection->getName();
+    _exclude.addGeomString(collection->getActiveExcludeGeom());
+    _include.addGeomString(collection->getActiveIncludeGeom());
+
+    // Flatten the include chain of the collection.
+    std::set<CollectionPtr> includedSet;
+    vector<CollectionPtr> includedVec = collection->getIncludeCollections();
+    for (size_t i = 0; i < includedVec.size(); i++)
+    {
+        CollectionPtr included = includedVec[i];
+        if (includedSet.count(included))
+        {
+            _includeCycle = true;
+            return;
+        }
+        includedSet.insert(included);
+        vector<CollectionPtr> appendVec = included->getIncludeCollections();
+        includedVec.insert(includedVec.end(), appendVec.begin(), appendVec.end());
+    }
+
+    // Merge the include geometry of collections without exclusions, since
+    // any of their paths may be matched independently.
+    for (ConstCollectionPtr included : includedVec)
+    {
+        GeomPathSet exclude(included->getActiveExcludeGeom());
+        if (exclude.isEmpty())
+        {
+            _includedGeom.addGeomString(included->getActiveIncludeGeom());
+        }
+        else
+        {
+            _includedTerms.emplace_back(exclude, GeomPathSet(included->getActiveIncludeGeom()));
+        }
+    }
+}
+
+bool GeomMatcher::matchesGeomString(const string& geom) const
+{
+    if (_geom.matchesGeomString(geom, true))
+    {
+        return true;
+    }
+    if (!_hasCollection || _exclude.matchesGeomString(geom, true))
+    {
+        return false;
+    }
+    if (_include.matchesGeomString(geom))
+    {
+        return true;
+    }
+    if (_includeCycle)
+    {
+        throw ExceptionFoundCycle("Encountered a cycle in collection: " + _collectionName);
+    }
+    if (_includedGeom.matchesGeomString(geom))
+    {
+        return true;
+    }
+    for (const auto& term : _includedTerms)
+    {
+        if (!term.first.matchesGeomString(geom, true) && term.second.matchesGeomString(geom))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+vector<bool> GeomMatcher::matchesGeomStrings(const StringVec& geoms) const
+{
+    vector<bool> results;
+    results.reserve(geoms.size());
+    for (const string& geom : geoms)
+    {
+        results.push_back(matchesGeomString(geom));
+    }
+    return results;
+}
+
 //
 // GeomElement methods
 //
@@ -71,7 +335,7 @@ bool GeomElement::validate(string* message) const
     bool res = true;
     if (hasCollectionString())
     {
-        validateRequire(getCollection() != nullptr, res, message, "Invalid collection string");
+        validateRequire(getCollection() != nullptr, res, message, "Invalid collection string", "geom.collection");
     }
     return Element::validate(message) && res;
 }
@@ -138,43 +402,30 @@ bool Collection::hasIncludeCycle() const
 
 bool Collection::matchesGeomString(const string& geom) const
 {
-    if (geomStringsMatch(getActiveExcludeGeom(), geom, true))
-    {
-        return false;
-    }
-    if (geomStringsMatch(getActiveIncludeGeom(), geom))
-    {
-        return true;
-    }
+    return getGeomMatcher()->matchesGeomString(geom);
+}
 
-    std::set<CollectionPtr> includedSet;
-    vector<CollectionPtr> includedVec = getIncludeCollections();
-    for (size_t i = 0; i < includedVec.size(); i++)
-    {
-        CollectionPtr collection = includedVec[i];
-        if (includedSet.count(collection))
-        {
-            throw ExceptionFoundCycle("Encountered a cycle in collection: " + getName());
-        }
-        includedSet.insert(collection);
-        vector<CollectionPtr> appendVec = collection->getIncludeCollections();
-        includedVec.insert(includedVec.end(), appendVec.begin(), appendVec.end());
-    }
-    for (ConstCollectionPtr collection : includedSet)
+ConstGeomMatcherPtr Collection::getGeomMatcher() const
+{
+    // Return the cached matcher if no edits have been made to the document
+    // since it was built.
+    const uint64_t revision = getDocument()->getRevision();
+    ConstGeomMatcherPtr matcher = std::atomic_load(&_geomMatcher);
+    if (matcher && matcher->_revision == revision)
     {
-        if (collection->matchesGeomString(geom))
-        {
-            return true;
-        }
+        return matcher;
     }
 
-    return false;
+    shared_ptr<GeomMatcher> newMatcher = std::make_shared<GeomMatcher>(getSelf()->asA<Collection>());
+    newMatcher->_revision = revision;
+    std::atomic_store(&_geomMatcher, ConstGeomMatcherPtr(newMatcher));
+    return newMatcher;
 }
 
 bool Collection::validate(string* message) const
 {
     bool res = true;
-    validateRequire(!hasIncludeCycle(), res, message, "Cycle in collection include chain");
+    validateRequire(!hasIncludeCycle(), res, message, "Cycle in collection include chain", "collection.includeCycle");
     return Element::validate(message) && res;
 }
 
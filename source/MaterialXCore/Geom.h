@@ -28,6 +28,7 @@ class GeomPropDef;
 class Collection;
 class CollectionAdd;
 class CollectionRemove;
+class GeomMatcher;
 
 /// A shared pointer to a GeomElement
 using GeomElementPtr = shared_ptr<GeomElement>;
@@ -54,6 +55,9 @@ using CollectionPtr = shared_ptr<Collection>;
 /// A shared pointer to a const Collection
 using ConstCollectionPtr = shared_ptr<const Collection>;
 
+/// A shared pointer to a const GeomMatcher
+using ConstGeomMatcherPtr = shared_ptr<const GeomMatcher>;
+
 /// @class GeomPath
 /// A MaterialX geometry path, representing the hierarchical location
 /// expressed by a geometry name.
@@ -137,6 +141,54 @@ class MX_CORE_API GeomPath
     bool _empty;
 };
 
+/// @class GeomPathSet
+/// A compiled set of geometry paths, stored as a prefix tree over path
+/// segments.  A GeomPathSet answers the same queries as geomStringsMatch
+/// with a fixed first argument, without splitting or allocating strings
+/// for each query.
+class MX_CORE_API GeomPathSet
+{
+  public:
+    GeomPathSet();
+    ~GeomPathSet() = default;
+
+    /// Construct a set from a geometry string containing an array of
+    /// geometry names.
+    explicit GeomPathSet(const string& geom);
+
+    /// Add the geometry names in the given geometry string to this set.
+    void addGeomString(const string& geom);
+
+    /// Return true if this set contains no geometry paths.  An empty set
+    /// matches no geometries.
+    bool isEmpty() const
+    {
+        return !_nodes[0].terminal && _nodes[0].children.empty();
+    }
+
+    /// Return true if this set and the given geometry string have any
+    /// geometries in common, with the same rules as geomStringsMatch.
+    /// @param geom A geometry string containing an array of geometry names.
+    /// @param contains If true, then we require that a path in this set
+    ///    completely contains a path in the given geometry string.
+    bool matchesGeomString(const string& geom, bool contains = false) const;
+
+  private:
+    bool matchesGeomName(const char* begin, const char* end, bool contains) const;
+    size_t findChild(size_t index, std::string_view segment, bool& found) const;
+
+  private:
+    // A node of the prefix tree, holding the indices of its children in
+    // the order of their path segments.
+    struct Node
+    {
+        string segment;
+        vector<size_t> children;
+        bool terminal = false;
+    };
+    vector<Node> _nodes;
+};
+
 /// @class GeomElement
 /// The base class for geometric elements, which support bindings to geometries
 /// and geometric collections.
@@ -548,6 +600,11 @@ class MX_CORE_API Collection : public Element
     /// @throws ExceptionFoundCycle if a cycle is encountered.
     bool matchesGeomString(const string& geom) const;
 
+    /// Return a compiled matcher for the geometry selected by this collection.
+    /// The matcher is built on first request and cached, and is rebuilt on the
+    /// next request following any edit to the document.
+    ConstGeomMatcherPtr getGeomMatcher() const;
+
     /// @}
     /// @name Validation
     /// @{
@@ -563,6 +620,76 @@ class MX_CORE_API Collection : public Element
     static const string INCLUDE_GEOM_ATTRIBUTE;
     static const string EXCLUDE_GEOM_ATTRIBUTE;
     static const string INCLUDE_COLLECTION_ATTRIBUTE;
+
+  private:
+    mutable ConstGeomMatcherPtr _geomMatcher;
+};
+
+/// @class GeomMatcher
+/// A compiled matcher for the geometry selected by a Collection or a
+/// GeomElement such as a MaterialAssign.  The active geometry strings of
+/// the element, and of all collections that it includes, are compiled into
+/// geometry path sets when the matcher is constructed, so that large numbers
+/// of geometry names may be tested without further document queries.
+///
+/// A GeomMatcher is a snapshot of the document at the time it was built.
+/// Collection::getGeomMatcher returns a cached matcher for a collection,
+/// which is rebuilt as needed after edits to the document.
+class MX_CORE_API GeomMatcher
+{
+  public:
+    /// Construct a matcher that matches no geometry.
+    GeomMatcher();
+
+    /// Construct a matcher for the geometry selected by the given collection,
+    /// including the geometry of all collections that it includes.
+    explicit GeomMatcher(ConstCollectionPtr collection);
+
+    /// Construct a matcher for the geometry assigned by the given element,
+    /// matching geometry names contained by its active geometry string, or
+    /// selected by its collection.
+    explicit GeomMatcher(ConstGeomElementPtr geomElem);
+
+    /// Construct a matcher for geometry names contained by the given geometry
+    /// string, or selected by the given collection, as with assignment
+    /// elements such as PropertyAssign that are not GeomElements.
+    GeomMatcher(const string& geom, ConstCollectionPtr collection);
+
+    ~GeomMatcher() = default;
+
+    /// Return true if the given geometry string has any geometries in common
+    /// with the geometry selected by this matcher.
+    /// @throws ExceptionFoundCycle if the include chain of the collection
+    ///    contains a cycle, and the included collections must be tested.
+    bool matchesGeomString(const string& geom) const;
+
+    /// Test each of the given geometry strings against this matcher,
+    /// returning a vector of results in the same order.
+    /// @throws ExceptionFoundCycle if the include chain of the collection
+    ///    contains a cycle, and the included collections must be tested.
+    vector<bool> matchesGeomStrings(const StringVec& geoms) const;
+
+    /// Return true if the include chain of the collection contains a cycle.
+    bool hasIncludeCycle() const
+    {
+        return _includeCycle;
+    }
+
+  private:
+    void addCollection(ConstCollectionPtr collection);
+
+  private:
+    friend class Collection;
+
+    GeomPathSet _geom;
+    bool _hasCollection;
+    string _collectionName;
+    GeomPathSet _exclude;
+    GeomPathSet _include;
+    GeomPathSet _includedGeom;
+    vector<std::pair<GeomPathSet, GeomPathSet>> _includedTerms;
+    bool _includeCycle;
+    uint64_t _revision;
 };
 
 template <class T> GeomPropPtr GeomInfo::setGeomPropValue(const string& name,
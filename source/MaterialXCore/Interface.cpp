@@ -155,7 +155,7 @@ bool PortElement::validate(string* message) const
         NodeGraphPtr nodeGraph = resolveNameReference<NodeGraph>(getNodeName());
         if (!nodeGraph)
         {
-            validateRequire(connectedNode != nullptr, res, message, "Invalid port connection");
+            validateRequire(connectedNode != nullptr, res, message, "Invalid port connection", "port.connection");
         }
     }
     if (connectedNode)
@@ -171,7 +171,7 @@ bool PortElement::validate(string* message) const
                 if (output)
                 {
                     validateRequire(connectedNode->getType() == MULTI_OUTPUT_TYPE_STRING, res, message,
-                                    "Multi-output type expected in port connection");
+                                    "Multi-output type expected in port connection", "port.multiOutputType");
                 }
             }
             else if (hasNodeGraphString())
@@ -183,7 +183,7 @@ bool PortElement::validate(string* message) const
                     if (nodeGraph->getNodeDef())
                     {
                         validateRequire(nodeGraph->getOutputCount() > 1, res, message,
-                                        "Multi-output type expected in port connection");
+                                        "Multi-output type expected in port connection", "port.multiOutputType");
                     }
                 }
             }
@@ -192,16 +192,16 @@ bool PortElement::validate(string* message) const
                 // Document has no concept of a multioutput type
                 output = getDocument()->getOutput(outputString);
             }
-            validateRequire(output != nullptr, res, message, "No output found for port connection");
+            validateRequire(output != nullptr, res, message, "No output found for port connection", "port.output");
 
             if (output)
             {
-                validateRequire(getType() == output->getType(), res, message, "Mismatched types in port connection");
+                validateRequire(getType() == output->getType(), res, message, "Mismatched types in port connection", "port.type");
             }
         }
         else if (connectedNode->getType() != MULTI_OUTPUT_TYPE_STRING)
         {
-            validateRequire(getType() == connectedNode->getType(), res, message, "Mismatched types in port connection");
+            validateRequire(getType() == connectedNode->getType(), res, message, "Mismatched types in port connection", "port.type");
         }
     }
     return ValueElement::validate(message) && res;
@@ -302,8 +302,8 @@ bool Input::validate(string* message) const
 
     if (hasDefaultGeomPropString())
     {
-        validateRequire(parent->isA<NodeDef>() || parent->isA<NodeGraph>(), res, message, "Invalid defaultgeomprop on non-definition and non-nodegraph input");
-        validateRequire(getDefaultGeomProp() != nullptr, res, message, "Invalid defaultgeomprop string");
+        validateRequire(parent->isA<NodeDef>() || parent->isA<NodeGraph>(), res, message, "Invalid defaultgeomprop on non-definition and non-nodegraph input", "input.defaultGeomPropScope");
+        validateRequire(getDefaultGeomProp() != nullptr, res, message, "Invalid defaultgeomprop string", "input.defaultGeomProp");
     }
     if (parent->isA<Node>())
     {
@@ -313,12 +313,12 @@ bool Input::validate(string* message) const
         if (hasNodeGraphString()) numBindings++;
         if (hasInterfaceName()) numBindings++;
         if (hasOutputString() && !(hasNodeName() || hasNodeGraphString()))  numBindings++;
-        validateRequire(numBindings, res, message, "Node input binds no value or connection");
-        validateRequire(numBindings <= 1, res, message, "Node input has too many bindings");
+        validateRequire(numBindings, res, message, "Node input binds no value or connection", "input.noBinding");
+        validateRequire(numBindings <= 1, res, message, "Node input has too many bindings", "input.multipleBindings");
     }
     else if (parent->isA<NodeGraph>())
     {
-        validateRequire(parent->asA<NodeGraph>()->getNodeDef() == nullptr, res, message, "Input element in a functional nodegraph has no effect");
+        validateRequire(parent->asA<NodeGraph>()->getNodeDef() == nullptr, res, message, "Input element in a functional nodegraph has no effect", "input.functionalGraph", ValidationDiagnostic::SeverityWarning);
     }
     return PortElement::validate(message) && res;
 }
@@ -341,7 +341,7 @@ bool Output::hasUpstreamCycle() const
 {
     try
     {
-        for (Edge edge : traverseGraph()) { }
+        for (RawGraphIterator it = traverseGraphRaw().begin(); it != RawGraphIterator::end(); ++it) { }
     }
     catch (ExceptionFoundCycle&)
     {
@@ -353,7 +353,7 @@ bool Output::hasUpstreamCycle() const
 bool Output::validate(string* message) const
 {
     bool res = true;
-    validateRequire(!hasUpstreamCycle(), res, message, "Cycle in upstream path");
+    validateRequire(!hasUpstreamCycle(), res, message, "Cycle in upstream path", "output.cycle");
     return PortElement::validate(message) && res;
 }
 
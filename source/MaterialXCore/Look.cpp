@@ -115,6 +115,122 @@ vector<VisibilityPtr> Look::getActiveVisibilities() const
     return activeVisibilities;
 }
 
+LookBindings Look::resolveGeomBindings(const StringVec& geoms, unsigned int threadCount) const
+{
+    LookBindings bindings;
+    bindings._geomCount = geoms.size();
+    bindings._materialAssigns.assigns = getActiveMaterialAssigns();
+    bindings._propertyAssigns.assigns = getActivePropertyAssigns();
+    bindings._propertySetAssigns.assigns = getActivePropertySetAssigns();
+    bindings._visibilities.assigns = getActiveVisibilities();
+    bindings._variantAssigns = getActiveVariantAssigns();
+
+    // Compile the geometry selected by each assignment, in column order
+    // across all tables.
+    vector<GeomMatcher> matchers;
+    for (MaterialAssignPtr assign : bindings._materialAssigns.assigns)
+    {
+        matchers.emplace_back(assign);
+    }
+    for (PropertyAssignPtr assign : bindings._propertyAssigns.assigns)
+    {
+        matchers.emplace_back(assign->getGeom(), assign->getCollection());
+    }
+    for (PropertySetAssignPtr assign : bindings._propertySetAssigns.assigns)
+    {
+        matchers.emplace_back(assign);
+    }
+    for (VisibilityPtr visibility : bindings._visibilities.assigns)
+    {
+        matchers.emplace_back(visibility);
+    }
+
+    auto initTable = [&geoms](auto& table)
+    {
+        table.stride = (table.assigns.size() + 63) / 64;
+        table.bits.assign(geoms.size() * table.stride, 0);
+    };
+    initTable(bindings._materialAssigns);
+    initTable(bindings._propertyAssigns);
+    initTable(bindings._propertySetAssigns);
+    initTable(bindings._visibilities);
+
+    // Each geometry name writes only to its own row of each table.
+    parallelFor(geoms.size(), threadCount, [&](size_t row)
+    {
+        const string& geom = geoms[row];
+        size_t matcherIndex = 0;
+        auto fillRow = [&](auto& table)
+        {
+            for (size_t col = 0; col < table.assigns.size(); col++)
+            {
+                if (matchers[matcherIndex++].matchesGeomString(geom))
+                {
+                    table.set(row, col);
+                }
+            }
+        };
+        fillRow(bindings._materialAssigns);
+        fillRow(bindings._propertyAssigns);
+        fillRow(bindings._propertySetAssigns);
+        fillRow(bindings._visibilities);
+    });
+
+    return bindings;
+}
+
+//
+// LookGroup methods
+//
+
+LookBindings LookGroup::resolveGeomBindings(const StringVec& geoms, unsigned int threadCount) const
+{
+    string lookName = getActiveLook();
+    if (lookName.empty())
+    {
+        StringVec looks = splitString(getLooks(), ARRAY_VALID_SEPARATORS);
+        if (!looks.empty())
+        {
+            lookName = looks[0];
+        }
+    }
+    LookPtr look = !lookName.empty() ? getDocument()->getLook(lookName) : nullptr;
+    if (!look)
+    {
+        LookBindings bindings;
+        bindings._geomCount = geoms.size();
+        return bindings;
+    }
+    return look->resolveGeomBindings(geoms, threadCount);
+}
+
+//
+// LookBindings methods
+//
+
+vector<VariantAssignPtr> LookBindings::getVariantAssigns(size_t geomIndex) const
+{
+    vector<VariantAssignPtr> variantAssigns = _variantAssigns;
+    for (MaterialAssignPtr matAssign : getMaterialAssigns(geomIndex))
+    {
+        vector<VariantAssignPtr> assigns = matAssign->getActiveVariantAssigns();
+        variantAssigns.insert(variantAssigns.end(), assigns.begin(), assigns.end());
+    }
+    return variantAssigns;
+}
+
+MaterialAssignPtr LookBindings::getBoundMaterialAssign(size_t geomIndex) const
+{
+    for (size_t col = _materialAssigns.assigns.size(); col > 0; col--)
+    {
+        if (_materialAssigns.test(geomIndex, col - 1))
+        {
+            return _materialAssigns.assigns[col - 1];
+        }
+    }
+    return MaterialAssignPtr();
+}
+
 //
 // MaterialAssign methods
 //
@@ -20,6 +20,7 @@ MATERIALX_NAMESPACE_BEGIN
 class Look;
 class LookGroup;
 class LookInherit;
+class LookBindings;
 class MaterialAssign;
 class Visibility;
 
@@ -234,6 +235,23 @@ class MX_CORE_API Look : public Element
     }
 
     /// @}
+    /// @name Geometry Bindings
+    /// @{
+
+    /// Resolve the active assignments of this look against each of the given
+    /// geometry names, returning a table of the assignments that apply to
+    /// each geometry.  The geometry selected by each assignment is compiled
+    /// once and shared across all geometry names, which may be tested in
+    /// parallel.
+    /// @param geoms The geometry names to be resolved.
+    /// @param threadCount The number of threads across which geometry names
+    ///    are distributed.  A value of zero selects the number of hardware
+    ///    threads.
+    /// @throws ExceptionFoundCycle if a collection referenced by an active
+    ///    assignment has a cycle in its include chain.
+    LookBindings resolveGeomBindings(const StringVec& geoms, unsigned int threadCount = 1) const;
+
+    /// @}
 
   public:
     static const string CATEGORY;
@@ -274,6 +292,18 @@ class MX_CORE_API LookGroup : public Element
         return getAttribute(ACTIVE_ATTRIBUTE);
     }
 
+    /// Resolve the assignments of the active look of this group against each
+    /// of the given geometry names.  If no active look is set, then the first
+    /// look in the group is used.
+    /// @param geoms The geometry names to be resolved.
+    /// @param threadCount The number of threads across which geometry names
+    ///    are distributed.  A value of zero selects the number of hardware
+    ///    threads.
+    /// @throws ExceptionFoundCycle if a collection referenced by an active
+    ///    assignment has a cycle in its include chain.
+    /// @see Look::resolveGeomBindings
+    LookBindings resolveGeomBindings(const StringVec& geoms, unsigned int threadCount = 1) const;
+
   public:
     static const string CATEGORY;
     static const string LOOKS_ATTRIBUTE;
@@ -488,6 +518,177 @@ class MX_CORE_API Visibility : public GeomElement
     static const string VISIBLE_ATTRIBUTE;
 };
 
+/// @class LookBindings
+/// A dense table of the assignments within a Look that apply to each of a
+/// list of geometry names, as returned by Look::resolveGeomBindings.
+///
+/// The active assignments of each type form the columns of the table, in
+/// the order returned by the corresponding Look::getActive methods, and the
+/// given geometry names form its rows.
+class MX_CORE_API LookBindings
+{
+  public:
+    LookBindings() :
+        _geomCount(0)
+    {
+    }
+    ~LookBindings() = default;
+
+    /// Return the number of geometry names in the table.
+    size_t getGeomCount() const
+    {
+        return _geomCount;
+    }
+
+    /// @name Assignments
+    /// @{
+
+    /// Return the active MaterialAssign elements of the look.
+    const vector<MaterialAssignPtr>& getMaterialAssigns() const
+    {
+        return _materialAssigns.assigns;
+    }
+
+    /// Return the active PropertyAssign elements of the look.
+    const vector<PropertyAssignPtr>& getPropertyAssigns() const
+    {
+        return _propertyAssigns.assigns;
+    }
+
+    /// Return the active PropertySetAssign elements of the look.
+    const vector<PropertySetAssignPtr>& getPropertySetAssigns() const
+    {
+        return _propertySetAssigns.assigns;
+    }
+
+    /// Return the active Visibility elements of the look.
+    const vector<VisibilityPtr>& getVisibilities() const
+    {
+        return _visibilities.assigns;
+    }
+
+    /// Return the active VariantAssign elements of the look, which apply
+    /// to all geometry.
+    const vector<VariantAssignPtr>& getVariantAssigns() const
+    {
+        return _variantAssigns;
+    }
+
+    /// @}
+    /// @name Geometry Bindings
+    /// @{
+
+    /// Return true if the MaterialAssign with the given index applies to the
+    /// geometry with the given index.
+    bool hasMaterialAssign(size_t geomIndex, size_t assignIndex) const
+    {
+        return _materialAssigns.test(geomIndex, assignIndex);
+    }
+
+    /// Return true if the PropertyAssign with the given index applies to the
+    /// geometry with the given index.
+    bool hasPropertyAssign(size_t geomIndex, size_t assignIndex) const
+    {
+        return _propertyAssigns.test(geomIndex, assignIndex);
+    }
+
+    /// Return true if the PropertySetAssign with the given index applies to
+    /// the geometry with the given index.
+    bool hasPropertySetAssign(size_t geomIndex, size_t assignIndex) const
+    {
+        return _propertySetAssigns.test(geomIndex, assignIndex);
+    }
+
+    /// Return true if the Visibility with the given index applies to the
+    /// geometry with the given index.
+    bool hasVisibility(size_t geomIndex, size_t assignIndex) const
+    {
+        return _visibilities.test(geomIndex, assignIndex);
+    }
+
+    /// Return the MaterialAssign elements that apply to the geometry with
+    /// the given index, in the order in which they are declared.
+    vector<MaterialAssignPtr> getMaterialAssigns(size_t geomIndex) const
+    {
+        return _materialAssigns.getRow(geomIndex);
+    }
+
+    /// Return the PropertyAssign elements that apply to the geometry with
+    /// the given index, in the order in which they are declared.
+    vector<PropertyAssignPtr> getPropertyAssigns(size_t geomIndex) const
+    {
+        return _propertyAssigns.getRow(geomIndex);
+    }
+
+    /// Return the PropertySetAssign elements that apply to the geometry with
+    /// the given index, in the order in which they are declared.
+    vector<PropertySetAssignPtr> getPropertySetAssigns(size_t geomIndex) const
+    {
+        return _propertySetAssigns.getRow(geomIndex);
+    }
+
+    /// Return the Visibility elements that apply to the geometry with the
+    /// given index, in the order in which they are declared.
+    vector<VisibilityPtr> getVisibilities(size_t geomIndex) const
+    {
+        return _visibilities.getRow(geomIndex);
+    }
+
+    /// Return the VariantAssign elements that apply to the geometry with the
+    /// given index: the active VariantAssign elements of the look, followed
+    /// by those of each MaterialAssign that applies to the geometry.
+    vector<VariantAssignPtr> getVariantAssigns(size_t geomIndex) const;
+
+    /// Return the MaterialAssign that binds a material to the geometry with
+    /// the given index, or an empty shared pointer if no assignment applies.
+    /// When several assignments apply, the last one declared takes precedence.
+    MaterialAssignPtr getBoundMaterialAssign(size_t geomIndex) const;
+
+    /// @}
+
+  private:
+    friend class Look;
+    friend class LookGroup;
+
+    // The assignments of a single type, with one bit per assignment in each
+    // row of the table.  Rows are padded to whole words, so that separate
+    // rows may be written concurrently.
+    template <class T> struct Table
+    {
+        bool test(size_t row, size_t col) const
+        {
+            return (bits[row * stride + col / 64] >> (col % 64)) & 1;
+        }
+        void set(size_t row, size_t col)
+        {
+            bits[row * stride + col / 64] |= uint64_t(1) << (col % 64);
+        }
+        vector<shared_ptr<T>> getRow(size_t row) const
+        {
+            vector<shared_ptr<T>> rowAssigns;
+            for (size_t col = 0; col < assigns.size(); col++)
+            {
+                if (test(row, col))
+                {
+                    rowAssigns.push_back(assigns[col]);
+                }
+            }
+            return rowAssigns;
+        }
+
+        vector<shared_ptr<T>> assigns;
+        size_t stride = 0;
+        vector<uint64_t> bits;
+    };
+
+    size_t _geomCount;
+    Table<MaterialAssign> _materialAssigns;
+    Table<PropertyAssign> _propertyAssigns;
+    Table<PropertySetAssign> _propertySetAssigns;
+    Table<Visibility> _visibilities;
+    vector<VariantAssignPtr> _variantAssigns;
+};
+
 /// Return a vector of all MaterialAssign elements that bind this material node
 /// to the given geometry string
 /// @param materialNode Node to examine
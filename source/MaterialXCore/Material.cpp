@@ -106,9 +106,9 @@ vector<NodePtr> getShaderNodes(NodePtr materialNode, const string& nodeType, con
                         OutputPtr implGraphOutput = implGraph->getOutput(defOutput->getName());
                         if (implGraphOutput)
                         {
-                            for (GraphIterator it = implGraphOutput->traverseGraph().begin(); it != GraphIterator::end(); ++it)
+                            for (RawGraphIterator it = implGraphOutput->traverseGraphRaw().begin(); it != RawGraphIterator::end(); ++it)
                             {
-                                ElementPtr upstreamElem = it.getUpstreamElement();
+                                Element* upstreamElem = it.getUpstreamElement();
                                 if (!upstreamElem)
                                 {
                                     it.setPruneSubgraph(true);
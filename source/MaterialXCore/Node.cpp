@@ -7,8 +7,11 @@
 
 #include <MaterialXCore/Document.h>
 #include <MaterialXCore/Material.h>
+#include <MaterialXCore/Util.h>
 
-#include <deque>
+#include <functional>
+#include <limits>
+#include <unordered_set>
 
 MATERIALX_NAMESPACE_BEGIN
 
@@ -85,33 +88,7 @@ NodeDefPtr Node::getNodeDef(const string& target, bool allowRoughMatch) const
     {
         return resolveNameReference<NodeDef>(getNodeDefString());
     }
-    vector<NodeDefPtr> nodeDefs = getDocument()->getMatchingNodeDefs(getQualifiedName(getCategory()));
-    vector<NodeDefPtr> secondary = getDocument()->getMatchingNodeDefs(getCategory());
-    vector<NodeDefPtr> roughMatches;
-    nodeDefs.insert(nodeDefs.end(), secondary.begin(), secondary.end());
-    for (NodeDefPtr nodeDef : nodeDefs)
-    {
-        if (!targetStringsMatch(nodeDef->getTarget(), target) ||
-            !nodeDef->isVersionCompatible(getVersionString()) ||
-            nodeDef->getType() != getType())
-        {
-            continue;
-        }
-        if (!hasExactInputMatch(nodeDef))
-        {
-            if (allowRoughMatch)
-            {
-                roughMatches.push_back(nodeDef);
-            }
-            continue;
-        }
-        return nodeDef;
-    }
-    if (!roughMatches.empty())
-    {
-        return roughMatches[0];
-    }
-    return NodeDefPtr();
+    return getDocument()->getMatchingNodeDef(getSelf()->asA<Node>(), target, allowRoughMatch);
 }
 
 Edge Node::getUpstreamEdge(size_t index) const
@@ -183,12 +160,47 @@ OutputPtr Node::getNodeDefOutput(ElementPtr connectingElement)
 
 vector<PortElementPtr> Node::getDownstreamPorts() const
 {
+    const string qualifiedName = getQualifiedName(getName());
+    auto isDownstreamPort = [this, &qualifiedName](ConstPortElementPtr port)
+    {
+        const string& portKey = port->hasNodeName() ? port->getNodeName() : port->getNodeGraphString();
+        return port->getQualifiedName(portKey) == qualifiedName && port->getConnectedNode() == getSelf();
+    };
+
     vector<PortElementPtr> downstreamPorts;
-    for (PortElementPtr port : getDocument()->getMatchingPorts(getQualifiedName(getName())))
+    ConstNodeGraphPtr nodeGraph = getParent() ? getParent()->asA<NodeGraph>() : nullptr;
+    if (nodeGraph)
     {
-        if (port->getConnectedNode() == getSelf())
+        // The nodes of a nodegraph can only be referenced from within the
+        // graph, so its connectivity index holds all downstream ports apart
+        // from the inputs of the graph itself.
+        ConstGraphIndexPtr index = nodeGraph->getGraphIndex();
+        const size_t id = index->getId(getSelf());
+        for (size_t i = 0; i < index->getDownstreamCount(id); i++)
         {
-            downstreamPorts.push_back(port);
+            const PortElementPtr& port = index->getDownstreamPort(id, i);
+            if (isDownstreamPort(port))
+            {
+                downstreamPorts.push_back(port);
+            }
+        }
+        for (InputPtr input : nodeGraph->getInputs())
+        {
+            if (isDownstreamPort(input))
+            {
+                downstreamPorts.push_back(input);
+            }
+        }
+    }
+    else
+    {
+        // Top-level nodes may be referenced from anywhere in the document.
+        for (PortElementPtr port : getDocument()->getMatchingPorts(qualifiedName))
+        {
+            if (port->getConnectedNode() == getSelf())
+            {
+                downstreamPorts.push_back(port);
+            }
         }
     }
     std::sort(downstreamPorts.begin(), downstreamPorts.end(), [](const ConstElementPtr& a, const ConstElementPtr& b)
@@ -201,31 +213,31 @@ vector<PortElementPtr> Node::getDownstreamPorts() const
 bool Node::validate(string* message) const
 {
     bool res = true;
-    validateRequire(!getCategory().empty(), res, message, "Node element is missing a category");
-    validateRequire(hasType(), res, message, "Node element is missing a type");
+    validateRequire(!getCategory().empty(), res, message, "Node element is missing a category", "node.category");
+    validateRequire(hasType(), res, message, "Node element is missing a type", "node.type");
 
     NodeDefPtr nodeDef = getNodeDef(EMPTY_STRING, true);
     if (nodeDef)
     {
         string matchMessage;
         bool exactMatch = hasExactInputMatch(nodeDef, &matchMessage);
-        validateRequire(exactMatch, res, message, "Node interface error: " + matchMessage);
+        validateRequire(exactMatch, res, message, "Node interface error: " + matchMessage, "node.interface");
 
         const vector<OutputPtr>& activeOutputs = nodeDef->getActiveOutputs();
         const size_t numActiveOutputs = activeOutputs.size();
         if (numActiveOutputs > 1)
         {
-            validateRequire(getType() == MULTI_OUTPUT_TYPE_STRING, res, message, "Node type is not 'multioutput' for node with multiple outputs");
+            validateRequire(getType() == MULTI_OUTPUT_TYPE_STRING, res, message, "Node type is not 'multioutput' for node with multiple outputs", "node.multiOutputType");
         }
         else if (numActiveOutputs == 1)
         {
-            validateRequire(getType() == activeOutputs[0]->getType(), res, message, "Node type does not match output port type");
+            validateRequire(getType() == activeOutputs[0]->getType(), res, message, "Node type does not match output port type", "node.outputType");
         }
     }
     else
     {
         bool categoryDeclared = !getDocument()->getMatchingNodeDefs(getCategory()).empty();
-        validateRequire(!categoryDeclared, res, message, "Node interface doesn't support this output type");
+        validateRequire(!categoryDeclared, res, message, "Node interface doesn't support this output type", "node.outputCategory");
     }
 
     return InterfaceElement::validate(message) && res;
@@ -248,229 +260,464 @@ NodePtr GraphElement::addMaterialNode(const string& name, ConstNodePtr shaderNod
     return materialNode;
 }
 
-void GraphElement::flattenSubgraphs(const string& target, NodePredicate filter)
+// Prepares the graph implementations of nodes for flattening, and stamps
+// instances of them into graph elements.  Each implementation is prepared
+// once, recording the connections between its nodes, so that instances may
+// be created without further definition lookups or connection queries.
+class GraphElement::SubgraphFlattener
 {
-    vector<NodePtr> nodeQueue = getNodes();
-    while (!nodeQueue.empty())
+  public:
+    static constexpr size_t NO_SUBNODE = std::numeric_limits<size_t>::max();
+
+    struct Template;
+
+    struct SubNode
+    {
+        NodePtr node;
+        vector<std::pair<string, size_t>> connections;
+        const Template* nested = nullptr;
+    };
+
+    struct SubOutput
+    {
+        size_t subNode = NO_SUBNODE;
+        string nodeName;
+    };
+
+    struct Template
+    {
+        ConstNodeDefPtr nodeDef;
+        vector<SubNode> subNodes;
+        std::unordered_map<string, SubOutput> outputs;
+        size_t defaultOutput = NO_SUBNODE;
+    };
+
+    using InstanceQueue = vector<std::pair<NodePtr, const Template*>>;
+
+  public:
+    SubgraphFlattener(const string& target, NodePredicate filter, bool snapshot) :
+        _target(target),
+        _filter(filter)
+    {
+        if (snapshot)
+        {
+            _snapshotDoc = createDocument();
+        }
+    }
+
+    // Return the nodes at the root scope of the given graph element that
+    // have graph implementations, paired with their prepared templates.
+    InstanceQueue getRootQueue(const GraphElement& graph)
     {
-        // Determine which nodes require processing, and precompute declarations
-        // and graph implementations for these nodes.
-        using PortElementVec = vector<PortElementPtr>;
-        std::vector<NodePtr> processNodeVec;
-        std::unordered_map<NodePtr, NodeGraphPtr> graphImplMap;
-        std::unordered_map<NodePtr, ConstInterfaceElementPtr> declarationMap;
-        std::unordered_map<NodePtr, PortElementVec> downstreamPortMap;
-        for (NodePtr node : nodeQueue)
+        InstanceQueue queue;
+        for (NodePtr node : graph.getNodes())
         {
-            if (filter && !filter(node))
+            if (_filter && !_filter(node))
             {
                 continue;
             }
+            const Template* tmpl = getTemplate(*node);
+            if (tmpl)
+            {
+                queue.emplace_back(node, tmpl);
+            }
+        }
+        return queue;
+    }
+
+    // Flatten the given queue of nodes within a graph element, returning true
+    // if the children of the graph element were reordered.  When templates
+    // are snapshots, no definitions are queried and no shared state is
+    // modified, so distinct graph elements may be flattened concurrently.
+    bool flatten(GraphElement& graph, InstanceQueue queue) const;
 
-            InterfaceElementPtr implement = node->getImplementation(target);
-            if (implement && implement->isA<NodeGraph>())
+  private:
+    const Template* getTemplate(const Node& node);
+
+  private:
+    string _target;
+    NodePredicate _filter;
+    DocumentPtr _snapshotDoc;
+    std::unordered_map<const NodeDef*, std::unique_ptr<Template>> _templates;
+};
+
+const GraphElement::SubgraphFlattener::Template* GraphElement::SubgraphFlattener::getTemplate(const Node& node)
+{
+    NodeDefPtr nodeDef = node.getNodeDef(_target);
+    if (!nodeDef)
+    {
+        return nullptr;
+    }
+    auto it = _templates.find(nodeDef.get());
+    if (it != _templates.end())
+    {
+        return it->second.get();
+    }
+
+    // Register the entry before preparing nested templates, so that
+    // recursive definitions terminate.
+    std::unique_ptr<Template>& entry = _templates[nodeDef.get()];
+    InterfaceElementPtr implement = nodeDef->getImplementation(_target);
+    NodeGraphPtr implGraph = implement ? implement->asA<NodeGraph>() : nullptr;
+    if (!implGraph)
+    {
+        return nullptr;
+    }
+    entry = std::make_unique<Template>();
+    Template* tmpl = entry.get();
+    tmpl->nodeDef = nodeDef;
+
+    NodeGraphPtr sourceGraph = implGraph;
+    if (_snapshotDoc)
+    {
+        sourceGraph = _snapshotDoc->addNodeGraph();
+        sourceGraph->copyContentFrom(implGraph);
+    }
+
+    // Record the subnodes and the connections between them.
+    vector<NodePtr> implNodes = implGraph->getNodes();
+    vector<NodePtr> sourceNodes = sourceGraph->getNodes();
+    std::unordered_map<string, size_t> subNodeIndices;
+    for (size_t i = 0; i < sourceNodes.size(); i++)
+    {
+        subNodeIndices[sourceNodes[i]->getName()] = i;
+    }
+    tmpl->subNodes.resize(sourceNodes.size());
+    for (size_t i = 0; i < sourceNodes.size(); i++)
+    {
+        SubNode& subNode = tmpl->subNodes[i];
+        subNode.node = sourceNodes[i];
+        for (InputPtr input : sourceNodes[i]->getInputs())
+        {
+            auto indexIt = subNodeIndices.find(input->getNodeName());
+            if (indexIt != subNodeIndices.end())
             {
-                processNodeVec.push_back(node);
-                graphImplMap[node] = implement->asA<NodeGraph>();
-                declarationMap[node] = node->getDeclaration(target);
-                downstreamPortMap[node] = node->getDownstreamPorts();
-                for (NodePtr sourceSubNode : implement->asA<NodeGraph>()->getNodes())
-                {
-                    downstreamPortMap[sourceSubNode] = sourceSubNode->getDownstreamPorts();
-                }
+                subNode.connections.emplace_back(input->getName(), indexIt->second);
+            }
+        }
+    }
+    for (OutputPtr output : sourceGraph->getOutputs())
+    {
+        SubOutput& subOutput = tmpl->outputs[output->getName()];
+        subOutput.nodeName = output->getNodeName();
+        auto indexIt = subNodeIndices.find(subOutput.nodeName);
+        if (indexIt != subNodeIndices.end())
+        {
+            subOutput.subNode = indexIt->second;
+            if (tmpl->defaultOutput == NO_SUBNODE)
+            {
+                tmpl->defaultOutput = indexIt->second;
             }
         }
-        nodeQueue.clear();
+    }
 
-        // Iterate through nodes with graph implementations.
-        for (NodePtr processNode : processNodeVec)
+    // Prepare nested templates from the nodes of the original graph.  For
+    // snapshots, the node filter is also applied here, since instances may
+    // later be created concurrently.
+    for (size_t i = 0; i < implNodes.size(); i++)
+    {
+        if (_snapshotDoc && _filter && !_filter(implNodes[i]))
         {
-            NodeGraphPtr sourceSubGraph = graphImplMap[processNode];
-            std::unordered_map<NodePtr, NodePtr> subNodeMap;
+            continue;
+        }
+        tmpl->subNodes[i].nested = getTemplate(*implNodes[i]);
+    }
+
+    return tmpl;
+}
+
+bool GraphElement::SubgraphFlattener::flatten(GraphElement& graph, InstanceQueue queue) const
+{
+    if (queue.empty())
+    {
+        return false;
+    }
 
-            // Create a new instance of each original subnode.
-            for (NodePtr sourceSubNode : sourceSubGraph->getNodes())
+    // Index the ports of the graph element by their connected nodes.
+    std::unordered_map<const Element*, vector<PortElementPtr>> downstreamPortMap;
+    auto addDownstreamPort = [&graph, &downstreamPortMap](const PortElementPtr& port)
+    {
+        ElementPtr connectedNode = graph.getChild(port->getNodeName());
+        if (connectedNode)
+        {
+            downstreamPortMap[connectedNode.get()].push_back(port);
+        }
+    };
+    for (const ElementPtr& child : graph.getChildren())
+    {
+        if (child->isA<Output>())
+        {
+            addDownstreamPort(child->asA<Output>());
+        }
+        else if (child->isA<Node>() || child->isA<NodeGraph>())
+        {
+            for (InputPtr input : child->asA<InterfaceElement>()->getInputs())
             {
-                string origName = sourceSubNode->getName();
-                string destName = createValidChildName(origName);
-                NodePtr destSubNode = addNode(sourceSubNode->getCategory(), destName);
+                addDownstreamPort(input);
+            }
+        }
+    }
+
+    // Generate unique names for new subnodes, resuming the search for each
+    // name from the last one issued.
+    std::unordered_map<string, string> nextNames;
+    auto createSubNodeName = [&graph, &nextNames](const string& name)
+    {
+        auto nameIt = nextNames.find(name);
+        string candidate = (nameIt != nextNames.end()) ? nameIt->second : name;
+        while (graph.getChild(candidate))
+        {
+            candidate = incrementName(candidate);
+        }
+        nextNames[name] = candidate;
+        return candidate;
+    };
 
-                destSubNode->copyContentFrom(sourceSubNode);
-                setChildIndex(destSubNode->getName(), getChildIndex(processNode->getName()));
+    ElementVec origOrder = graph.getChildren();
+    std::unordered_map<const Element*, vector<NodePtr>> expansions;
+    for (size_t queueIndex = 0; queueIndex < queue.size(); queueIndex++)
+    {
+        NodePtr processNode = queue[queueIndex].first;
+        const Template& tmpl = *queue[queueIndex].second;
 
-                // Store the mapping between subgraphs.
-                subNodeMap[sourceSubNode] = destSubNode;
+        // Create a new instance of each subnode.
+        vector<NodePtr> destNodes;
+        destNodes.reserve(tmpl.subNodes.size());
+        for (const SubNode& subNode : tmpl.subNodes)
+        {
+            NodePtr destNode = graph.addNode(subNode.node->getCategory(), createSubNodeName(subNode.node->getName()));
+            destNode->copyContentFrom(subNode.node);
+            destNodes.push_back(destNode);
+        }
 
-                // Add the subnode to the queue, allowing processing of nested subgraphs.
-                nodeQueue.push_back(destSubNode);
+        // Update connections between subnodes.
+        for (size_t i = 0; i < destNodes.size(); i++)
+        {
+            for (const auto& connection : tmpl.subNodes[i].connections)
+            {
+                InputPtr destInput = destNodes[i]->getInput(connection.first);
+                NodePtr upstreamNode = destNodes[connection.second];
+                destInput->setNodeName(upstreamNode->getName());
+                downstreamPortMap[upstreamNode.get()].push_back(destInput);
             }
+        }
 
-            // Update properties of generated subnodes.
-            for (const auto& subNodePair : subNodeMap)
+        // Transfer interface properties.
+        for (const NodePtr& destNode : destNodes)
+        {
+            for (InputPtr destInput : destNode->getInputs())
             {
-                NodePtr sourceSubNode = subNodePair.first;
-                NodePtr destSubNode = subNodePair.second;
-
-                // Update node connections.
-                for (PortElementPtr sourcePort : downstreamPortMap[sourceSubNode])
+                if (!destInput->hasInterfaceName())
                 {
-                    if (sourcePort->isA<Input>())
-                    {
-                        auto it = subNodeMap.find(sourcePort->getParent()->asA<Node>());
-                        if (it != subNodeMap.end())
-                        {
-                            InputPtr processNodeInput = it->second->getInput(sourcePort->getName());
-                            if (processNodeInput)
-                            {
-                                processNodeInput->setNodeName(destSubNode->getName());
-                            }
-                        }
-                    }
-                    else if (sourcePort->isA<Output>())
-                    {
-                        for (PortElementPtr processNodePort : downstreamPortMap[processNode])
-                        {
-                            processNodePort->setNodeName(destSubNode->getName());
-                        }
-                    }
+                    continue;
                 }
-
-                // Transfer interface properties.
-                for (InputPtr destInput : destSubNode->getInputs())
+                InputPtr sourceInput = processNode->getInput(destInput->getInterfaceName());
+                if (sourceInput)
+                {
+                    destInput->copyContentFrom(sourceInput);
+                    addDownstreamPort(destInput);
+                }
+                else
                 {
-                    if (destInput->hasInterfaceName())
+                    InputPtr declInput = tmpl.nodeDef->getActiveInput(destInput->getInterfaceName());
+                    if (declInput)
                     {
-                        InputPtr sourceInput = processNode->getInput(destInput->getInterfaceName());
-                        if (sourceInput)
+                        if (declInput->hasValueString())
                         {
-                            destInput->copyContentFrom(sourceInput);
-                            NodePtr connectedNode = destInput->getConnectedNode();
-                            // Update downstream port map with the new instance
-                            if (connectedNode && downstreamPortMap.count(connectedNode) > 0)
-                            {
-                                downstreamPortMap[connectedNode] = connectedNode->getDownstreamPorts();
-                            }
+                            destInput->setValueString(declInput->getValueString());
                         }
-                        else
+                        if (declInput->hasDefaultGeomPropString())
                         {
-                            ConstInterfaceElementPtr declaration = declarationMap[processNode];
-                            InputPtr declInput = declaration ? declaration->getActiveInput(destInput->getInterfaceName()) : nullptr;
-                            if (declInput)
+                            ConstGeomPropDefPtr geomPropDef = graph.getDocument()->getGeomPropDef(declInput->getDefaultGeomPropString());
+                            if (geomPropDef)
                             {
-                                if (declInput->hasValueString())
-                                {
-                                    destInput->setValueString(declInput->getValueString());
-                                }
-                                if (declInput->hasDefaultGeomPropString())
-                                {
-                                    ConstGeomPropDefPtr geomPropDef = getDocument()->getGeomPropDef(declInput->getDefaultGeomPropString());
-                                    if (geomPropDef)
-                                    {
-                                        destInput->setConnectedNode(addGeomNode(geomPropDef, "geomNode"));
-                                    }
-                                }
+                                destInput->setConnectedNode(graph.addGeomNode(geomPropDef, "geomNode"));
                             }
-                            destInput->removeAttribute(ValueElement::INTERFACE_NAME_ATTRIBUTE);
                         }
                     }
+                    destInput->removeAttribute(ValueElement::INTERFACE_NAME_ATTRIBUTE);
                 }
             }
+        }
 
-            // Update downstream ports with connections to subgraph outputs.
-            for (PortElementPtr downstreamPort : downstreamPortMap[processNode])
+        // Update downstream ports with connections to subgraph outputs.
+        auto portIt = downstreamPortMap.find(processNode.get());
+        if (portIt != downstreamPortMap.end())
+        {
+            vector<PortElementPtr> downstreamPorts = std::move(portIt->second);
+            downstreamPortMap.erase(portIt);
+            for (const PortElementPtr& downstreamPort : downstreamPorts)
             {
+                if (downstreamPort->getNodeName() != processNode->getName())
+                {
+                    continue;
+                }
+                size_t subNodeIndex = tmpl.defaultOutput;
                 if (downstreamPort->hasOutputString())
                 {
-                    OutputPtr subGraphOutput = sourceSubGraph->getOutput(downstreamPort->getOutputString());
-                    if (subGraphOutput)
+                    auto outputIt = tmpl.outputs.find(downstreamPort->getOutputString());
+                    if (outputIt != tmpl.outputs.end())
                     {
-                        string destName = subGraphOutput->getNodeName();
-                        NodePtr sourceSubNode = sourceSubGraph->getNode(destName);
-                        NodePtr destNode = sourceSubNode ? subNodeMap[sourceSubNode] : nullptr;
-                        if (destNode)
+                        subNodeIndex = outputIt->second.subNode;
+                        if (subNodeIndex == NO_SUBNODE)
                         {
-                            destName = destNode->getName();
+                            downstreamPort->setNodeName(outputIt->second.nodeName);
                         }
-                        downstreamPort->setNodeName(destName);
                         downstreamPort->setOutputString(EMPTY_STRING);
                     }
                 }
+                if (subNodeIndex != NO_SUBNODE)
+                {
+                    downstreamPort->setNodeName(destNodes[subNodeIndex]->getName());
+                    downstreamPortMap[destNodes[subNodeIndex].get()].push_back(downstreamPort);
+                }
             }
-
-            // The processed node has been replaced, so remove it from the graph.
-            removeNode(processNode->getName());
         }
-    }
-}
 
-ElementVec GraphElement::topologicalSort() const
-{
-    // Calculate a topological order of the children, using Kahn's algorithm
-    // to avoid recursion.
-    //
-    // Running time: O(numNodes + numEdges).
+        // The processed node has been replaced, so remove it from the graph.
+        graph.removeNode(processNode->getName());
 
-    const ElementVec& children = getChildren();
+        // Add subnodes with graph implementations to the queue, allowing
+        // processing of nested subgraphs.
+        for (size_t i = 0; i < destNodes.size(); i++)
+        {
+            const Template* nested = tmpl.subNodes[i].nested;
+            if (nested && (_snapshotDoc || !_filter || _filter(destNodes[i])))
+            {
+                queue.emplace_back(destNodes[i], nested);
+            }
+        }
+        expansions[processNode.get()] = std::move(destNodes);
+    }
 
-    // Calculate in-degrees for all children.
-    std::unordered_map<ElementPtr, size_t> inDegree(children.size());
-    std::deque<ElementPtr> childQueue;
-    for (ElementPtr child : children)
+    // Place each set of subnodes at the position of the node it replaced,
+    // with any other new elements following in their order of creation.
+    ElementVec newOrder;
+    newOrder.reserve(graph._childOrder.size());
+    std::unordered_set<const Element*> placed;
+    std::function<void(const ElementPtr&)> placeElement = [&](const ElementPtr& elem)
     {
-        size_t connectionCount = 0;
-        for (size_t i = 0; i < child->getUpstreamEdgeCount(); ++i)
+        auto expansionIt = expansions.find(elem.get());
+        if (expansionIt != expansions.end())
         {
-            Edge upstreamEdge = child->getUpstreamEdge(i);
-            if (upstreamEdge)
+            for (const NodePtr& subNode : expansionIt->second)
             {
-                if (upstreamEdge.getUpstreamElement())
-                {
-                    ElementPtr elem = upstreamEdge.getUpstreamElement()->getParent();
-                    if (elem == child->getParent())
-                    {
-                        connectionCount++;
-                    }
-                }
+                placeElement(subNode);
             }
+            return;
         }
-
-        inDegree[child] = connectionCount;
-
-        // Enqueue children with in-degree 0.
-        if (connectionCount == 0)
+        newOrder.push_back(elem);
+        placed.insert(elem.get());
+    };
+    for (const ElementPtr& elem : origOrder)
+    {
+        placeElement(elem);
+    }
+    for (const ElementPtr& elem : graph._childOrder)
+    {
+        if (!placed.count(elem.get()))
         {
-            childQueue.push_back(child);
+            newOrder.push_back(elem);
         }
     }
+    graph._childOrder = std::move(newOrder);
 
-    ElementVec result;
-    while (!childQueue.empty())
+    return true;
+}
+
+void GraphElement::flattenSubgraphs(const string& target, NodePredicate filter)
+{
+    flattenGraphElements({ getSelf()->asA<GraphElement>() }, target, filter, 1);
+}
+
+void GraphElement::flattenGraphElements(const vector<GraphElementPtr>& graphs,
+                                        const string& target,
+                                        NodePredicate filter,
+                                        unsigned int threadCount)
+{
+    if (graphs.empty())
     {
-        // Pop the queue and add to topological order.
-        ElementPtr child = childQueue.front();
-        childQueue.pop_front();
-        result.push_back(child);
+        return;
+    }
 
-        // Find connected nodes and decrease their in-degree,
-        // adding node to the queue if in-degrees becomes 0.
-        if (child->isA<Node>())
+    // When more than one graph element is flattened, implementations are
+    // prepared as snapshots before any edits are made, so that the result is
+    // independent of the order in which graph elements are processed.
+    SubgraphFlattener flattener(target, filter, graphs.size() > 1);
+    vector<SubgraphFlattener::InstanceQueue> queues;
+    for (const GraphElementPtr& graph : graphs)
+    {
+        queues.push_back(flattener.getRootQueue(*graph));
+    }
+
+    // Flatten documents first, since their root scope contains the other
+    // graph elements.
+    DocumentPtr doc = graphs[0]->getDocument();
+    bool invalidateCache = false;
+    vector<size_t> concurrentGraphs;
+    for (size_t i = 0; i < graphs.size(); i++)
+    {
+        if (graphs[i]->isA<Document>())
         {
-            for (PortElementPtr port : child->asA<Node>()->getDownstreamPorts())
-            {
-                const ElementPtr downstreamElem = port->isA<Output>() ? port : port->getParent();
-                if (inDegree[downstreamElem] > 1)
-                {
-                    inDegree[downstreamElem]--;
-                }
-                else
-                {
-                    inDegree[downstreamElem] = 0;
-                    childQueue.push_back(downstreamElem);
-                }
-            }
+            invalidateCache |= flattener.flatten(*graphs[i], std::move(queues[i]));
+        }
+        else
+        {
+            concurrentGraphs.push_back(i);
         }
     }
+    if (concurrentGraphs.size() > 1)
+    {
+        // Invalidate the document cache before editing graph elements
+        // concurrently, allowing their edits to proceed without locks.
+        doc->invalidateCache();
+        invalidateCache = false;
+    }
+    vector<char> reordered(concurrentGraphs.size(), 0);
+    parallelFor(concurrentGraphs.size(), concurrentGraphs.size() > 1 ? threadCount : 1,
+                [&graphs, &queues, &concurrentGraphs, &reordered, &flattener](size_t i)
+    {
+        size_t index = concurrentGraphs[i];
+        reordered[i] = flattener.flatten(*graphs[index], std::move(queues[index]));
+    });
+    for (char graphReordered : reordered)
+    {
+        invalidateCache |= graphReordered != 0;
+    }
+
+    // Elements are reordered in place by the flattener, so cached lookups
+    // must be rebuilt to restore their document order.
+    if (invalidateCache)
+    {
+        doc->invalidateCache();
+    }
+}
+
+ConstGraphIndexPtr GraphElement::getGraphIndex() const
+{
+    // Return the cached index if no edits have been made to the document
+    // since it was built.
+    const uint64_t revision = getDocument()->getRevision();
+    ConstGraphIndexPtr index = std::atomic_load(&_graphIndex);
+    if (index && index->_revision == revision)
+    {
+        return index;
+    }
+
+    shared_ptr<GraphIndex> newIndex = std::make_shared<GraphIndex>(getSelf()->asA<GraphElement>());
+    newIndex->_revision = revision;
+    std::atomic_store(&_graphIndex, ConstGraphIndexPtr(newIndex));
+    return newIndex;
+}
 
+ElementVec GraphElement::topologicalSort() const
+{
+    ConstGraphIndexPtr index = getGraphIndex();
+    ElementVec result;
+    for (size_t id : index->getTopologicalOrder())
+    {
+        result.push_back(index->getElement(id));
+    }
     return result;
 }
 
@@ -578,6 +825,150 @@ string GraphElement::asStringDot() const
     return dot;
 }
 
+//
+// GraphIndex methods
+//
+
+const size_t GraphIndex::INVALID_ID = std::numeric_limits<size_t>::max();
+
+GraphIndex::GraphIndex(ConstGraphElementPtr graph) :
+    _elements(graph->getChildren()),
+    _revision(0)
+{
+    const size_t count = _elements.size();
+    _ids.reserve(count);
+    for (size_t id = 0; id < count; id++)
+    {
+        _ids[_elements[id].get()] = id;
+    }
+
+    // Resolve the upstream connections of each node and output, keeping
+    // those whose upstream node is also a child of the graph.
+    vector<size_t> downstreamCounts(count, 0);
+    auto addConnection = [this, &downstreamCounts](ConstNodePtr upstreamNode, PortElementPtr port)
+    {
+        auto it = upstreamNode ? _ids.find(upstreamNode.get()) : _ids.end();
+        if (it != _ids.end())
+        {
+            _upstreamIds.push_back(it->second);
+            _upstreamPorts.push_back(port);
+            downstreamCounts[it->second]++;
+        }
+    };
+    _upstreamOffsets.reserve(count + 1);
+    _upstreamOffsets.push_back(0);
+    for (const ElementPtr& child : _elements)
+    {
+        if (child->isA<Node>())
+        {
+            for (InputPtr input : child->asA<Node>()->getInputs())
+            {
+                addConnection(input->getConnectedNode(), input);
+            }
+        }
+        else if (child->isA<Output>())
+        {
+            OutputPtr output = child->asA<Output>();
+            addConnection(output->getConnectedNode(), output);
+        }
+        _upstreamOffsets.push_back(_upstreamIds.size());
+    }
+
+    // Invert the upstream connections to form the downstream arrays.
+    _downstreamOffsets.resize(count + 1, 0);
+    for (size_t id = 0; id < count; id++)
+    {
+        _downstreamOffsets[id + 1] = _downstreamOffsets[id] + downstreamCounts[id];
+    }
+    _downstreamIds.resize(_upstreamIds.size());
+    _downstreamPorts.resize(_upstreamPorts.size());
+    vector<size_t> writePositions(_downstreamOffsets.begin(), _downstreamOffsets.end() - 1);
+    for (size_t id = 0; id < count; id++)
+    {
+        for (size_t i = _upstreamOffsets[id]; i < _upstreamOffsets[id + 1]; i++)
+        {
+            size_t pos = writePositions[_upstreamIds[i]]++;
+            _downstreamIds[pos] = id;
+            _downstreamPorts[pos] = _upstreamPorts[i];
+        }
+    }
+
+    // Order the downstream connections of each element by descending port
+    // name, matching the order of Node::getDownstreamPorts.
+    vector<std::pair<size_t, PortElementPtr>> connections;
+    for (size_t id = 0; id < count; id++)
+    {
+        const size_t begin = _downstreamOffsets[id];
+        const size_t end = _downstreamOffsets[id + 1];
+        if (end - begin < 2)
+        {
+            continue;
+        }
+        connections.clear();
+        for (size_t i = begin; i < end; i++)
+        {
+            connections.emplace_back(_downstreamIds[i], _downstreamPorts[i]);
+        }
+        std::stable_sort(connections.begin(), connections.end(),
+                         [](const std::pair<size_t, PortElementPtr>& a, const std::pair<size_t, PortElementPtr>& b)
+                         {
+                             return a.second->getName() > b.second->getName();
+                         });
+        for (size_t i = begin; i < end; i++)
+        {
+            _downstreamIds[i] = connections[i - begin].first;
+            _downstreamPorts[i] = connections[i - begin].second;
+        }
+    }
+}
+
+size_t GraphIndex::getId(ConstElementPtr elem) const
+{
+    auto it = elem ? _ids.find(elem.get()) : _ids.end();
+    return (it != _ids.end()) ? it->second : INVALID_ID;
+}
+
+vector<PortElementPtr> GraphIndex::getDownstreamPorts(size_t id) const
+{
+    return vector<PortElementPtr>(_downstreamPorts.begin() + _downstreamOffsets[id],
+                                  _downstreamPorts.begin() + _downstreamOffsets[id + 1]);
+}
+
+vector<size_t> GraphIndex::getTopologicalOrder() const
+{
+    // Calculate a topological order of the elements, using Kahn's algorithm
+    // to avoid recursion.  The result vector doubles as the queue of
+    // elements whose upstream connections have all been visited.
+    //
+    // Running time: O(numNodes + numEdges).
+
+    const size_t count = _elements.size();
+    vector<size_t> inDegree(count);
+    vector<size_t> result;
+    result.reserve(count);
+    for (size_t id = 0; id < count; id++)
+    {
+        inDegree[id] = getUpstreamCount(id);
+        if (inDegree[id] == 0)
+        {
+            result.push_back(id);
+        }
+    }
+    for (size_t head = 0; head < result.size(); head++)
+    {
+        const size_t id = result[head];
+        for (size_t i = _downstreamOffsets[id]; i < _downstreamOffsets[id + 1]; i++)
+        {
+            const size_t downstreamId = _downstreamIds[i];
+            if (--inDegree[downstreamId] == 0)
+            {
+                result.push_back(downstreamId);
+            }
+        }
+    }
+    return result;
+}
+
 //
 // NodeGraph methods
 //
@@ -785,19 +1176,19 @@ bool NodeGraph::validate(string* message) const
 {
     bool res = true;
 
-    validateRequire(!hasVersionString(), res, message, "NodeGraph elements do not support version strings");
+    validateRequire(!hasVersionString(), res, message, "NodeGraph elements do not support version strings", "nodegraph.version");
     if (hasNodeDefString())
     {
         NodeDefPtr nodeDef = getNodeDef();
-        validateRequire(nodeDef != nullptr, res, message, "NodeGraph implementation refers to non-existent NodeDef");
+        validateRequire(nodeDef != nullptr, res, message, "NodeGraph implementation refers to non-existent NodeDef", "nodegraph.nodeDef");
         if (nodeDef)
         {
             vector<OutputPtr> graphOutputs = getOutputs();
             vector<OutputPtr> nodeDefOutputs = nodeDef->getActiveOutputs();
-            validateRequire(graphOutputs.size() == nodeDefOutputs.size(), res, message, "NodeGraph implementation has a different number of outputs than its NodeDef");
+            validateRequire(graphOutputs.size() == nodeDefOutputs.size(), res, message, "NodeGraph implementation has a different number of outputs than its NodeDef", "nodegraph.outputCount");
             if (graphOutputs.size() == 1 && nodeDefOutputs.size() == 1)
             {
-                validateRequire(graphOutputs[0]->getType() == nodeDefOutputs[0]->getType(), res, message, "NodeGraph implementation has a different output type than its NodeDef");
+                validateRequire(graphOutputs[0]->getType() == nodeDefOutputs[0]->getType(), res, message, "NodeGraph implementation has a different output type than its NodeDef", "nodegraph.outputType");
             }
         }
     }
@@ -865,7 +1256,7 @@ bool Backdrop::validate(string* message) const
     {
         StringVec stringVec = getTypedAttribute<StringVec>("contains");
         vector<TypedElementPtr> elemVec = getContainsElements();
-        validateRequire(stringVec.size() == elemVec.size(), res, message, "Invalid element in contains string");
+        validateRequire(stringVec.size() == elemVec.size(), res, message, "Invalid element in contains string", "backdrop.contains");
     }
     return Element::validate(message) && res;
 }
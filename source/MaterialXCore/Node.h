@@ -17,6 +17,7 @@ MATERIALX_NAMESPACE_BEGIN
 
 class Node;
 class GraphElement;
+class GraphIndex;
 class NodeGraph;
 class Backdrop;
 
@@ -30,6 +31,9 @@ using GraphElementPtr = shared_ptr<GraphElement>;
 /// A shared pointer to a const GraphElement
 using ConstGraphElementPtr = shared_ptr<const GraphElement>;
 
+/// A shared pointer to a const GraphIndex
+using ConstGraphIndexPtr = shared_ptr<const GraphIndex>;
+
 /// A shared pointer to a NodeGraph
 using NodeGraphPtr = shared_ptr<NodeGraph>;
 /// A shared pointer to a const NodeGraph
@@ -178,6 +182,127 @@ class MX_CORE_API Node : public InterfaceElement
     static const string CATEGORY;
 };
 
+/// @class GraphIndex
+/// A compiled index of the connections between the children of a graph
+/// element.
+///
+/// Each child of the graph is assigned a dense integer id, given by its
+/// position in the child order of the graph, and the connections between
+/// children are stored as upstream and downstream arrays in compressed
+/// sparse row form.  This allows connectivity queries over large graphs to
+/// proceed without resolving node names.  Only connections between two
+/// children of the indexed graph are recorded.
+///
+/// A GraphIndex is a snapshot of the graph at the time it was built, and is
+/// normally accessed through GraphElement::getGraphIndex, which rebuilds the
+/// index as needed after edits to the document.
+///
+/// The index answers GraphElement::topologicalSort, and Node::getDownstreamPorts
+/// for nodes within a nodegraph.  Upstream traversals through
+/// Element::traverseGraph continue to resolve connections by name, since
+/// their edges may cross graph boundaries through interface inputs and
+/// nodegraph outputs.
+class MX_CORE_API GraphIndex
+{
+  public:
+    explicit GraphIndex(ConstGraphElementPtr graph);
+    ~GraphIndex() { }
+
+    /// @name Elements
+    /// @{
+
+    /// Return the number of child elements in the index.
+    size_t getElementCount() const
+    {
+        return _elements.size();
+    }
+
+    /// Return the child element with the given id.
+    const ElementPtr& getElement(size_t id) const
+    {
+        return _elements[id];
+    }
+
+    /// Return the id of the given child element, or INVALID_ID if the
+    /// element is not a child of the indexed graph.
+    size_t getId(ConstElementPtr elem) const;
+
+    /// @}
+    /// @name Connections
+    /// @{
+
+    /// Return the number of upstream connections of the given element.
+    size_t getUpstreamCount(size_t id) const
+    {
+        return _upstreamOffsets[id + 1] - _upstreamOffsets[id];
+    }
+
+    /// Return the id of the upstream element for the given connection.
+    size_t getUpstreamId(size_t id, size_t index) const
+    {
+        return _upstreamIds[_upstreamOffsets[id] + index];
+    }
+
+    /// Return the port for the given upstream connection, which is either
+    /// the connecting input of a node or the output element itself.
+    const PortElementPtr& getUpstreamPort(size_t id, size_t index) const
+    {
+        return _upstreamPorts[_upstreamOffsets[id] + index];
+    }
+
+    /// Return the number of downstream connections of the given element.
+    size_t getDownstreamCount(size_t id) const
+    {
+        return _downstreamOffsets[id + 1] - _downstreamOffsets[id];
+    }
+
+    /// Return the id of the downstream element for the given connection.
+    size_t getDownstreamId(size_t id, size_t index) const
+    {
+        return _downstreamIds[_downstreamOffsets[id] + index];
+    }
+
+    /// Return the port for the given downstream connection.  Downstream
+    /// connections are ordered by the names of their ports, as in
+    /// Node::getDownstreamPorts.
+    const PortElementPtr& getDownstreamPort(size_t id, size_t index) const
+    {
+        return _downstreamPorts[_downstreamOffsets[id] + index];
+    }
+
+    /// Return a vector of the downstream ports of the given element.
+    vector<PortElementPtr> getDownstreamPorts(size_t id) const;
+
+    /// @}
+    /// @name Traversal
+    /// @{
+
+    /// Return the ids of all elements in topological order.  Elements
+    /// that are part of a cycle are omitted.
+    vector<size_t> getTopologicalOrder() const;
+
+    /// @}
+
+  public:
+    static const size_t INVALID_ID;
+
+  private:
+    friend class GraphElement;
+
+    ElementVec _elements;
+    std::unordered_map<const Element*, size_t> _ids;
+
+    vector<size_t> _upstreamOffsets;
+    vector<size_t> _upstreamIds;
+    vector<PortElementPtr> _upstreamPorts;
+
+    vector<size_t> _downstreamOffsets;
+    vector<size_t> _downstreamIds;
+    vector<PortElementPtr> _downstreamPorts;
+
+    uint64_t _revision;
+};
+
 /// @class GraphElement
 /// The base class for graph elements such as NodeGraph and Document.
 class MX_CORE_API GraphElement : public InterfaceElement
@@ -294,6 +419,15 @@ class MX_CORE_API GraphElement : public InterfaceElement
         removeChildOfType<Backdrop>(name);
     }
 
+    /// @}
+    /// @name Graph Index
+    /// @{
+
+    /// Return a compiled index of the connections between the children of
+    /// this graph.  The index is built on first request and cached, and is
+    /// rebuilt on the next request following any edit to the document.
+    ConstGraphIndexPtr getGraphIndex() const;
+
     /// @}
     /// @name Utility
     /// @{
@@ -324,6 +458,21 @@ class MX_CORE_API GraphElement : public InterfaceElement
     string asStringDot() const;
 
     /// @}
+
+  protected:
+    // Flatten the subgraphs of each of the given graph elements, preparing
+    // each graph implementation once and sharing it across all instances.
+    // Any Document in the list is flattened first, after which the remaining
+    // graph elements are flattened using the given number of threads.
+    static void flattenGraphElements(const vector<GraphElementPtr>& graphs,
+                                     const string& target,
+                                     NodePredicate filter,
+                                     unsigned int threadCount);
+
+  private:
+    class SubgraphFlattener;
+
+    mutable ConstGraphIndexPtr _graphIndex;
 };
 
 /// @class NodeGraph
@@ -9,6 +9,186 @@
 
 MATERIALX_NAMESPACE_BEGIN
 
+namespace
+{
+
+// The maximum number of scratch tables retained for reuse by each thread.
+const size_t MAX_POOLED_SCRATCH = 8;
+
+size_t hashPointer(const void* ptr)
+{
+    uint64_t x = (uint64_t) (uintptr_t) ptr;
+    x ^= x >> 33;
+    x *= 0xff51afd7ed558ccdull;
+    x ^= x >> 33;
+    return (size_t) x;
+}
+
+struct PointerHash
+{
+    size_t operator()(const Element* elem) const
+    {
+        return hashPointer(elem);
+    }
+};
+
+// The identity of a traversed edge.
+struct EdgeKey
+{
+    bool operator==(const EdgeKey& rhs) const
+    {
+        return elemDown == rhs.elemDown &&
+               elemConnect == rhs.elemConnect &&
+               elemUp == rhs.elemUp;
+    }
+
+    const Element* elemDown;
+    const Element* elemConnect;
+    const Element* elemUp;
+};
+
+struct EdgeKeyHash
+{
+    size_t operator()(const EdgeKey& key) const
+    {
+        size_t hash = hashPointer(key.elemDown);
+        hash = hash * 31 + hashPointer(key.elemConnect);
+        hash = hash * 31 + hashPointer(key.elemUp);
+        return hash;
+    }
+};
+
+// A flat hash set with linear probing, in which each slot is stamped with
+// the generation in which it was filled.  Clearing the set advances the
+// current generation, so that stale slots are ignored without being reset.
+template <class Key, class Hash> class StampedSet
+{
+  public:
+    void clear()
+    {
+        _size = 0;
+        _filled = 0;
+        if (++_generation == 0)
+        {
+            std::fill(_stamps.begin(), _stamps.end(), 0);
+            _generation = 1;
+        }
+    }
+
+    bool contains(const Key& key) const
+    {
+        return findSlot(key) != NO_SLOT;
+    }
+
+    // Insert the given key, returning false if it was already present.
+    bool insert(const Key& key)
+    {
+        if ((_filled + 1) * 4 > _keys.size() * 3)
+        {
+            rehash();
+        }
+        const size_t mask = _keys.size() - 1;
+        size_t erasedSlot = NO_SLOT;
+        for (size_t slot = Hash()(key) & mask;; slot = (slot + 1) & mask)
+        {
+            if (_stamps[slot] != _generation)
+            {
+                if (erasedSlot == NO_SLOT)
+                {
+                    erasedSlot = slot;
+                    _filled++;
+                }
+                _keys[slot = erasedSlot] = key;
+                _stamps[slot] = _generation;
+                _erased[slot] = false;
+                _size++;
+                return true;
+            }
+            if (_erased[slot])
+            {
+                if (erasedSlot == NO_SLOT)
+                {
+                    erasedSlot = slot;
+                }
+            }
+            else if (_keys[slot] == key)
+            {
+                return false;
+            }
+        }
+    }
+
+    void erase(const Key& key)
+    {
+        size_t slot = findSlot(key);
+        if (slot != NO_SLOT)
+        {
+            _erased[slot] = true;
+            _size--;
+        }
+    }
+
+  private:
+    size_t findSlot(const Key& key) const
+    {
+        if (_keys.empty())
+        {
+            return NO_SLOT;
+        }
+        const size_t mask = _keys.size() - 1;
+        for (size_t slot = Hash()(key) & mask; _stamps[slot] == _generation; slot = (slot + 1) & mask)
+        {
+            if (!_erased[slot] && _keys[slot] == key)
+            {
+                return slot;
+            }
+        }
+        return NO_SLOT;
+    }
+
+    // Rebuild the table with room for twice the current number of keys,
+    // discarding erased slots.
+    void rehash()
+    {
+        size_t capacity = 16;
+        while (capacity < (_size + 1) * 2)
+        {
+            capacity *= 2;
+        }
+
+        vector<Key> keys(capacity);
+        vector<uint32_t> stamps(capacity, 0);
+        vector<uint8_t> erased(capacity, false);
+        std::swap(keys, _keys);
+        std::swap(stamps, _stamps);
+        std::swap(erased, _erased);
+
+        const uint32_t generation = _generation;
+        _generation = 1;
+        _size = 0;
+        _filled = 0;
+        for (size_t slot = 0; slot < keys.size(); slot++)
+        {
+            if (stamps[slot] == generation && !erased[slot])
+            {
+                insert(keys[slot]);
+            }
+        }
+    }
+
+  private:
+    static const size_t NO_SLOT = (size_t) -1;
+
+    vector<Key> _keys;
+    vector<uint32_t> _stamps;
+    vector<uint8_t> _erased;
+    uint32_t _generation = 1;
+    size_t _size = 0;
+    size_t _filled = 0;
+};
+
+} // anonymous namespace
+
 const Edge& getNullEdge() {
     static const auto ret = new Edge(nullptr, nullptr, nullptr);
     return *ret;
@@ -195,6 +375,301 @@ bool GraphIterator::skipOrMarkAsVisited(const Edge& edge)
     return !inserted;
 }
 
+//
+// RawTreeIterator methods
+//
+
+const RawTreeIterator& RawTreeIterator::end()
+{
+    static const RawTreeIterator nullIterator(nullptr);
+    return nullIterator;
+}
+
+RawTreeIterator& RawTreeIterator::operator++()
+{
+    if (!_prune && _elem && !_elem->getChildren().empty())
+    {
+        // Traverse to the first child of this element.
+        _stack.emplace_back(_elem, 0);
+        _elem = _elem->getChildren()[0].get();
+        return *this;
+    }
+    _prune = false;
+
+    while (true)
+    {
+        if (_stack.empty())
+        {
+            // Traversal is complete.
+            _elem = nullptr;
+            return *this;
+        }
+
+        // Traverse to our siblings.
+        StackFrame& parentFrame = _stack.back();
+        const ElementVec& siblings = parentFrame.first->getChildren();
+        if (parentFrame.second + 1 < siblings.size())
+        {
+            _elem = siblings[++parentFrame.second].get();
+            return *this;
+        }
+
+        // Traverse to our parent's siblings.
+        _stack.pop_back();
+    }
+}
+
+//
+// RawGraphIterator methods
+//
+
+class RawGraphIterator::Scratch
+{
+  public:
+    // Return a cleared scratch object, recycling a released object from the
+    // current thread when one is available.
+    static Scratch* acquire()
+    {
+        vector<std::unique_ptr<Scratch>>& pool = getPool();
+        if (pool.empty())
+        {
+            return new Scratch();
+        }
+        Scratch* scratch = pool.back().release();
+        pool.pop_back();
+        return scratch;
+    }
+
+    // Release a scratch object, retaining it for reuse by the current thread.
+    static void release(Scratch* scratch)
+    {
+        vector<std::unique_ptr<Scratch>>& pool = getPool();
+        if (pool.size() < MAX_POOLED_SCRATCH)
+        {
+            scratch->clear();
+            pool.emplace_back(scratch);
+        }
+        else
+        {
+            delete scratch;
+        }
+    }
+
+    void clear()
+    {
+        stack.clear();
+        pathElems.clear();
+        visitedEdges.clear();
+    }
+
+    vector<std::pair<Element*, size_t>> stack;
+    StampedSet<const Element*, PointerHash> pathElems;
+    StampedSet<EdgeKey, EdgeKeyHash> visitedEdges;
+
+  private:
+    static vector<std::unique_ptr<Scratch>>& getPool()
+    {
+        thread_local vector<std::unique_ptr<Scratch>> pool;
+        return pool;
+    }
+};
+
+RawGraphIterator::RawGraphIterator(Element* elem) :
+    _upstreamElem(elem),
+    _connectingElem(nullptr),
+    _prune(false),
+    _scratch(nullptr)
+{
+    if (elem)
+    {
+        _scratch = Scratch::acquire();
+        _scratch->pathElems.insert(elem);
+    }
+}
+
+RawGraphIterator::RawGraphIterator(const RawGraphIterator& rhs) :
+    _upstreamElem(rhs._upstreamElem),
+    _connectingElem(rhs._connectingElem),
+    _prune(rhs._prune),
+    _scratch(nullptr)
+{
+    if (rhs._scratch)
+    {
+        _scratch = Scratch::acquire();
+        *_scratch = *rhs._scratch;
+    }
+}
+
+RawGraphIterator& RawGraphIterator::operator=(const RawGraphIterator& rhs)
+{
+    if (this != &rhs)
+    {
+        if (rhs._scratch && !_scratch)
+        {
+            _scratch = Scratch::acquire();
+        }
+        else if (!rhs._scratch && _scratch)
+        {
+            Scratch::release(_scratch);
+            _scratch = nullptr;
+        }
+        if (rhs._scratch)
+        {
+            *_scratch = *rhs._scratch;
+        }
+        _upstreamElem = rhs._upstreamElem;
+        _connectingElem = rhs._connectingElem;
+        _prune = rhs._prune;
+    }
+    return *this;
+}
+
+RawGraphIterator::~RawGraphIterator()
+{
+    if (_scratch)
+    {
+        Scratch::release(_scratch);
+    }
+}
+
+bool RawGraphIterator::operator==(const RawGraphIterator& rhs) const
+{
+    if (_upstreamElem != rhs._upstreamElem || _prune != rhs._prune)
+    {
+        return false;
+    }
+    if (!_scratch || !rhs._scratch)
+    {
+        return getElementDepth() == rhs.getElementDepth();
+    }
+    return _scratch->stack == rhs._scratch->stack;
+}
+
+const RawGraphIterator& RawGraphIterator::end()
+{
+    static const RawGraphIterator nullIterator(nullptr);
+    return nullIterator;
+}
+
+Element* RawGraphIterator::getDownstreamElement() const
+{
+    return getElementDepth() ? _scratch->stack.back().first : nullptr;
+}
+
+size_t RawGraphIterator::getUpstreamIndex() const
+{
+    return getElementDepth() ? _scratch->stack.back().second : 0;
+}
+
+size_t RawGraphIterator::getElementDepth() const
+{
+    return _scratch ? _scratch->stack.size() : 0;
+}
+
+size_t RawGraphIterator::getNodeDepth() const
+{
+    // Count the nodes along the current path, which is a subset of the
+    // downstream elements on the stack and the current upstream element.
+    if (!_scratch)
+    {
+        return 0;
+    }
+    auto isPathNode = [this](const Element* elem)
+    {
+        return elem && elem->isA<Node>() && _scratch->pathElems.contains(elem);
+    };
+    size_t nodeDepth = isPathNode(_upstreamElem) ? 1 : 0;
+    for (const auto& frame : _scratch->stack)
+    {
+        if (isPathNode(frame.first))
+        {
+            nodeDepth++;
+        }
+    }
+    return nodeDepth;
+}
+
+RawGraphIterator& RawGraphIterator::operator++()
+{
+    if (!_scratch)
+    {
+        return *this;
+    }
+
+    vector<std::pair<Element*, size_t>>& stack = _scratch->stack;
+    if (!_prune && _upstreamElem && _upstreamElem->getUpstreamEdgeCount())
+    {
+        // Traverse to the first upstream edge of this element.
+        stack.emplace_back(_upstreamElem, 0);
+        if (extendPathUpstream(_upstreamElem, 0))
+        {
+            return *this;
+        }
+    }
+    _prune = false;
+
+    while (true)
+    {
+        if (_upstreamElem)
+        {
+            returnPathDownstream(_upstreamElem);
+        }
+
+        if (stack.empty())
+        {
+            // Traversal is complete.
+            Scratch::release(_scratch);
+            _scratch = nullptr;
+            return *this;
+        }
+
+        // Traverse to our siblings.
+        auto& parentFrame = stack.back();
+        if (parentFrame.second + 1 < parentFrame.first->getUpstreamEdgeCount())
+        {
+            if (extendPathUpstream(parentFrame.first, ++parentFrame.second))
+            {
+                return *this;
+            }
+            continue;
+        }
+
+        // Traverse to our parent's siblings.
+        returnPathDownstream(parentFrame.first);
+        stack.pop_back();
+    }
+}
+
+bool RawGraphIterator::extendPathUpstream(Element* downstreamElem, size_t index)
+{
+    Edge edge = downstreamElem->getUpstreamEdge(index);
+    Element* upstreamElem = edge.getUpstreamElement().get();
+    Element* connectingElem = edge.getConnectingElement().get();
+    if (!upstreamElem || !_scratch->visitedEdges.insert({ downstreamElem, connectingElem, upstreamElem }))
+    {
+        return false;
+    }
+
+    // Check for cycles.
+    if (_scratch->pathElems.contains(upstreamElem))
+    {
+        throw ExceptionFoundCycle("Encountered cycle at element: " + upstreamElem->asString());
+    }
+
+    // Extend the current path to the new element.
+    _scratch->pathElems.insert(upstreamElem);
+    _upstreamElem = upstreamElem;
+    _connectingElem = connectingElem;
+    return true;
+}
+
+void RawGraphIterator::returnPathDownstream(Element* upstreamElem)
+{
+    _scratch->pathElems.erase(upstreamElem);
+    _upstreamElem = nullptr;
+    _connectingElem = nullptr;
+}
+
 //
 // InheritanceIterator methods
 //
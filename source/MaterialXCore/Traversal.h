@@ -328,6 +328,239 @@ class MX_CORE_API GraphIterator
     size_t _holdCount;
 };
 
+/// @class RawTreeIterator
+/// A lightweight variant of TreeIterator, which visits the same elements in
+/// the same order, but returns raw element pointers and holds no shared
+/// pointers in its traversal state.  This avoids reference count updates at
+/// each step of the traversal.
+///
+/// The elements visited by a RawTreeIterator are owned by their document,
+/// and the traversed subtree must not be modified while a traversal is in
+/// progress.
+///
+/// @sa Element::traverseTreeRaw
+class MX_CORE_API RawTreeIterator
+{
+  public:
+    explicit RawTreeIterator(Element* elem) :
+        _elem(elem),
+        _prune(false)
+    {
+    }
+    ~RawTreeIterator() = default;
+
+  private:
+    using StackFrame = std::pair<Element*, size_t>;
+
+  public:
+    bool operator==(const RawTreeIterator& rhs) const
+    {
+        return _elem == rhs._elem &&
+               _stack == rhs._stack &&
+               _prune == rhs._prune;
+    }
+    bool operator!=(const RawTreeIterator& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    /// Dereference this iterator, returning the current element in the
+    /// traversal.
+    Element* operator*() const
+    {
+        return _elem;
+    }
+
+    /// Iterate to the next element in the traversal.
+    RawTreeIterator& operator++();
+
+    /// @name Elements
+    /// @{
+
+    /// Return the current element in the traversal.
+    Element* getElement() const
+    {
+        return _elem;
+    }
+
+    /// @}
+    /// @name Depth
+    /// @{
+
+    /// Return the element depth of the current traversal, where the starting
+    /// element represents a depth of zero.
+    size_t getElementDepth() const
+    {
+        return _stack.size();
+    }
+
+    /// @}
+    /// @name Pruning
+    /// @{
+
+    /// Set the prune subtree flag, which controls whether the current subtree
+    /// is pruned from traversal.
+    /// @param prune If set to true, then the current subtree will be pruned.
+    void setPruneSubtree(bool prune)
+    {
+        _prune = prune;
+    }
+
+    /// Return the prune subtree flag, which controls whether the current
+    /// subtree is pruned from traversal.
+    bool getPruneSubtree() const
+    {
+        return _prune;
+    }
+
+    /// @}
+    /// @name Range Methods
+    /// @{
+
+    /// Interpret this object as an iteration range, and return its begin
+    /// iterator.
+    RawTreeIterator& begin()
+    {
+        return *this;
+    }
+
+    /// Return the sentinel end iterator for this class.
+    static const RawTreeIterator& end();
+
+    /// @}
+
+  private:
+    Element* _elem;
+    vector<StackFrame> _stack;
+    bool _prune;
+};
+
+/// @class RawGraphIterator
+/// A lightweight variant of GraphIterator, which visits the same edges in
+/// the same order, but returns raw element pointers in place of Edge objects.
+///
+/// The visited edges and the elements along the current path are recorded
+/// in flat tables of raw pointers rather than sets of shared pointers.  These
+/// tables are cleared by advancing a generation stamp, and are recycled
+/// between traversals on the same thread, so that a traversal performs no
+/// allocations once the tables have grown to the size of the graph.
+///
+/// As with RawTreeIterator, the traversed graph must not be modified while
+/// a traversal is in progress.
+///
+/// @sa Element::traverseGraphRaw
+class MX_CORE_API RawGraphIterator
+{
+  public:
+    explicit RawGraphIterator(Element* elem);
+    RawGraphIterator(const RawGraphIterator& rhs);
+    RawGraphIterator& operator=(const RawGraphIterator& rhs);
+    ~RawGraphIterator();
+
+    bool operator==(const RawGraphIterator& rhs) const;
+    bool operator!=(const RawGraphIterator& rhs) const
+    {
+        return !(*this == rhs);
+    }
+
+    /// Dereference this iterator, returning the upstream element of the
+    /// current edge in the traversal.
+    Element* operator*() const
+    {
+        return _upstreamElem;
+    }
+
+    /// Iterate to the next edge in the traversal.
+    /// @throws ExceptionFoundCycle if a cycle is encountered.
+    RawGraphIterator& operator++();
+
+    /// @name Elements
+    /// @{
+
+    /// Return the downstream element of the current edge.
+    Element* getDownstreamElement() const;
+
+    /// Return the connecting element, if any, of the current edge.
+    Element* getConnectingElement() const
+    {
+        return _connectingElem;
+    }
+
+    /// Return the upstream element of the current edge.
+    Element* getUpstreamElement() const
+    {
+        return _upstreamElem;
+    }
+
+    /// Return the index of the current edge within the range of upstream edges
+    /// available to the downstream element.
+    size_t getUpstreamIndex() const;
+
+    /// @}
+    /// @name Depth
+    /// @{
+
+    /// Return the element depth of the current traversal, where a single edge
+    /// between two elements represents a depth of one.
+    size_t getElementDepth() const;
+
+    /// Return the node depth of the current traversal, where a single edge
+    /// between two nodes represents a depth of one.
+    size_t getNodeDepth() const;
+
+    /// @}
+    /// @name Pruning
+    /// @{
+
+    /// Set the prune subgraph flag, which controls whether the current subgraph
+    /// is pruned from traversal.
+    /// @param prune If set to true, then the current subgraph will be pruned.
+    void setPruneSubgraph(bool prune)
+    {
+        _prune = prune;
+    }
+
+    /// Return the prune subgraph flag, which controls whether the current
+    /// subgraph is pruned from traversal.
+    bool getPruneSubgraph() const
+    {
+        return _prune;
+    }
+
+    /// @}
+    /// @name Range Methods
+    /// @{
+
+    /// Interpret this object as an iteration range, and return its begin
+    /// iterator.
+    RawGraphIterator& begin()
+    {
+        // Increment once to generate a valid edge.
+        if (getElementDepth() == 0)
+        {
+            operator++();
+        }
+        return *this;
+    }
+
+    /// Return the sentinel end iterator for this class.
+    static const RawGraphIterator& end();
+
+    /// @}
+
+  private:
+    class Scratch;
+
+    bool extendPathUpstream(Element* downstreamElem, size_t index);
+    void returnPathDownstream(Element* upstreamElem);
+
+  private:
+    Element* _upstreamElem;
+    Element* _connectingElem;
+    bool _prune;
+    Scratch* _scratch;
+};
+
 /// @class InheritanceIterator
 /// An iterator object representing the current state of an inheritance traversal.
 ///
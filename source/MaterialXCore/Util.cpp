@@ -5,15 +5,25 @@
 
 #include <MaterialXCore/Types.h>
 
+#include <atomic>
 #include <cctype>
+#include <exception>
+#include <mutex>
+#include <shared_mutex>
+#include <system_error>
+#include <thread>
+#include <unordered_set>
 
 MATERIALX_NAMESPACE_BEGIN
 
 const string EMPTY_STRING;
+const uint64_t STABLE_HASH_BASIS = 0xcbf29ce484222325ull;
 
 namespace
 {
 
+const uint64_t STABLE_HASH_PRIME = 0x100000001b3ull;
+
 const string LIBRARY_VERSION_STRING = std::to_string(MATERIALX_MAJOR_VERSION) + "." +
                                       std::to_string(MATERIALX_MINOR_VERSION) + "." +
                                       std::to_string(MATERIALX_BUILD_VERSION);
@@ -27,6 +37,37 @@ bool invalidNameChar(char c)
     return !isalnum((unsigned char) c) && c != '_' && c != ':';
 }
 
+// A process-wide table of interned strings, divided into independently
+// locked shards to reduce contention between threads.
+class InternTable
+{
+  public:
+    const string& intern(const string& str)
+    {
+        Shard& shard = _shards[std::hash<string>()(str) % SHARD_COUNT];
+        {
+            std::shared_lock<std::shared_mutex> lock(shard.mutex);
+            auto it = shard.strings.find(str);
+            if (it != shard.strings.end())
+            {
+                return *it;
+            }
+        }
+        std::unique_lock<std::shared_mutex> lock(shard.mutex);
+        return *shard.strings.insert(str).first;
+    }
+
+  private:
+    static const size_t SHARD_COUNT = 16;
+
+    struct Shard
+    {
+        std::shared_mutex mutex;
+        std::unordered_set<string> strings;
+    };
+    Shard _shards[SHARD_COUNT];
+};
+
 } // anonymous namespace
 
 //
@@ -179,4 +220,108 @@ string parentNamePath(const string& namePath)
     return EMPTY_STRING;
 }
 
+uint64_t stableHashInteger(uint64_t hash, uint64_t value)
+{
+    for (int i = 0; i < 8; i++)
+    {
+        hash ^= (value >> (i * 8)) & 0xff;
+        hash *= STABLE_HASH_PRIME;
+    }
+    return hash;
+}
+
+uint64_t stableHashString(uint64_t hash, const string& str)
+{
+    // Include the length, so that adjacent strings cannot run together.
+    hash = stableHashInteger(hash, str.size());
+    for (char c : str)
+    {
+        hash ^= (uint8_t) c;
+        hash *= STABLE_HASH_PRIME;
+    }
+    return hash;
+}
+
+const string& internString(const string& str)
+{
+    // The table is intentionally never destroyed, keeping interned strings
+    // valid for elements that outlive static destruction.
+    static InternTable* table = new InternTable();
+    return table->intern(str);
+}
+
+void parallelFor(size_t count, unsigned int threadCount, const std::function<void(size_t)>& func)
+{
+    if (threadCount == 0)
+    {
+        threadCount = std::max(std::thread::hardware_concurrency(), 1u);
+    }
+    threadCount = (unsigned int) std::min((size_t) threadCount, count);
+
+    // Process small workloads serially on the calling thread.
+    if (threadCount <= 1)
+    {
+        for (size_t i = 0; i < count; i++)
+        {
+            func(i);
+        }
+        return;
+    }
+
+    std::atomic<size_t> nextIndex(0);
+    std::atomic<bool> failed(false);
+    std::exception_ptr firstException;
+    std::mutex exceptionMutex;
+
+    auto worker = [&]()
+    {
+        while (!failed)
+        {
+            size_t i = nextIndex++;
+            if (i >= count)
+            {
+                break;
+            }
+            try
+            {
+                func(i);
+            }
+            catch (...)
+            {
+                std::lock_guard<std::mutex> lock(exceptionMutex);
+                if (!firstException)
+                {
+                    firstException = std::current_exception();
+                }
+                failed = true;
+            }
+        }
+    };
+
+    // Launch helper threads, falling back to the calling thread alone on
+    // platforms where threads cannot be created.
+    vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+    try
+    {
+        for (unsigned int t = 1; t < threadCount; t++)
+        {
+            threads.emplace_back(worker);
+        }
+    }
+    catch (std::system_error&)
+    {
+    }
+    worker();
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+
+    if (firstException)
+    {
+        std::rethrow_exception(firstException);
+    }
+}
+
 MATERIALX_NAMESPACE_END
@@ -60,6 +60,19 @@ template <typename T> void hashCombine(size_t& seed, const T& value)
     seed ^= std::hash<T>()(value) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
 }
 
+/// The initial value of a stable hash.
+extern MX_CORE_API const uint64_t STABLE_HASH_BASIS;
+
+/// Combine an integer with an existing stable hash, returning the new hash.
+/// Stable hashes are 64-bit FNV-1a hashes of values in a fixed byte order,
+/// which unlike hashCombine are independent of the platform, compiler and
+/// process, so that they may be stored persistently.
+MX_CORE_API uint64_t stableHashInteger(uint64_t hash, uint64_t value);
+
+/// Combine a string, including its length, with an existing stable hash,
+/// returning the new hash.
+MX_CORE_API uint64_t stableHashString(uint64_t hash, const string& str);
+
 /// Split a name path into string vector
 MX_CORE_API StringVec splitNamePath(const string& namePath);
 
@@ -69,6 +82,27 @@ MX_CORE_API string createNamePath(const StringVec& nameVec);
 /// Given a name path, return the parent name path
 MX_CORE_API string parentNamePath(const string& namePath);
 
+/// Return the interned copy of the given string.  Interned strings are held
+/// in a process-wide table for the lifetime of the process, so that equal
+/// strings share a single address and may be compared by pointer.  Since
+/// interned strings are never released, interning is intended only for the
+/// bounded vocabulary of element categories and attribute names, and not for
+/// element names or attribute values.  This method may be called concurrently
+/// from multiple threads.
+MX_CORE_API const string& internString(const string& str);
+
+/// Invoke the given function once for each index in the range [0, count),
+/// distributing the calls across a pool of worker threads.
+/// @param count The number of indices to process.
+/// @param threadCount The maximum number of threads to use.  A value of zero
+///    selects the number of hardware threads, and a value of one processes all
+///    indices in order on the calling thread.
+/// @param func The function to invoke for each index.
+/// @throws The first exception thrown by any invocation of the function, after
+///    all worker threads have completed.  Indices that have not yet been
+///    dispatched when an exception is thrown are skipped.
+MX_CORE_API void parallelFor(size_t count, unsigned int threadCount, const std::function<void(size_t)>& func);
+
 MATERIALX_NAMESPACE_END
 
 #endif
@@ -7,6 +7,8 @@
 #include <MaterialXCore/Document.h>
 #include <MaterialXCore/Value.h>
 
+#include <cctype>
+#include <charconv>
 #include <iomanip>
 #include <sstream>
 #include <type_traits>
@@ -24,34 +26,143 @@ thread_local int _floatPrecision = 6;
 template <class T> inline constexpr bool is_std_vector_v = false;
 template <class T> inline constexpr bool is_std_vector_v<vector<T>> = true;
 
-} // anonymous namespace
+// Parse a number from the given character range, following the conventions of
+// stream extraction in the classic locale: leading whitespace and a leading
+// plus sign are skipped, and characters following the number are ignored.
+template <class T> bool parseNumber(const char* begin, const char* end, T& value)
+{
+    while (begin != end && std::isspace((unsigned char) *begin))
+        begin++;
+    if (begin != end && *begin == '+')
+        begin++;
 
-//
-// Global functions
-//
+    if constexpr(std::is_floating_point_v<T>)
+    {
+        // Reject special values, which are not accepted by stream extraction.
+        const char* digits = (begin != end && *begin == '-') ? begin + 1 : begin;
+        if (digits == end || (!std::isdigit((unsigned char) *digits) && *digits != '.'))
+        {
+            return false;
+        }
+#if defined(__cpp_lib_to_chars)
+        std::from_chars_result result = std::from_chars(begin, end, value);
+        if (result.ec != std::errc::result_out_of_range)
+        {
+            return result.ec == std::errc();
+        }
+        // Defer to stream extraction for out-of-range values, which may
+        // still be accepted as denormals or zero.
+#endif
+        std::istringstream ss(string(begin, end));
+        ss.imbue(std::locale::classic());
+        return (bool) (ss >> value);
+    }
+    else
+    {
+        return std::from_chars(begin, end, value).ec == std::errc();
+    }
+}
 
-template <class T> const string& getTypeString()
+// Parse a fixed number of float components from the given value string,
+// returning false if the number of components does not match.
+bool parseComponents(const string& value, float* components, size_t count)
 {
-    return TypedValue<T>::TYPE;
+    const char* begin = value.data();
+    const char* end = begin + value.size();
+    const char* invalidBegin = nullptr;
+    const char* invalidEnd = nullptr;
+    size_t index = 0;
+    while (true)
+    {
+        while (begin != end && ARRAY_VALID_SEPARATORS.find(*begin) != string::npos)
+            begin++;
+        if (begin == end)
+        {
+            break;
+        }
+        const char* tokenEnd = begin;
+        while (tokenEnd != end && ARRAY_VALID_SEPARATORS.find(*tokenEnd) == string::npos)
+            tokenEnd++;
+        if (index == count)
+        {
+            return false;
+        }
+        if (!parseNumber(begin, tokenEnd, components[index++]) && !invalidBegin)
+        {
+            invalidBegin = begin;
+            invalidEnd = tokenEnd;
+        }
+        begin = tokenEnd;
+    }
+    if (index != count)
+    {
+        return false;
+    }
+    if (invalidBegin)
+    {
+        throw ExceptionTypeError("Type mismatch in generic fromValueString: " + string(invalidBegin, invalidEnd));
+    }
+    return true;
 }
 
-template <class T> string toValueString(const T& data)
+// Append a number to the given string, applying the current float format
+// and precision to floating-point values.
+template <class T> void appendNumber(string& str, T value)
+{
+    char buffer[128];
+    if constexpr(std::is_floating_point_v<T>)
+    {
+#if defined(__cpp_lib_to_chars)
+        const Value::FloatFormat format = Value::getFloatFormat();
+        const int precision = std::max(Value::getFloatPrecision(), 0);
+        std::to_chars_result result =
+            std::to_chars(buffer, buffer + sizeof(buffer), value,
+                          format == Value::FloatFormatFixed ? std::chars_format::fixed :
+                          (format == Value::FloatFormatScientific ? std::chars_format::scientific : std::chars_format::general),
+                          precision);
+        if (result.ec == std::errc())
+        {
+            str.append(buffer, result.ptr);
+            return;
+        }
+#endif
+        std::stringstream ss;
+        ss.imbue(std::locale::classic());
+
+        // Set float format and precision for the stream
+        const Value::FloatFormat fmt = Value::getFloatFormat();
+        ss.setf(std::ios_base::fmtflags(
+                (fmt == Value::FloatFormatFixed ? std::ios_base::fixed :
+                (fmt == Value::FloatFormatScientific ? std::ios_base::scientific : 0))),
+            std::ios_base::floatfield);
+        ss.precision(Value::getFloatPrecision());
+
+        ss << value;
+        str += ss.str();
+    }
+    else
+    {
+        std::to_chars_result result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+        str.append(buffer, result.ptr);
+    }
+}
+
+// Append the value string of the given data to a string.
+template <class T> void appendValueString(string& str, const T& data)
 {
-    string str;
-    
     if constexpr(std::is_same_v<T, string>)
     {
-        str = data;
+        str += data;
     }
     else if constexpr(std::is_same_v<T, bool>)
     {
-        str = data ? VALUE_STRING_TRUE : VALUE_STRING_FALSE;
+        str += data ? VALUE_STRING_TRUE : VALUE_STRING_FALSE;
     }
     else if constexpr(std::is_base_of_v<VectorBase, T>)
     {
         for (size_t i = 0; i < data.numElements(); i++)
         {
-            str += toValueString(data[i]);
+            appendNumber(str, data[i]);
             if (i + 1 < data.numElements())
             {
                 str += ARRAY_PREFERRED_SEPARATOR;
@@ -64,7 +175,7 @@ template <class T> string toValueString(const T& data)
         {
             for (size_t j = 0; j < data.numColumns(); j++)
             {
-                str += toValueString(data[i][j]);
+                appendNumber(str, data[i][j]);
                 if (i + 1 < data.numRows() ||
                     j + 1 < data.numColumns())
                 {
@@ -77,7 +188,7 @@ template <class T> string toValueString(const T& data)
     {
         for (size_t i = 0; i < data.size(); i++)
         {
-            str += toValueString<typename T::value_type>(data[i]);
+            appendValueString<typename T::value_type>(str, data[i]);
             if (i + 1 < data.size())
             {
                 str += ARRAY_PREFERRED_SEPARATOR;
@@ -86,28 +197,32 @@ template <class T> string toValueString(const T& data)
     }
     else
     {
-        std::stringstream ss;
-        ss.imbue(std::locale::classic());
+        appendNumber(str, data);
+    }
+}
 
-        // Set float format and precision for the stream
-        const Value::FloatFormat fmt = Value::getFloatFormat();
-        ss.setf(std::ios_base::fmtflags(
-                (fmt == Value::FloatFormatFixed ? std::ios_base::fixed :
-                (fmt == Value::FloatFormatScientific ? std::ios_base::scientific : 0))),
-            std::ios_base::floatfield);
-        ss.precision(Value::getFloatPrecision());
+} // anonymous namespace
 
-        ss << data;
-        str = ss.str();
-    }
-    
+//
+// Global functions
+//
+
+template <class T> const string& getTypeString()
+{
+    return TypedValue<T>::TYPE;
+}
+
+template <class T> string toValueString(const T& data)
+{
+    string str;
+    appendValueString(str, data);
     return str;
 }
 
 template <class T> T fromValueString(const string& value)
 {
     T data;
-    
+
     if constexpr(std::is_same_v<T, string>)
     {
         data = value;
@@ -123,20 +238,15 @@ template <class T> T fromValueString(const string& value)
     }
     else if constexpr(std::is_base_of_v<VectorBase, T>)
     {
-        StringVec tokens = splitString(value, ARRAY_VALID_SEPARATORS);
-        if (tokens.size() != data.numElements())
+        if (!parseComponents(value, &data[0], data.numElements()))
         {
             throw ExceptionTypeError("Type mismatch in vector fromValueString: " + value);
         }
-        for (size_t i = 0; i < data.numElements(); i++)
-        {
-            data[i] = fromValueString<float>(tokens[i]);
-        }
     }
     else if constexpr(std::is_base_of_v<MatrixBase, T>)
     {
-        StringVec tokens = splitString(value, ARRAY_VALID_SEPARATORS);
-        if (tokens.size() != data.numRows() * data.numColumns())
+        float components[T::numRows() * T::numColumns()];
+        if (!parseComponents(value, components, T::numRows() * T::numColumns()))
         {
             throw ExceptionTypeError("Type mismatch in matrix fromValueString: " + value);
         }
@@ -144,7 +254,7 @@ template <class T> T fromValueString(const string& value)
         {
             for (size_t j = 0; j < data.numColumns(); j++)
             {
-                data[i][j] = fromValueString<float>(tokens[i * data.numRows() + j]);
+                data[i][j] = components[i * data.numRows() + j];
             }
         }
     }
@@ -152,23 +262,50 @@ template <class T> T fromValueString(const string& value)
     {
         // This code path parses an array of arbitrary substrings, so we split the string
         // in a fashion that preserves substrings with internal spaces.
-        const string COMMA_SEPARATOR = ",";
-        for (const string& token : splitString(value, COMMA_SEPARATOR))
+        const char* begin = value.data();
+        const char* end = begin + value.size();
+        while (begin != end)
         {
-            typename T::value_type val = fromValueString<typename T::value_type>(trimSpaces(token));
-            data.push_back(val);
+            const char* tokenEnd = std::find(begin, end, ',');
+            if (tokenEnd != begin)
+            {
+                // Trim spaces from the token.
+                const char* tokenBegin = begin;
+                const char* trimmedEnd = tokenEnd;
+                while (tokenBegin != trimmedEnd && *tokenBegin == ' ')
+                    tokenBegin++;
+                while (trimmedEnd != tokenBegin && *(trimmedEnd - 1) == ' ')
+                    trimmedEnd--;
+
+                if constexpr(std::is_same_v<typename T::value_type, string>)
+                {
+                    data.emplace_back(tokenBegin, trimmedEnd);
+                }
+                else if constexpr(std::is_same_v<typename T::value_type, bool>)
+                {
+                    data.push_back(fromValueString<bool>(string(tokenBegin, trimmedEnd)));
+                }
+                else
+                {
+                    typename T::value_type val;
+                    if (!parseNumber(tokenBegin, trimmedEnd, val))
+                    {
+                        throw ExceptionTypeError("Type mismatch in generic fromValueString: " + string(tokenBegin, trimmedEnd));
+                    }
+                    data.push_back(val);
+                }
+            }
+            begin = (tokenEnd != end) ? tokenEnd + 1 : end;
         }
     }
     else
     {
-        std::stringstream ss(value);
-        ss.imbue(std::locale::classic());
-        if (!(ss >> data))
+        if (!parseNumber(value.data(), value.data() + value.size(), data))
         {
             throw ExceptionTypeError("Type mismatch in generic fromValueString: " + value);
         }
     }
-    
+
     return data;
 }
 
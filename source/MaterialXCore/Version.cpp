@@ -5,6 +5,8 @@
 
 #include <MaterialXCore/Document.h>
 
+#include <unordered_set>
+
 MATERIALX_NAMESPACE_BEGIN
 
 namespace
@@ -58,6 +60,133 @@ void copyInputWithBindings(NodePtr sourceNode, const string& sourceInputName,
     }
 }
 
+// A summary of the categories, attributes and types present in a document,
+// gathered in a single traversal, from which upgrade passes with no work to
+// do may be skipped.
+class UpgradeScan
+{
+  public:
+    explicit UpgradeScan(const Document& doc) :
+        _hasBoundValues(false)
+    {
+        const string* typeAttr = &internString(TypedElement::TYPE_ATTRIBUTE);
+        const string* valueAttr = &internString(ValueElement::VALUE_ATTRIBUTE);
+        const std::unordered_set<const string*> connectionAttrs =
+        {
+            &internString(PortElement::NODE_NAME_ATTRIBUTE),
+            &internString(PortElement::NODE_GRAPH_ATTRIBUTE),
+            &internString(PortElement::OUTPUT_ATTRIBUTE),
+            &internString(ValueElement::INTERFACE_NAME_ATTRIBUTE)
+        };
+
+        size_t index = 0;
+        for (Element* elem : doc.traverseTreeRaw())
+        {
+            _categories[&elem->getCategory()].emplace_back(index++, elem);
+            bool hasValue = false;
+            bool hasConnection = false;
+            for (const auto& attr : elem->getAttributes())
+            {
+                _attributes.insert(attr.first);
+                if (attr.first == typeAttr)
+                {
+                    _types.insert(attr.second);
+                }
+                hasValue = hasValue || attr.first == valueAttr;
+                hasConnection = hasConnection || connectionAttrs.count(attr.first);
+            }
+            _hasBoundValues = _hasBoundValues || (hasValue && hasConnection);
+        }
+    }
+
+    // Return true if an element of the given category is present.
+    bool hasCategory(const string& category) const
+    {
+        return _categories.count(&internString(category)) != 0;
+    }
+
+    // Return true if an element of any of the given categories is present.
+    bool hasAnyCategory(const StringVec& categories) const
+    {
+        for (const string& category : categories)
+        {
+            if (hasCategory(category))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Return true if an element of the given category has the given attribute.
+    bool hasCategoryAttribute(const string& category, const string& attrib) const
+    {
+        auto it = _categories.find(&internString(category));
+        if (it == _categories.end())
+        {
+            return false;
+        }
+        for (const auto& pair : it->second)
+        {
+            if (pair.second->hasAttribute(attrib))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    // Return true if an attribute with the given name is present.
+    bool hasAttribute(const string& attrib) const
+    {
+        return _attributes.count(&internString(attrib)) != 0;
+    }
+
+    // Return true if an element of the given type is present.
+    bool hasType(const string& type) const
+    {
+        return _types.count(type) != 0;
+    }
+
+    // Return true if any element has both a value and a connection.
+    bool hasBoundValues() const
+    {
+        return _hasBoundValues;
+    }
+
+    // Return all nodes with the given categories, in traversal order.
+    vector<NodePtr> getNodes(const StringSet& categories) const
+    {
+        vector<std::pair<size_t, Element*>> elements;
+        for (const string& category : categories)
+        {
+            auto it = _categories.find(&internString(category));
+            if (it != _categories.end())
+            {
+                elements.insert(elements.end(), it->second.begin(), it->second.end());
+            }
+        }
+        std::sort(elements.begin(), elements.end());
+
+        vector<NodePtr> nodes;
+        for (const auto& pair : elements)
+        {
+            NodePtr node = pair.second->getSelf()->asA<Node>();
+            if (node)
+            {
+                nodes.push_back(node);
+            }
+        }
+        return nodes;
+    }
+
+  private:
+    std::unordered_map<const string*, vector<std::pair<size_t, Element*>>> _categories;
+    std::unordered_set<const string*> _attributes;
+    std::unordered_set<string> _types;
+    bool _hasBoundValues;
+};
+
 } // anonymous namespace
 
 void Document::upgradeVersion()
@@ -71,15 +200,23 @@ void Document::upgradeVersion()
     int majorVersion = documentVersion.first;
     int minorVersion = documentVersion.second;
 
+    // Scan the document once, so that passes with no work to do can be
+    // skipped, and rescan after any pass that edits the document.
+    UpgradeScan scan(*this);
+
     // Upgrade from v1.22 to v1.23
     if (majorVersion == 1 && minorVersion == 22)
     {
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasType("vector"))
         {
-            if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "vector")
+            for (ElementPtr elem : traverseTree())
             {
-                elem->setAttribute(TypedElement::TYPE_ATTRIBUTE, getTypeString<Vector3>());
+                if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "vector")
+                {
+                    elem->setAttribute(TypedElement::TYPE_ATTRIBUTE, getTypeString<Vector3>());
+                }
             }
+            scan = UpgradeScan(*this);
         }
         minorVersion = 23;
     }
@@ -87,17 +224,21 @@ void Document::upgradeVersion()
     // Upgrade from v1.23 to v1.24
     if (majorVersion == 1 && minorVersion == 23)
     {
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasCategory("assign") || scan.hasAttribute("shadername"))
         {
-            if (elem->getCategory() == "shader" && elem->hasAttribute("shadername"))
-            {
-                elem->setAttribute(NodeDef::NODE_ATTRIBUTE, elem->getAttribute("shadername"));
-                elem->removeAttribute("shadername");
-            }
-            for (ElementPtr child : getChildrenOfType<Element>("assign"))
+            for (ElementPtr elem : traverseTree())
             {
-                elem->changeChildCategory(child, "materialassign");
+                if (elem->getCategory() == "shader" && elem->hasAttribute("shadername"))
+                {
+                    elem->setAttribute(NodeDef::NODE_ATTRIBUTE, elem->getAttribute("shadername"));
+                    elem->removeAttribute("shadername");
+                }
+                for (ElementPtr child : getChildrenOfType<Element>("assign"))
+                {
+                    elem->changeChildCategory(child, "materialassign");
+                }
             }
+            scan = UpgradeScan(*this);
         }
         minorVersion = 24;
     }
@@ -105,13 +246,17 @@ void Document::upgradeVersion()
     // Upgrade from v1.24 to v1.25
     if (majorVersion == 1 && minorVersion == 24)
     {
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasAttribute("graphname"))
         {
-            if (elem->isA<Input>() && elem->hasAttribute("graphname"))
+            for (ElementPtr elem : traverseTree())
             {
-                elem->setAttribute("opgraph", elem->getAttribute("graphname"));
-                elem->removeAttribute("graphname");
+                if (elem->isA<Input>() && elem->hasAttribute("graphname"))
+                {
+                    elem->setAttribute("opgraph", elem->getAttribute("graphname"));
+                    elem->removeAttribute("graphname");
+                }
             }
+            scan = UpgradeScan(*this);
         }
         minorVersion = 25;
     }
@@ -119,16 +264,20 @@ void Document::upgradeVersion()
     // Upgrade from v1.25 to v1.26
     if (majorVersion == 1 && minorVersion == 25)
     {
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasCategory("constant"))
         {
-            if (elem->getCategory() == "constant")
+            for (ElementPtr elem : traverseTree())
             {
-                ElementPtr param = elem->getChild("color");
-                if (param)
+                if (elem->getCategory() == "constant")
                 {
-                    param->setName("value");
+                    ElementPtr param = elem->getChild("color");
+                    if (param)
+                    {
+                        param->setName("value");
+                    }
                 }
             }
+            scan = UpgradeScan(*this);
         }
         minorVersion = 26;
     }
@@ -136,120 +285,140 @@ void Document::upgradeVersion()
     // Upgrade from v1.26 to v1.34
     if (majorVersion == 1 && minorVersion == 26)
     {
-        // Upgrade elements in place.
-        for (ElementPtr elem : traverseTree())
+        // Determine which steps have work to do before editing the document.
+        const bool upgradeElements = scan.hasAnyCategory({ "opgraph", "shader", "shaderref" }) ||
+                                     (scan.hasCategory("parameter") && scan.hasType("opgraphnode"));
+        const bool upgradeShaderRefs = scan.hasCategory("shaderref");
+        const bool upgradeNodeDefInputs = scan.hasAttribute("opgraph") && scan.hasAttribute("graphoutput");
+        const bool upgradeGeomAttrs = scan.hasCategory("geomattr");
+        const bool upgradeUdims = upgradeGeomAttrs || scan.hasCategory(GeomProp::CATEGORY);
+
+        if (upgradeElements)
         {
-            ElementVec origChildren = elem->getChildren();
-            for (ElementPtr child : origChildren)
+            // Upgrade elements in place.
+            for (ElementPtr elem : traverseTree())
             {
-                if (child->getCategory() == "opgraph")
+                ElementVec origChildren = elem->getChildren();
+                for (ElementPtr child : origChildren)
                 {
-                    elem->changeChildCategory(child, "nodegraph");
-                }
-                else if (child->getCategory() == "shader")
-                {
-                    NodeDefPtr nodeDef = elem->changeChildCategory(child, "nodedef")->asA<NodeDef>();
-                    if (nodeDef->hasAttribute("shadertype"))
+                    if (child->getCategory() == "opgraph")
                     {
-                        nodeDef->setType(SURFACE_SHADER_TYPE_STRING);
+                        elem->changeChildCategory(child, "nodegraph");
                     }
-                    if (nodeDef->hasAttribute("shaderprogram"))
+                    else if (child->getCategory() == "shader")
                     {
-                        nodeDef->setNodeString(nodeDef->getAttribute("shaderprogram"));
+                        NodeDefPtr nodeDef = elem->changeChildCategory(child, "nodedef")->asA<NodeDef>();
+                        if (nodeDef->hasAttribute("shadertype"))
+                        {
+                            nodeDef->setType(SURFACE_SHADER_TYPE_STRING);
+                        }
+                        if (nodeDef->hasAttribute("shaderprogram"))
+                        {
+                            nodeDef->setNodeString(nodeDef->getAttribute("shaderprogram"));
+                        }
                     }
-                }
-                else if (child->getCategory() == "shaderref")
-                {
-                    if (child->hasAttribute("shadertype"))
+                    else if (child->getCategory() == "shaderref")
                     {
-                        child->setAttribute(TypedElement::TYPE_ATTRIBUTE, SURFACE_SHADER_TYPE_STRING);
-                        child->removeAttribute("shadertype");
+                        if (child->hasAttribute("shadertype"))
+                        {
+                            child->setAttribute(TypedElement::TYPE_ATTRIBUTE, SURFACE_SHADER_TYPE_STRING);
+                            child->removeAttribute("shadertype");
+                        }
                     }
-                }
-                else if (child->getCategory() == "parameter")
-                {
-                    if (child->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "opgraphnode")
+                    else if (child->getCategory() == "parameter")
                     {
-                        if (elem->isA<Node>())
+                        if (child->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "opgraphnode")
                         {
-                            InputPtr input = elem->changeChildCategory(child, "input")->asA<Input>();
-                            input->setNodeName(input->getAttribute("value"));
-                            input->removeAttribute("value");
-                            if (input->getConnectedNode())
+                            if (elem->isA<Node>())
                             {
-                                input->setType(input->getConnectedNode()->getType());
-                            }
-                            else
-                            {
-                                input->setType(getTypeString<Color3>());
+                                InputPtr input = elem->changeChildCategory(child, "input")->asA<Input>();
+                                input->setNodeName(input->getAttribute("value"));
+                                input->removeAttribute("value");
+                                if (input->getConnectedNode())
+                                {
+                                    input->setType(input->getConnectedNode()->getType());
+                                }
+                                else
+                                {
+                                    input->setType(getTypeString<Color3>());
+                                }
                             }
-                        }
-                        else if (elem->isA<Output>())
-                        {
-                            if (child->getName() == "in")
+                            else if (elem->isA<Output>())
                             {
-                                elem->setAttribute("nodename", child->getAttribute("value"));
+                                if (child->getName() == "in")
+                                {
+                                    elem->setAttribute("nodename", child->getAttribute("value"));
+                                }
+                                elem->removeChild(child->getName());
                             }
-                            elem->removeChild(child->getName());
                         }
                     }
                 }
             }
         }
 
-        // Assign nodedef names to shaderrefs.
-        for (ElementPtr mat : getChildrenOfType<Element>("material"))
+        if (upgradeShaderRefs)
         {
-            for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
+            // Assign nodedef names to shaderrefs.
+            for (ElementPtr mat : getChildrenOfType<Element>("material"))
             {
-                if (!getShaderNodeDef(shaderRef))
+                for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
                 {
-                    NodeDefPtr nodeDef = getNodeDef(shaderRef->getName());
-                    if (nodeDef)
+                    if (!getShaderNodeDef(shaderRef))
                     {
-                        shaderRef->setAttribute(NodeDef::NODE_DEF_ATTRIBUTE, nodeDef->getName());
-                        shaderRef->setAttribute(NodeDef::NODE_ATTRIBUTE, nodeDef->getNodeString());
+                        NodeDefPtr nodeDef = getNodeDef(shaderRef->getName());
+                        if (nodeDef)
+                        {
+                            shaderRef->setAttribute(NodeDef::NODE_DEF_ATTRIBUTE, nodeDef->getName());
+                            shaderRef->setAttribute(NodeDef::NODE_ATTRIBUTE, nodeDef->getNodeString());
+                        }
                     }
                 }
             }
         }
 
-        // Move connections from nodedef inputs to bindinputs.
-        ElementVec materials = getChildrenOfType<Element>("material");
-        for (NodeDefPtr nodeDef : getNodeDefs())
+        if (upgradeNodeDefInputs)
         {
-            for (InputPtr input : nodeDef->getActiveInputs())
+            // Move connections from nodedef inputs to bindinputs.
+            ElementVec materials = getChildrenOfType<Element>("material");
+            for (NodeDefPtr nodeDef : getNodeDefs())
             {
-                if (input->hasAttribute("opgraph") && input->hasAttribute("graphoutput"))
+                for (InputPtr input : nodeDef->getActiveInputs())
                 {
-                    for (ElementPtr mat : materials)
+                    if (input->hasAttribute("opgraph") && input->hasAttribute("graphoutput"))
                     {
-                        for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
+                        for (ElementPtr mat : materials)
                         {
-                            if (getShaderNodeDef(shaderRef) == nodeDef && !shaderRef->getChild(input->getName()))
+                            for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
                             {
-                                ElementPtr bindInput = shaderRef->addChildOfCategory("bindinput", input->getName());
-                                bindInput->setAttribute(TypedElement::TYPE_ATTRIBUTE, input->getType());
-                                bindInput->setAttribute("nodegraph", input->getAttribute("opgraph"));
-                                bindInput->setAttribute("output", input->getAttribute("graphoutput"));
+                                if (getShaderNodeDef(shaderRef) == nodeDef && !shaderRef->getChild(input->getName()))
+                                {
+                                    ElementPtr bindInput = shaderRef->addChildOfCategory("bindinput", input->getName());
+                                    bindInput->setAttribute(TypedElement::TYPE_ATTRIBUTE, input->getType());
+                                    bindInput->setAttribute("nodegraph", input->getAttribute("opgraph"));
+                                    bindInput->setAttribute("output", input->getAttribute("graphoutput"));
+                                }
                             }
                         }
+                        input->removeAttribute("opgraph");
+                        input->removeAttribute("graphoutput");
                     }
-                    input->removeAttribute("opgraph");
-                    input->removeAttribute("graphoutput");
                 }
             }
         }
 
         // Combine udim assignments into udim sets.
-        for (GeomInfoPtr geomInfo : getGeomInfos())
+        if (upgradeGeomAttrs)
         {
-            for (ElementPtr child : geomInfo->getChildrenOfType<Element>("geomattr"))
+            for (GeomInfoPtr geomInfo : getGeomInfos())
             {
-                geomInfo->changeChildCategory(child, "geomprop");
+                for (ElementPtr child : geomInfo->getChildrenOfType<Element>("geomattr"))
+                {
+                    geomInfo->changeChildCategory(child, "geomprop");
+                }
             }
         }
-        if (getGeomPropValue("udim") && !getGeomPropValue("udimset"))
+        if (upgradeUdims && getGeomPropValue("udim") && !getGeomPropValue("udimset"))
         {
             StringSet udimSet;
             for (GeomInfoPtr geomInfo : getGeomInfos())
@@ -280,29 +449,37 @@ void Document::upgradeVersion()
             udimSetInfo->setGeomPropValue(UDIM_SET_PROPERTY, udimSetString, getTypeString<StringVec>());
         }
 
+        if (upgradeElements || upgradeShaderRefs || upgradeNodeDefInputs || upgradeUdims)
+        {
+            scan = UpgradeScan(*this);
+        }
         minorVersion = 34;
     }
 
     // Upgrade from v1.34 to v1.35
     if (majorVersion == 1 && minorVersion == 34)
     {
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasType("matrix") || scan.hasAttribute("default") || scan.hasCategory(MaterialAssign::CATEGORY))
         {
-            if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "matrix")
+            for (ElementPtr elem : traverseTree())
             {
-                elem->setAttribute(TypedElement::TYPE_ATTRIBUTE, getTypeString<Matrix44>());
-            }
-            if (elem->hasAttribute("default") && !elem->hasAttribute(ValueElement::VALUE_ATTRIBUTE))
-            {
-                elem->setAttribute(ValueElement::VALUE_ATTRIBUTE, elem->getAttribute("default"));
-                elem->removeAttribute("default");
-            }
+                if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "matrix")
+                {
+                    elem->setAttribute(TypedElement::TYPE_ATTRIBUTE, getTypeString<Matrix44>());
+                }
+                if (elem->hasAttribute("default") && !elem->hasAttribute(ValueElement::VALUE_ATTRIBUTE))
+                {
+                    elem->setAttribute(ValueElement::VALUE_ATTRIBUTE, elem->getAttribute("default"));
+                    elem->removeAttribute("default");
+                }
 
-            MaterialAssignPtr matAssign = elem->asA<MaterialAssign>();
-            if (matAssign)
-            {
-                matAssign->setMaterial(matAssign->getName());
+                MaterialAssignPtr matAssign = elem->asA<MaterialAssign>();
+                if (matAssign)
+                {
+                    matAssign->setMaterial(matAssign->getName());
+                }
             }
+            scan = UpgradeScan(*this);
         }
         minorVersion = 35;
     }
@@ -310,68 +487,73 @@ void Document::upgradeVersion()
     // Upgrade from v1.35 to v1.36
     if (majorVersion == 1 && minorVersion == 35)
     {
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasType(GEOMNAME_TYPE_STRING) || scan.hasType(FILENAME_TYPE_STRING) ||
+            scan.hasCategory("material") || scan.hasCategory("lookinherit"))
         {
-            LookPtr look = elem->asA<Look>();
-            GeomInfoPtr geomInfo = elem->asA<GeomInfo>();
-
-            if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == GEOMNAME_TYPE_STRING &&
-                elem->getAttribute(ValueElement::VALUE_ATTRIBUTE) == "*")
-            {
-                elem->setAttribute(ValueElement::VALUE_ATTRIBUTE, UNIVERSAL_GEOM_NAME);
-            }
-            if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == FILENAME_TYPE_STRING)
+            for (ElementPtr elem : traverseTree())
             {
-                StringMap stringMap;
-                stringMap["%UDIM"] = UDIM_TOKEN;
-                stringMap["%UVTILE"] = UV_TILE_TOKEN;
-                elem->setAttribute(ValueElement::VALUE_ATTRIBUTE, replaceSubstrings(elem->getAttribute(ValueElement::VALUE_ATTRIBUTE), stringMap));
-            }
+                LookPtr look = elem->asA<Look>();
+                GeomInfoPtr geomInfo = elem->asA<GeomInfo>();
 
-            ElementVec origChildren = elem->getChildren();
-            for (ElementPtr child : origChildren)
-            {
-                if (elem->getCategory() == "material" && child->getCategory() == "override")
+                if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == GEOMNAME_TYPE_STRING &&
+                    elem->getAttribute(ValueElement::VALUE_ATTRIBUTE) == "*")
                 {
-                    for (ElementPtr shaderRef : elem->getChildrenOfType<Element>("shaderref"))
+                    elem->setAttribute(ValueElement::VALUE_ATTRIBUTE, UNIVERSAL_GEOM_NAME);
+                }
+                if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == FILENAME_TYPE_STRING)
+                {
+                    StringMap stringMap;
+                    stringMap["%UDIM"] = UDIM_TOKEN;
+                    stringMap["%UVTILE"] = UV_TILE_TOKEN;
+                    elem->setAttribute(ValueElement::VALUE_ATTRIBUTE, replaceSubstrings(elem->getAttribute(ValueElement::VALUE_ATTRIBUTE), stringMap));
+                }
+
+                ElementVec origChildren = elem->getChildren();
+                for (ElementPtr child : origChildren)
+                {
+                    if (elem->getCategory() == "material" && child->getCategory() == "override")
                     {
-                        NodeDefPtr nodeDef = getShaderNodeDef(shaderRef);
-                        if (nodeDef)
+                        for (ElementPtr shaderRef : elem->getChildrenOfType<Element>("shaderref"))
                         {
-                            for (ValueElementPtr activeValue : nodeDef->getActiveValueElements())
+                            NodeDefPtr nodeDef = getShaderNodeDef(shaderRef);
+                            if (nodeDef)
                             {
-                                if (activeValue->getAttribute("publicname") == child->getName() &&
-                                    !shaderRef->getChild(child->getName()))
+                                for (ValueElementPtr activeValue : nodeDef->getActiveValueElements())
                                 {
-                                    if (activeValue->getCategory() == "parameter")
+                                    if (activeValue->getAttribute("publicname") == child->getName() &&
+                                        !shaderRef->getChild(child->getName()))
                                     {
-                                        ElementPtr bindParam = shaderRef->addChildOfCategory("bindparam", activeValue->getName());
-                                        bindParam->setAttribute(TypedElement::TYPE_ATTRIBUTE, activeValue->getType());
-                                        bindParam->setAttribute(ValueElement::VALUE_ATTRIBUTE, child->getAttribute("value"));
-                                    }
-                                    else if (activeValue->isA<Input>())
-                                    {
-                                        ElementPtr bindInput = shaderRef->addChildOfCategory("bindinput", activeValue->getName());
-                                        bindInput->setAttribute(TypedElement::TYPE_ATTRIBUTE, activeValue->getType());
-                                        bindInput->setAttribute(ValueElement::VALUE_ATTRIBUTE, child->getAttribute("value"));
+                                        if (activeValue->getCategory() == "parameter")
+                                        {
+                                            ElementPtr bindParam = shaderRef->addChildOfCategory("bindparam", activeValue->getName());
+                                            bindParam->setAttribute(TypedElement::TYPE_ATTRIBUTE, activeValue->getType());
+                                            bindParam->setAttribute(ValueElement::VALUE_ATTRIBUTE, child->getAttribute("value"));
+                                        }
+                                        else if (activeValue->isA<Input>())
+                                        {
+                                            ElementPtr bindInput = shaderRef->addChildOfCategory("bindinput", activeValue->getName());
+                                            bindInput->setAttribute(TypedElement::TYPE_ATTRIBUTE, activeValue->getType());
+                                            bindInput->setAttribute(ValueElement::VALUE_ATTRIBUTE, child->getAttribute("value"));
+                                        }
                                     }
                                 }
                             }
                         }
+                        elem->removeChild(child->getName());
+                    }
+                    else if (elem->getCategory() == "material" && child->getCategory() == "materialinherit")
+                    {
+                        elem->setInheritString(child->getAttribute("material"));
+                        elem->removeChild(child->getName());
+                    }
+                    else if (look && child->getCategory() == "lookinherit")
+                    {
+                        elem->setInheritString(child->getAttribute("look"));
+                        elem->removeChild(child->getName());
                     }
-                    elem->removeChild(child->getName());
-                }
-                else if (elem->getCategory() == "material" && child->getCategory() == "materialinherit")
-                {
-                    elem->setInheritString(child->getAttribute("material"));
-                    elem->removeChild(child->getName());
-                }
-                else if (look && child->getCategory() == "lookinherit")
-                {
-                    elem->setInheritString(child->getAttribute("look"));
-                    elem->removeChild(child->getName());
                 }
             }
+            scan = UpgradeScan(*this);
         }
         minorVersion = 36;
     }
@@ -379,598 +561,655 @@ void Document::upgradeVersion()
     // Upgrade from 1.36 to 1.37
     if (majorVersion == 1 && minorVersion == 36)
     {
-        // Convert type attributes to child outputs.
-        for (NodeDefPtr nodeDef : getNodeDefs())
+        // Determine which steps have work to do before editing the document.
+        const bool upgradeNodeDefTypes = scan.hasCategoryAttribute(NodeDef::CATEGORY, TypedElement::TYPE_ATTRIBUTE);
+        const bool removeShaderNodeDefs = scan.hasCategoryAttribute(NodeDef::CATEGORY, "shadertype");
+        const bool upgradeGeomAttrs = scan.hasCategory("geomattr") || scan.hasCategory("geomattrvalue");
+        const bool upgradeNodes = scan.hasAnyCategory({ "invert", "rotate", "compare", "transformpoint", "transformvector",
+                                                        "transformnormal", "combine", "separate", "backdrop" });
+
+        if (upgradeNodeDefTypes)
         {
-            InterfaceElementPtr interfaceElem = std::static_pointer_cast<InterfaceElement>(nodeDef);
-            if (interfaceElem && interfaceElem->hasType())
+            // Convert type attributes to child outputs.
+            for (NodeDefPtr nodeDef : getNodeDefs())
             {
-                string type = interfaceElem->getAttribute(TypedElement::TYPE_ATTRIBUTE);
-                OutputPtr outputPtr;
-                if (!type.empty() && type != MULTI_OUTPUT_TYPE_STRING)
+                InterfaceElementPtr interfaceElem = std::static_pointer_cast<InterfaceElement>(nodeDef);
+                if (interfaceElem && interfaceElem->hasType())
                 {
-                    outputPtr = interfaceElem->getOutput("out");
-                    if (!outputPtr)
+                    string type = interfaceElem->getAttribute(TypedElement::TYPE_ATTRIBUTE);
+                    OutputPtr outputPtr;
+                    if (!type.empty() && type != MULTI_OUTPUT_TYPE_STRING)
                     {
-                        outputPtr = interfaceElem->addOutput("out", type);
+                        outputPtr = interfaceElem->getOutput("out");
+                        if (!outputPtr)
+                        {
+                            outputPtr = interfaceElem->addOutput("out", type);
+                        }
                     }
-                }
-                interfaceElem->removeAttribute(TypedElement::TYPE_ATTRIBUTE);
+                    interfaceElem->removeAttribute(TypedElement::TYPE_ATTRIBUTE);
 
-                const string& defaultInput = interfaceElem->getAttribute(Output::DEFAULT_INPUT_ATTRIBUTE);
-                if (outputPtr && !defaultInput.empty())
-                {
-                    outputPtr->setAttribute(Output::DEFAULT_INPUT_ATTRIBUTE, defaultInput);
+                    const string& defaultInput = interfaceElem->getAttribute(Output::DEFAULT_INPUT_ATTRIBUTE);
+                    if (outputPtr && !defaultInput.empty())
+                    {
+                        outputPtr->setAttribute(Output::DEFAULT_INPUT_ATTRIBUTE, defaultInput);
+                    }
+                    interfaceElem->removeAttribute(Output::DEFAULT_INPUT_ATTRIBUTE);
                 }
-                interfaceElem->removeAttribute(Output::DEFAULT_INPUT_ATTRIBUTE);
             }
         }
 
-        // Remove legacy shader nodedefs.
-        for (NodeDefPtr nodeDef : getNodeDefs())
+        if (removeShaderNodeDefs)
         {
-            if (nodeDef->hasAttribute("shadertype"))
+            // Remove legacy shader nodedefs.
+            for (NodeDefPtr nodeDef : getNodeDefs())
             {
-                for (ElementPtr mat : getChildrenOfType<Element>("material"))
+                if (nodeDef->hasAttribute("shadertype"))
                 {
-                    for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
+                    for (ElementPtr mat : getChildrenOfType<Element>("material"))
                     {
-                        if (shaderRef->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE) == nodeDef->getName())
+                        for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
                         {
-                            shaderRef->removeAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+                            if (shaderRef->getAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE) == nodeDef->getName())
+                            {
+                                shaderRef->removeAttribute(InterfaceElement::NODE_DEF_ATTRIBUTE);
+                            }
                         }
                     }
+                    removeNodeDef(nodeDef->getName());
                 }
-                removeNodeDef(nodeDef->getName());
             }
         }
 
-        // Convert geometric attributes to geometric properties.
-        for (GeomInfoPtr geomInfo : getGeomInfos())
+        if (upgradeGeomAttrs)
         {
-            for (ElementPtr child : geomInfo->getChildrenOfType<Element>("geomattr"))
+            // Convert geometric attributes to geometric properties.
+            for (GeomInfoPtr geomInfo : getGeomInfos())
             {
-                geomInfo->changeChildCategory(child, "geomprop");
+                for (ElementPtr child : geomInfo->getChildrenOfType<Element>("geomattr"))
+                {
+                    geomInfo->changeChildCategory(child, "geomprop");
+                }
             }
-        }
-        for (ElementPtr elem : traverseTree())
-        {
-            NodePtr node = elem->asA<Node>();
-            if (!node)
+            for (ElementPtr elem : traverseTree())
             {
-                continue;
-            }
+                NodePtr node = elem->asA<Node>();
+                if (!node)
+                {
+                    continue;
+                }
 
-            if (node->getCategory() == "geomattrvalue")
-            {
-                node->setCategory("geompropvalue");
-                if (node->hasAttribute("attrname"))
+                if (node->getCategory() == "geomattrvalue")
                 {
-                    node->setAttribute("geomprop", node->getAttribute("attrname"));
-                    node->removeAttribute("attrname");
+                    node->setCategory("geompropvalue");
+                    if (node->hasAttribute("attrname"))
+                    {
+                        node->setAttribute("geomprop", node->getAttribute("attrname"));
+                        node->removeAttribute("attrname");
+                    }
                 }
             }
         }
 
-        vector<NodePtr> unusedNodes;
-        for (ElementPtr elem : traverseTree())
+        if (upgradeNodes)
         {
-            NodePtr node = elem->asA<Node>();
-            if (!node)
-            {
-                continue;
-            }
-            const string& nodeCategory = node->getCategory();
-
-            // Change category from "invert to "invertmatrix" for matrix invert nodes
-            if (nodeCategory == "invert" &&
-                (node->getType() == getTypeString<Matrix33>() || node->getType() == getTypeString<Matrix44>()))
+            vector<NodePtr> unusedNodes;
+            for (ElementPtr elem : traverseTree())
             {
-                node->setCategory("invertmatrix");
-            }
-
-            // Change category from "rotate" to "rotate2d" or "rotate3d" nodes
-            else if (nodeCategory == "rotate")
-            {
-                node->setCategory((node->getType() == getTypeString<Vector2>()) ? "rotate2d" : "rotate3d");
-            }
-
-            // Convert "compare" node to "ifgreatereq".
-            else if (nodeCategory == "compare")
-            {
-                node->setCategory("ifgreatereq");
-                InputPtr intest = node->getInput("intest");
-                if (intest)
-                {
-                    intest->setName("value1");
-                }
-                ElementPtr cutoff = node->getChild("cutoff");
-                if (cutoff)
-                {
-                    cutoff = node->changeChildCategory(cutoff, "input");
-                    cutoff->setName("value2");
-                }
-                InputPtr in1 = node->getInput("in1");
-                InputPtr in2 = node->getInput("in2");
-                if (in1 && in2)
+                NodePtr node = elem->asA<Node>();
+                if (!node)
                 {
-                    in1->setName(createValidChildName("temp"));
-                    in2->setName("in1");
-                    in1->setName("in2");
+                    continue;
                 }
-            }
+                const string& nodeCategory = node->getCategory();
 
-            // Change nodes with category "transform[vector|point|normal]",
-            // which are not fromspace/tospace variants, to "transformmatrix"
-            else if (nodeCategory == "transformpoint" ||
-                     nodeCategory == "transformvector" ||
-                     nodeCategory == "transformnormal")
-            {
-                if (!node->getChild("fromspace") && !node->getChild("tospace"))
+                // Change category from "invert to "invertmatrix" for matrix invert nodes
+                if (nodeCategory == "invert" &&
+                    (node->getType() == getTypeString<Matrix33>() || node->getType() == getTypeString<Matrix44>()))
                 {
-                    node->setCategory("transformmatrix");
+                    node->setCategory("invertmatrix");
                 }
-            }
 
-            // Convert "combine" to "combine2", "combine3" or "combine4"
-            else if (nodeCategory == "combine")
-            {
-                if (node->getChild("in4"))
+                // Change category from "rotate" to "rotate2d" or "rotate3d" nodes
+                else if (nodeCategory == "rotate")
                 {
-                    node->setCategory("combine4");
+                    node->setCategory((node->getType() == getTypeString<Vector2>()) ? "rotate2d" : "rotate3d");
                 }
-                else if (node->getChild("in3"))
+
+                // Convert "compare" node to "ifgreatereq".
+                else if (nodeCategory == "compare")
                 {
-                    node->setCategory("combine3");
+                    node->setCategory("ifgreatereq");
+                    InputPtr intest = node->getInput("intest");
+                    if (intest)
+                    {
+                        intest->setName("value1");
+                    }
+                    ElementPtr cutoff = node->getChild("cutoff");
+                    if (cutoff)
+                    {
+                        cutoff = node->changeChildCategory(cutoff, "input");
+                        cutoff->setName("value2");
+                    }
+                    InputPtr in1 = node->getInput("in1");
+                    InputPtr in2 = node->getInput("in2");
+                    if (in1 && in2)
+                    {
+                        in1->setName(createValidChildName("temp"));
+                        in2->setName("in1");
+                        in1->setName("in2");
+                    }
                 }
-                else
+
+                // Change nodes with category "transform[vector|point|normal]",
+                // which are not fromspace/tospace variants, to "transformmatrix"
+                else if (nodeCategory == "transformpoint" ||
+                         nodeCategory == "transformvector" ||
+                         nodeCategory == "transformnormal")
                 {
-                    node->setCategory("combine2");
+                    if (!node->getChild("fromspace") && !node->getChild("tospace"))
+                    {
+                        node->setCategory("transformmatrix");
+                    }
                 }
-            }
 
-            // Convert "separate" to "separate2", "separate3" or "separate4"
-            else if (nodeCategory == "separate")
-            {
-                InputPtr in = node->getInput("in");
-                if (in)
+                // Convert "combine" to "combine2", "combine3" or "combine4"
+                else if (nodeCategory == "combine")
                 {
-                    const string& inType = in->getType();
-                    if (inType == getTypeString<Vector4>() || inType == getTypeString<Color4>())
+                    if (node->getChild("in4"))
                     {
-                        node->setCategory("separate4");
+                        node->setCategory("combine4");
                     }
-                    else if (inType == getTypeString<Vector3>() || inType == getTypeString<Color3>())
+                    else if (node->getChild("in3"))
                     {
-                        node->setCategory("separate3");
+                        node->setCategory("combine3");
                     }
                     else
                     {
-                        node->setCategory("separate2");
+                        node->setCategory("combine2");
                     }
                 }
-            }
 
-            // Convert backdrop nodes to backdrop elements
-            else if (nodeCategory == "backdrop")
-            {
-                BackdropPtr backdrop = addBackdrop(node->getName());
-                for (ElementPtr child : node->getChildrenOfType<Element>("parameter"))
+                // Convert "separate" to "separate2", "separate3" or "separate4"
+                else if (nodeCategory == "separate")
                 {
-                    if (child->hasAttribute(ValueElement::VALUE_ATTRIBUTE))
+                    InputPtr in = node->getInput("in");
+                    if (in)
                     {
-                        backdrop->setAttribute(child->getName(), child->getAttribute(ValueElement::VALUE_ATTRIBUTE));
+                        const string& inType = in->getType();
+                        if (inType == getTypeString<Vector4>() || inType == getTypeString<Color4>())
+                        {
+                            node->setCategory("separate4");
+                        }
+                        else if (inType == getTypeString<Vector3>() || inType == getTypeString<Color3>())
+                        {
+                            node->setCategory("separate3");
+                        }
+                        else
+                        {
+                            node->setCategory("separate2");
+                        }
                     }
                 }
-                unusedNodes.push_back(node);
+
+                // Convert backdrop nodes to backdrop elements
+                else if (nodeCategory == "backdrop")
+                {
+                    BackdropPtr backdrop = addBackdrop(node->getName());
+                    for (ElementPtr child : node->getChildrenOfType<Element>("parameter"))
+                    {
+                        if (child->hasAttribute(ValueElement::VALUE_ATTRIBUTE))
+                        {
+                            backdrop->setAttribute(child->getName(), child->getAttribute(ValueElement::VALUE_ATTRIBUTE));
+                        }
+                    }
+                    unusedNodes.push_back(node);
+                }
+            }
+            for (NodePtr node : unusedNodes)
+            {
+                node->getParent()->removeChild(node->getName());
             }
         }
-        for (NodePtr node : unusedNodes)
+
+        if (upgradeNodeDefTypes || removeShaderNodeDefs || upgradeGeomAttrs || upgradeNodes)
         {
-            node->getParent()->removeChild(node->getName());
+            scan = UpgradeScan(*this);
         }
-
         minorVersion = 37;
     }
 
     // Upgrade from 1.37 to 1.38
     if (majorVersion == 1 && minorVersion == 37)
     {
-        // Convert color2 types to vector2
-        const StringMap COLOR2_CHANNEL_MAP = { { "r", "x" }, { "a", "y" } };
-        for (ElementPtr elem : traverseTree())
+        // Determine which steps have work to do before editing the document.
+        // Material elements are converted to shader nodes of any category, so
+        // their presence also requires the node updates below.
+        const bool upgradeColor2 = scan.hasType("color2");
+        const bool upgradeMaterials = scan.hasCategory("material");
+        const bool upgradeNodes = upgradeMaterials ||
+                                  scan.hasAnyCategory({ "atan2", "rotate3d", "dielectric_brdf", "dielectric_btdf",
+                                                        "generalized_schlick_brdf", "conductor_brdf", "sheen_brdf",
+                                                        "diffuse_brdf", "burley_diffuse_brdf", "diffuse_btdf",
+                                                        "subsurface_brdf", "thin_film_brdf", "artistic_ior" });
+        const bool upgradeNodeGraphs = scan.hasCategory(NodeGraph::CATEGORY) &&
+                                       (scan.hasCategoryAttribute(NodeGraph::CATEGORY, InterfaceElement::VERSION_ATTRIBUTE) ||
+                                        scan.hasAttribute(ValueElement::INTERFACE_NAME_ATTRIBUTE));
+        const bool upgradeParameters = scan.hasCategory("parameter");
+
+        if (upgradeColor2)
         {
-            if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "color2")
+            // Convert color2 types to vector2
+            const StringMap COLOR2_CHANNEL_MAP = { { "r", "x" }, { "a", "y" } };
+            for (ElementPtr elem : traverseTree())
             {
-                elem->setAttribute(TypedElement::TYPE_ATTRIBUTE, getTypeString<Vector2>());
-                NodePtr parentNode = elem->getParent()->asA<Node>();
-                if (!parentNode)
+                if (elem->getAttribute(TypedElement::TYPE_ATTRIBUTE) == "color2")
                 {
-                    continue;
-                }
-
-                for (PortElementPtr port : parentNode->getDownstreamPorts())
-                {
-                    if (port->hasAttribute("channels"))
+                    elem->setAttribute(TypedElement::TYPE_ATTRIBUTE, getTypeString<Vector2>());
+                    NodePtr parentNode = elem->getParent()->asA<Node>();
+                    if (!parentNode)
                     {
-                        string channels = port->getAttribute("channels");
-                        channels = replaceSubstrings(channels, COLOR2_CHANNEL_MAP);
-                        port->setAttribute("channels", channels);
+                        continue;
                     }
-                    if (port->hasOutputString())
+
+                    for (PortElementPtr port : parentNode->getDownstreamPorts())
                     {
-                        string output = port->getOutputString();
-                        output = replaceSubstrings(output, COLOR2_CHANNEL_MAP);
-                        port->setOutputString(output);
+                        if (port->hasAttribute("channels"))
+                        {
+                            string channels = port->getAttribute("channels");
+                            channels = replaceSubstrings(channels, COLOR2_CHANNEL_MAP);
+                            port->setAttribute("channels", channels);
+                        }
+                        if (port->hasOutputString())
+                        {
+                            string output = port->getOutputString();
+                            output = replaceSubstrings(output, COLOR2_CHANNEL_MAP);
+                            port->setOutputString(output);
+                        }
                     }
-                }
 
-                ElementPtr channels = parentNode->getChild("channels");
-                if (channels && channels->hasAttribute(ValueElement::VALUE_ATTRIBUTE))
-                {
-                    string value = channels->getAttribute(ValueElement::VALUE_ATTRIBUTE);
-                    value = replaceSubstrings(value, COLOR2_CHANNEL_MAP);
-                    channels->setAttribute(ValueElement::VALUE_ATTRIBUTE, value);
+                    ElementPtr channels = parentNode->getChild("channels");
+                    if (channels && channels->hasAttribute(ValueElement::VALUE_ATTRIBUTE))
+                    {
+                        string value = channels->getAttribute(ValueElement::VALUE_ATTRIBUTE);
+                        value = replaceSubstrings(value, COLOR2_CHANNEL_MAP);
+                        channels->setAttribute(ValueElement::VALUE_ATTRIBUTE, value);
+                    }
                 }
             }
         }
 
-        // Convert material elements to material nodes
-        for (ElementPtr mat : getChildrenOfType<Element>("material"))
+        if (upgradeMaterials)
         {
-            NodePtr materialNode = nullptr;
-
-            for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
+            // Convert material elements to material nodes
+            for (ElementPtr mat : getChildrenOfType<Element>("material"))
             {
-                NodeDefPtr nodeDef = getShaderNodeDef(shaderRef);
+                NodePtr materialNode = nullptr;
 
-                // Get the shader node type and category, using the shader nodedef if present.
-                string shaderNodeType = nodeDef ? nodeDef->getType() : SURFACE_SHADER_TYPE_STRING;
-                string shaderNodeCategory = nodeDef ? nodeDef->getNodeString() : shaderRef->getAttribute(NodeDef::NODE_ATTRIBUTE);
+                for (ElementPtr shaderRef : mat->getChildrenOfType<Element>("shaderref"))
+                {
+                    NodeDefPtr nodeDef = getShaderNodeDef(shaderRef);
 
-                // Add the shader node.
-                string shaderNodeName = createValidChildName(shaderRef->getName());
-                NodePtr shaderNode = addNode(shaderNodeCategory, shaderNodeName, shaderNodeType);
+                    // Get the shader node type and category, using the shader nodedef if present.
+                    string shaderNodeType = nodeDef ? nodeDef->getType() : SURFACE_SHADER_TYPE_STRING;
+                    string shaderNodeCategory = nodeDef ? nodeDef->getNodeString() : shaderRef->getAttribute(NodeDef::NODE_ATTRIBUTE);
 
-                // Copy attributes to the shader node.
-                string nodeDefString = shaderRef->getAttribute(NodeDef::NODE_DEF_ATTRIBUTE);
-                string target = shaderRef->getAttribute(InterfaceElement::TARGET_ATTRIBUTE);
-                string version = shaderRef->getAttribute(InterfaceElement::VERSION_ATTRIBUTE);
-                if (!nodeDefString.empty())
-                {
-                    shaderNode->setNodeDefString(nodeDefString);
-                }
-                if (!target.empty())
-                {
-                    shaderNode->setTarget(target);
-                }
-                if (!version.empty())
-                {
-                    shaderNode->setVersionString(version);
-                }
-                shaderNode->setSourceUri(shaderRef->getSourceUri());
+                    // Add the shader node.
+                    string shaderNodeName = createValidChildName(shaderRef->getName());
+                    NodePtr shaderNode = addNode(shaderNodeCategory, shaderNodeName, shaderNodeType);
 
-                // Copy child elements to the shader node.
-                for (ElementPtr child : shaderRef->getChildren())
-                {
-                    ElementPtr newChild;
-                    if (child->getCategory() == "bindinput" || child->getCategory() == "bindparam")
+                    // Copy attributes to the shader node.
+                    string nodeDefString = shaderRef->getAttribute(NodeDef::NODE_DEF_ATTRIBUTE);
+                    string target = shaderRef->getAttribute(InterfaceElement::TARGET_ATTRIBUTE);
+                    string version = shaderRef->getAttribute(InterfaceElement::VERSION_ATTRIBUTE);
+                    if (!nodeDefString.empty())
                     {
-                        newChild = shaderNode->addInput(child->getName());
+                        shaderNode->setNodeDefString(nodeDefString);
                     }
-                    else if (child->getCategory() == "bindtoken")
+                    if (!target.empty())
                     {
-                        newChild = shaderNode->addToken(child->getName());
+                        shaderNode->setTarget(target);
                     }
-                    if (newChild)
+                    if (!version.empty())
                     {
-                        newChild->copyContentFrom(child);
+                        shaderNode->setVersionString(version);
                     }
-                }
+                    shaderNode->setSourceUri(shaderRef->getSourceUri());
 
-                // Create a material node if needed, making a connection to the new shader node.
-                if (!materialNode)
-                {
-                    materialNode = addMaterialNode(createValidName("temp"), shaderNode);
-                    materialNode->setSourceUri(mat->getSourceUri());
-                }
+                    // Copy child elements to the shader node.
+                    for (ElementPtr child : shaderRef->getChildren())
+                    {
+                        ElementPtr newChild;
+                        if (child->getCategory() == "bindinput" || child->getCategory() == "bindparam")
+                        {
+                            newChild = shaderNode->addInput(child->getName());
+                        }
+                        else if (child->getCategory() == "bindtoken")
+                        {
+                            newChild = shaderNode->addToken(child->getName());
+                        }
+                        if (newChild)
+                        {
+                            newChild->copyContentFrom(child);
+                        }
+                    }
 
-                // Assign additional shader inputs to the material as needed.
-                if (!materialNode->getInput(shaderNodeType))
-                {
-                    InputPtr shaderInput = materialNode->addInput(shaderNodeType, shaderNodeType);
-                    shaderInput->setNodeName(shaderNode->getName());
+                    // Create a material node if needed, making a connection to the new shader node.
+                    if (!materialNode)
+                    {
+                        materialNode = addMaterialNode(createValidName("temp"), shaderNode);
+                        materialNode->setSourceUri(mat->getSourceUri());
+                    }
+
+                    // Assign additional shader inputs to the material as needed.
+                    if (!materialNode->getInput(shaderNodeType))
+                    {
+                        InputPtr shaderInput = materialNode->addInput(shaderNodeType, shaderNodeType);
+                        shaderInput->setNodeName(shaderNode->getName());
+                    }
                 }
-            }
 
-            // Remove the material element, transferring its name and attributes to the material node.
-            removeChild(mat->getName());
-            if (materialNode)
-            {
-                materialNode->setName(mat->getName());
-                for (const string& attr : mat->getAttributeNames())
+                // Remove the material element, transferring its name and attributes to the material node.
+                removeChild(mat->getName());
+                if (materialNode)
                 {
-                    if (!materialNode->hasAttribute(attr))
+                    materialNode->setName(mat->getName());
+                    for (const string& attr : mat->getAttributeNames())
                     {
-                        materialNode->setAttribute(attr, mat->getAttribute(attr));
+                        if (!materialNode->hasAttribute(attr))
+                        {
+                            materialNode->setAttribute(attr, mat->getAttribute(attr));
+                        }
                     }
                 }
             }
         }
 
-        // Define BSDF node pairs.
-        using StringPair = std::pair<string, string>;
-        const StringPair DIELECTRIC_BRDF = { "dielectric_brdf", "dielectric_bsdf" };
-        const StringPair DIELECTRIC_BTDF = { "dielectric_btdf", "dielectric_bsdf" };
-        const StringPair GENERALIZED_SCHLICK_BRDF = { "generalized_schlick_brdf", "generalized_schlick_bsdf" };
-        const StringPair CONDUCTOR_BRDF = { "conductor_brdf", "conductor_bsdf" };
-        const StringPair SHEEN_BRDF = { "sheen_brdf", "sheen_bsdf" };
-        const StringPair DIFFUSE_BRDF = { "diffuse_brdf", "oren_nayar_diffuse_bsdf" };
-        const StringPair BURLEY_DIFFUSE_BRDF = { "burley_diffuse_brdf", "burley_diffuse_bsdf" };
-        const StringPair DIFFUSE_BTDF = { "diffuse_btdf", "translucent_bsdf" };
-        const StringPair SUBSURFACE_BRDF = { "subsurface_brdf", "subsurface_bsdf" };
-        const StringPair THIN_FILM_BRDF = { "thin_film_brdf", "thin_film_bsdf" };
-
-        // Function for upgrading old nested layering setup
-        // to new setup with layer operators.
-        auto upgradeBsdfLayering = [](NodePtr node)
+        if (upgradeNodes)
         {
-            InputPtr base = node->getInput("base");
-            if (base)
-            {
-                NodePtr baseNode = base->getConnectedNode();
-                if (baseNode)
+            // Define BSDF node pairs.
+            using StringPair = std::pair<string, string>;
+            const StringPair DIELECTRIC_BRDF = { "dielectric_brdf", "dielectric_bsdf" };
+            const StringPair DIELECTRIC_BTDF = { "dielectric_btdf", "dielectric_bsdf" };
+            const StringPair GENERALIZED_SCHLICK_BRDF = { "generalized_schlick_brdf", "generalized_schlick_bsdf" };
+            const StringPair CONDUCTOR_BRDF = { "conductor_brdf", "conductor_bsdf" };
+            const StringPair SHEEN_BRDF = { "sheen_brdf", "sheen_bsdf" };
+            const StringPair DIFFUSE_BRDF = { "diffuse_brdf", "oren_nayar_diffuse_bsdf" };
+            const StringPair BURLEY_DIFFUSE_BRDF = { "burley_diffuse_brdf", "burley_diffuse_bsdf" };
+            const StringPair DIFFUSE_BTDF = { "diffuse_btdf", "translucent_bsdf" };
+            const StringPair SUBSURFACE_BRDF = { "subsurface_brdf", "subsurface_bsdf" };
+            const StringPair THIN_FILM_BRDF = { "thin_film_brdf", "thin_film_bsdf" };
+
+            // Function for upgrading old nested layering setup
+            // to new setup with layer operators.
+            auto upgradeBsdfLayering = [](NodePtr node)
+            {
+                InputPtr base = node->getInput("base");
+                if (base)
                 {
-                    GraphElementPtr parent = node->getParent()->asA<GraphElement>();
-                    // Rename the top bsdf node, and give its old name to the layer operator
-                    // so we don't need to update any connection references.
-                    const string oldName = node->getName();
-                    node->setName(oldName + "__layer_top");
-                    NodePtr layer = parent->addNode("layer", oldName, "BSDF");
-                    InputPtr layerTop = layer->addInput("top", "BSDF");
-                    InputPtr layerBase = layer->addInput("base", "BSDF");
-                    layerTop->setConnectedNode(node);
-                    layerBase->setConnectedNode(baseNode);
-                }
-                node->removeInput("base");
-            }
-        };
+                    NodePtr baseNode = base->getConnectedNode();
+                    if (baseNode)
+                    {
+                        GraphElementPtr parent = node->getParent()->asA<GraphElement>();
+                        // Rename the top bsdf node, and give its old name to the layer operator
+                        // so we don't need to update any connection references.
+                        const string oldName = node->getName();
+                        node->setName(oldName + "__layer_top");
+                        NodePtr layer = parent->addNode("layer", oldName, "BSDF");
+                        InputPtr layerTop = layer->addInput("top", "BSDF");
+                        InputPtr layerBase = layer->addInput("base", "BSDF");
+                        layerTop->setConnectedNode(node);
+                        layerBase->setConnectedNode(baseNode);
+                    }
+                    node->removeInput("base");
+                }
+            };
 
-        // Storage for inputs found connected downstream from artistic_ior node.
-        vector<InputPtr> artisticIorConnections, artisticExtConnections;
+            // Storage for inputs found connected downstream from artistic_ior node.
+            vector<InputPtr> artisticIorConnections, artisticExtConnections;
 
-        // Update all nodes.
-        for (ElementPtr elem : traverseTree())
-        {
-            NodePtr node = elem->asA<Node>();
-            if (!node)
-            {
-                continue;
-            }
-            const string& nodeCategory = node->getCategory();
-            if (nodeCategory == "atan2")
+            // Update all nodes.
+            for (ElementPtr elem : traverseTree())
             {
-                InputPtr input = node->getInput("in1");
-                InputPtr input2 = node->getInput("in2");
-                if (input && input2)
+                NodePtr node = elem->asA<Node>();
+                if (!node)
                 {
-                    input->setName(EMPTY_STRING);
-                    input2->setName("in1");
-                    input->setName("in2");
+                    continue;
                 }
-                else
+                const string& nodeCategory = node->getCategory();
+                if (nodeCategory == "atan2")
                 {
-                    if (input)
+                    InputPtr input = node->getInput("in1");
+                    InputPtr input2 = node->getInput("in2");
+                    if (input && input2)
                     {
+                        input->setName(EMPTY_STRING);
+                        input2->setName("in1");
                         input->setName("in2");
                     }
-                    if (input2)
+                    else
                     {
-                        input2->setName("in1");
+                        if (input)
+                        {
+                            input->setName("in2");
+                        }
+                        if (input2)
+                        {
+                            input2->setName("in1");
+                        }
                     }
                 }
-            }
-            else if (nodeCategory == "rotate3d")
-            {
-                ElementPtr axis = node->getChild("axis");
-                if (axis)
+                else if (nodeCategory == "rotate3d")
                 {
-                    node->changeChildCategory(axis, "input");
+                    ElementPtr axis = node->getChild("axis");
+                    if (axis)
+                    {
+                        node->changeChildCategory(axis, "input");
+                    }
                 }
-            }
-            else if (nodeCategory == DIELECTRIC_BRDF.first)
-            {
-                node->setCategory(DIELECTRIC_BRDF.second);
-                upgradeBsdfLayering(node);
-            }
-            else if (nodeCategory == DIELECTRIC_BTDF.first)
-            {
-                node->setCategory(DIELECTRIC_BTDF.second);
-                node->removeInput("interior");
-                InputPtr mode = node->addInput("scatter_mode", STRING_TYPE_STRING);
-                mode->setValueString("T");
-            }
-            else if (nodeCategory == GENERALIZED_SCHLICK_BRDF.first)
-            {
-                node->setCategory(GENERALIZED_SCHLICK_BRDF.second);
-                upgradeBsdfLayering(node);
-            }
-            else if (nodeCategory == SHEEN_BRDF.first)
-            {
-                node->setCategory(SHEEN_BRDF.second);
-                upgradeBsdfLayering(node);
-            }
-            else if (nodeCategory == THIN_FILM_BRDF.first)
-            {
-                node->setCategory(THIN_FILM_BRDF.second);
-                upgradeBsdfLayering(node);
-            }
-            else if (nodeCategory == CONDUCTOR_BRDF.first)
-            {
-                node->setCategory(CONDUCTOR_BRDF.second);
-
-                // Create an artistic_ior node to convert from artistic to physical parameterization.
-                GraphElementPtr parent = node->getParent()->asA<GraphElement>();
-                NodePtr artisticIor = parent->addNode("artistic_ior", node->getName() + "__artistic_ior", "multioutput");
-                OutputPtr artisticIor_ior = artisticIor->addOutput("ior", "color3");
-                OutputPtr artisticIor_extinction = artisticIor->addOutput("extinction", "color3");
-
-                // Copy inputs and bindings from conductor node to artistic_ior node.
-                copyInputWithBindings(node, "reflectivity", artisticIor, "reflectivity");
-                copyInputWithBindings(node, "edge_color", artisticIor, "edge_color");
-
-                // Update the parameterization on the conductor node
-                // and connect it to the artistic_ior node.
-                node->removeInput("reflectivity");
-                node->removeInput("edge_color");
-                InputPtr ior = node->addInput("ior", "color3");
-                ior->setNodeName(artisticIor->getName());
-                ior->setOutputString(artisticIor_ior->getName());
-                InputPtr extinction = node->addInput("extinction", "color3");
-                extinction->setNodeName(artisticIor->getName());
-                extinction->setOutputString(artisticIor_extinction->getName());
-            }
-            else if (nodeCategory == DIFFUSE_BRDF.first)
-            {
-                node->setCategory(DIFFUSE_BRDF.second);
-            }
-            else if (nodeCategory == BURLEY_DIFFUSE_BRDF.first)
-            {
-                node->setCategory(BURLEY_DIFFUSE_BRDF.second);
-            }
-            else if (nodeCategory == DIFFUSE_BTDF.first)
-            {
-                node->setCategory(DIFFUSE_BTDF.second);
-            }
-            else if (nodeCategory == SUBSURFACE_BRDF.first)
-            {
-                node->setCategory(SUBSURFACE_BRDF.second);
-            }
-            else if (nodeCategory == "artistic_ior")
-            {
-                OutputPtr ior = node->getOutput("ior");
-                if (ior)
+                else if (nodeCategory == DIELECTRIC_BRDF.first)
                 {
-                    ior->setType("color3");
+                    node->setCategory(DIELECTRIC_BRDF.second);
+                    upgradeBsdfLayering(node);
                 }
-                OutputPtr extinction = node->getOutput("extinction");
-                if (extinction)
+                else if (nodeCategory == DIELECTRIC_BTDF.first)
                 {
-                    extinction->setType("color3");
+                    node->setCategory(DIELECTRIC_BTDF.second);
+                    node->removeInput("interior");
+                    InputPtr mode = node->addInput("scatter_mode", STRING_TYPE_STRING);
+                    mode->setValueString("T");
                 }
-            }
+                else if (nodeCategory == GENERALIZED_SCHLICK_BRDF.first)
+                {
+                    node->setCategory(GENERALIZED_SCHLICK_BRDF.second);
+                    upgradeBsdfLayering(node);
+                }
+                else if (nodeCategory == SHEEN_BRDF.first)
+                {
+                    node->setCategory(SHEEN_BRDF.second);
+                    upgradeBsdfLayering(node);
+                }
+                else if (nodeCategory == THIN_FILM_BRDF.first)
+                {
+                    node->setCategory(THIN_FILM_BRDF.second);
+                    upgradeBsdfLayering(node);
+                }
+                else if (nodeCategory == CONDUCTOR_BRDF.first)
+                {
+                    node->setCategory(CONDUCTOR_BRDF.second);
 
-            // Search for connections to artistic_ior with vector3 type.
-            // If found we must insert a conversion node color3->vector3
-            // since the outputs of artistic_ior is now color3.
-            // Save the inputs here and insert the conversion nodes below,
-            // since we can't modify the graph while traversing it.
-            for (InputPtr input : node->getInputs())
-            {
-                if (input->getOutputString() == "ior" && input->getType() == "vector3")
+                    // Create an artistic_ior node to convert from artistic to physical parameterization.
+                    GraphElementPtr parent = node->getParent()->asA<GraphElement>();
+                    NodePtr artisticIor = parent->addNode("artistic_ior", node->getName() + "__artistic_ior", "multioutput");
+                    OutputPtr artisticIor_ior = artisticIor->addOutput("ior", "color3");
+                    OutputPtr artisticIor_extinction = artisticIor->addOutput("extinction", "color3");
+
+                    // Copy inputs and bindings from conductor node to artistic_ior node.
+                    copyInputWithBindings(node, "reflectivity", artisticIor, "reflectivity");
+                    copyInputWithBindings(node, "edge_color", artisticIor, "edge_color");
+
+                    // Update the parameterization on the conductor node
+                    // and connect it to the artistic_ior node.
+                    node->removeInput("reflectivity");
+                    node->removeInput("edge_color");
+                    InputPtr ior = node->addInput("ior", "color3");
+                    ior->setNodeName(artisticIor->getName());
+                    ior->setOutputString(artisticIor_ior->getName());
+                    InputPtr extinction = node->addInput("extinction", "color3");
+                    extinction->setNodeName(artisticIor->getName());
+                    extinction->setOutputString(artisticIor_extinction->getName());
+                }
+                else if (nodeCategory == DIFFUSE_BRDF.first)
+                {
+                    node->setCategory(DIFFUSE_BRDF.second);
+                }
+                else if (nodeCategory == BURLEY_DIFFUSE_BRDF.first)
+                {
+                    node->setCategory(BURLEY_DIFFUSE_BRDF.second);
+                }
+                else if (nodeCategory == DIFFUSE_BTDF.first)
                 {
-                    NodePtr connectedNode = input->getConnectedNode();
-                    if (connectedNode && connectedNode->getCategory() == "artistic_ior")
+                    node->setCategory(DIFFUSE_BTDF.second);
+                }
+                else if (nodeCategory == SUBSURFACE_BRDF.first)
+                {
+                    node->setCategory(SUBSURFACE_BRDF.second);
+                }
+                else if (nodeCategory == "artistic_ior")
+                {
+                    OutputPtr ior = node->getOutput("ior");
+                    if (ior)
+                    {
+                        ior->setType("color3");
+                    }
+                    OutputPtr extinction = node->getOutput("extinction");
+                    if (extinction)
                     {
-                        artisticIorConnections.push_back(input);
+                        extinction->setType("color3");
                     }
                 }
-                else if (input->getOutputString() == "extinction" && input->getType() == "vector3")
+
+                // Search for connections to artistic_ior with vector3 type.
+                // If found we must insert a conversion node color3->vector3
+                // since the outputs of artistic_ior is now color3.
+                // Save the inputs here and insert the conversion nodes below,
+                // since we can't modify the graph while traversing it.
+                for (InputPtr input : node->getInputs())
                 {
-                    NodePtr connectedNode = input->getConnectedNode();
-                    if (connectedNode && connectedNode->getCategory() == "artistic_ior")
+                    if (input->getOutputString() == "ior" && input->getType() == "vector3")
+                    {
+                        NodePtr connectedNode = input->getConnectedNode();
+                        if (connectedNode && connectedNode->getCategory() == "artistic_ior")
+                        {
+                            artisticIorConnections.push_back(input);
+                        }
+                    }
+                    else if (input->getOutputString() == "extinction" && input->getType() == "vector3")
                     {
-                        artisticExtConnections.push_back(input);
+                        NodePtr connectedNode = input->getConnectedNode();
+                        if (connectedNode && connectedNode->getCategory() == "artistic_ior")
+                        {
+                            artisticExtConnections.push_back(input);
+                        }
                     }
                 }
             }
-        }
 
-        // Insert conversion nodes for artistic_ior connections found above.
-        for (InputPtr input : artisticIorConnections)
-        {
-            NodePtr artisticIorNode = input->getConnectedNode();
-            ElementPtr node = input->getParent();
-            GraphElementPtr parent = node->getParent()->asA<GraphElement>();
-            NodePtr convert = parent->addNode("convert", node->getName() + "__convert_ior", "vector3");
-            InputPtr convertInput = convert->addInput("in", "color3");
-            convertInput->setNodeName(artisticIorNode->getName());
-            convertInput->setOutputString("ior");
-            input->setNodeName(convert->getName());
-            input->removeAttribute(PortElement::OUTPUT_ATTRIBUTE);
-        }
-        for (InputPtr input : artisticExtConnections)
-        {
-            NodePtr artisticIorNode = input->getConnectedNode();
-            ElementPtr node = input->getParent();
-            GraphElementPtr parent = node->getParent()->asA<GraphElement>();
-            NodePtr convert = parent->addNode("convert", node->getName() + "__convert_extinction", "vector3");
-            InputPtr convertInput = convert->addInput("in", "color3");
-            convertInput->setNodeName(artisticIorNode->getName());
-            convertInput->setOutputString("extinction");
-            input->setNodeName(convert->getName());
-            input->removeAttribute(PortElement::OUTPUT_ATTRIBUTE);
+            // Insert conversion nodes for artistic_ior connections found above.
+            for (InputPtr input : artisticIorConnections)
+            {
+                NodePtr artisticIorNode = input->getConnectedNode();
+                ElementPtr node = input->getParent();
+                GraphElementPtr parent = node->getParent()->asA<GraphElement>();
+                NodePtr convert = parent->addNode("convert", node->getName() + "__convert_ior", "vector3");
+                InputPtr convertInput = convert->addInput("in", "color3");
+                convertInput->setNodeName(artisticIorNode->getName());
+                convertInput->setOutputString("ior");
+                input->setNodeName(convert->getName());
+                input->removeAttribute(PortElement::OUTPUT_ATTRIBUTE);
+            }
+            for (InputPtr input : artisticExtConnections)
+            {
+                NodePtr artisticIorNode = input->getConnectedNode();
+                ElementPtr node = input->getParent();
+                GraphElementPtr parent = node->getParent()->asA<GraphElement>();
+                NodePtr convert = parent->addNode("convert", node->getName() + "__convert_extinction", "vector3");
+                InputPtr convertInput = convert->addInput("in", "color3");
+                convertInput->setNodeName(artisticIorNode->getName());
+                convertInput->setOutputString("extinction");
+                input->setNodeName(convert->getName());
+                input->removeAttribute(PortElement::OUTPUT_ATTRIBUTE);
+            }
         }
 
-        // Make it so that interface names and nodes in a nodegraph are not duplicates
-        // If they are, rename the nodes.
-        for (NodeGraphPtr nodegraph : getNodeGraphs())
+        if (upgradeNodeGraphs)
         {
-            // Clear out any erroneously set version
-            nodegraph->removeAttribute(InterfaceElement::VERSION_ATTRIBUTE);
-
-            StringSet interfaceNames;
-            for (auto child : nodegraph->getChildren())
+            // Make it so that interface names and nodes in a nodegraph are not duplicates
+            // If they are, rename the nodes.
+            for (NodeGraphPtr nodegraph : getNodeGraphs())
             {
-                NodePtr node = child->asA<Node>();
-                if (node)
+                // Clear out any erroneously set version
+                nodegraph->removeAttribute(InterfaceElement::VERSION_ATTRIBUTE);
+
+                StringSet interfaceNames;
+                for (auto child : nodegraph->getChildren())
                 {
-                    for (ValueElementPtr elem : node->getChildrenOfType<ValueElement>())
+                    NodePtr node = child->asA<Node>();
+                    if (node)
                     {
-                        const string& interfaceName = elem->getInterfaceName();
-                        if (!interfaceName.empty())
+                        for (ValueElementPtr elem : node->getChildrenOfType<ValueElement>())
                         {
-                            interfaceNames.insert(interfaceName);
+                            const string& interfaceName = elem->getInterfaceName();
+                            if (!interfaceName.empty())
+                            {
+                                interfaceNames.insert(interfaceName);
+                            }
                         }
                     }
                 }
-            }
-            for (string interfaceName : interfaceNames)
-            {
-                NodePtr node = nodegraph->getNode(interfaceName);
-                if (node)
+                for (string interfaceName : interfaceNames)
                 {
-                    string newNodeName = nodegraph->createValidChildName(interfaceName);
-                    vector<MaterialX::PortElementPtr> downstreamPorts = node->getDownstreamPorts();
-                    for (MaterialX::PortElementPtr downstreamPort : downstreamPorts)
+                    NodePtr node = nodegraph->getNode(interfaceName);
+                    if (node)
                     {
-                        if (downstreamPort->getNodeName() == interfaceName)
+                        string newNodeName = nodegraph->createValidChildName(interfaceName);
+                        vector<MaterialX::PortElementPtr> downstreamPorts = node->getDownstreamPorts();
+                        for (MaterialX::PortElementPtr downstreamPort : downstreamPorts)
                         {
-                            downstreamPort->setNodeName(newNodeName);
+                            if (downstreamPort->getNodeName() == interfaceName)
+                            {
+                                downstreamPort->setNodeName(newNodeName);
+                            }
                         }
+                        node->setName(newNodeName);
                     }
-                    node->setName(newNodeName);
                 }
             }
         }
 
-        // Convert parameters to inputs, applying uniform markings to converted inputs
-        // of nodedefs.
-        for (ElementPtr elem : traverseTree())
+        if (upgradeParameters)
         {
-            if (elem->isA<InterfaceElement>())
+            // Convert parameters to inputs, applying uniform markings to converted inputs
+            // of nodedefs.
+            for (ElementPtr elem : traverseTree())
             {
-                for (ElementPtr param : elem->getChildrenOfType<Element>("parameter"))
+                if (elem->isA<InterfaceElement>())
                 {
-                    InputPtr input = elem->changeChildCategory(param, "input")->asA<Input>();
-                    if (elem->isA<NodeDef>())
+                    for (ElementPtr param : elem->getChildrenOfType<Element>("parameter"))
                     {
-                        input->setIsUniform(true);
+                        InputPtr input = elem->changeChildCategory(param, "input")->asA<Input>();
+                        if (elem->isA<NodeDef>())
+                        {
+                            input->setIsUniform(true);
+                        }
                     }
                 }
             }
         }
 
+        if (upgradeColor2 || upgradeMaterials || upgradeNodes || upgradeNodeGraphs || upgradeParameters)
+        {
+            scan = UpgradeScan(*this);
+        }
         minorVersion = 38;
     }
 
@@ -1008,110 +1247,116 @@ void Document::upgradeVersion()
 
         // Convert channels attributes to legacy swizzle nodes, which are then converted
         // to modern nodes in a second pass.
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasAttribute("channels"))
         {
-            PortElementPtr port = elem->asA<PortElement>();
-            if (!port)
+            for (ElementPtr elem : traverseTree())
             {
-                continue;
-            }
+                PortElementPtr port = elem->asA<PortElement>();
+                if (!port)
+                {
+                    continue;
+                }
 
-            const string& channelString = port->getAttribute("channels");
-            if (channelString.empty())
-            {
-                continue;
-            }
+                const string& channelString = port->getAttribute("channels");
+                if (channelString.empty())
+                {
+                    continue;
+                }
 
-            // Determine the upstream type.
-            ElementPtr parent = port->getParent();
-            GraphElementPtr graph = port->getAncestorOfType<GraphElement>();
-            NodePtr upstreamNode = port->getConnectedNode();
-            string upstreamType = upstreamNode ? upstreamNode->getType() : EMPTY_STRING;
-            if (upstreamType.empty() || upstreamType == MULTI_OUTPUT_TYPE_STRING)
-            {
-                for (const auto& pair : CHANNEL_ATTRIBUTE_PATTERNS)
+                // Determine the upstream type.
+                ElementPtr parent = port->getParent();
+                GraphElementPtr graph = port->getAncestorOfType<GraphElement>();
+                NodePtr upstreamNode = port->getConnectedNode();
+                string upstreamType = upstreamNode ? upstreamNode->getType() : EMPTY_STRING;
+                if (upstreamType.empty() || upstreamType == MULTI_OUTPUT_TYPE_STRING)
                 {
-                    if (pair.first.count(channelString))
+                    for (const auto& pair : CHANNEL_ATTRIBUTE_PATTERNS)
+                    {
+                        if (pair.first.count(channelString))
+                        {
+                            upstreamType = pair.second;
+                            break;
+                        }
+                    }
+                    if (upstreamType.empty() || upstreamType == MULTI_OUTPUT_TYPE_STRING)
                     {
-                        upstreamType = pair.second;
-                        break;
+                        upstreamType = (port->getType() == "color3") ? "color4" : "color3";
                     }
                 }
-                if (upstreamType.empty() || upstreamType == MULTI_OUTPUT_TYPE_STRING)
+
+                // Ignore the channels string for purely scalar connections.
+                if (upstreamType == getTypeString<float>() && port->getType() == getTypeString<float>())
                 {
-                    upstreamType = (port->getType() == "color3") ? "color4" : "color3";
+                    port->removeAttribute("channels");
+                    continue;
                 }
-            }
 
-            // Ignore the channels string for purely scalar connections.
-            if (upstreamType == getTypeString<float>() && port->getType() == getTypeString<float>())
-            {
+                // Create the new swizzle node.
+                NodePtr swizzleNode = graph->addNode("swizzle", graph->createValidChildName("swizzle"), port->getType());
+                int childIndex = (parent->getParent() == graph) ? graph->getChildIndex(parent->getName()) : graph->getChildIndex(port->getName());
+                if (childIndex != -1)
+                {
+                    graph->setChildIndex(swizzleNode->getName(), childIndex);
+                }
+                InputPtr in = swizzleNode->addInput("in");
+                in->copyContentFrom(port);
+                in->removeAttribute("channels");
+                in->setType(upstreamType);
+                swizzleNode->setInputValue("channels", channelString);
+
+                // Connect the original port to this node.
+                port->setConnectedNode(swizzleNode);
+                port->removeAttribute(PortElement::OUTPUT_ATTRIBUTE);
+                port->removeAttribute(PortElement::INTERFACE_NAME_ATTRIBUTE);
                 port->removeAttribute("channels");
-                continue;
-            }
 
-            // Create the new swizzle node.
-            NodePtr swizzleNode = graph->addNode("swizzle", graph->createValidChildName("swizzle"), port->getType());
-            int childIndex = (parent->getParent() == graph) ? graph->getChildIndex(parent->getName()) : graph->getChildIndex(port->getName());
-            if (childIndex != -1)
-            {
-                graph->setChildIndex(swizzleNode->getName(), childIndex);
-            }
-            InputPtr in = swizzleNode->addInput("in");
-            in->copyContentFrom(port);
-            in->removeAttribute("channels");
-            in->setType(upstreamType);
-            swizzleNode->setInputValue("channels", channelString);
-
-            // Connect the original port to this node.
-            port->setConnectedNode(swizzleNode);
-            port->removeAttribute(PortElement::OUTPUT_ATTRIBUTE);
-            port->removeAttribute(PortElement::INTERFACE_NAME_ATTRIBUTE);
-            port->removeAttribute("channels");
-
-            // Update any nodegraph reference
-            if (graph)
-            {
-                const string& portNodeGraphString = port->getNodeGraphString();
-                if (!portNodeGraphString.empty())
+                // Update any nodegraph reference
+                if (graph)
                 {
-                    const string& graphName = graph->getName();
-                    if (graphName.empty())
+                    const string& portNodeGraphString = port->getNodeGraphString();
+                    if (!portNodeGraphString.empty())
                     {
-                        port->removeAttribute(PortElement::NODE_GRAPH_ATTRIBUTE);
-                    }
-                    else if (graphName != portNodeGraphString)
-                    {
-                        port->setNodeGraphString(graphName);
+                        const string& graphName = graph->getName();
+                        if (graphName.empty())
+                        {
+                            port->removeAttribute(PortElement::NODE_GRAPH_ATTRIBUTE);
+                        }
+                        else if (graphName != portNodeGraphString)
+                        {
+                            port->setNodeGraphString(graphName);
+                        }
                     }
                 }
             }
+            scan = UpgradeScan(*this);
         }
 
         // In MaterialX 1.39, each node input may have only one binding.  Legacy
         // 1.38 nodegraph implementations sometimes kept a default value on an
         // input that was also connected to a nodegraph interface, so preserve the
         // binding and let the declaration provide any default value.
-        for (ElementPtr elem : traverseTree())
+        if (scan.hasBoundValues())
         {
-            InputPtr input = elem->asA<Input>();
-            if (input && input->getParent()->isA<Node>() && input->hasValue() &&
-                (input->hasNodeName() || input->hasNodeGraphString() ||
-                 input->hasInterfaceName() || input->hasOutputString()))
+            for (ElementPtr elem : traverseTree())
             {
-                input->removeAttribute(ValueElement::VALUE_ATTRIBUTE);
+                InputPtr input = elem->asA<Input>();
+                if (input && input->getParent()->isA<Node>() && input->hasValue() &&
+                    (input->hasNodeName() || input->hasNodeGraphString() ||
+                     input->hasInterfaceName() || input->hasOutputString()))
+                {
+                    input->removeAttribute(ValueElement::VALUE_ATTRIBUTE);
+                }
             }
         }
 
-        // Update all nodes.
+        // Update all nodes of the affected categories.
+        const StringSet UPGRADE_NODE_CATEGORIES =
+        {
+            "layer", "subsurface_bsdf", "switch", "swizzle", "atan2", "normalmap"
+        };
         vector<NodePtr> unusedNodes;
-        for (ElementPtr elem : traverseTree())
+        for (NodePtr node : scan.getNodes(UPGRADE_NODE_CATEGORIES))
         {
-            NodePtr node = elem->asA<Node>();
-            if (!node)
-            {
-                continue;
-            }
             const string& nodeCategory = node->getCategory();
             if (nodeCategory == "layer")
             {
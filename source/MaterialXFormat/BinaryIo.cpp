@@ -0,0 +1,601 @@
+//
+// Copyright Contributors to the MaterialX Project
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <MaterialXFormat/BinaryIo.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+MATERIALX_NAMESPACE_BEGIN
+
+const string MTLX_SNAPSHOT_EXTENSION = "mtlxsnap";
+
+const uint32_t BINARY_SNAPSHOT_VERSION = 2;
+
+namespace
+{
+
+const char SNAPSHOT_MAGIC[8] = { 'M', 'T', 'L', 'X', 'S', 'N', 'A', 'P' };
+const uint32_t SNAPSHOT_BYTE_ORDER = 0x01020304;
+const size_t SNAPSHOT_HEADER_SIZE = 48;
+
+// A single element in the flat element table.  Children of each element are
+// stored contiguously, in breadth-first order.
+struct ElementRecord
+{
+    uint32_t category;
+    uint32_t name;
+    uint32_t sourceUri;
+    uint32_t firstChild;
+    uint32_t childCount;
+    uint32_t firstAttribute;
+    uint32_t attributeCount;
+};
+
+struct SnapshotHeader
+{
+    uint32_t formatVersion = 0;
+    uint32_t byteOrder = 0;
+    uint32_t libraryVersion = 0;
+    uint32_t sourceFilesSize = 0;
+    uint64_t sourceHash = 0;
+    uint64_t payloadSize = 0;
+    uint64_t payloadChecksum = 0;
+};
+
+// Compute a 64-bit FNV-1a checksum of the given data.
+uint64_t computeChecksum(const char* data, size_t size)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (size_t i = 0; i < size; i++)
+    {
+        hash ^= (uint64_t) (unsigned char) data[i];
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+template <class T> void appendValue(string& buffer, const T& value)
+{
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+// Helper class for interning strings during serialization.
+class StringTable
+{
+  public:
+    uint32_t intern(const string& str)
+    {
+        auto it = _indices.find(str);
+        if (it != _indices.end())
+        {
+            return it->second;
+        }
+        uint32_t index = (uint32_t) _strings.size();
+        _indices.emplace(str, index);
+        _strings.push_back(str);
+        return index;
+    }
+
+    const StringVec& getStrings() const
+    {
+        return _strings;
+    }
+
+  private:
+    std::unordered_map<string, uint32_t> _indices;
+    StringVec _strings;
+};
+
+// Helper class for bounds-checked reads from a snapshot buffer.
+class SnapshotReader
+{
+  public:
+    SnapshotReader(const char* data, size_t size) :
+        _data(data),
+        _size(size),
+        _pos(0)
+    {
+    }
+
+    const char* readBytes(size_t count)
+    {
+        if (count > _size - _pos)
+        {
+            throw ExceptionParseError("Binary snapshot is truncated");
+        }
+        const char* bytes = _data + _pos;
+        _pos += count;
+        return bytes;
+    }
+
+    template <class T> T readValue()
+    {
+        T value;
+        std::memcpy(&value, readBytes(sizeof(T)), sizeof(T));
+        return value;
+    }
+
+    void alignTo(size_t alignment)
+    {
+        size_t padding = (alignment - (_pos % alignment)) % alignment;
+        readBytes(padding);
+    }
+
+  private:
+    const char* _data;
+    size_t _size;
+    size_t _pos;
+};
+
+bool readHeader(const char* data, size_t size, SnapshotHeader& header)
+{
+    if (size < SNAPSHOT_HEADER_SIZE || std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)))
+    {
+        return false;
+    }
+    SnapshotReader reader(data + sizeof(SNAPSHOT_MAGIC), SNAPSHOT_HEADER_SIZE - sizeof(SNAPSHOT_MAGIC));
+    header.formatVersion = reader.readValue<uint32_t>();
+    header.byteOrder = reader.readValue<uint32_t>();
+    header.libraryVersion = reader.readValue<uint32_t>();
+    header.sourceFilesSize = reader.readValue<uint32_t>();
+    header.sourceHash = reader.readValue<uint64_t>();
+    header.payloadSize = reader.readValue<uint64_t>();
+    header.payloadChecksum = reader.readValue<uint64_t>();
+    return header.formatVersion == BINARY_SNAPSHOT_VERSION &&
+           header.byteOrder == SNAPSHOT_BYTE_ORDER &&
+           header.libraryVersion == (uint32_t) MATERIALX_VERSION_INDEX &&
+           header.sourceFilesSize <= header.payloadSize;
+}
+
+// The list of source files is stored at the start of the payload, as a count
+// followed by length-prefixed strings.
+string serializeSourceFiles(const StringVec& sourceFiles)
+{
+    string data;
+    appendValue(data, (uint32_t) sourceFiles.size());
+    for (const string& file : sourceFiles)
+    {
+        appendValue(data, (uint32_t) file.size());
+        data.append(file);
+    }
+    data.append((4 - (data.size() % 4)) % 4, '\0');
+    return data;
+}
+
+StringVec sourceFilesFromData(const char* data, size_t size)
+{
+    SnapshotReader reader(data, size);
+    uint32_t fileCount = reader.readValue<uint32_t>();
+    StringVec sourceFiles;
+    for (uint32_t i = 0; i < fileCount; i++)
+    {
+        uint32_t length = reader.readValue<uint32_t>();
+        sourceFiles.emplace_back(reader.readBytes(length), length);
+    }
+    return sourceFiles;
+}
+
+string serializePayload(DocumentPtr doc)
+{
+    StringTable strings;
+    vector<ElementRecord> elements;
+    vector<uint32_t> attributes;
+
+    // Flatten the element tree in breadth-first order, so that the children
+    // of each element occupy a contiguous range of the element table.
+    ElementVec queue = { doc };
+    for (size_t i = 0; i < queue.size(); i++)
+    {
+        ElementPtr elem = queue[i];
+        ElementRecord record;
+        record.category = strings.intern(elem->getCategory());
+        record.name = strings.intern(elem->getName());
+        record.sourceUri = strings.intern(elem->getSourceUri());
+        record.firstAttribute = (uint32_t) (attributes.size() / 2);
+        record.attributeCount = (uint32_t) elem->getAttributes().size();
+        for (const AttributeStore::Attribute& attr : elem->getAttributes())
+        {
+            attributes.push_back(strings.intern(*attr.first));
+            attributes.push_back(strings.intern(attr.second));
+        }
+        record.firstChild = (uint32_t) queue.size();
+        record.childCount = (uint32_t) elem->getChildren().size();
+        queue.insert(queue.end(), elem->getChildren().begin(), elem->getChildren().end());
+        elements.push_back(record);
+    }
+
+    string payload;
+
+    // Write the string table as an offset array followed by packed characters.
+    const StringVec& stringVec = strings.getStrings();
+    appendValue(payload, (uint32_t) stringVec.size());
+    uint32_t offset = 0;
+    appendValue(payload, offset);
+    for (const string& str : stringVec)
+    {
+        offset += (uint32_t) str.size();
+        appendValue(payload, offset);
+    }
+    for (const string& str : stringVec)
+    {
+        payload.append(str);
+    }
+    payload.append((4 - (payload.size() % 4)) % 4, '\0');
+
+    // Write the element and attribute tables.
+    appendValue(payload, (uint32_t) elements.size());
+    for (const ElementRecord& record : elements)
+    {
+        appendValue(payload, record);
+    }
+    appendValue(payload, (uint32_t) (attributes.size() / 2));
+    for (uint32_t index : attributes)
+    {
+        appendValue(payload, index);
+    }
+
+    return payload;
+}
+
+void documentFromPayload(DocumentPtr doc, const char* data, size_t size)
+{
+    SnapshotReader reader(data, size);
+
+    // Read the string table.
+    uint32_t stringCount = reader.readValue<uint32_t>();
+    const char* offsetData = reader.readBytes(((size_t) stringCount + 1) * sizeof(uint32_t));
+    uint32_t stringDataSize;
+    std::memcpy(&stringDataSize, offsetData + (size_t) stringCount * sizeof(uint32_t), sizeof(uint32_t));
+    const char* stringData = reader.readBytes(stringDataSize);
+    reader.alignTo(4);
+    StringVec strings;
+    strings.reserve(stringCount);
+    for (uint32_t i = 0; i < stringCount; i++)
+    {
+        uint32_t range[2];
+        std::memcpy(range, offsetData + (size_t) i * sizeof(uint32_t), sizeof(range));
+        if (range[0] > range[1] || range[1] > stringDataSize)
+        {
+            throw ExceptionParseError("Invalid string table in binary snapshot");
+        }
+        strings.emplace_back(stringData + range[0], range[1] - range[0]);
+    }
+
+    // Read the element and attribute tables.
+    uint32_t elementCount = reader.readValue<uint32_t>();
+    vector<ElementRecord> elements(elementCount);
+    if (elementCount)
+    {
+        std::memcpy(elements.data(), reader.readBytes((size_t) elementCount * sizeof(ElementRecord)), (size_t) elementCount * sizeof(ElementRecord));
+    }
+    uint32_t attributeCount = reader.readValue<uint32_t>();
+    vector<uint32_t> attributes((size_t) attributeCount * 2);
+    if (attributeCount)
+    {
+        std::memcpy(attributes.data(), reader.readBytes(attributes.size() * sizeof(uint32_t)), attributes.size() * sizeof(uint32_t));
+    }
+    if (elements.empty())
+    {
+        throw ExceptionParseError("No root element found in binary snapshot");
+    }
+
+    // Validate all table references before modifying the document.
+    for (uint32_t index : attributes)
+    {
+        if (index >= stringCount)
+        {
+            throw ExceptionParseError("Invalid attribute in binary snapshot");
+        }
+    }
+    for (size_t i = 0; i < elements.size(); i++)
+    {
+        const ElementRecord& record = elements[i];
+        if (record.category >= stringCount || record.name >= stringCount || record.sourceUri >= stringCount ||
+            (uint64_t) record.firstAttribute + record.attributeCount > attributeCount ||
+            (uint64_t) record.firstChild + record.childCount > elementCount ||
+            (record.childCount && record.firstChild <= i))
+        {
+            throw ExceptionParseError("Invalid element table in binary snapshot");
+        }
+    }
+
+    // Rebuild the element tree from the flat tables.
+    using RecordStack = vector<std::pair<uint32_t, ElementPtr>>;
+    RecordStack recordStack = { { 0, doc } };
+    while (!recordStack.empty())
+    {
+        const ElementRecord& record = elements[recordStack.back().first];
+        ElementPtr elem = recordStack.back().second;
+        recordStack.pop_back();
+
+        for (uint32_t a = record.firstAttribute; a < record.firstAttribute + record.attributeCount; a++)
+        {
+            elem->setAttribute(strings[attributes[a * 2]], strings[attributes[a * 2 + 1]]);
+        }
+        if (!strings[record.sourceUri].empty())
+        {
+            elem->setSourceUri(strings[record.sourceUri]);
+        }
+
+        for (uint32_t c = record.firstChild; c < record.firstChild + record.childCount; c++)
+        {
+            const ElementRecord& childRecord = elements[c];
+            const string& name = strings[childRecord.name];
+
+            // Skip duplicate elements.
+            if (elem->getChild(name))
+            {
+                continue;
+            }
+
+            ElementPtr child = elem->addChildOfCategory(strings[childRecord.category], name);
+            recordStack.emplace_back(c, child);
+        }
+    }
+}
+
+// Read-only view of a file's contents, memory-mapped where supported.
+class MappedFile
+{
+  public:
+    explicit MappedFile(const FilePath& filename) :
+        _data(nullptr),
+        _size(0),
+        _mapped(false)
+    {
+#if defined(_WIN32)
+        _file = CreateFileA(filename.asString().c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+                            OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+        _mapping = nullptr;
+        if (_file == INVALID_HANDLE_VALUE)
+        {
+            throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+        }
+        LARGE_INTEGER fileSize;
+        if (GetFileSizeEx(_file, &fileSize) && fileSize.QuadPart > 0)
+        {
+            _size = (size_t) fileSize.QuadPart;
+            _mapping = CreateFileMappingA(_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+            if (_mapping)
+            {
+                _data = static_cast<const char*>(MapViewOfFile(_mapping, FILE_MAP_READ, 0, 0, 0));
+                _mapped = (_data != nullptr);
+            }
+        }
+#else
+        _file = open(filename.asString().c_str(), O_RDONLY);
+        if (_file < 0)
+        {
+            throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+        }
+        struct stat sb;
+        if (fstat(_file, &sb) == 0 && sb.st_size > 0)
+        {
+            _size = (size_t) sb.st_size;
+            void* address = mmap(nullptr, _size, PROT_READ, MAP_PRIVATE, _file, 0);
+            if (address != MAP_FAILED)
+            {
+                _data = static_cast<const char*>(address);
+                _mapped = true;
+            }
+        }
+#endif
+
+        // Fall back to reading the file into memory.
+        if (!_mapped && _size)
+        {
+            std::ifstream stream(filename.asString(), std::ios::in | std::ios::binary);
+            _buffer.resize(_size);
+            if (!stream.read(&_buffer[0], (std::streamsize) _size))
+            {
+                close();
+                throw ExceptionFileMissing("Failed to read file: " + filename.asString());
+            }
+            _data = _buffer.data();
+        }
+    }
+
+    ~MappedFile()
+    {
+        close();
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const char* getData() const
+    {
+        return _data;
+    }
+
+    size_t getSize() const
+    {
+        return _size;
+    }
+
+  private:
+    void close()
+    {
+#if defined(_WIN32)
+        if (_mapped)
+        {
+            UnmapViewOfFile(_data);
+        }
+        if (_mapping)
+        {
+            CloseHandle(_mapping);
+            _mapping = nullptr;
+        }
+        if (_file != INVALID_HANDLE_VALUE)
+        {
+            CloseHandle(_file);
+            _file = INVALID_HANDLE_VALUE;
+        }
+#else
+        if (_mapped)
+        {
+            munmap(const_cast<char*>(_data), _size);
+        }
+        if (_file >= 0)
+        {
+            ::close(_file);
+            _file = -1;
+        }
+#endif
+        _mapped = false;
+    }
+
+  private:
+    const char* _data;
+    size_t _size;
+    bool _mapped;
+    string _buffer;
+#if defined(_WIN32)
+    HANDLE _file;
+    HANDLE _mapping;
+#else
+    int _file;
+#endif
+};
+
+} // anonymous namespace
+
+//
+// Writing
+//
+
+void writeToBinaryStream(DocumentPtr doc, std::ostream& stream, uint64_t sourceHash, const StringVec& sourceFiles)
+{
+    string sourceData = serializeSourceFiles(sourceFiles);
+    if (sourceData.size() > std::numeric_limits<uint32_t>::max())
+    {
+        throw Exception("Source file list is too large for a binary snapshot");
+    }
+    string payload = sourceData + serializePayload(doc);
+
+    string header(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+    appendValue(header, BINARY_SNAPSHOT_VERSION);
+    appendValue(header, SNAPSHOT_BYTE_ORDER);
+    appendValue(header, (uint32_t) MATERIALX_VERSION_INDEX);
+    appendValue(header, (uint32_t) sourceData.size());
+    appendValue(header, sourceHash);
+    appendValue(header, (uint64_t) payload.size());
+    appendValue(header, computeChecksum(payload.data(), payload.size()));
+
+    stream.write(header.data(), (std::streamsize) header.size());
+    stream.write(payload.data(), (std::streamsize) payload.size());
+}
+
+void writeToBinaryFile(DocumentPtr doc, const FilePath& filename, uint64_t sourceHash, const StringVec& sourceFiles)
+{
+    std::ofstream ofs(filename.asString(), std::ios::out | std::ios::binary);
+    if (!ofs)
+    {
+        throw ExceptionFileMissing("Failed to open file for writing: " + filename.asString());
+    }
+    writeToBinaryStream(doc, ofs, sourceHash, sourceFiles);
+    ofs.close();
+    if (!ofs)
+    {
+        throw Exception("Failed to write binary snapshot: " + filename.asString());
+    }
+}
+
+//
+// Reading
+//
+
+void readFromBinaryBuffer(DocumentPtr doc, const char* buffer, size_t size)
+{
+    SnapshotHeader header;
+    if (!buffer || !readHeader(buffer, size, header))
+    {
+        throw ExceptionParseError("Invalid binary snapshot header");
+    }
+    if (header.payloadSize != size - SNAPSHOT_HEADER_SIZE)
+    {
+        throw ExceptionParseError("Binary snapshot size does not match its header");
+    }
+    const char* payload = buffer + SNAPSHOT_HEADER_SIZE;
+    if (computeChecksum(payload, (size_t) header.payloadSize) != header.payloadChecksum)
+    {
+        throw ExceptionParseError("Binary snapshot checksum does not match its header");
+    }
+
+    documentFromPayload(doc, payload + header.sourceFilesSize, (size_t) (header.payloadSize - header.sourceFilesSize));
+}
+
+void readFromBinaryFile(DocumentPtr doc, const FilePath& filename)
+{
+    MappedFile file(filename);
+    try
+    {
+        readFromBinaryBuffer(doc, file.getData(), file.getSize());
+    }
+    catch (ExceptionParseError& e)
+    {
+        throw ExceptionParseError(string(e.what()) + " in " + filename.asString());
+    }
+}
+
+uint64_t readBinarySourceHash(const FilePath& filename)
+{
+    std::ifstream stream(filename.asString(), std::ios::in | std::ios::binary);
+    char buffer[SNAPSHOT_HEADER_SIZE];
+    if (!stream.read(buffer, SNAPSHOT_HEADER_SIZE))
+    {
+        return 0;
+    }
+    SnapshotHeader header;
+    return readHeader(buffer, SNAPSHOT_HEADER_SIZE, header) ? header.sourceHash : 0;
+}
+
+StringVec readBinarySourceFiles(const FilePath& filename)
+{
+    std::ifstream stream(filename.asString(), std::ios::in | std::ios::binary);
+    char buffer[SNAPSHOT_HEADER_SIZE];
+    SnapshotHeader header;
+    if (!stream.read(buffer, SNAPSHOT_HEADER_SIZE) || !readHeader(buffer, SNAPSHOT_HEADER_SIZE, header))
+    {
+        return StringVec();
+    }
+
+    // Bound the list by the size of the file before allocating for it.
+    const std::streampos dataStart = stream.tellg();
+    stream.seekg(0, std::ios::end);
+    if (!stream || (uint64_t) (stream.tellg() - dataStart) < header.sourceFilesSize)
+    {
+        return StringVec();
+    }
+    stream.seekg(dataStart);
+    string data(header.sourceFilesSize, '\0');
+    if (!stream.read(&data[0], (std::streamsize) data.size()))
+    {
+        return StringVec();
+    }
+    try
+    {
+        return sourceFilesFromData(data.data(), data.size());
+    }
+    catch (ExceptionParseError&)
+    {
+        return StringVec();
+    }
+}
+
+MATERIALX_NAMESPACE_END
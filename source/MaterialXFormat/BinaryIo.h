@@ -0,0 +1,102 @@
+//
+// Copyright Contributors to the MaterialX Project
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#ifndef MATERIALX_BINARYIO_H
+#define MATERIALX_BINARYIO_H
+
+/// @file
+/// Support for binary document snapshots
+
+#include <MaterialXCore/Library.h>
+
+#include <MaterialXCore/Document.h>
+
+#include <MaterialXFormat/Export.h>
+#include <MaterialXFormat/File.h>
+#include <MaterialXFormat/XmlIo.h>
+
+#include <iosfwd>
+
+MATERIALX_NAMESPACE_BEGIN
+
+extern MX_FORMAT_API const string MTLX_SNAPSHOT_EXTENSION;
+
+/// The version of the binary snapshot format written by this library.
+extern MX_FORMAT_API const uint32_t BINARY_SNAPSHOT_VERSION;
+
+/// @name Binary Snapshots
+/// A binary snapshot is a compact serialization of a fully loaded Document,
+/// intended as a fast cache for data libraries that would otherwise be parsed
+/// from XML in every process.  A snapshot stores an interned string table,
+/// flat element and attribute tables in breadth-first order, an optional list
+/// of the source files from which the document was built, and a header
+/// recording the format version, the MaterialX library version, a
+/// caller-provided source hash, and a checksum of the payload.
+///
+/// Snapshots are a cache format rather than an interchange format: they are
+/// specific to the library version and byte order of the writing process,
+/// and are rejected when either differs.
+/// @{
+
+/// Write a Document as a binary snapshot to the given output stream.
+/// @param doc The Document to be written.
+/// @param stream The output stream to which data is written.
+/// @param sourceHash An optional hash of the source content from which the
+///    document was built, which is stored in the snapshot header and may be
+///    queried with readBinarySourceHash.
+/// @param sourceFiles An optional list of the source files from which the
+///    document was built, which may be queried with readBinarySourceFiles.
+MX_FORMAT_API void writeToBinaryStream(DocumentPtr doc, std::ostream& stream, uint64_t sourceHash = 0,
+                                       const StringVec& sourceFiles = StringVec());
+
+/// Write a Document as a binary snapshot to the given filename.
+/// @param doc The Document to be written.
+/// @param filename The filename to which data is written.
+/// @param sourceHash An optional hash of the source content from which the
+///    document was built.
+/// @param sourceFiles An optional list of the source files from which the
+///    document was built.
+/// @throws ExceptionFileMissing if the file cannot be opened.
+/// @throws Exception if the snapshot cannot be written in full.
+MX_FORMAT_API void writeToBinaryFile(DocumentPtr doc, const FilePath& filename, uint64_t sourceHash = 0,
+                                     const StringVec& sourceFiles = StringVec());
+
+/// Read a Document from a binary snapshot held in the given character buffer.
+/// As with XML read functions, the contents of the snapshot are merged into
+/// the given document, skipping any elements whose names are already present.
+/// @param doc The Document into which data is read.
+/// @param buffer The character buffer from which data is read.
+/// @param size The size of the character buffer in bytes.
+/// @throws ExceptionParseError if the snapshot is invalid, or was written by
+///    a different version of the library.
+MX_FORMAT_API void readFromBinaryBuffer(DocumentPtr doc, const char* buffer, size_t size);
+
+/// Read a Document from a binary snapshot file.  The file is memory-mapped
+/// where supported by the platform, and the element tree is rebuilt directly
+/// from the mapped tables.
+/// @param doc The Document into which data is read.
+/// @param filename The filename from which data is read.
+/// @throws ExceptionParseError if the snapshot is invalid, or was written by
+///    a different version of the library.
+/// @throws ExceptionFileMissing if the file cannot be opened.
+MX_FORMAT_API void readFromBinaryFile(DocumentPtr doc, const FilePath& filename);
+
+/// Return the source hash stored in the header of the given binary snapshot
+/// file, without reading its contents.
+/// @return The stored source hash, or zero if the file is missing or is not
+///    a valid snapshot for this version of the library.
+MX_FORMAT_API uint64_t readBinarySourceHash(const FilePath& filename);
+
+/// Return the list of source files stored in the given binary snapshot file,
+/// without reading its document.
+/// @return The stored source files, or an empty vector if the file is missing
+///    or is not a valid snapshot for this version of the library.
+MX_FORMAT_API StringVec readBinarySourceFiles(const FilePath& filename);
+
+/// @}
+
+MATERIALX_NAMESPACE_END
+
+#endif
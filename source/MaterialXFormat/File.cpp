@@ -179,6 +179,45 @@ bool FilePath::isDirectory() const
 #endif
 }
 
+int64_t FilePath::getModificationTime() const
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(asString().c_str(), GetFileExInfoStandard, &data))
+        return 0;
+    ULARGE_INTEGER time;
+    time.LowPart = data.ftLastWriteTime.dwLowDateTime;
+    time.HighPart = data.ftLastWriteTime.dwHighDateTime;
+
+    // Convert from 100-nanosecond intervals since 1601 to seconds since 1970.
+    const uint64_t EPOCH_DIFFERENCE = 11644473600ULL;
+    return (int64_t) (time.QuadPart / 10000000ULL - EPOCH_DIFFERENCE);
+#else
+    struct stat sb;
+    if (stat(asString().c_str(), &sb))
+        return 0;
+    return (int64_t) sb.st_mtime;
+#endif
+}
+
+uint64_t FilePath::getFileSize() const
+{
+#if defined(_WIN32)
+    WIN32_FILE_ATTRIBUTE_DATA data;
+    if (!GetFileAttributesExA(asString().c_str(), GetFileExInfoStandard, &data))
+        return 0;
+    ULARGE_INTEGER size;
+    size.LowPart = data.nFileSizeLow;
+    size.HighPart = data.nFileSizeHigh;
+    return (uint64_t) size.QuadPart;
+#else
+    struct stat sb;
+    if (stat(asString().c_str(), &sb))
+        return 0;
+    return (uint64_t) sb.st_size;
+#endif
+}
+
 FilePathVec FilePath::getFilesInDirectory(const string& extension) const
 {
     FilePathVec files;
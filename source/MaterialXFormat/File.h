@@ -187,6 +187,14 @@ class MX_FORMAT_API FilePath
     /// Return true if the given path is a directory on the file system.
     bool isDirectory() const;
 
+    /// Return the last modification time of the given path on the file system,
+    /// in seconds since the epoch, or zero if the path does not exist.
+    int64_t getModificationTime() const;
+
+    /// Return the size in bytes of the given file on the file system, or zero
+    /// if the file does not exist.
+    uint64_t getFileSize() const;
+
     /// Return a vector of all files in the given directory with the given extension.
     /// If extension is empty all files are returned.
     FilePathVec getFilesInDirectory(const string& extension = EMPTY_STRING) const;
@@ -5,8 +5,15 @@
 
 #include <MaterialXFormat/Util.h>
 
+#include <MaterialXFormat/BinaryIo.h>
+
+#include <cstdio>
+#include <exception>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <mutex>
+#include <random>
 #include <sstream>
 
 #if defined(__APPLE__) && defined(BUILD_APPLE_FRAMEWORK)
@@ -84,37 +91,27 @@ void loadLibrary(const FilePath& file, DocumentPtr doc, const FileSearchPath& se
     doc->importLibrary(libDoc);
 }
 
-StringSet loadLibraries(const FilePathVec& libraryFolders,
-                        const FileSearchPath& searchPath,
-                        DocumentPtr doc,
-                        const StringSet& excludeFiles,
-                        const XmlReadOptions* readOptions)
+namespace
+{
+
+// Gather the MaterialX files within the given library folders, in load order.
+FilePathVec getLibraryFiles(const FilePathVec& libraryFolders,
+                            const FileSearchPath& searchPath,
+                            const StringSet& excludeFiles,
+                            StringSet& loadedLibraries)
 {
     // Append environment path to the specified search path.
     FileSearchPath librarySearchPath = searchPath;
     librarySearchPath.append(getEnvironmentPath());
 
-    StringSet loadedLibraries;
+    // Gather the library folders to be scanned.
+    FilePathVec libraryPaths;
     if (libraryFolders.empty())
     {
         // No libraries specified so scan in all search paths
         for (const FilePath& libraryPath : librarySearchPath)
         {
-            for (const FilePath& path : libraryPath.getSubDirectories())
-            {
-                for (const FilePath& filename : path.getFilesInDirectory(MTLX_EXTENSION))
-                {
-                    if (!excludeFiles.count(filename))
-                    {
-                        const FilePath& file = path / filename;
-                        if (loadedLibraries.count(file) == 0)
-                        {
-                            loadLibrary(file, doc, searchPath, readOptions);
-                            loadedLibraries.insert(file.asString());
-                        }
-                    }
-                }
-            }
+            libraryPaths.push_back(libraryPath);
         }
     }
     else
@@ -122,24 +119,203 @@ StringSet loadLibraries(const FilePathVec& libraryFolders,
         // Look for specific library folders in the search paths
         for (const FilePath& libraryName : libraryFolders)
         {
-            FilePath libraryPath = librarySearchPath.find(libraryName);
-            for (const FilePath& path : libraryPath.getSubDirectories())
+            libraryPaths.push_back(librarySearchPath.find(libraryName));
+        }
+    }
+
+    // Gather library files in load order.
+    FilePathVec libraryFiles;
+    for (const FilePath& libraryPath : libraryPaths)
+    {
+        for (const FilePath& path : libraryPath.getSubDirectories())
+        {
+            for (const FilePath& filename : path.getFilesInDirectory(MTLX_EXTENSION))
             {
-                for (const FilePath& filename : path.getFilesInDirectory(MTLX_EXTENSION))
+                if (!excludeFiles.count(filename))
                 {
-                    if (!excludeFiles.count(filename))
+                    const FilePath& file = path / filename;
+                    if (loadedLibraries.count(file) == 0)
                     {
-                        const FilePath& file = path / filename;
-                        if (loadedLibraries.count(file) == 0)
-                        {
-                            loadLibrary(file, doc, searchPath, readOptions);
-                            loadedLibraries.insert(file.asString());
-                        }
+                        libraryFiles.push_back(file);
+                        loadedLibraries.insert(file.asString());
                     }
                 }
             }
         }
     }
+
+    return libraryFiles;
+}
+
+} // anonymous namespace
+
+StringSet loadLibraries(const FilePathVec& libraryFolders,
+                        const FileSearchPath& searchPath,
+                        DocumentPtr doc,
+                        const StringSet& excludeFiles,
+                        const XmlReadOptions* readOptions,
+                        unsigned int threadCount)
+{
+    StringSet loadedLibraries;
+    FilePathVec libraryFiles = getLibraryFiles(libraryFolders, searchPath, excludeFiles, loadedLibraries);
+
+    if (threadCount == 1)
+    {
+        for (const FilePath& file : libraryFiles)
+        {
+            loadLibrary(file, doc, searchPath, readOptions);
+        }
+        return loadedLibraries;
+    }
+
+    // Parse library files concurrently into separate documents.
+    vector<DocumentPtr> libraryDocs(libraryFiles.size());
+    vector<std::exception_ptr> libraryErrors(libraryFiles.size());
+    parallelFor(libraryFiles.size(), threadCount, [&](size_t i)
+    {
+        try
+        {
+            DocumentPtr libDoc = createDocument();
+            readFromXmlFile(libDoc, libraryFiles[i], searchPath, readOptions);
+            libraryDocs[i] = libDoc;
+        }
+        catch (...)
+        {
+            libraryErrors[i] = std::current_exception();
+        }
+    });
+
+    // Import library documents in their original order, reporting the first
+    // error at the point where a serial load would have encountered it.
+    for (size_t i = 0; i < libraryFiles.size(); i++)
+    {
+        if (libraryErrors[i])
+        {
+            std::rethrow_exception(libraryErrors[i]);
+        }
+        doc->importLibrary(libraryDocs[i]);
+    }
+
+    return loadedLibraries;
+}
+
+StringSet loadCachedLibraries(const FilePathVec& libraryFolders,
+                              const FileSearchPath& searchPath,
+                              DocumentPtr doc,
+                              const FilePath& snapshotFile,
+                              const StringSet& excludeFiles,
+                              const XmlReadOptions* readOptions,
+                              unsigned int threadCount)
+{
+    StringSet loadedLibraries;
+    FilePathVec libraryFiles = getLibraryFiles(libraryFolders, searchPath, excludeFiles, loadedLibraries);
+    XmlReadOptions cacheReadOptions = readOptions ? *readOptions : XmlReadOptions();
+
+    // Hash the options that affect how the files are read, along with the
+    // path and content of each library file.
+    uint64_t sourceHash = stableHashString(STABLE_HASH_BASIS, searchPath.asString());
+    sourceHash = stableHashInteger(sourceHash, cacheReadOptions.readComments);
+    sourceHash = stableHashInteger(sourceHash, cacheReadOptions.readNewlines);
+    sourceHash = stableHashInteger(sourceHash, cacheReadOptions.upgradeVersion);
+    sourceHash = stableHashInteger(sourceHash, (bool) cacheReadOptions.readXIncludeFunction);
+    auto hashFile = [](uint64_t hash, const FilePath& file)
+    {
+        hash = stableHashString(hash, file.asString());
+        hash = stableHashInteger(hash, file.exists());
+        return stableHashString(hash, readFile(file));
+    };
+    for (const FilePath& file : libraryFiles)
+    {
+        sourceHash = hashFile(sourceHash, file);
+    }
+
+    // Complete the hash with the path and content hash of each XIncluded
+    // file, ordered by path.
+    using IncludeHashMap = std::map<string, uint64_t>;
+    auto getSnapshotHash = [sourceHash](const IncludeHashMap& includeHashes)
+    {
+        uint64_t hash = stableHashInteger(sourceHash, includeHashes.size());
+        for (const auto& pair : includeHashes)
+        {
+            hash = stableHashString(hash, pair.first);
+            hash = stableHashInteger(hash, pair.second);
+        }
+        return hash ? hash : 1;
+    };
+
+    // Read the libraries from the snapshot if its hash matches the current
+    // content of the files from which it was built.
+    IncludeHashMap includeHashes;
+    for (const string& file : readBinarySourceFiles(snapshotFile))
+    {
+        includeHashes[file] = hashFile(STABLE_HASH_BASIS, file);
+    }
+    DocumentPtr libDoc = createDocument();
+    if (readBinarySourceHash(snapshotFile) == getSnapshotHash(includeHashes))
+    {
+        try
+        {
+            readFromBinaryFile(libDoc, snapshotFile);
+            doc->importLibrary(libDoc);
+            return loadedLibraries;
+        }
+        catch (Exception&)
+        {
+            // Fall back to loading the source files.
+            libDoc = createDocument();
+        }
+    }
+
+    // Load the libraries from their source files, recording the path and
+    // content hash of each XIncluded file before it is read.
+    includeHashes.clear();
+    std::mutex includeMutex;
+    XmlReadFunction readXInclude = cacheReadOptions.readXIncludeFunction;
+    if (readXInclude)
+    {
+        cacheReadOptions.readXIncludeFunction = [&](DocumentPtr includeDoc, const FilePath& filename,
+                                                    const FileSearchPath& includeSearchPath, const XmlReadOptions* options)
+        {
+            FileSearchPath resolvePath = includeSearchPath;
+            resolvePath.append(getEnvironmentPath());
+            FilePath resolvedFile = resolvePath.find(filename);
+            uint64_t fileHash = hashFile(STABLE_HASH_BASIS, resolvedFile);
+            {
+                std::lock_guard<std::mutex> lock(includeMutex);
+                includeHashes[resolvedFile.asString()] = fileHash;
+            }
+            readXInclude(includeDoc, filename, includeSearchPath, options);
+        };
+    }
+    loadLibraries(libraryFolders, searchPath, libDoc, excludeFiles, &cacheReadOptions, threadCount);
+    StringVec includeFiles;
+    for (const auto& pair : includeHashes)
+    {
+        includeFiles.push_back(pair.first);
+    }
+
+    // Write a new snapshot, renaming it into place so that concurrent readers
+    // never observe a partially written file.
+    FilePath tempFile = snapshotFile.asString() + "." + std::to_string(std::random_device{}()) + ".tmp";
+    try
+    {
+        writeToBinaryFile(libDoc, tempFile, getSnapshotHash(includeHashes), includeFiles);
+    }
+    catch (Exception&)
+    {
+        std::remove(tempFile.asString().c_str());
+        throw;
+    }
+    if (std::rename(tempFile.asString().c_str(), snapshotFile.asString().c_str()) != 0)
+    {
+        std::remove(snapshotFile.asString().c_str());
+        if (std::rename(tempFile.asString().c_str(), snapshotFile.asString().c_str()) != 0)
+        {
+            std::remove(tempFile.asString().c_str());
+        }
+    }
+
+    doc->importLibrary(libDoc);
     return loadedLibraries;
 }
 
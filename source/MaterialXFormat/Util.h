@@ -44,11 +44,51 @@ MX_FORMAT_API void loadLibrary(const FilePath& file,
 
 /// Load all MaterialX files within the given library folders into a document,
 /// using the given search path to locate the folders on the file system.
+/// @param libraryFolders The library folders to load.  If empty, then all
+///    folders within the search path are scanned.
+/// @param searchPath The search path used to locate library folders.
+/// @param doc The document into which libraries are imported.
+/// @param excludeFiles An optional set of filenames to skip.
+/// @param readOptions An optional pointer to an XmlReadOptions object.
+/// @param threadCount The number of threads used to parse library files.
+///    Files are parsed concurrently into separate library documents, and are
+///    then imported into the given document in the same order as a serial load,
+///    producing identical results.  A value of zero selects the number of
+///    hardware threads.  Defaults to one, which loads files serially.  When
+///    multiple threads are used, any custom XInclude read function provided
+///    in the read options must be safe to call concurrently.
+/// @return The set of library files that were loaded.
 MX_FORMAT_API StringSet loadLibraries(const FilePathVec& libraryFolders,
                                       const FileSearchPath& searchPath,
                                       DocumentPtr doc,
                                       const StringSet& excludeFiles = StringSet(),
-                                      const XmlReadOptions* readOptions = nullptr);
+                                      const XmlReadOptions* readOptions = nullptr,
+                                      unsigned int threadCount = 1);
+
+/// Load all MaterialX files within the given library folders into a document,
+/// caching the combined libraries as a binary snapshot at the given filename.
+/// If the snapshot exists and was written from the same set of library files
+/// and XIncluded files, with unchanged content, then the libraries are read
+/// from the snapshot without parsing XML.  Otherwise, the libraries are loaded
+/// as in loadLibraries, and the snapshot is rewritten for use by later calls.
+/// @param libraryFolders The library folders to load.  If empty, then all
+///    folders within the search path are scanned.
+/// @param searchPath The search path used to locate library folders.
+/// @param doc The document into which libraries are imported.
+/// @param snapshotFile The filename of the binary snapshot.
+/// @param excludeFiles An optional set of filenames to skip.
+/// @param readOptions An optional pointer to an XmlReadOptions object.
+/// @param threadCount The number of threads used to parse library files
+///    when the snapshot is out of date.
+/// @return The set of library files that were loaded.
+/// @throws Exception if the snapshot cannot be written.
+MX_FORMAT_API StringSet loadCachedLibraries(const FilePathVec& libraryFolders,
+                                            const FileSearchPath& searchPath,
+                                            DocumentPtr doc,
+                                            const FilePath& snapshotFile,
+                                            const StringSet& excludeFiles = StringSet(),
+                                            const XmlReadOptions* readOptions = nullptr,
+                                            unsigned int threadCount = 1);
 
 /// Flatten all filenames in the given document, applying string resolvers at the
 /// scope of each element and removing all fileprefix attributes.
@@ -9,6 +9,8 @@
 
 #include <MaterialXCore/Types.h>
 
+#include <algorithm>
+#include <cstdio>
 #include <cstring>
 #include <fstream>
 #include <sstream>
@@ -49,10 +51,10 @@ void documentToXml(DocumentPtr doc, xml_node& xmlRoot, const XmlWriteOptions* wr
         {
             xmlNode.append_attribute(Element::NAME_ATTRIBUTE.c_str()) = elem->getName().c_str();
         }
-        for (const string& attrName : elem->getAttributeNames())
+        for (const AttributeStore::Attribute& attr : elem->getAttributes())
         {
-            xml_attribute xmlAttr = xmlNode.append_attribute(attrName.c_str());
-            xmlAttr.set_value(elem->getAttribute(attrName).c_str());
+            xml_attribute xmlAttr = xmlNode.append_attribute(attr.first->c_str());
+            xmlAttr.set_value(attr.second.c_str());
         }
 
         // Create child elements and recurse.
@@ -112,154 +114,1228 @@ void documentToXml(DocumentPtr doc, xml_node& xmlRoot, const XmlWriteOptions* wr
     }
 }
 
-void elementFromXml(const xml_node& xmlNode, ElementPtr elem, const XmlReadOptions* readOptions, int depth = 1)
+const size_t XML_STREAM_CHUNK_SIZE = 1 << 16;
+const size_t XML_MAX_ENTITY_LENGTH = 12;
+const size_t XML_EVENT_BATCH_SIZE = 1 << 24;
+const size_t XML_PARALLEL_MIN_EVENTS = 1 << 12;
+
+bool isXmlSpace(int c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+// A buffered source of characters for the streaming XML reader, which reads
+// either directly from a character buffer, or in fixed-size chunks from an
+// input stream.
+class XmlSource
 {
-    // Store attributes in element.
-    for (const xml_attribute& xmlAttr : xmlNode.attributes())
+  public:
+    XmlSource(const char* data, size_t size) :
+        _begin(data),
+        _pos(data),
+        _end(data + size),
+        _stream(nullptr),
+        _offset(0)
     {
-        if (xmlAttr.name() != Element::NAME_ATTRIBUTE)
+    }
+
+    explicit XmlSource(std::istream& stream) :
+        _buffer(XML_STREAM_CHUNK_SIZE),
+        _stream(&stream),
+        _offset(0)
+    {
+        _begin = _pos = _end = _buffer.data();
+    }
+
+    // Return the next character without consuming it, or EOF at the end of input.
+    int peek()
+    {
+        return (_pos != _end || fill(1)) ? (unsigned char) *_pos : EOF;
+    }
+
+    // Consume and return the next character, or EOF at the end of input.
+    int get()
+    {
+        int c = peek();
+        if (c != EOF)
         {
-            elem->setAttribute(xmlAttr.name(), xmlAttr.value());
+            _pos++;
         }
+        return c;
     }
 
-    // Create child elements and recurse.
-    for (const xml_node& xmlChild : xmlNode.children())
+    // Consume characters while they satisfy the given predicate, appending
+    // them to the given string if one is provided, and return the first
+    // character that does not, or EOF at the end of input.
+    template <class Predicate> int scan(string* str, Predicate predicate)
     {
-        // Get child category.
-        string category = xmlChild.name();
-        if (category == XINCLUDE_TAG)
+        while (_pos != _end || fill(1))
         {
-            continue;
+            const char* start = _pos;
+            while (_pos != _end && predicate((unsigned char) *_pos))
+            {
+                _pos++;
+            }
+            if (str)
+            {
+                str->append(start, _pos);
+            }
+            if (_pos != _end)
+            {
+                return (unsigned char) *_pos;
+            }
         }
+        return EOF;
+    }
 
-        // Get child name and skip duplicates.
-        string name = xmlChild.attribute(Element::NAME_ATTRIBUTE.c_str()).value();
-        ConstElementPtr previous = elem->getChild(name);
-        if (previous)
+    // Consume the given literal if it is next in the input, returning true
+    // if it was found.
+    bool consume(const char* literal)
+    {
+        size_t length = std::strlen(literal);
+        if ((size_t) (_end - _pos) < length && !fill(length))
+        {
+            return false;
+        }
+        if (std::memcmp(_pos, literal, length) != 0)
         {
-            continue;
+            return false;
         }
+        _pos += length;
+        return true;
+    }
 
-        // Enforce maximum tree depth.
-        if (depth >= MAX_XML_TREE_DEPTH)
+    // Return a pointer to the upcoming characters, making up to the given
+    // number of them available, and returning the available count.
+    const char* lookahead(size_t count, size_t& available)
+    {
+        if ((size_t) (_end - _pos) < count)
         {
-            throw ExceptionParseError("Maximum tree depth exceeded.");
+            fill(count);
+        }
+        available = std::min(count, (size_t) (_end - _pos));
+        return _pos;
+    }
+
+    // Consume the given number of characters, which must be available.
+    void advance(size_t count)
+    {
+        _pos += count;
+    }
+
+    // Return the character offset of the read position in the input.
+    size_t getOffset() const
+    {
+        return _offset + (size_t) (_pos - _begin);
+    }
+
+  private:
+    // Make at least the given number of characters available, returning
+    // false if the end of input is reached first.
+    bool fill(size_t count)
+    {
+        if (!_stream)
+        {
+            return false;
+        }
+
+        // Move any unread characters to the start of the buffer, then read
+        // the next chunk from the stream.
+        size_t remaining = (size_t) (_end - _pos);
+        std::memmove(_buffer.data(), _pos, remaining);
+        _offset += (size_t) (_pos - _begin);
+        _begin = _pos = _buffer.data();
+        _end = _pos + remaining;
+        while (remaining < count && *_stream)
+        {
+            _stream->read(_buffer.data() + remaining, (std::streamsize) (_buffer.size() - remaining));
+            size_t readCount = (size_t) _stream->gcount();
+            if (!readCount)
+            {
+                break;
+            }
+            remaining += readCount;
+            _end += readCount;
+        }
+        if (_stream->bad())
+        {
+            throw ExceptionFileMissing("Failed to read from stream");
+        }
+        return remaining >= count;
+    }
+
+  private:
+    vector<char> _buffer;
+    const char* _begin;
+    const char* _pos;
+    const char* _end;
+    std::istream* _stream;
+    size_t _offset;
+};
+
+using XmlAttributeList = vector<std::pair<string, string>>;
+
+// Return the value of the given attribute in an attribute list.
+const string& getListAttribute(const XmlAttributeList& attrs, size_t attrCount, const string& name)
+{
+    for (size_t i = 0; i < attrCount; i++)
+    {
+        if (attrs[i].first == name)
+        {
+            return attrs[i].second;
+        }
+    }
+    return EMPTY_STRING;
+}
+
+// Builds MaterialX elements from a sequence of XML parse events, tracking
+// the element at each open scope.  Scopes whose content is being skipped
+// are tracked as null elements.
+class XmlElementBuilder
+{
+  public:
+    XmlElementBuilder(const XmlReadOptions* readOptions, size_t baseDepth = 0) :
+        _readOptions(readOptions),
+        _baseDepth(baseDepth),
+        _rootChildCount(0)
+    {
+    }
+
+    // Open a scope for the given element, which may be null.
+    void openScope(ElementPtr elem)
+    {
+        _scopes.push_back(elem);
+    }
+
+    // Return the element at the current scope, or nullptr if content at
+    // this scope is being skipped.
+    ElementPtr getScopeElement() const
+    {
+        return _scopes.empty() ? nullptr : _scopes.back();
+    }
+
+    // Return the depth of the current scope, where the document is at
+    // depth one.
+    size_t getDepth() const
+    {
+        return _baseDepth + _scopes.size();
+    }
+
+    // Return the number of document-level children that have been created.
+    size_t getRootChildCount() const
+    {
+        return _rootChildCount;
+    }
+
+    void removeRootChild(const string& name)
+    {
+        _scopes.front()->removeChild(name);
+        _rootChildCount--;
+    }
+
+    void startElement(const string& category, const XmlAttributeList& attrs, size_t attrCount, bool closed)
+    {
+        ElementPtr elem;
+        if (category != XINCLUDE_TAG)
+        {
+            elem = addChild(category, getListAttribute(attrs, attrCount, Element::NAME_ATTRIBUTE));
+            if (elem)
+            {
+                for (size_t i = 0; i < attrCount; i++)
+                {
+                    if (attrs[i].first != Element::NAME_ATTRIBUTE)
+                    {
+                        elem->setAttribute(attrs[i].first, attrs[i].second);
+                    }
+                }
+            }
+        }
+        if (!closed)
+        {
+            _scopes.push_back(elem);
         }
+    }
 
-        // Create the child element.
-        ElementPtr child = elem->addChildOfCategory(category, name);
-        elementFromXml(xmlChild, child, readOptions, depth + 1);
+    void endElement()
+    {
+        _scopes.pop_back();
+    }
 
-        // Handle the interpretation of XML comments and newlines.
-        if (readOptions && category.empty())
+    // Handle the interpretation of XML comments.
+    void comment(const string& text)
+    {
+        if (_readOptions && _readOptions->readComments)
         {
-            if (readOptions->readComments && xmlChild.type() == node_comment)
+            ElementPtr child = addAnonymousChild();
+            if (child)
             {
-                child = elem->changeChildCategory(child, CommentElement::CATEGORY);
-                child->setDocString(xmlChild.value());
+                child = getScopeElement()->changeChildCategory(child, CommentElement::CATEGORY);
+                child->setDocString(text);
             }
-            else if (readOptions->readNewlines && xmlChild.type() == node_newline)
+        }
+    }
+
+    // Handle the interpretation of XML newlines.
+    void newlines(size_t count)
+    {
+        if (_readOptions && _readOptions->readNewlines)
+        {
+            for (size_t i = 0; i < count; i++)
             {
-                child = elem->changeChildCategory(child, NewlineElement::CATEGORY);
+                ElementPtr child = addAnonymousChild();
+                if (child)
+                {
+                    getScopeElement()->changeChildCategory(child, NewlineElement::CATEGORY);
+                }
             }
         }
     }
-}
 
-void documentFromXml(DocumentPtr doc, const xml_document& xmlDoc, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
+    // Character data has no MaterialX equivalent, and is represented as a
+    // child with an empty category.
+    void text()
+    {
+        addAnonymousChild();
+    }
+
+  private:
+    // Create a child of the element at the current scope, skipping children
+    // whose names are already present.
+    ElementPtr addChild(const string& category, const string& name)
+    {
+        ElementPtr parent = getScopeElement();
+        if (!parent || parent->getChild(name))
+        {
+            return nullptr;
+        }
+
+        // Enforce maximum tree depth.
+        size_t depth = getDepth();
+        if (depth >= (size_t) MAX_XML_TREE_DEPTH)
+        {
+            throw ExceptionParseError("Maximum tree depth exceeded.");
+        }
+
+        ElementPtr child = parent->addChildOfCategory(category, name);
+        if (depth == 1)
+        {
+            _rootChildCount++;
+        }
+        return child;
+    }
+
+    ElementPtr addAnonymousChild()
+    {
+        return addChild(EMPTY_STRING, EMPTY_STRING);
+    }
+
+  private:
+    const XmlReadOptions* _readOptions;
+    size_t _baseDepth;
+    vector<ElementPtr> _scopes;
+    size_t _rootChildCount;
+};
+
+// A batch of parse events for document-level XML content, recorded so that
+// document-level subtrees can be constructed in parallel.  Each record in
+// the batch holds a single document-level element and its descendants, or
+// a single document-level comment, newline, or text event.
+class XmlEventBatch
 {
-    xml_node xmlRoot = xmlDoc.child(Document::CATEGORY.c_str());
-    if (!xmlRoot)
+  public:
+    enum class EventType
     {
-        throw ExceptionParseError("No root MaterialX element found.");
+        StartTag,
+        ClosedTag,
+        EndTag,
+        Comment,
+        Newlines,
+        Text
+    };
+
+    struct Event
+    {
+        EventType type;
+        size_t count;
+        size_t offset;
+        size_t length;
+    };
+
+  public:
+    void beginRecord()
+    {
+        _recordStarts.push_back(_events.size());
     }
 
-    // Process XInclude directives.
-    XmlReadFunction readXIncludeFunction = readOptions ? readOptions->readXIncludeFunction : readFromXmlFile;
-    if (readXIncludeFunction)
+    void addTag(const string& category, const XmlAttributeList& attrs, size_t attrCount, bool closed)
     {
-        for (const xml_node& xmlChild : xmlRoot.children())
+        _events.push_back({ closed ? EventType::ClosedTag : EventType::StartTag, attrCount, _chars.size(), category.size() });
+        _chars += category;
+        for (size_t i = 0; i < attrCount; i++)
         {
-            if (xmlChild.name() == XINCLUDE_TAG)
+            addString(attrs[i].first);
+            addString(attrs[i].second);
+        }
+    }
+
+    void addEvent(EventType type, size_t count = 0, const string& text = EMPTY_STRING)
+    {
+        _events.push_back({ type, count, _chars.size(), text.size() });
+        _chars += text;
+    }
+
+    size_t getRecordCount() const
+    {
+        return _recordStarts.size();
+    }
+
+    size_t getRecordStart(size_t index) const
+    {
+        return _recordStarts[index];
+    }
+
+    size_t getRecordEnd(size_t index) const
+    {
+        return (index + 1 < _recordStarts.size()) ? _recordStarts[index + 1] : _events.size();
+    }
+
+    const Event& getEvent(size_t index) const
+    {
+        return _events[index];
+    }
+
+    // Return the number of events in the batch.
+    size_t getEventCount() const
+    {
+        return _events.size();
+    }
+
+    // Return the approximate memory footprint of the batch in bytes.
+    size_t getSize() const
+    {
+        return _chars.size() + _events.size() * sizeof(Event);
+    }
+
+    // Read the string with the given offset and length into a string.
+    void getString(size_t offset, size_t length, string& str) const
+    {
+        str.assign(_chars, offset, length);
+    }
+
+    // Read the category and attributes of the tag event at the given index.
+    void getTag(size_t index, string& category, XmlAttributeList& attrs) const
+    {
+        const Event& event = _events[index];
+        getString(event.offset, event.length, category);
+        if (attrs.size() < event.count)
+        {
+            attrs.resize(event.count);
+        }
+        size_t offset = event.offset + event.length;
+        for (size_t i = 0; i < event.count; i++)
+        {
+            offset = readString(offset, attrs[i].first);
+            offset = readString(offset, attrs[i].second);
+        }
+    }
+
+    // Replay the events in the given range into an element builder.
+    void replay(XmlElementBuilder& builder, size_t begin, size_t end) const
+    {
+        string category;
+        XmlAttributeList attrs;
+        for (size_t i = begin; i < end; i++)
+        {
+            const Event& event = _events[i];
+            switch (event.type)
             {
-                string filename = xmlChild.attribute("href").value();
-                const StringVec& parents = readOptions ? readOptions->parentXIncludes : StringVec();
+                case EventType::StartTag:
+                case EventType::ClosedTag:
+                    getTag(i, category, attrs);
+                    builder.startElement(category, attrs, event.count, event.type == EventType::ClosedTag);
+                    break;
+                case EventType::EndTag:
+                    builder.endElement();
+                    break;
+                case EventType::Comment:
+                    getString(event.offset, event.length, category);
+                    builder.comment(category);
+                    break;
+                case EventType::Newlines:
+                    builder.newlines(event.count);
+                    break;
+                case EventType::Text:
+                    builder.text();
+                    break;
+            }
+        }
+    }
 
-                // Validate XInclude state.
-                if (std::find(parents.begin(), parents.end(), filename) != parents.end())
+    void clear()
+    {
+        _chars.clear();
+        _events.clear();
+        _recordStarts.clear();
+    }
+
+  private:
+    // Strings following a tag are stored with a length prefix.
+    void addString(const string& str)
+    {
+        size_t length = str.size();
+        _chars.append(reinterpret_cast<const char*>(&length), sizeof(length));
+        _chars += str;
+    }
+
+    size_t readString(size_t offset, string& str) const
+    {
+        size_t length;
+        std::memcpy(&length, _chars.data() + offset, sizeof(length));
+        offset += sizeof(length);
+        str.assign(_chars, offset, length);
+        return offset + length;
+    }
+
+  private:
+    string _chars;
+    vector<Event> _events;
+    vector<size_t> _recordStarts;
+};
+
+// A streaming XML reader, which tokenizes its source in a single pass and
+// builds MaterialX elements directly, without constructing an intermediate
+// XML tree.
+//
+// When multiple threads are requested, document-level subtrees are recorded
+// in bounded batches, and each batch is constructed in parallel, with the
+// document-level elements themselves created in document order.
+class XmlStreamReader
+{
+  public:
+    XmlStreamReader(XmlSource& source, DocumentPtr doc, const FileSearchPath& searchPath,
+                    const XmlReadOptions* readOptions, const FilePath& filename) :
+        _source(source),
+        _doc(doc),
+        _searchPath(searchPath),
+        _readOptions(readOptions),
+        _filename(filename),
+        _builder(readOptions),
+        _depth(0),
+        _attrCount(0),
+        _batching(readOptions && readOptions->threadCount != 1),
+        _recording(false),
+        _foundElement(false),
+        _foundRoot(false),
+        _includePosition(0)
+    {
+    }
+
+    void read()
+    {
+        // Elements are built as they are read, so if an error is encountered,
+        // then the document is restored to its state before the read.
+        const size_t previousCount = _doc->getChildren().size();
+        StringMap previousAttributes;
+        for (const string& attr : _doc->getAttributeNames())
+        {
+            previousAttributes[attr] = _doc->getAttribute(attr);
+        }
+        try
+        {
+            parse();
+        }
+        catch (...)
+        {
+            ElementVec children = _doc->getChildren();
+            for (size_t i = previousCount; i < children.size(); i++)
+            {
+                _doc->removeChild(children[i]->getName());
+            }
+            for (const string& attr : _doc->getAttributeNames())
+            {
+                if (!previousAttributes.count(attr))
+                {
+                    _doc->removeAttribute(attr);
+                }
+            }
+            for (const auto& pair : previousAttributes)
+            {
+                _doc->setAttribute(pair.first, pair.second);
+            }
+            throw;
+        }
+
+        // Upgrade version if requested.
+        if (!_readOptions || _readOptions->upgradeVersion)
+        {
+            _doc->upgradeVersion();
+        }
+    }
+
+  private:
+    void parse()
+    {
+        // Skip any UTF-8 byte order mark.
+        _source.consume("\xEF\xBB\xBF");
+
+        while (true)
+        {
+            int c = _source.peek();
+            if (c == EOF)
+            {
+                break;
+            }
+            if (c != '<')
+            {
+                readText();
+                continue;
+            }
+
+            _source.get();
+            c = _source.peek();
+            if (c == '?')
+            {
+                skipUntil("?>", "Error parsing document declaration/processing instruction");
+            }
+            else if (c == '!')
+            {
+                if (_source.consume("!--"))
+                {
+                    readComment();
+                }
+                else if (_source.consume("![CDATA["))
+                {
+                    skipUntil("]]>", "Error parsing CDATA section");
+                    handleText();
+                }
+                else if (_source.consume("!DOCTYPE"))
+                {
+                    skipDoctype();
+                }
+                else
                 {
-                    throw ExceptionParseError("XInclude cycle detected.");
+                    throwParseError("Could not determine tag type");
                 }
-                if (parents.size() >= MAX_XINCLUDE_DEPTH)
+            }
+            else if (c == '/')
+            {
+                _source.get();
+                readEndTag();
+            }
+            else
+            {
+                readStartTag();
+            }
+        }
+
+        if (_depth > 0)
+        {
+            throwParseError("Start-end tags mismatch");
+        }
+        if (!_foundElement)
+        {
+            throwParseError("No document element found");
+        }
+        if (!_foundRoot)
+        {
+            throw ExceptionParseError("No root MaterialX element found.");
+        }
+    }
+
+    void throwParseError(const string& desc) const
+    {
+        throwParseError(desc, _source.getOffset());
+    }
+
+    void throwParseError(const string& desc, size_t offset) const
+    {
+        string message = "XML parse error";
+        if (!_filename.isEmpty())
+        {
+            message += " in " + _filename.asString();
+        }
+        message += " (" + desc + " at character " + std::to_string(offset) + ")";
+        throw ExceptionParseError(message);
+    }
+
+    // Return true if document-level content at the current scope should be
+    // recorded as a new record in the event batch.
+    bool isBatchedScope() const
+    {
+        return _batching && _depth == 1 && _builder.getDepth() == 1 && _builder.getScopeElement();
+    }
+
+    // Handle a non-element event, either recording it in the current batch
+    // or passing it to the element builder.
+    void handleEvent(XmlEventBatch::EventType type, size_t count = 0, const string& text = EMPTY_STRING)
+    {
+        if (_recording)
+        {
+            _batch.addEvent(type, count, text);
+        }
+        else if (isBatchedScope())
+        {
+            _batch.beginRecord();
+            _batch.addEvent(type, count, text);
+        }
+        else if (type == XmlEventBatch::EventType::Comment)
+        {
+            _builder.comment(text);
+        }
+        else if (type == XmlEventBatch::EventType::Newlines)
+        {
+            _builder.newlines(count);
+        }
+        else
+        {
+            _builder.text();
+        }
+    }
+
+    void handleText()
+    {
+        if (_recording || _builder.getScopeElement())
+        {
+            handleEvent(XmlEventBatch::EventType::Text);
+        }
+    }
+
+    void readText()
+    {
+        size_t lineCount = 0;
+        int c = _source.scan(nullptr, [&lineCount](int ch)
+        {
+            lineCount += (ch == '\n');
+            return isXmlSpace(ch);
+        });
+        if (lineCount > 1 && _readOptions && _readOptions->readNewlines &&
+            (_recording || _builder.getScopeElement()))
+        {
+            handleEvent(XmlEventBatch::EventType::Newlines, lineCount - 1);
+        }
+
+        // Skip character data, which has no MaterialX equivalent.
+        if (c == EOF || c == '<')
+        {
+            return;
+        }
+        _source.scan(nullptr, [](int ch) { return ch != '<'; });
+        handleText();
+    }
+
+    void readComment()
+    {
+        bool storeComment = _readOptions && _readOptions->readComments &&
+                            (_recording || _builder.getScopeElement());
+        _text.clear();
+        while (true)
+        {
+            _source.scan(storeComment ? &_text : nullptr, [](int ch)
+            {
+                return ch != '-' && ch != '\r';
+            });
+            int c = _source.get();
+            if (c == EOF)
+            {
+                throwParseError("Error parsing comment");
+            }
+            if (c == '-' && _source.consume("->"))
+            {
+                break;
+            }
+            if (storeComment)
+            {
+                // Normalize line endings.
+                if (c == '\r')
                 {
-                    throw ExceptionParseError("Maximum XInclude depth exceeded.");
+                    _source.consume("\n");
+                    c = '\n';
                 }
+                _text += (char) c;
+            }
+        }
 
-                // Read the included file into a library document.
-                DocumentPtr library = createDocument();
-                XmlReadOptions xiReadOptions = readOptions ? *readOptions : XmlReadOptions();
-                xiReadOptions.parentXIncludes.push_back(filename);
-                readXIncludeFunction(library, filename, searchPath, &xiReadOptions);
+        if (storeComment)
+        {
+            handleEvent(XmlEventBatch::EventType::Comment, 0, _text);
+        }
+    }
 
-                // Import the library document.
-                doc->importLibrary(library);
+    void skipUntil(const char* terminator, const char* errorDesc)
+    {
+        const char first = terminator[0];
+        const char* rest = terminator + 1;
+        while (true)
+        {
+            _source.scan(nullptr, [first](int ch) { return ch != first; });
+            if (_source.get() == EOF)
+            {
+                throwParseError(errorDesc);
+            }
+            if (_source.consume(rest))
+            {
+                return;
             }
         }
     }
 
-    // Build the element tree.
-    elementFromXml(xmlRoot, doc, readOptions);
+    void skipDoctype()
+    {
+        int bracketDepth = 0;
+        while (true)
+        {
+            int c = _source.get();
+            if (c == EOF)
+            {
+                throwParseError("Error parsing document type declaration");
+            }
+            if (c == '"' || c == '\'')
+            {
+                int quote = c;
+                while ((c = _source.get()) != quote)
+                {
+                    if (c == EOF)
+                    {
+                        throwParseError("Error parsing document type declaration");
+                    }
+                }
+            }
+            else if (c == '[')
+            {
+                bracketDepth++;
+            }
+            else if (c == ']')
+            {
+                bracketDepth--;
+            }
+            else if (c == '>' && bracketDepth <= 0)
+            {
+                return;
+            }
+        }
+    }
 
-    // Upgrade version if requested.
-    if (!readOptions || readOptions->upgradeVersion)
+    void readName(string& name)
     {
-        doc->upgradeVersion();
+        name.clear();
+        _source.scan(&name, [](int ch)
+        {
+            return !isXmlSpace(ch) && ch != '/' && ch != '>' && ch != '=' && ch != '<';
+        });
     }
-}
 
-void validateParseResult(const xml_parse_result& result, const FilePath& filename = FilePath())
-{
-    if (result)
+    void skipSpace()
     {
-        return;
+        _source.scan(nullptr, isXmlSpace);
     }
 
-    if (result.status == xml_parse_status::status_file_not_found ||
-        result.status == xml_parse_status::status_io_error ||
-        result.status == xml_parse_status::status_out_of_memory)
+    // Decode a character or entity reference following an ampersand,
+    // appending it to the given string.  Unrecognized references are
+    // appended verbatim.
+    void readReference(string& value)
     {
-        throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+        static const std::pair<const char*, char> ENTITIES[] = {
+            { "lt;", '<' }, { "gt;", '>' }, { "amp;", '&' }, { "apos;", '\'' }, { "quot;", '"' }
+        };
+        for (const auto& entity : ENTITIES)
+        {
+            if (_source.consume(entity.first))
+            {
+                value += entity.second;
+                return;
+            }
+        }
+
+        size_t available = 0;
+        const char* data = _source.lookahead(XML_MAX_ENTITY_LENGTH, available);
+        if (available < 3 || data[0] != '#')
+        {
+            value += '&';
+            return;
+        }
+        bool hex = (data[1] == 'x');
+        size_t i = hex ? 2 : 1;
+        unsigned long code = 0;
+        size_t digitStart = i;
+        for (; i < available && data[i] != ';'; i++)
+        {
+            int digit = -1;
+            char c = data[i];
+            if (c >= '0' && c <= '9')
+                digit = c - '0';
+            else if (hex && c >= 'a' && c <= 'f')
+                digit = c - 'a' + 10;
+            else if (hex && c >= 'A' && c <= 'F')
+                digit = c - 'A' + 10;
+            if (digit < 0)
+            {
+                break;
+            }
+            code = code * (hex ? 16 : 10) + (unsigned long) digit;
+        }
+        if (i == digitStart || i == available || data[i] != ';' || code > 0x10FFFF)
+        {
+            value += '&';
+            return;
+        }
+        _source.advance(i + 1);
+
+        // Encode the code point as UTF-8.
+        if (code < 0x80)
+        {
+            value += (char) code;
+        }
+        else if (code < 0x800)
+        {
+            value += (char) (0xC0 | (code >> 6));
+            value += (char) (0x80 | (code & 0x3F));
+        }
+        else if (code < 0x10000)
+        {
+            value += (char) (0xE0 | (code >> 12));
+            value += (char) (0x80 | ((code >> 6) & 0x3F));
+            value += (char) (0x80 | (code & 0x3F));
+        }
+        else
+        {
+            value += (char) (0xF0 | (code >> 18));
+            value += (char) (0x80 | ((code >> 12) & 0x3F));
+            value += (char) (0x80 | ((code >> 6) & 0x3F));
+            value += (char) (0x80 | (code & 0x3F));
+        }
     }
 
-    string desc = result.description();
-    string offset = std::to_string(result.offset);
-    string message = "XML parse error";
-    if (!filename.isEmpty())
+    void readAttributeValue(string& value)
     {
-        message += " in " + filename.asString();
+        value.clear();
+        if (_source.peek() != '"' && _source.peek() != '\'')
+        {
+            throwParseError("Error parsing element attribute");
+        }
+        int quote = _source.get();
+        while (true)
+        {
+            _source.scan(&value, [quote](int ch)
+            {
+                return ch != quote && ch != '&' && !isXmlSpace(ch);
+            });
+            int c = _source.get();
+            if (c == EOF)
+            {
+                throwParseError("Error parsing element attribute");
+            }
+            if (c == quote)
+            {
+                return;
+            }
+            if (c == '&')
+            {
+                readReference(value);
+            }
+            else
+            {
+                // Convert whitespace characters to spaces, treating CRLF
+                // sequences as a single character.
+                if (c == '\r')
+                {
+                    _source.consume("\n");
+                }
+                value += ' ';
+            }
+        }
     }
-    message += " (" + desc + " at character " + offset + ")";
 
-    throw ExceptionParseError(message);
-}
+    void readStartTag()
+    {
+        readName(_tagName);
+        if (_tagName.empty())
+        {
+            throwParseError("Error parsing start element tag");
+        }
 
-unsigned int getParseOptions(const XmlReadOptions* readOptions)
-{
-    unsigned int parseOptions = parse_default;
-    if (readOptions)
+        // Read attributes, reusing storage from previous tags.
+        _attrCount = 0;
+        bool closed = false;
+        while (true)
+        {
+            skipSpace();
+            int c = _source.peek();
+            if (c == '>')
+            {
+                _source.get();
+                break;
+            }
+            if (c == '/')
+            {
+                if (!_source.consume("/>"))
+                {
+                    throwParseError("Error parsing start element tag");
+                }
+                closed = true;
+                break;
+            }
+            if (c == EOF)
+            {
+                throwParseError("Error parsing start element tag");
+            }
+
+            if (_attrCount == _attributes.size())
+            {
+                _attributes.emplace_back();
+            }
+            std::pair<string, string>& attr = _attributes[_attrCount++];
+            readName(attr.first);
+            skipSpace();
+            if (attr.first.empty() || _source.get() != '=')
+            {
+                throwParseError("Error parsing element attribute");
+            }
+            skipSpace();
+            readAttributeValue(attr.second);
+        }
+
+        if (_recording)
+        {
+            _batch.addTag(_tagName, _attributes, _attrCount, closed);
+        }
+        else if (!_depth)
+        {
+            // Read the first MaterialX element at the document level into
+            // the document itself.
+            _foundElement = true;
+            ElementPtr elem;
+            if (!_foundRoot && _tagName == Document::CATEGORY)
+            {
+                _foundRoot = true;
+                for (size_t i = 0; i < _attrCount; i++)
+                {
+                    if (_attributes[i].first != Element::NAME_ATTRIBUTE)
+                    {
+                        _doc->setAttribute(_attributes[i].first, _attributes[i].second);
+                    }
+                }
+                _includePosition = _doc->getChildren().size();
+                elem = _doc;
+            }
+            if (!closed)
+            {
+                _builder.openScope(elem);
+            }
+        }
+        else if (_tagName == XINCLUDE_TAG && isBatchedScope())
+        {
+            flushBatch();
+            readXInclude(getListAttribute(_attributes, _attrCount, "href"));
+            _builder.startElement(_tagName, _attributes, _attrCount, closed);
+        }
+        else if (_tagName == XINCLUDE_TAG && _depth == 1 && _builder.getScopeElement())
+        {
+            readXInclude(getListAttribute(_attributes, _attrCount, "href"));
+            _builder.startElement(_tagName, _attributes, _attrCount, closed);
+        }
+        else if (isBatchedScope())
+        {
+            _batch.beginRecord();
+            _batch.addTag(_tagName, _attributes, _attrCount, closed);
+            _recording = !closed;
+        }
+        else
+        {
+            _builder.startElement(_tagName, _attributes, _attrCount, closed);
+        }
+
+        if (!closed)
+        {
+            if (_depth == _tagStack.size())
+            {
+                _tagStack.emplace_back();
+            }
+            _tagStack[_depth].swap(_tagName);
+            _depth++;
+        }
+
+        // Bound the memory used by batched events.
+        if (_batch.getSize() >= XML_EVENT_BATCH_SIZE)
+        {
+            flushBatch();
+        }
+    }
+
+    void readEndTag()
     {
-        if (readOptions->readComments)
+        size_t offset = _source.getOffset();
+        readName(_tagName);
+        skipSpace();
+        if (_tagName.empty() || _source.get() != '>')
         {
-            parseOptions |= parse_comments;
+            throwParseError("Error parsing end element tag");
         }
-        if (readOptions->readNewlines)
+        if (!_depth || _tagName != _tagStack[_depth - 1])
         {
-            parseOptions |= parse_newlines;
+            throwParseError("Start-end tags mismatch", offset);
+        }
+        _depth--;
+
+        if (_recording)
+        {
+            _batch.addEvent(XmlEventBatch::EventType::EndTag);
+            _recording = (_depth > 1);
+        }
+        else
+        {
+            if (_depth == 0 && _builder.getScopeElement())
+            {
+                flushBatch();
+            }
+            _builder.endElement();
         }
     }
-    return parseOptions;
-}
+
+    // Construct the elements recorded in the current batch.  Document-level
+    // elements are created in document order, and their descendants are then
+    // constructed in parallel.  A record that is still in progress is replayed
+    // into the element builder, and the remainder of its content is then
+    // constructed as it is read.
+    void flushBatch()
+    {
+        size_t recordCount = _batch.getRecordCount();
+        if (!recordCount)
+        {
+            return;
+        }
+        size_t completeCount = _recording ? recordCount - 1 : recordCount;
+
+        string category;
+        XmlAttributeList attrs;
+        vector<std::pair<ElementPtr, size_t>> subtrees;
+        for (size_t i = 0; i < completeCount; i++)
+        {
+            size_t start = _batch.getRecordStart(i);
+            const XmlEventBatch::Event& event = _batch.getEvent(start);
+            if (event.type != XmlEventBatch::EventType::StartTag)
+            {
+                _batch.replay(_builder, start, start + 1);
+                continue;
+            }
+            _batch.getTag(start, category, attrs);
+            _builder.startElement(category, attrs, event.count, false);
+            ElementPtr elem = _builder.getScopeElement();
+            _builder.endElement();
+            if (elem)
+            {
+                subtrees.emplace_back(elem, i);
+            }
+        }
+
+        if (!subtrees.empty())
+        {
+            // Construct subtrees in parallel when the batch holds enough work,
+            // with document cache maintenance deferred until the next lookup.
+            unsigned int threadCount = (_batch.getEventCount() >= XML_PARALLEL_MIN_EVENTS) ? _readOptions->threadCount : 1;
+            if (threadCount != 1)
+            {
+                _doc->invalidateCache();
+            }
+            parallelFor(subtrees.size(), threadCount, [this, &subtrees](size_t i)
+            {
+                XmlElementBuilder builder(_readOptions, 1);
+                builder.openScope(subtrees[i].first);
+                size_t start = _batch.getRecordStart(subtrees[i].second);
+                size_t end = _batch.getRecordEnd(subtrees[i].second);
+                _batch.replay(builder, start + 1, end - 1);
+            });
+        }
+
+        if (_recording)
+        {
+            _batch.replay(_builder, _batch.getRecordStart(completeCount), _batch.getEventCount());
+            _recording = false;
+        }
+        _batch.clear();
+    }
+
+    void readXInclude(const string& filename)
+    {
+        XmlReadFunction readXIncludeFunction = _readOptions ? _readOptions->readXIncludeFunction : readFromXmlFile;
+        if (!readXIncludeFunction)
+        {
+            return;
+        }
+
+        const StringVec& parents = _readOptions ? _readOptions->parentXIncludes : StringVec();
+
+        // Validate XInclude state.
+        if (std::find(parents.begin(), parents.end(), filename) != parents.end())
+        {
+            throw ExceptionParseError("XInclude cycle detected.");
+        }
+        if (parents.size() >= MAX_XINCLUDE_DEPTH)
+        {
+            throw ExceptionParseError("Maximum XInclude depth exceeded.");
+        }
+
+        // Read the included file into a library document.
+        DocumentPtr library = createDocument();
+        XmlReadOptions xiReadOptions = _readOptions ? *_readOptions : XmlReadOptions();
+        xiReadOptions.parentXIncludes.push_back(filename);
+        readXIncludeFunction(library, filename, _searchPath, &xiReadOptions);
+
+        // Included content takes precedence over the content of this file,
+        // and is ordered before it, so an XInclude that follows other
+        // elements displaces any of them with matching names.
+        if (_builder.getRootChildCount())
+        {
+            for (ElementPtr child : library->getChildren())
+            {
+                const string childName = child->getQualifiedName(child->getName());
+                if (_doc->getChild(childName) && _doc->getChildIndex(childName) >= (int) _includePosition)
+                {
+                    _builder.removeRootChild(childName);
+                }
+            }
+        }
+
+        // Import the library document.
+        size_t previousCount = _doc->getChildren().size();
+        _doc->importLibrary(library);
+        if (_builder.getRootChildCount())
+        {
+            ElementVec children = _doc->getChildren();
+            for (size_t i = previousCount; i < children.size(); i++)
+            {
+                _doc->setChildIndex(children[i]->getName(), (int) _includePosition++);
+            }
+        }
+        else
+        {
+            _includePosition = _doc->getChildren().size();
+        }
+    }
+
+  private:
+    XmlSource& _source;
+    DocumentPtr _doc;
+    const FileSearchPath& _searchPath;
+    const XmlReadOptions* _readOptions;
+    FilePath _filename;
+
+    XmlElementBuilder _builder;
+    XmlEventBatch _batch;
+
+    vector<string> _tagStack;
+    size_t _depth;
+
+    XmlAttributeList _attributes;
+    size_t _attrCount;
+    string _tagName;
+    string _text;
+
+    bool _batching;
+    bool _recording;
+    bool _foundElement;
+    bool _foundRoot;
+    size_t _includePosition;
+};
 
 } // anonymous namespace
 
@@ -271,6 +1347,7 @@ XmlReadOptions::XmlReadOptions() :
     readComments(false),
     readNewlines(false),
     upgradeVersion(true),
+    threadCount(1),
     readXIncludeFunction(readFromXmlFile)
 {
 }
@@ -292,22 +1369,21 @@ void readFromXmlBuffer(DocumentPtr doc, const char* buffer, FileSearchPath searc
 {
     searchPath.append(getEnvironmentPath());
 
-    xml_document xmlDoc;
-    xml_parse_result result = xmlDoc.load_string(buffer, getParseOptions(readOptions));
-    validateParseResult(result);
-
-    documentFromXml(doc, xmlDoc, searchPath, readOptions);
+    XmlSource source(buffer, buffer ? std::strlen(buffer) : 0);
+    XmlStreamReader(source, doc, searchPath, readOptions, FilePath()).read();
 }
 
 void readFromXmlStream(DocumentPtr doc, std::istream& stream, FileSearchPath searchPath, const XmlReadOptions* readOptions)
 {
     searchPath.append(getEnvironmentPath());
 
-    xml_document xmlDoc;
-    xml_parse_result result = xmlDoc.load(stream, getParseOptions(readOptions));
-    validateParseResult(result);
+    if (!stream)
+    {
+        throw ExceptionFileMissing("Failed to open file for reading: ");
+    }
 
-    documentFromXml(doc, xmlDoc, searchPath, readOptions);
+    XmlSource source(stream);
+    XmlStreamReader(source, doc, searchPath, readOptions, FilePath()).read();
 }
 
 void readFromXmlFile(DocumentPtr doc, FilePath filename, FileSearchPath searchPath, const XmlReadOptions* readOptions)
@@ -315,11 +1391,15 @@ void readFromXmlFile(DocumentPtr doc, FilePath filename, FileSearchPath searchPa
     searchPath.append(getEnvironmentPath());
     filename = searchPath.find(filename);
 
-    xml_document xmlDoc;
-    xml_parse_result result = xmlDoc.load_file(filename.asString().c_str(), getParseOptions(readOptions));
-    validateParseResult(result, filename);
+    std::ifstream stream(filename.asString(), std::ios::binary);
+    if (!stream)
+    {
+        throw ExceptionFileMissing("Failed to open file for reading: " + filename.asString());
+    }
 
-    // Store the source URI of the document.
+    // Store the source URI of the document, restoring the previous URI if
+    // the document cannot be read.
+    const string previousUri = doc->getSourceUri();
     FilePath sourcePath = (readOptions && !readOptions->parentXIncludes.empty()) ?
                            FilePath(readOptions->parentXIncludes[0]) :
                            FilePath(filename);
@@ -332,7 +1412,16 @@ void readFromXmlFile(DocumentPtr doc, FilePath filename, FileSearchPath searchPa
     }
     searchPath.prepend(sourcePath.getParentPath());
 
-    documentFromXml(doc, xmlDoc, searchPath, readOptions);
+    XmlSource source(stream);
+    try
+    {
+        XmlStreamReader(source, doc, searchPath, readOptions, filename).read();
+    }
+    catch (...)
+    {
+        doc->setSourceUri(previousUri);
+        throw;
+    }
 }
 
 void readFromXmlString(DocumentPtr doc, const string& str, const FileSearchPath& searchPath, const XmlReadOptions* readOptions)
@@ -49,6 +49,13 @@ class MX_FORMAT_API XmlReadOptions
     /// to the current version.  Defaults to true.
     bool upgradeVersion;
 
+    /// The maximum number of threads used to construct the elements of a
+    /// document.  When more than one thread is used, the subtrees of
+    /// top-level elements are constructed in parallel, and are then attached
+    /// in document order.  A value of zero selects the number of hardware
+    /// threads.  Defaults to one.
+    unsigned int threadCount;
+
     /// If provided, this function will be invoked when an XInclude reference
     /// needs to be read into a document.  Defaults to readFromXmlFile.
     XmlReadFunction readXIncludeFunction;
@@ -92,6 +99,12 @@ class MX_FORMAT_API ExceptionFileMissing : public Exception
 };
 
 /// @name Read Functions
+/// XML documents are read with a streaming parser, which builds elements
+/// directly as their tags are tokenized, and which reads files and streams
+/// in fixed-size chunks rather than loading them into an intermediate XML
+/// tree.  If an error is encountered, then the elements and attributes
+/// read before the error are removed, leaving the document in its state
+/// before the read.
 /// @{
 
 /// Read a Document as XML from the given character buffer.
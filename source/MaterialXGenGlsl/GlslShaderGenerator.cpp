@@ -148,12 +148,12 @@ ShaderPtr GlslShaderGenerator::generate(const string& name, ElementPtr element,
     // Emit code for vertex shader stage
     ShaderStage& vs = shader->getStage(Stage::VERTEX);
     emitVertexStage(shader->getGraph(), context, vs);
-    replaceTokens(_tokenSubstitutions, vs);
+    replaceTokens(context.getTokenSubstitutions(), vs);
 
     // Emit code for pixel shader stage
     ShaderStage& ps = shader->getStage(Stage::PIXEL);
     emitPixelStage(shader->getGraph(), context, ps);
-    replaceTokens(_tokenSubstitutions, ps);
+    replaceTokens(context.getTokenSubstitutions(), ps);
 
     return shader;
 }
@@ -461,11 +461,11 @@ void GlslShaderGenerator::emitPixelStage(const ShaderGraph& graph, GenContext& c
     // depending on the vertical flip flag.
     if (context.getOptions().fileTextureVerticalFlip)
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "mx_transform_uv_vflip.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "mx_transform_uv_vflip.glsl");
     }
     else
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "mx_transform_uv.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "mx_transform_uv.glsl");
     }
 
     emitLightFunctionDefinitions(graph, context, stage);
@@ -32,21 +32,35 @@ class MX_GENHW_API HwLightShaders : public GenUserData
     }
 
     /// Bind a light shader to a light type id.
-    void bind(unsigned int type, ShaderNodePtr shader)
+    /// @param type The light type id.
+    /// @param shader The light shader node.
+    /// @param nodeDef The optional nodedef from which the light shader was
+    ///    created, allowing private instances to be created for other contexts.
+    void bind(unsigned int type, ShaderNodePtr shader, ConstNodeDefPtr nodeDef = nullptr)
     {
         _shaders[type] = shader;
+        if (nodeDef)
+        {
+            _nodeDefs[type] = nodeDef;
+        }
+        else
+        {
+            _nodeDefs.erase(type);
+        }
     }
 
     /// Unbind a light shader previously bound to a light type id.
     void unbind(unsigned int type)
     {
         _shaders.erase(type);
+        _nodeDefs.erase(type);
     }
 
     /// Clear all light shaders previously bound.
     void clear()
     {
         _shaders.clear();
+        _nodeDefs.clear();
     }
 
     /// Return the light shader bound to the given light type,
@@ -63,8 +77,17 @@ class MX_GENHW_API HwLightShaders : public GenUserData
         return _shaders;
     }
 
+    /// Return the nodedef from which the light shader bound to the given
+    /// light type was created, or nullptr if no nodedef was given.
+    ConstNodeDefPtr getNodeDef(unsigned int type) const
+    {
+        auto it = _nodeDefs.find(type);
+        return it != _nodeDefs.end() ? it->second : nullptr;
+    }
+
   protected:
     std::unordered_map<unsigned int, ShaderNodePtr> _shaders;
+    std::unordered_map<unsigned int, ConstNodeDefPtr> _nodeDefs;
 };
 
 MATERIALX_NAMESPACE_END
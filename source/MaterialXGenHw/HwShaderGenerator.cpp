@@ -20,6 +20,60 @@
 
 MATERIALX_NAMESPACE_BEGIN
 
+namespace
+{
+
+// Return true if the given node graph, or the graph implementation of any
+// node within it, has a filename input that is not bound to its interface.
+bool hasUnboundFilenames(const NodeGraph& nodeGraph, const string& target)
+{
+    for (NodePtr node : nodeGraph.getNodes())
+    {
+        NodeDefPtr nodeDef = node->getNodeDef(target);
+        if (!nodeDef)
+        {
+            continue;
+        }
+        for (InputPtr defInput : nodeDef->getActiveInputs())
+        {
+            if (defInput->getType() == FILENAME_TYPE_STRING)
+            {
+                InputPtr input = node->getInput(defInput->getName());
+                if (!input || !input->hasInterfaceName())
+                {
+                    return true;
+                }
+            }
+        }
+        InterfaceElementPtr implElement = nodeDef->getImplementation(target);
+        if (implElement && implElement->isA<NodeGraph>() && hasUnboundFilenames(*implElement->asA<NodeGraph>(), target))
+        {
+            return true;
+        }
+    }
+    return false;
+}
+
+ShaderNodePtr createLightShader(const NodeDef& nodeDef, GenContext& context)
+{
+    ShaderNodePtr shader = ShaderNode::create(nullptr, nodeDef.getNodeString(), nodeDef, context);
+
+    // Check if this is a graph implementation.
+    // If so prepend the light struct instance name on all input socket variables,
+    // since in generated code these inputs will be members of the light struct.
+    ShaderGraph* graph = shader->getImplementation().getGraph();
+    if (graph)
+    {
+        for (ShaderGraphInputSocket* inputSockets : graph->getInputSockets())
+        {
+            inputSockets->setVariable("light." + inputSockets->getName());
+        }
+    }
+    return shader;
+}
+
+} // anonymous namespace
+
 //
 // HwShaderGenerator methods
 //
@@ -353,21 +407,8 @@ void HwShaderGenerator::bindLightShader(const NodeDef& nodeDef, unsigned int lig
                                       "' has already been bound");
     }
 
-    ShaderNodePtr shader = ShaderNode::create(nullptr, nodeDef.getNodeString(), nodeDef, context);
-
-    // Check if this is a graph implementation.
-    // If so prepend the light struct instance name on all input socket variables,
-    // since in generated code these inputs will be members of the light struct.
-    ShaderGraph* graph = shader->getImplementation().getGraph();
-    if (graph)
-    {
-        for (ShaderGraphInputSocket* inputSockets : graph->getInputSockets())
-        {
-            inputSockets->setVariable("light." + inputSockets->getName());
-        }
-    }
-
-    lightShaders->bind(lightTypeId, shader);
+    ShaderNodePtr shader = createLightShader(nodeDef, context);
+    lightShaders->bind(lightTypeId, shader, nodeDef.getSelf()->asA<NodeDef>());
 }
 
 void HwShaderGenerator::unbindLightShader(unsigned int lightTypeId, GenContext& context)
@@ -388,6 +429,42 @@ void HwShaderGenerator::unbindLightShaders(GenContext& context)
     }
 }
 
+string HwShaderGenerator::getImplementationCacheKey(const InterfaceElement& implElement, const NodeDef& nodedef, GenContext& context) const
+{
+    // Unbound filename inputs in the graph are converted into uniforms by
+    // createShader, which rewrites their values, so these graph
+    // implementations are not shared.
+    if (implElement.isA<NodeGraph>() && hasUnboundFilenames(*implElement.asA<NodeGraph>(), getTarget()))
+    {
+        return EMPTY_STRING;
+    }
+    return ShaderGenerator::getImplementationCacheKey(implElement, nodedef, context);
+}
+
+void HwShaderGenerator::initializeWorkerContext(GenContext& context) const
+{
+    // The graphs of bound light shaders are modified during code generation,
+    // so each worker context binds its own instances of the light shaders.
+    // Light shaders bound without a nodedef remain shared.
+    HwLightShadersPtr lightShaders = context.getUserData<HwLightShaders>(HW::USER_DATA_LIGHT_SHADERS);
+    if (!lightShaders)
+    {
+        return;
+    }
+    // The bound light shaders are copied before they are replaced, preserving
+    // the order in which they are emitted.
+    HwLightShadersPtr workerLightShaders = std::make_shared<HwLightShaders>(*lightShaders);
+    for (const auto& it : lightShaders->get())
+    {
+        ConstNodeDefPtr nodeDef = lightShaders->getNodeDef(it.first);
+        if (nodeDef)
+        {
+            workerLightShaders->bind(it.first, createLightShader(*nodeDef, context), nodeDef);
+        }
+    }
+    context.pushUserData(HW::USER_DATA_LIGHT_SHADERS, workerLightShaders);
+}
+
 bool HwShaderGenerator::nodeNeedsClosureData(const ShaderNode& node) const
 {
     return (node.hasClassification(ShaderNode::Classification::BSDF) || node.hasClassification(ShaderNode::Classification::EDF) || node.hasClassification(ShaderNode::Classification::VDF));
@@ -90,6 +90,13 @@ class MX_GENHW_API HwShaderGenerator : public ShaderGenerator
     /// Create and initialize a new HW shader for shader generation.
     virtual ShaderPtr createShader(const string& name, ElementPtr element, GenContext& context) const;
 
+    /// Return the key under which the given implementation is shared, or an
+    /// empty string for graph implementations with unbound filename inputs.
+    string getImplementationCacheKey(const InterfaceElement& implElement, const NodeDef& nodedef, GenContext& context) const override;
+
+    /// Bind private instances of the light shaders of the given context.
+    void initializeWorkerContext(GenContext& context) const override;
+
     void toVec4(TypeDesc type, string& variable) const;
 };
 
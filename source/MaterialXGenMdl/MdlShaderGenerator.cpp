@@ -342,7 +342,7 @@ ShaderPtr MdlShaderGenerator::generate(const string& name, ElementPtr element, G
     }
 
     // Perform token substitution
-    replaceTokens(_tokenSubstitutions, stage);
+    replaceTokens(context.getTokenSubstitutions(), stage);
 
     return shader;
 }
@@ -385,6 +385,23 @@ ShaderNodeImplPtr MdlShaderGenerator::createShaderNodeImplForImplementation(cons
     return SourceCodeNodeMdl::create();
 }
 
+string MdlShaderGenerator::getImplementationCacheKey(const InterfaceElement& implElement, const NodeDef& nodedef, GenContext& context) const
+{
+    // Layering nodes temporarily rewire the nodes of their graph while
+    // emitting code, so graph implementations are not shared.
+    if (implElement.isA<NodeGraph>())
+    {
+        return EMPTY_STRING;
+    }
+    return ShaderGenerator::getImplementationCacheKey(implElement, nodedef, context);
+}
+
+StringSet MdlShaderGenerator::getParameterBlocks() const
+{
+    // Material parameters are declared in the input block of the stage.
+    return { MDL::INPUTS };
+}
+
 string MdlShaderGenerator::getUpstreamResult(const ShaderInput* input, GenContext& context) const
 {
     const ShaderOutput* upstreamOutput = input->getConnection();
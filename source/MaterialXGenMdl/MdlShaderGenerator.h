@@ -87,6 +87,9 @@ class MX_GENMDL_API MdlShaderGenerator : public ShaderGenerator
     /// Return the result of an upstream connection or value for an input.
     string getUpstreamResult(const ShaderInput* input, GenContext& context) const override;
 
+    /// Return the names of the input blocks holding material parameters.
+    StringSet getParameterBlocks() const override;
+
     /// Unique identifier for this generator target
     static const string TARGET;
 
@@ -115,6 +118,9 @@ class MX_GENMDL_API MdlShaderGenerator : public ShaderGenerator
 
     // Emit a block of shader inputs.
     void emitShaderInputs(const VariableBlock& inputs, ShaderStage& stage) const;
+
+    // Return the shared implementation cache key for an implementation.
+    string getImplementationCacheKey(const InterfaceElement& implElement, const NodeDef& nodedef, GenContext& context) const override;
 };
 
 namespace MDL
@@ -159,14 +159,14 @@ ShaderPtr MslShaderGenerator::generate(const string& name, ElementPtr element, G
     // Emit code for vertex shader stage
     ShaderStage& vs = shader->getStage(Stage::VERTEX);
     emitVertexStage(shader->getGraph(), context, vs);
-    replaceTokens(_tokenSubstitutions, vs);
+    replaceTokens(context.getTokenSubstitutions(), vs);
 
     MetalizeGeneratedShader(vs);
 
     // Emit code for pixel shader stage
     ShaderStage& ps = shader->getStage(Stage::PIXEL);
     emitPixelStage(shader->getGraph(), context, ps);
-    replaceTokens(_tokenSubstitutions, ps);
+    replaceTokens(context.getTokenSubstitutions(), ps);
 
     MetalizeGeneratedShader(ps);
 
@@ -952,11 +952,11 @@ void MslShaderGenerator::emitPixelStage(const ShaderGraph& graph, GenContext& co
         // depending on the vertical flip flag.
         if (context.getOptions().fileTextureVerticalFlip)
         {
-            _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "mx_transform_uv_vflip.glsl";
+            context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "mx_transform_uv_vflip.glsl");
         }
         else
         {
-            _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "mx_transform_uv.glsl";
+            context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "mx_transform_uv.glsl");
         }
 
         emitLightFunctionDefinitions(graph, context, stage);
@@ -20,6 +20,10 @@ GenContext::GenContext(ShaderGeneratorPtr sg) :
         throw ExceptionShaderGenError("GenContext must have a valid shader generator");
     }
 
+    // Start from the generator's token substitutions, which may be overridden
+    // per context during generation.
+    _tokenSubstitutions = _sg->getTokenSubstitutions();
+
     // Apply the generator's default options for its target.
     _sg->applyDefaultOptions(_options);
 
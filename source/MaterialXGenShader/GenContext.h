@@ -70,6 +70,13 @@ class MX_GENSHADER_API GenContext
         _sourceCodeSearchPath.append(path);
     }
 
+    /// Return the user search path for finding source code during
+    /// code generation.
+    const FileSearchPath& getSourceCodeSearchPath() const
+    {
+        return _sourceCodeSearchPath;
+    }
+
     /// Resolve a source code filename, first checking the given local path
     /// then checking any file paths registered by the user.
     FilePath resolveSourceFile(const FilePath& filename, const FilePath& localPath) const
@@ -96,6 +103,20 @@ class MX_GENSHADER_API GenContext
         return _reservedWords;
     }
 
+    /// Set the substitution for the given token in code generated with this
+    /// context, overriding any substitution defined by the shader generator.
+    void setTokenSubstitution(const string& token, const string& substitution)
+    {
+        _tokenSubstitutions[token] = substitution;
+    }
+
+    /// Return the map of token substitutions used in code generated with
+    /// this context.
+    const StringMap& getTokenSubstitutions() const
+    {
+        return _tokenSubstitutions;
+    }
+
     /// Cache a shader node implementation.
     void addNodeImplementation(const string& name, ShaderNodeImplPtr impl);
 
@@ -211,6 +232,7 @@ class MX_GENSHADER_API GenContext
     GenOptions _options;
     FileSearchPath _sourceCodeSearchPath;
     StringSet _reservedWords;
+    StringMap _tokenSubstitutions;
 
     std::unordered_map<string, ShaderNodeImplPtr> _nodeImpls;
     std::unordered_map<string, vector<GenUserDataPtr>> _userData;
@@ -0,0 +1,44 @@
+//
+// Copyright Contributors to the MaterialX Project
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <MaterialXGenShader/GenOptions.h>
+
+#include <MaterialXCore/Util.h>
+
+MATERIALX_NAMESPACE_BEGIN
+
+size_t GenOptions::getHash() const
+{
+    uint64_t hash = STABLE_HASH_BASIS;
+    hash = stableHashInteger(hash, (uint64_t) shaderInterfaceType);
+    hash = stableHashInteger(hash, (uint64_t) fileTextureVerticalFlip);
+    hash = stableHashString(hash, targetColorSpaceOverride);
+    hash = stableHashString(hash, targetDistanceUnit);
+    hash = stableHashInteger(hash, (uint64_t) addUpstreamDependencies);
+    hash = stableHashString(hash, libraryPrefix.asString());
+    hash = stableHashInteger(hash, (uint64_t) emitColorTransforms);
+    hash = stableHashInteger(hash, (uint64_t) elideConstantNodes);
+    hash = stableHashInteger(hash, (uint64_t) premultipliedBsdfAdd);
+    hash = stableHashInteger(hash, (uint64_t) distributeLayerOverBsdfMix);
+    hash = stableHashInteger(hash, (uint64_t) hwTransparency);
+    hash = stableHashInteger(hash, (uint64_t) hwSpecularEnvironmentMethod);
+    hash = stableHashInteger(hash, (uint64_t) hwDirectionalAlbedoMethod);
+    hash = stableHashInteger(hash, (uint64_t) hwTransmissionRenderMethod);
+    hash = stableHashInteger(hash, (uint64_t) hwAiryFresnelIterations);
+    hash = stableHashInteger(hash, (uint64_t) hwSrgbEncodeOutput);
+    hash = stableHashInteger(hash, (uint64_t) hwWriteDepthMoments);
+    hash = stableHashInteger(hash, (uint64_t) hwShadowMap);
+    hash = stableHashInteger(hash, (uint64_t) hwAmbientOcclusion);
+    hash = stableHashInteger(hash, (uint64_t) hwMaxActiveLightSources);
+    hash = stableHashInteger(hash, (uint64_t) hwNormalizeUdimTexCoords);
+    hash = stableHashInteger(hash, (uint64_t) hwWriteAlbedoTable);
+    hash = stableHashInteger(hash, (uint64_t) hwWriteEnvPrefilter);
+    hash = stableHashInteger(hash, (uint64_t) hwImplicitBitangents);
+    hash = stableHashInteger(hash, (uint64_t) oslImplicitSurfaceShaderConversion);
+    hash = stableHashInteger(hash, (uint64_t) oslConnectCiWrapper);
+    return (size_t) hash;
+}
+
+MATERIALX_NAMESPACE_END
@@ -104,6 +104,12 @@ class MX_GENSHADER_API GenOptions
     }
     virtual ~GenOptions() { }
 
+    /// Return a hash of the values of all options.  Generation results that
+    /// depend on these options may use the hash to identify the options from
+    /// which they were generated.  The hash is stable across platforms and
+    /// processes, so that it may be stored persistently.
+    virtual size_t getHash() const;
+
     // TODO: Add options for:
     //  - shader gen optimization level
     //  - graph flattening or not
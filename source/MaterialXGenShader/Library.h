@@ -15,6 +15,7 @@
 MATERIALX_NAMESPACE_BEGIN
 
 class Shader;
+struct ShaderInstance;
 class ShaderStage;
 class ShaderGenerator;
 class ShaderNode;
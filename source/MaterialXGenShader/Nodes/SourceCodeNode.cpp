@@ -33,7 +33,13 @@ void SourceCodeNode::resolveSourceCode(const InterfaceElement& element, GenConte
 
     FilePath localPath = FilePath(impl.getActiveSourceUri()).getParentPath();
     _sourceFilename = context.resolveSourceFile(impl.getAttribute("file"), localPath);
-    _functionSource = readFile(_sourceFilename);
+
+    // Read the file through the source code cache of the generator if present,
+    // allowing its lines to be reused whenever the function is emitted.
+    const ShaderGenerator& shadergen = context.getShaderGenerator();
+    SourceCodeCachePtr cache = shadergen.getSourceCodeCache();
+    ConstSourceCodeBlockPtr block = cache ? cache->get(_sourceFilename, shadergen) : nullptr;
+    _functionSource = block ? block->getText() : readFile(_sourceFilename);
     if (_functionSource.empty())
     {
         throw ExceptionShaderGenError("Failed to get source code from file '" + _sourceFilename.asString() +
@@ -9,8 +9,139 @@
 #include <MaterialXGenShader/Syntax.h>
 #include <MaterialXGenShader/Util.h>
 
+#include <MaterialXCore/Util.h>
+
+#include <algorithm>
+#include <cctype>
+
 MATERIALX_NAMESPACE_BEGIN
 
+namespace
+{
+
+using NameIndexMap = std::unordered_map<string, size_t>;
+
+bool isIdentifierChar(char c)
+{
+    return std::isalnum(static_cast<unsigned char>(c)) || c == '_';
+}
+
+// Return the given identifier with its longest prefix that matches one of the
+// given names replaced by the index of that name.
+string getCanonicalIdentifier(const string& identifier, const NameIndexMap& names)
+{
+    size_t pos = identifier.size();
+    while (pos != string::npos && pos > 0)
+    {
+        auto it = names.find(identifier.substr(0, pos));
+        if (it != names.end())
+        {
+            return "$" + std::to_string(it->second) + identifier.substr(pos);
+        }
+        pos = identifier.rfind('_', pos - 1);
+    }
+    return identifier;
+}
+
+// Return the position following the initial value expression that starts at
+// the given position of the given source code.
+size_t skipInitialValue(const string& source, size_t pos)
+{
+    int depth = 0;
+    while (pos < source.size())
+    {
+        const char c = source[pos];
+        if (c == '"')
+        {
+            size_t endQuote = source.find('"', pos + 1);
+            pos = endQuote != string::npos ? endQuote + 1 : source.size();
+            continue;
+        }
+        if (depth == 0 && (c == ';' || c == ',' || c == '\n' || source.compare(pos, 2, "[[") == 0))
+        {
+            break;
+        }
+        if (c == '(' || c == '[' || c == '{')
+        {
+            depth++;
+        }
+        else if (c == ')' || c == ']' || c == '}')
+        {
+            if (depth == 0)
+            {
+                break;
+            }
+            depth--;
+        }
+        pos++;
+    }
+    return pos;
+}
+
+// Return the canonical form of the given source code, in which identifiers
+// derived from the given names are replaced by the indices of the names, and
+// the initial values in the declarations of the given uniforms are removed.
+string getCanonicalSource(const string& source, const NameIndexMap& names, StringSet uniforms)
+{
+    string result;
+    result.reserve(source.size());
+    bool afterIdentifier = false;
+    size_t pos = 0;
+    while (pos < source.size())
+    {
+        const char c = source[pos];
+        if (!isIdentifierChar(c))
+        {
+            result += c;
+            afterIdentifier = afterIdentifier && std::isspace(static_cast<unsigned char>(c));
+            pos++;
+            continue;
+        }
+
+        size_t end = pos;
+        while (end < source.size() && isIdentifierChar(source[end]))
+        {
+            end++;
+        }
+        const string token = source.substr(pos, end - pos);
+        pos = end;
+        if (std::isdigit(static_cast<unsigned char>(token[0])))
+        {
+            result += token;
+            afterIdentifier = false;
+            continue;
+        }
+        result += getCanonicalIdentifier(token, names);
+
+        // A uniform is declared where its variable follows a type name, and
+        // its initial value follows an array suffix, if any.
+        if (afterIdentifier && uniforms.count(token))
+        {
+            size_t next = source.find_first_not_of(" \t", pos);
+            if (next != string::npos && source[next] == '[' && source.compare(next, 2, "[[") != 0)
+            {
+                size_t endBracket = source.find(']', next);
+                if (endBracket != string::npos)
+                {
+                    result += source.substr(pos, endBracket + 1 - pos);
+                    pos = endBracket + 1;
+                    next = source.find_first_not_of(" \t", pos);
+                }
+            }
+            if (next != string::npos && source[next] == '=' && source.compare(next, 2, "==") != 0)
+            {
+                result += " =";
+                pos = skipInitialValue(source, next + 1);
+                uniforms.erase(token);
+            }
+        }
+        afterIdentifier = true;
+    }
+    return result;
+}
+
+} // anonymous namespace
+
 //
 // Shader methods
 //
@@ -52,6 +183,113 @@ const ShaderStage& Shader::getStage(const string& name) const
     return const_cast<Shader*>(this)->getStage(name);
 }
 
+size_t Shader::getStructuralHash(const StringSet& parameterBlocks) const
+{
+    // Identifiers derived from the names of the shader and its graph nodes are
+    // replaced by indices, which depend only on the order of the nodes.
+    NameIndexMap names;
+    names.emplace(_name, 0);
+    names.emplace(_graph->getName(), 0);
+    size_t hash = 0;
+    size_t nodeIndex = 0;
+    for (const ShaderNode* node : _graph->getNodes())
+    {
+        names.emplace(node->getName(), ++nodeIndex);
+        hashCombine(hash, node->getImplementation().getName());
+    }
+
+    StringVec attributes;
+    for (const auto& it : _attributeMap)
+    {
+        attributes.push_back(it.first);
+    }
+    std::sort(attributes.begin(), attributes.end());
+    for (const string& attrib : attributes)
+    {
+        ValuePtr value = getAttribute(attrib);
+        hashCombine(hash, attrib);
+        hashCombine(hash, value ? value->getValueString() : EMPTY_STRING);
+    }
+
+    auto hashBlock = [&hash, &names](const VariableBlock& block)
+    {
+        hashCombine(hash, block.getName());
+        hashCombine(hash, block.getInstance());
+        hashCombine(hash, block.size());
+        for (const ShaderPort* port : block.getVariableOrder())
+        {
+            hashCombine(hash, port->getType().getName());
+            hashCombine(hash, getCanonicalIdentifier(port->getVariable(), names));
+            hashCombine(hash, port->getSemantic());
+        }
+    };
+
+    for (const ShaderStage* stage : _stages)
+    {
+        hashCombine(hash, stage->getName());
+        hashCombine(hash, getCanonicalIdentifier(stage->getFunctionName(), names));
+
+        StringSet uniforms;
+        hashBlock(stage->getConstantBlock());
+        for (const auto& it : stage->getUniformBlocks())
+        {
+            hashBlock(*it.second);
+            for (const ShaderPort* port : it.second->getVariableOrder())
+            {
+                uniforms.insert(port->getVariable());
+            }
+        }
+        for (const auto& it : stage->getInputBlocks())
+        {
+            hashBlock(*it.second);
+            if (parameterBlocks.count(it.first))
+            {
+                for (const ShaderPort* port : it.second->getVariableOrder())
+                {
+                    uniforms.insert(port->getVariable());
+                }
+            }
+        }
+        for (const auto& it : stage->getOutputBlocks())
+        {
+            hashBlock(*it.second);
+        }
+
+        hashCombine(hash, getCanonicalSource(stage->getSourceCode(), names, uniforms));
+    }
+    return hash;
+}
+
+ShaderUniformValueMap Shader::getUniformValues(const StringSet& parameterBlocks) const
+{
+    ShaderUniformValueMap values;
+    auto addValues = [&values](const VariableBlock& block)
+    {
+        for (const ShaderPort* port : block.getVariableOrder())
+        {
+            if (port->getValue())
+            {
+                values[port->getVariable()] = port->getValue();
+            }
+        }
+    };
+    for (const ShaderStage* stage : _stages)
+    {
+        for (const auto& it : stage->getUniformBlocks())
+        {
+            addValues(*it.second);
+        }
+        for (const auto& it : stage->getInputBlocks())
+        {
+            if (parameterBlocks.count(it.first))
+            {
+                addValues(*it.second);
+            }
+        }
+    }
+    return values;
+}
+
 ShaderStagePtr Shader::createStage(const string& name, ConstSyntaxPtr syntax)
 {
     auto it = _stagesMap.find(name);
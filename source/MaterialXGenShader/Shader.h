@@ -20,6 +20,9 @@ MATERIALX_NAMESPACE_BEGIN
 class ShaderGenerator;
 class Shader;
 
+/// A map from the variable names of shader uniforms to their values
+using ShaderUniformValueMap = std::unordered_map<string, ValuePtr>;
+
 /// @class Shader
 /// Class containing all data needed during shader generation.
 /// After generation is completed it will contain the resulting source code
@@ -91,6 +94,26 @@ class MX_GENSHADER_API Shader
     /// Return the shader graph.
     ShaderGraph& getGraph() { return *_graph; }
 
+    /// Return a hash of the structure of this shader, ignoring the values of
+    /// its uniforms and the names of the elements from which it was generated.
+    ///
+    /// Shaders with equal structural hashes have the same stages, variable
+    /// blocks and attributes, and the same source code up to the initial values
+    /// of uniforms and the identifiers derived from the names of the shader and
+    /// the nodes of its graph.  A program compiled from one such shader may be
+    /// used to render the others, by binding the uniform values of each.
+    /// Shaders restored from a ShaderCache disk store have no graph nodes, so
+    /// their structural hashes include the names of their nodes.
+    /// @param parameterBlocks The names of input blocks whose variables hold
+    ///    public inputs, and whose values are ignored in the same way as the
+    ///    values of uniforms.  Generators declaring public inputs in input
+    ///    blocks return these names from ShaderGenerator::getParameterBlocks.
+    size_t getStructuralHash(const StringSet& parameterBlocks = StringSet()) const;
+
+    /// Return the values of the uniforms in all stages of this shader, and
+    /// of the variables in the given input blocks, keyed by variable name.
+    ShaderUniformValueMap getUniformValues(const StringSet& parameterBlocks = StringSet()) const;
+
     /// Return true if this shader matches the given classification.
     bool hasClassification(unsigned int c) const { return _graph->hasClassification(c); }
 
@@ -111,6 +134,20 @@ class MX_GENSHADER_API Shader
     std::unordered_map<string, ValuePtr> _attributeMap;
 
     friend class ShaderGenerator;
+    friend class ShaderCache;
+};
+
+/// @struct ShaderInstance
+/// An instance of a shader that may be shared between elements with the same
+/// structure, holding the uniform values of a single element.
+struct MX_GENSHADER_API ShaderInstance
+{
+    /// The shared shader.
+    ShaderPtr shader;
+
+    /// The uniform values of the element, keyed by the variable names of
+    /// the shared shader.
+    ShaderUniformValueMap uniformValues;
 };
 
 MATERIALX_NAMESPACE_END
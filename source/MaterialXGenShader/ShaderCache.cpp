@@ -0,0 +1,596 @@
+//
+// Copyright Contributors to the MaterialX Project
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <MaterialXGenShader/ShaderCache.h>
+
+#include <MaterialXGenShader/ColorManagementSystem.h>
+#include <MaterialXGenShader/Exception.h>
+#include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/Shader.h>
+#include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/ShaderGraph.h>
+#include <MaterialXGenShader/ShaderStage.h>
+#include <MaterialXGenShader/UnitSystem.h>
+
+#include <MaterialXCore/Document.h>
+#include <MaterialXCore/Traversal.h>
+#include <MaterialXCore/Util.h>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <set>
+#include <thread>
+#include <typeinfo>
+
+MATERIALX_NAMESPACE_BEGIN
+
+const size_t ShaderCache::DEFAULT_CAPACITY = 256;
+const string ShaderCache::FILE_EXTENSION = "mxshader";
+
+namespace
+{
+
+const char FILE_MAGIC[4] = { 'M', 'X', 'S', 'C' };
+const uint32_t FILE_FORMAT_VERSION = 2;
+
+// Return true if the given child of a document holds a definition that may
+// be referenced by elements elsewhere in the document.
+bool isLocalDefinition(ConstElementPtr child)
+{
+    if (child->isA<NodeGraph>())
+    {
+        return child->asA<NodeGraph>()->hasNodeDefString();
+    }
+    const string& category = child->getCategory();
+    return category == NodeDef::CATEGORY ||
+           category == Implementation::CATEGORY ||
+           category == TypeDef::CATEGORY ||
+           category == GeomPropDef::CATEGORY ||
+           category == UnitDef::CATEGORY ||
+           category == UnitTypeDef::CATEGORY ||
+           category == AttributeDef::CATEGORY;
+}
+
+// Return the ancestor of the given element that is a child of its document.
+ConstElementPtr getTopLevelElement(ConstElementPtr element)
+{
+    while (element->getParent() && element->getParent()->getParent())
+    {
+        element = element->getParent();
+    }
+    return element;
+}
+
+// Return a stable hash of the given element, the elements upstream of it,
+// and the definitions and settings of its document.
+uint64_t getContentKey(ConstElementPtr element)
+{
+    uint64_t hash = STABLE_HASH_BASIS;
+
+    // Hash the top-level elements that contain the element and its upstream
+    // elements, so that changes to any part of a node graph are detected.
+    std::set<ConstElementPtr> visited;
+    ConstElementPtr topLevel = getTopLevelElement(element);
+    visited.insert(topLevel);
+    hash = stableHashInteger(hash, topLevel->getContentHash());
+    for (Edge edge : element->traverseGraph())
+    {
+        ElementPtr upstream = edge.getUpstreamElement();
+        if (!upstream)
+        {
+            continue;
+        }
+        topLevel = getTopLevelElement(upstream);
+        if (visited.insert(topLevel).second)
+        {
+            hash = stableHashInteger(hash, topLevel->getContentHash());
+        }
+    }
+
+    // Hash the document settings and the definitions held by the document
+    // and its data library.
+    ConstDocumentPtr doc = element->getDocument();
+    for (const string& attr : doc->getAttributeNames())
+    {
+        hash = stableHashString(hash, attr);
+        hash = stableHashString(hash, doc->getAttribute(attr));
+    }
+    for (ElementPtr child : doc->getChildren())
+    {
+        if (isLocalDefinition(child))
+        {
+            hash = stableHashInteger(hash, child->getContentHash());
+        }
+    }
+    ConstDocumentPtr dataLibrary = doc->getDataLibrary();
+    if (dataLibrary)
+    {
+        hash = stableHashInteger(hash, dataLibrary->getContentHash());
+    }
+
+    return hash;
+}
+
+// Return the fields identifying the shader generated for the given element,
+// which are stored in the disk store and compared when a shader is read.
+StringVec getIdentity(const string& name, ConstElementPtr element, GenContext& context)
+{
+    const ShaderGenerator& shadergen = context.getShaderGenerator();
+    return {
+        getVersionString(),
+        typeid(shadergen).name(),
+        shadergen.getTarget(),
+        name,
+        std::to_string(context.getOptions().getHash()),
+        context.getSourceCodeSearchPath().asString(),
+        shadergen.getColorManagementSystem() ? shadergen.getColorManagementSystem()->getName() : EMPTY_STRING,
+        shadergen.getUnitSystem() ? shadergen.getUnitSystem()->getName() : EMPTY_STRING,
+        std::to_string(getContentKey(element))
+    };
+}
+
+// Return a unique suffix for temporary files in the disk store.
+string getTemporarySuffix()
+{
+    static std::atomic<uint64_t> counter(0);
+    size_t hash = 0;
+    hashCombine(hash, std::this_thread::get_id());
+    hashCombine(hash, std::chrono::high_resolution_clock::now().time_since_epoch().count());
+    hashCombine(hash, counter++);
+    return "." + std::to_string(hash) + ".tmp";
+}
+
+//
+// Binary serialization of shaders
+//
+
+class ShaderWriter
+{
+  public:
+    ShaderWriter(std::ostream& stream) :
+        _stream(stream)
+    {
+    }
+
+    void writeUInt(uint32_t value)
+    {
+        _stream.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeString(const string& value)
+    {
+        uint64_t size = value.size();
+        _stream.write(reinterpret_cast<const char*>(&size), sizeof(size));
+        _stream.write(value.data(), (std::streamsize) value.size());
+    }
+
+    void writeValue(ConstValuePtr value)
+    {
+        writeString(value ? value->getTypeString() : EMPTY_STRING);
+        writeString(value ? value->getValueString() : EMPTY_STRING);
+    }
+
+    void writeBlock(const VariableBlock& block)
+    {
+        writeString(block.getName());
+        writeString(block.getInstance());
+        writeUInt((uint32_t) block.size());
+        for (const ShaderPort* port : block.getVariableOrder())
+        {
+            writeString(port->getType().getName());
+            writeString(port->getName());
+            writeString(port->getVariable());
+            writeString(port->getPath());
+            writeString(port->getSemantic());
+            writeString(port->getUnit());
+            writeString(port->getColorSpace());
+            writeString(port->getGeomProp());
+            writeValue(port->getValue());
+            writeUInt(port->getFlags());
+
+            const ShaderMetadataVecPtr& metadata = port->getMetadata();
+            writeUInt(metadata ? (uint32_t) metadata->size() : 0);
+            if (metadata)
+            {
+                for (const ShaderMetadata& data : *metadata)
+                {
+                    writeString(data.name);
+                    writeString(data.type.getName());
+                    writeValue(data.value);
+                }
+            }
+        }
+    }
+
+    void writeBlocks(const VariableBlockMap& blocks)
+    {
+        writeUInt((uint32_t) blocks.size());
+        for (const auto& it : blocks)
+        {
+            writeBlock(*it.second);
+        }
+    }
+
+  private:
+    std::ostream& _stream;
+};
+
+class ShaderReader
+{
+  public:
+    ShaderReader(std::istream& stream, uint64_t size, GenContext& context) :
+        _stream(stream),
+        _remaining(size),
+        _context(context)
+    {
+    }
+
+    uint32_t readUInt()
+    {
+        uint32_t value = 0;
+        readBytes(reinterpret_cast<char*>(&value), sizeof(value));
+        return value;
+    }
+
+    string readString()
+    {
+        uint64_t size = 0;
+        readBytes(reinterpret_cast<char*>(&size), sizeof(size));
+
+        // Sizes are validated before allocation, so that a corrupt file
+        // cannot request more memory than the file could hold.
+        if (size > _remaining)
+        {
+            throw ExceptionShaderGenError("Invalid string size in cached shader file");
+        }
+        string value((size_t) size, '\0');
+        readBytes(&value[0], size);
+        return value;
+    }
+
+    ValuePtr readValue()
+    {
+        string typeString = readString();
+        string valueString = readString();
+        if (typeString.empty())
+        {
+            return nullptr;
+        }
+        TypeDesc type = _context.getTypeDesc(typeString);
+        if (type.isStruct())
+        {
+            return type.createValueFromStrings(valueString);
+        }
+        return Value::createValueFromStrings(valueString, typeString);
+    }
+
+    void readBlock(VariableBlock& block)
+    {
+        uint32_t portCount = readUInt();
+        for (uint32_t i = 0; i < portCount; i++)
+        {
+            TypeDesc type = _context.getTypeDesc(readString());
+            string name = readString();
+            ShaderPort* port = block.add(type, name);
+            port->setVariable(readString());
+            port->setPath(readString());
+            port->setSemantic(readString());
+            port->setUnit(readString());
+            port->setColorSpace(readString());
+            port->setGeomProp(readString());
+            port->setValue(readValue());
+            port->setFlags(readUInt());
+
+            uint32_t metadataCount = readUInt();
+            if (metadataCount)
+            {
+                ShaderMetadataVecPtr metadata = std::make_shared<ShaderMetadataVec>();
+                for (uint32_t j = 0; j < metadataCount; j++)
+                {
+                    string dataName = readString();
+                    TypeDesc dataType = _context.getTypeDesc(readString());
+                    metadata->emplace_back(dataName, dataType, readValue());
+                }
+                port->setMetadata(metadata);
+            }
+        }
+    }
+
+  private:
+    void readBytes(char* data, uint64_t size)
+    {
+        if (size > _remaining)
+        {
+            throw ExceptionShaderGenError("Unexpected end of cached shader file");
+        }
+        _stream.read(data, (std::streamsize) size);
+        if (!_stream)
+        {
+            throw ExceptionShaderGenError("Unexpected end of cached shader file");
+        }
+        _remaining -= size;
+    }
+
+  private:
+    std::istream& _stream;
+    uint64_t _remaining;
+    GenContext& _context;
+};
+
+} // anonymous namespace
+
+//
+// ShaderCache methods
+//
+
+ShaderCache::ShaderCache(const FilePath& directory, size_t capacity) :
+    _directory(directory),
+    _capacity(capacity)
+{
+    if (!_directory.isEmpty() && !_directory.exists())
+    {
+        _directory.createDirectory(true);
+    }
+}
+
+ShaderPtr ShaderCache::generate(const string& name, ElementPtr element, GenContext& context)
+{
+    const string key = getKey(name, element, context);
+    ShaderPtr shader = findInMemory(key);
+    if (shader)
+    {
+        return shader;
+    }
+
+    FilePath filename;
+    StringVec identity;
+    if (!_directory.isEmpty())
+    {
+        filename = _directory / FilePath(key + "." + FILE_EXTENSION);
+        identity = getIdentity(name, element, context);
+        shader = readShader(filename, identity, name, element, context);
+        if (shader)
+        {
+            addToMemory(key, shader);
+            return shader;
+        }
+    }
+
+    shader = context.getShaderGenerator().generate(name, element, context);
+    if (shader)
+    {
+        if (!filename.isEmpty())
+        {
+            writeShader(filename, identity, *shader);
+        }
+        addToMemory(key, shader);
+    }
+    return shader;
+}
+
+string ShaderCache::getKey(const string& name, ConstElementPtr element, GenContext& context) const
+{
+    uint64_t hash = STABLE_HASH_BASIS;
+    for (const string& field : getIdentity(name, element, context))
+    {
+        hash = stableHashString(hash, field);
+    }
+
+    std::stringstream ss;
+    ss << std::hex << std::setw(16) << std::setfill('0') << hash;
+    return ss.str();
+}
+
+size_t ShaderCache::size() const
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    return _shaders.size();
+}
+
+void ShaderCache::clear()
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    _shaders.clear();
+    _shaderMap.clear();
+}
+
+ShaderPtr ShaderCache::findInMemory(const string& key)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _shaderMap.find(key);
+    if (it == _shaderMap.end())
+    {
+        return nullptr;
+    }
+
+    // Move the shader to the front of the list, as the most recently used.
+    _shaders.splice(_shaders.begin(), _shaders, it->second);
+    return it->second->second;
+}
+
+void ShaderCache::addToMemory(const string& key, ShaderPtr shader)
+{
+    std::lock_guard<std::mutex> lock(_mutex);
+    auto it = _shaderMap.find(key);
+    if (it != _shaderMap.end())
+    {
+        _shaders.erase(it->second);
+        _shaderMap.erase(it);
+    }
+    if (!_capacity)
+    {
+        return;
+    }
+
+    // Evict the least recently used shaders to make room for the new shader.
+    while (_shaders.size() >= _capacity)
+    {
+        _shaderMap.erase(_shaders.back().first);
+        _shaders.pop_back();
+    }
+    _shaders.emplace_front(key, shader);
+    _shaderMap[key] = _shaders.begin();
+}
+
+ShaderPtr ShaderCache::readShader(const FilePath& filename, const StringVec& identity, const string& name,
+                                  ConstElementPtr element, GenContext& context) const
+{
+    std::ifstream stream(filename.asString(), std::ios::binary | std::ios::ate);
+    if (!stream)
+    {
+        return nullptr;
+    }
+    const std::streamoff fileSize = stream.tellg();
+    stream.seekg(0);
+
+    try
+    {
+        char magic[sizeof(FILE_MAGIC)];
+        stream.read(magic, sizeof(magic));
+        if (!stream || !std::equal(magic, magic + sizeof(magic), FILE_MAGIC))
+        {
+            return nullptr;
+        }
+
+        // Files whose identity differs from the requested shader, such as
+        // files written by another generator, are treated as misses.
+        ShaderReader reader(stream, (uint64_t) fileSize - sizeof(FILE_MAGIC), context);
+        if (reader.readUInt() != FILE_FORMAT_VERSION || reader.readUInt() != identity.size())
+        {
+            return nullptr;
+        }
+        for (const string& field : identity)
+        {
+            if (reader.readString() != field)
+            {
+                return nullptr;
+            }
+        }
+
+        // Restored shaders hold an empty graph, so that no graph construction
+        // is required on a cache hit.
+        ShaderGraphPtr graph = std::make_shared<ShaderGraph>(nullptr, name, element->getDocument(), context);
+        graph->setClassification(reader.readUInt());
+        ShaderPtr shader = std::make_shared<Shader>(name, graph);
+
+        uint32_t attributeCount = reader.readUInt();
+        for (uint32_t i = 0; i < attributeCount; i++)
+        {
+            string attrib = reader.readString();
+            shader->setAttribute(attrib, reader.readValue());
+        }
+
+        const ShaderGenerator& shadergen = context.getShaderGenerator();
+        uint32_t stageCount = reader.readUInt();
+        for (uint32_t i = 0; i < stageCount; i++)
+        {
+            ShaderStagePtr stage = shadergen.createStage(reader.readString(), *shader);
+            stage->setFunctionName(reader.readString());
+            stage->setSourceCode(reader.readString());
+
+            uint32_t dependencyCount = reader.readUInt();
+            for (uint32_t j = 0; j < dependencyCount; j++)
+            {
+                stage->addSourceDependency(reader.readString());
+            }
+
+            reader.readString();
+            reader.readString();
+            reader.readBlock(stage->getConstantBlock());
+            for (int blockType = 0; blockType < 3; blockType++)
+            {
+                uint32_t blockCount = reader.readUInt();
+                for (uint32_t j = 0; j < blockCount; j++)
+                {
+                    string blockName = reader.readString();
+                    string blockInstance = reader.readString();
+                    VariableBlockPtr block = blockType == 0 ? stage->createUniformBlock(blockName, blockInstance) :
+                                             blockType == 1 ? stage->createInputBlock(blockName, blockInstance) :
+                                                              stage->createOutputBlock(blockName, blockInstance);
+                    reader.readBlock(*block);
+                }
+            }
+        }
+
+        return shader;
+    }
+    catch (Exception&)
+    {
+        // Files that are truncated or hold invalid values are treated as
+        // cache misses, and are replaced when the shader is generated.
+        return nullptr;
+    }
+}
+
+void ShaderCache::writeShader(const FilePath& filename, const StringVec& identity, const Shader& shader) const
+{
+    // Write to a temporary file that is then renamed, so that concurrent
+    // readers never encounter a partially written shader.
+    const string tempFilename = filename.asString() + getTemporarySuffix();
+    {
+        std::ofstream stream(tempFilename, std::ios::binary);
+        if (!stream)
+        {
+            return;
+        }
+
+        stream.write(FILE_MAGIC, sizeof(FILE_MAGIC));
+        ShaderWriter writer(stream);
+        writer.writeUInt(FILE_FORMAT_VERSION);
+        writer.writeUInt((uint32_t) identity.size());
+        for (const string& field : identity)
+        {
+            writer.writeString(field);
+        }
+        writer.writeUInt(shader.getGraph().getClassification());
+
+        writer.writeUInt((uint32_t) shader._attributeMap.size());
+        for (const auto& it : shader._attributeMap)
+        {
+            writer.writeString(it.first);
+            writer.writeValue(it.second);
+        }
+
+        writer.writeUInt((uint32_t) shader.numStages());
+        for (size_t i = 0; i < shader.numStages(); i++)
+        {
+            const ShaderStage& stage = shader.getStage(i);
+            writer.writeString(stage.getName());
+            writer.writeString(stage.getFunctionName());
+            writer.writeString(stage.getSourceCode());
+
+            writer.writeUInt((uint32_t) stage.getSourceDependencies().size());
+            for (const string& dependency : stage.getSourceDependencies())
+            {
+                writer.writeString(dependency);
+            }
+
+            writer.writeBlock(stage.getConstantBlock());
+            writer.writeBlocks(stage.getUniformBlocks());
+            writer.writeBlocks(stage.getInputBlocks());
+            writer.writeBlocks(stage.getOutputBlocks());
+        }
+
+        // Buffered data is only written when the file is closed, so the
+        // stream is checked afterwards.
+        stream.close();
+        if (!stream)
+        {
+            std::remove(tempFilename.c_str());
+            return;
+        }
+    }
+
+    if (std::rename(tempFilename.c_str(), filename.asString().c_str()) != 0)
+    {
+        std::remove(tempFilename.c_str());
+    }
+}
+
+MATERIALX_NAMESPACE_END
@@ -0,0 +1,119 @@
+//
+// Copyright Contributors to the MaterialX Project
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#ifndef MATERIALX_SHADERCACHE_H
+#define MATERIALX_SHADERCACHE_H
+
+/// @file
+/// Persistent cache of generated shaders
+
+#include <MaterialXGenShader/Export.h>
+#include <MaterialXGenShader/Library.h>
+
+#include <MaterialXFormat/File.h>
+
+#include <MaterialXCore/Element.h>
+
+#include <list>
+#include <mutex>
+#include <unordered_map>
+
+MATERIALX_NAMESPACE_BEGIN
+
+/// Shared pointer to a ShaderCache
+using ShaderCachePtr = shared_ptr<class ShaderCache>;
+
+/// @class ShaderCache
+/// A cache of generated shaders, keyed by the content of the elements from
+/// which they are generated.
+///
+/// Shaders are held in an in-memory cache with least-recently-used eviction,
+/// in front of an optional on-disk store that persists shaders between
+/// processes.  When a shader is found in either cache, it is returned without
+/// constructing a shader graph.  Shaders restored from disk hold their stage
+/// source code, variable blocks, attributes and graph classification, but
+/// their shader graph contains no nodes.
+///
+/// The cache key is a stable hash of the element and every element upstream
+/// of it, the definitions held by the element's document, the content of its
+/// data library, the MaterialX version, the shader name, the generator class
+/// and target, the generation options and the source code search path.  These
+/// fields are also stored in each file of the disk store, and files whose
+/// fields differ from those of the requested shader are ignored.  User data
+/// in the generation context, such as bound light shaders, is not part of the
+/// key, so contexts that differ in their user data should use separate caches.
+///
+/// Cached shaders are shared by all callers, and should not be modified.
+/// All methods may be called concurrently from multiple threads, and a disk
+/// store may be shared by concurrent processes.
+class MX_GENSHADER_API ShaderCache
+{
+  public:
+    /// The default number of shaders held in memory.
+    static const size_t DEFAULT_CAPACITY;
+
+    /// The file extension of shaders in the disk store.
+    static const string FILE_EXTENSION;
+
+  public:
+    ShaderCache(const FilePath& directory, size_t capacity);
+    ~ShaderCache() { }
+
+    /// Create a new shader cache.
+    /// @param directory The directory of the disk store, which is created if
+    ///    needed.  Defaults to an empty path, disabling the disk store.
+    /// @param capacity The maximum number of shaders held in memory.
+    static ShaderCachePtr create(const FilePath& directory = FilePath(), size_t capacity = DEFAULT_CAPACITY)
+    {
+        return std::make_shared<ShaderCache>(directory, capacity);
+    }
+
+    /// Return the directory of the disk store.
+    const FilePath& getDirectory() const
+    {
+        return _directory;
+    }
+
+    /// Return the maximum number of shaders held in memory.
+    size_t getCapacity() const
+    {
+        return _capacity;
+    }
+
+    /// Return the shader generated for the given element, generating the
+    /// shader with the context's generator and storing it in the cache if it
+    /// is not found in memory or on disk.
+    /// @param name Name of the shader.
+    /// @param element The element to generate the shader from.
+    /// @param context The context for shader generation.
+    ShaderPtr generate(const string& name, ElementPtr element, GenContext& context);
+
+    /// Return the key under which the shader for the given element is cached.
+    string getKey(const string& name, ConstElementPtr element, GenContext& context) const;
+
+    /// Return the number of shaders held in memory.
+    size_t size() const;
+
+    /// Remove all shaders from memory.  The disk store is not modified.
+    void clear();
+
+  private:
+    ShaderPtr findInMemory(const string& key);
+    void addToMemory(const string& key, ShaderPtr shader);
+    ShaderPtr readShader(const FilePath& filename, const StringVec& identity, const string& name, ConstElementPtr element, GenContext& context) const;
+    void writeShader(const FilePath& filename, const StringVec& identity, const Shader& shader) const;
+
+  private:
+    FilePath _directory;
+    size_t _capacity;
+
+    mutable std::mutex _mutex;
+    std::list<std::pair<string, ShaderPtr>> _shaders;
+    std::unordered_map<string, std::list<std::pair<string, ShaderPtr>>::iterator> _shaderMap;
+};
+
+MATERIALX_NAMESPACE_END
+
+#endif
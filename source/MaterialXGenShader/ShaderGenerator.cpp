@@ -6,6 +6,7 @@
 #include <MaterialXGenShader/ShaderGenerator.h>
 
 #include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/Shader.h>
 #include <MaterialXGenShader/ShaderNodeImpl.h>
 #include <MaterialXGenShader/Nodes/CompoundNode.h>
 #include <MaterialXGenShader/Nodes/SourceCodeNode.h>
@@ -15,11 +16,15 @@
 
 #include <MaterialXCore/Document.h>
 #include <MaterialXCore/Node.h>
+#include <MaterialXCore/Util.h>
 #include <MaterialXCore/Value.h>
 
 #include <MaterialXTrace/Tracing.h>
 
+#include <algorithm>
+#include <mutex>
 #include <sstream>
+#include <typeinfo>
 
 MATERIALX_NAMESPACE_BEGIN
 
@@ -46,6 +51,130 @@ void ShaderGenerator::applyDefaultOptions(GenOptions& /*options*/) const
     // Derived generators override to set target-specific defaults.
 }
 
+vector<ShaderPtr> ShaderGenerator::generateBatch(const vector<ElementPtr>& elements, const GenContext& context,
+                                                unsigned int threadCount) const
+{
+    MX_TRACE_FUNCTION(Tracing::Category::ShaderGen);
+
+    // Worker contexts are drawn from a shared pool, so that each is reused
+    // for the elements generated on one thread at a time, and its cache of
+    // node implementations is never accessed concurrently.
+    vector<std::unique_ptr<GenContext>> contextPool;
+    std::mutex poolMutex;
+
+    vector<ShaderPtr> shaders(elements.size());
+    parallelFor(elements.size(), threadCount, [&](size_t i)
+    {
+        std::unique_ptr<GenContext> workerContext;
+        {
+            std::lock_guard<std::mutex> lock(poolMutex);
+            if (!contextPool.empty())
+            {
+                workerContext = std::move(contextPool.back());
+                contextPool.pop_back();
+            }
+        }
+        if (!workerContext)
+        {
+            workerContext = std::make_unique<GenContext>(context);
+            workerContext->clearNodeImplementations();
+            initializeWorkerContext(*workerContext);
+        }
+
+        shaders[i] = generate(elements[i]->getName(), elements[i], *workerContext);
+
+        std::lock_guard<std::mutex> lock(poolMutex);
+        contextPool.push_back(std::move(workerContext));
+    });
+    return shaders;
+}
+
+vector<ShaderInstance> ShaderGenerator::generateInstances(const vector<ElementPtr>& elements, const GenContext& context,
+                                                         unsigned int threadCount) const
+{
+    MX_TRACE_FUNCTION(Tracing::Category::ShaderGen);
+
+    vector<ShaderPtr> shaders = generateBatch(elements, context, threadCount);
+    const StringSet parameterBlocks = getParameterBlocks();
+    vector<size_t> hashes(shaders.size());
+    parallelFor(shaders.size(), threadCount, [&shaders, &hashes, &parameterBlocks](size_t i)
+    {
+        hashes[i] = shaders[i]->getStructuralHash(parameterBlocks);
+    });
+
+    // Shaders with the same structure have the same uniforms in the same
+    // order, so the uniform values of each element are assigned to the
+    // variables of the shared shader by position.
+    auto getUniforms = [&parameterBlocks](const Shader& shader)
+    {
+        vector<const ShaderPort*> uniforms;
+        for (size_t i = 0; i < shader.numStages(); i++)
+        {
+            const ShaderStage& stage = shader.getStage(i);
+            for (const auto& it : stage.getUniformBlocks())
+            {
+                const vector<ShaderPort*>& ports = it.second->getVariableOrder();
+                uniforms.insert(uniforms.end(), ports.begin(), ports.end());
+            }
+            for (const auto& it : stage.getInputBlocks())
+            {
+                if (parameterBlocks.count(it.first))
+                {
+                    const vector<ShaderPort*>& ports = it.second->getVariableOrder();
+                    uniforms.insert(uniforms.end(), ports.begin(), ports.end());
+                }
+            }
+        }
+        return uniforms;
+    };
+
+    // Shaders are only shared if their uniforms match in number and type,
+    // guarding the assignment of values against collisions between hashes.
+    auto matchUniforms = [](const vector<const ShaderPort*>& lhs, const vector<const ShaderPort*>& rhs)
+    {
+        return lhs.size() == rhs.size() &&
+               std::equal(lhs.begin(), lhs.end(), rhs.begin(), [](const ShaderPort* a, const ShaderPort* b)
+               {
+                   return a->getType() == b->getType();
+               });
+    };
+
+    std::unordered_map<size_t, vector<ShaderPtr>> sharedShaders;
+    vector<ShaderInstance> instances(shaders.size());
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        vector<const ShaderPort*> uniforms = getUniforms(*shaders[i]);
+        vector<const ShaderPort*> sharedUniforms;
+        ShaderPtr sharedShader;
+        vector<ShaderPtr>& candidates = sharedShaders[hashes[i]];
+        for (ShaderPtr candidate : candidates)
+        {
+            sharedUniforms = getUniforms(*candidate);
+            if (matchUniforms(sharedUniforms, uniforms))
+            {
+                sharedShader = candidate;
+                break;
+            }
+        }
+        if (!sharedShader)
+        {
+            sharedShader = shaders[i];
+            sharedUniforms = uniforms;
+            candidates.push_back(sharedShader);
+        }
+        instances[i].shader = sharedShader;
+
+        for (size_t j = 0; j < uniforms.size(); j++)
+        {
+            if (uniforms[j]->getValue())
+            {
+                instances[i].uniformValues[sharedUniforms[j]->getVariable()] = uniforms[j]->getValue();
+            }
+        }
+    }
+    return instances;
+}
+
 void ShaderGenerator::emitScopeBegin(ShaderStage& stage, Syntax::Punctuation punc) const
 {
     stage.beginScope(punc);
@@ -333,6 +462,21 @@ ShaderNodeImplPtr ShaderGenerator::getImplementation(const NodeDef& nodedef, Gen
         return impl;
     }
 
+    // Check if it's been created by another context sharing the generator.
+    // The color management system may replace any implementation, so these
+    // are never shared.
+    const bool colorManagementImpl = getColorManagementSystem() && getColorManagementSystem()->hasImplementation(name);
+    const string cacheKey = (_implCache && !colorManagementImpl) ? getImplementationCacheKey(*implElement, nodedef, context) : EMPTY_STRING;
+    if (!cacheKey.empty())
+    {
+        impl = _implCache->find(cacheKey);
+        if (impl)
+        {
+            context.addNodeImplementation(name, impl);
+            return impl;
+        }
+    }
+
     if (implElement->isA<NodeGraph>())
     {
         impl = createShaderNodeImplForNodeGraph(*implElement->asA<NodeGraph>());
@@ -340,7 +484,7 @@ ShaderNodeImplPtr ShaderGenerator::getImplementation(const NodeDef& nodedef, Gen
     else if (implElement->isA<Implementation>())
     {
         ImplementationPtr implementationElement = implElement->asA<Implementation>();
-        if (getColorManagementSystem() && getColorManagementSystem()->hasImplementation(name))
+        if (colorManagementImpl)
         {
             impl = getColorManagementSystem()->createImplementation(name);
         }
@@ -361,12 +505,31 @@ ShaderNodeImplPtr ShaderGenerator::getImplementation(const NodeDef& nodedef, Gen
 
     impl->initialize(*implElement, context);
 
-    // Cache it.
+    // Cache it, using the shared instance if another thread has
+    // initialized the same implementation in the meantime.
+    if (!cacheKey.empty())
+    {
+        impl = _implCache->add(cacheKey, impl);
+    }
     context.addNodeImplementation(name, impl);
 
     return impl;
 }
 
+string ShaderGenerator::getImplementationCacheKey(const InterfaceElement& implElement, const NodeDef& nodedef, GenContext& context) const
+{
+    if (context.getTypeDesc(nodedef.getType()) == Type::LIGHTSHADER)
+    {
+        return EMPTY_STRING;
+    }
+
+    size_t hash = context.getOptions().getHash();
+    hashCombine(hash, implElement.getContentHash());
+    hashCombine(hash, nodedef.getContentHash());
+    hashCombine(hash, context.getSourceCodeSearchPath().asString());
+    return string(typeid(*this).name()) + ":" + getTarget() + ":" + nodedef.getName() + ":" + implElement.getName() + ":" + std::to_string(hash);
+}
+
 void ShaderGenerator::registerTypeDefs(const DocumentPtr& doc)
 {
     /// Load any struct type definitions from the document.
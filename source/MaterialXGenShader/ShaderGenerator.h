@@ -16,6 +16,7 @@
 #include <MaterialXGenShader/Factory.h>
 #include <MaterialXGenShader/ShaderGraphRefactor.h>
 #include <MaterialXGenShader/ShaderStage.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
 #include <MaterialXGenShader/Syntax.h>
 
 #include <MaterialXFormat/File.h>
@@ -47,6 +48,55 @@ class MX_GENSHADER_API ShaderGenerator
         return nullptr;
     }
 
+    /// Generate shaders for a batch of elements, distributing the work across
+    /// a pool of worker threads, and return the shaders in the order of the
+    /// given elements.  Each shader is named after its element.
+    ///
+    /// Each worker thread generates its shaders in a private copy of the given
+    /// context, with its own cache of node implementations, while the shader
+    /// generator and any user data in the context are shared between threads,
+    /// except for user data that the generator replaces in each worker context,
+    /// as described by initializeWorkerContext.
+    /// If the generator has a shared implementation cache, then implementations
+    /// initialized by one worker are reused by the others.
+    /// Type definitions and shader metadata should therefore be registered,
+    /// and light shaders bound, before this method is called, and user data
+    /// that is modified during generation, such as a resource binding context,
+    /// should not be present in the given context.
+    /// @param elements The elements from which shaders are generated.
+    /// @param context The context providing the options, search paths, and
+    ///    user data for generation.  The context itself is not modified.
+    /// @param threadCount The maximum number of threads to use.  A value of
+    ///    zero selects the number of hardware threads.  Defaults to one,
+    ///    generating shaders serially.
+    /// @throws The first exception thrown during the generation of any shader.
+    vector<ShaderPtr> generateBatch(const vector<ElementPtr>& elements, const GenContext& context,
+                                    unsigned int threadCount = 1) const;
+
+    /// Generate shaders for a batch of elements, as with generateBatch, and
+    /// share a single shader between all elements whose shaders have the same
+    /// structural hash, so that renderers need compile only one program for
+    /// each distinct structure.
+    ///
+    /// One instance is returned for each of the given elements, in the same
+    /// order, holding the shared shader and the uniform values of the element,
+    /// including the values of variables in the parameter blocks of the
+    /// generator.  Shared shaders are the shaders generated for the first
+    /// element with each structure.
+    /// @see Shader::getStructuralHash, getParameterBlocks
+    vector<ShaderInstance> generateInstances(const vector<ElementPtr>& elements, const GenContext& context,
+                                             unsigned int threadCount = 1) const;
+
+    /// Return the names of the input blocks in which shaders created by this
+    /// generator declare public inputs, such as the parameters of an MDL
+    /// material.  The values of these inputs are instance values, in the same
+    /// way as the values of uniforms.  Defaults to an empty set, for
+    /// generators that declare public inputs only as uniforms.
+    virtual StringSet getParameterBlocks() const
+    {
+        return StringSet();
+    }
+
     /// Start a new scope using the given bracket type.
     virtual void emitScopeBegin(ShaderStage& stage, Syntax::Punctuation punc = Syntax::CURLY_BRACKETS) const;
 
@@ -177,8 +227,45 @@ class MX_GENSHADER_API ShaderGenerator
     virtual ShaderNodeImplPtr createShaderNodeImplForImplementation(const Implementation& implementation) const;
 
     /// Return a registered shader node implementation for the given nodedef.
+    /// Implementations are cached in the given context, and in the shared
+    /// implementation cache of the generator if one has been set.
     virtual ShaderNodeImplPtr getImplementation(const NodeDef& nodedef, GenContext& context) const;
 
+    /// Set a shared cache of node implementations for this generator.
+    /// Implementations initialized by any context are stored in the cache,
+    /// and are reused by other contexts with the same generation options and
+    /// source search path, including contexts used concurrently on other
+    /// threads.  The cache should be cleared whenever the data libraries,
+    /// color management system or unit system of the generator are changed,
+    /// and should not be shared by contexts with differing reserved words.
+    /// Defaults to no shared cache.
+    void setImplementationCache(ShaderNodeImplCachePtr cache)
+    {
+        _implCache = cache;
+    }
+
+    /// Return the shared cache of node implementations for this generator.
+    ShaderNodeImplCachePtr getImplementationCache() const
+    {
+        return _implCache;
+    }
+
+    /// Set a shared cache of source code files for this generator.
+    /// Implementation and include files read by any context are stored in
+    /// the cache with their lines pre-split, and are reused by other contexts,
+    /// including contexts used concurrently on other threads.
+    /// Defaults to no shared cache.
+    void setSourceCodeCache(SourceCodeCachePtr cache)
+    {
+        _sourceCodeCache = cache;
+    }
+
+    /// Return the shared cache of source code files for this generator.
+    SourceCodeCachePtr getSourceCodeCache() const
+    {
+        return _sourceCodeCache;
+    }
+
     /// Sets the color management system
     void setColorManagementSystem(ColorManagementSystemPtr colorManagementSystem)
     {
@@ -267,6 +354,25 @@ class MX_GENSHADER_API ShaderGenerator
     /// nodes that require input data from the application.
     void createVariables(ShaderGraphPtr graph, GenContext& context, Shader& shader) const;
 
+    /// Return the key under which the implementation for the given element
+    /// is stored in the shared implementation cache, or an empty string if
+    /// the implementation should not be shared between contexts.
+    /// The default key combines the class and target of the generator, the
+    /// names and content hashes of the implementation and its nodedef, the
+    /// generation options, and the source search path of the context, so that
+    /// generators of different classes sharing a target, such as the GLSL and
+    /// Vulkan generators, never share implementations.  Light shader
+    /// implementations are not shared, since their graphs are modified when
+    /// they are bound.
+    /// Derived generators may override this method to exclude implementations
+    /// whose state is modified during code generation.
+    virtual string getImplementationCacheKey(const InterfaceElement& implElement, const NodeDef& nodedef, GenContext& context) const;
+
+    /// Initialize the private context of a worker thread in generateBatch.
+    /// Derived generators may override this method to replace user data
+    /// whose state is modified during code generation with private copies.
+    virtual void initializeWorkerContext(GenContext&) const { }
+
   protected:
     static const string T_FILE_TRANSFORM_UV;
     static const string LIGHTDATA_TYPEVAR_STRING;
@@ -276,10 +382,13 @@ class MX_GENSHADER_API ShaderGenerator
     Factory<ShaderNodeImpl> _implFactory;
     ColorManagementSystemPtr _colorManagementSystem;
     UnitSystemPtr _unitSystem;
-    mutable StringMap _tokenSubstitutions;
+    StringMap _tokenSubstitutions;
     vector<ShaderGraphRefactorPtr> _refactors;
+    ShaderNodeImplCachePtr _implCache;
+    SourceCodeCachePtr _sourceCodeCache;
 
     friend ShaderGraph;
+    friend class ShaderCache;
 };
 
 MATERIALX_NAMESPACE_END
@@ -10,6 +10,8 @@
 #include <MaterialXGenShader/Shader.h>
 #include <MaterialXGenShader/ShaderNode.h>
 
+#include <mutex>
+
 MATERIALX_NAMESPACE_BEGIN
 
 //
@@ -93,4 +95,33 @@ ShaderNodeImplPtr NopNode::create()
     return std::make_shared<NopNode>();
 }
 
+//
+// ShaderNodeImplCache methods
+//
+
+ShaderNodeImplPtr ShaderNodeImplCache::find(const string& key) const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    auto it = _impls.find(key);
+    return it != _impls.end() ? it->second : nullptr;
+}
+
+ShaderNodeImplPtr ShaderNodeImplCache::add(const string& key, ShaderNodeImplPtr impl)
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    return _impls.emplace(key, impl).first->second;
+}
+
+size_t ShaderNodeImplCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _impls.size();
+}
+
+void ShaderNodeImplCache::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _impls.clear();
+}
+
 MATERIALX_NAMESPACE_END
@@ -15,6 +15,9 @@
 #include <MaterialXGenShader/TypeDesc.h>
 #include <MaterialXCore/Util.h>
 
+#include <shared_mutex>
+#include <unordered_map>
+
 MATERIALX_NAMESPACE_BEGIN
 
 class InterfaceElement;
@@ -24,6 +27,9 @@ using ShaderGraphInputSocket = ShaderOutput;
 /// Shared pointer to a ShaderNodeImpl
 using ShaderNodeImplPtr = shared_ptr<class ShaderNodeImpl>;
 
+/// Shared pointer to a ShaderNodeImplCache
+using ShaderNodeImplCachePtr = shared_ptr<class ShaderNodeImplCache>;
+
 /// @class ShaderNodeImpl
 /// Class handling the shader generation implementation for a node.
 /// Responsible for emitting the function definition and function call
@@ -118,6 +124,48 @@ class MX_GENSHADER_API NopNode : public ShaderNodeImpl
     static ShaderNodeImplPtr create();
 };
 
+/// @class ShaderNodeImplCache
+/// A thread-safe cache of initialized shader node implementations.
+///
+/// A cache may be attached to a shader generator, allowing implementations
+/// to be shared by all contexts that generate code with that generator,
+/// rather than being initialized again for every new context.  Entries are
+/// stored under keys returned by ShaderGenerator::getImplementationCacheKey,
+/// which identify an implementation element together with the generation
+/// state that its initialization depends on.
+class MX_GENSHADER_API ShaderNodeImplCache
+{
+  public:
+    ShaderNodeImplCache() { }
+    ~ShaderNodeImplCache() { }
+
+    /// Create a new implementation cache.
+    static ShaderNodeImplCachePtr create()
+    {
+        return std::make_shared<ShaderNodeImplCache>();
+    }
+
+    /// Return the implementation stored under the given key, if any.
+    ShaderNodeImplPtr find(const string& key) const;
+
+    /// Store an implementation under the given key, and return the
+    /// implementation that is cached for the key.  If an implementation
+    /// was already stored under the key, e.g. by another thread, then
+    /// the cache is unchanged and the existing implementation is returned.
+    ShaderNodeImplPtr add(const string& key, ShaderNodeImplPtr impl);
+
+    /// Return the number of implementations in the cache.
+    size_t size() const;
+
+    /// Remove all implementations from the cache.  This should be called
+    /// whenever the data libraries used for shader generation are modified.
+    void clear();
+
+  private:
+    mutable std::shared_mutex _mutex;
+    std::unordered_map<string, ShaderNodeImplPtr> _impls;
+};
+
 MATERIALX_NAMESPACE_END
 
 #endif
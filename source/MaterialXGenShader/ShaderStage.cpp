@@ -313,50 +313,51 @@ void ShaderStage::addComment(const string& str)
 
 void ShaderStage::addBlock(const string& str, const FilePath& sourceFilename, GenContext& context)
 {
-    const string& INCLUDE = _syntax->getIncludeStatement();
-    const string& QUOTE   = _syntax->getStringQuote();
-
-    // Add each line in the block separately to get correct indentation.
-    StringStream stream(str);
-    for (string line; std::getline(stream, line);)
+    // Reuse the lines of a cached source file if the block holds its contents.
+    const ShaderGenerator& shadergen = context.getShaderGenerator();
+    SourceCodeCachePtr cache = shadergen.getSourceCodeCache();
+    ConstSourceCodeBlockPtr block = (cache && !sourceFilename.isEmpty()) ? cache->find(sourceFilename, shadergen) : nullptr;
+    if (!block || block->getText() != str)
     {
-        size_t pos = line.find(INCLUDE);
-        if (pos != string::npos)
-        {
-            size_t startQuote = line.find_first_of(QUOTE);
-            size_t endQuote = line.find_last_of(QUOTE);
-            if (startQuote != string::npos && endQuote != string::npos && endQuote > startQuote)
-            {
-                size_t length = (endQuote - startQuote) - 1;
-                if (length)
-                {
-                    const string filename = line.substr(startQuote + 1, length);
-                    addInclude(filename, sourceFilename, context);
-                }
-            }
-        }
-        else
-        {
-            addLine(line, false);
-        }
+        block = SourceCodeBlock::create(str, *_syntax);
     }
+    addSourceCode(*block, sourceFilename, context);
 }
 
 void ShaderStage::addInclude(const FilePath& includeFilename, const FilePath& sourceFilename, GenContext& context)
 {
     string modifiedFile = includeFilename;
-    tokenSubstitution(context.getShaderGenerator().getTokenSubstitutions(), modifiedFile);
+    tokenSubstitution(context.getTokenSubstitutions(), modifiedFile);
     FilePath resolvedFile = context.resolveSourceFile(modifiedFile, sourceFilename.getParentPath());
 
     if (!_includes.count(resolvedFile))
     {
-        string content = readFile(resolvedFile);
-        if (content.empty())
+        const ShaderGenerator& shadergen = context.getShaderGenerator();
+        SourceCodeCachePtr cache = shadergen.getSourceCodeCache();
+        ConstSourceCodeBlockPtr block = cache ? cache->get(resolvedFile, shadergen) : SourceCodeBlock::read(resolvedFile, *_syntax);
+        if (!block)
         {
             throw ExceptionShaderGenError("Could not find include file: '" + includeFilename.asString() + "'");
         }
         _includes.insert(resolvedFile);
-        addBlock(content, resolvedFile, context);
+        addSourceCode(*block, resolvedFile, context);
+    }
+}
+
+void ShaderStage::addSourceCode(const SourceCodeBlock& block, const FilePath& sourceFilename, GenContext& context)
+{
+    // Add each line in the block separately to get correct indentation.
+    const StringVec& lines = block.getLines();
+    for (size_t i = 0; i < lines.size(); i++)
+    {
+        if (block.isInclude(i))
+        {
+            addInclude(lines[i], sourceFilename, context);
+        }
+        else
+        {
+            addLine(lines[i], false);
+        }
     }
 }
 
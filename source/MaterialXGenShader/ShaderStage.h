@@ -13,6 +13,7 @@
 
 #include <MaterialXGenShader/GenOptions.h>
 #include <MaterialXGenShader/ShaderGraph.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
 #include <MaterialXGenShader/Syntax.h>
 
 #include <MaterialXFormat/File.h>
@@ -295,6 +296,10 @@ class MX_GENSHADER_API ShaderStage
         _functionName = functionName;
     }
 
+  private:
+    /// Add the lines of a block of code, and the contents of its include files.
+    void addSourceCode(const SourceCodeBlock& block, const FilePath& sourceFilename, GenContext& context);
+
   private:
     /// Name of the stage
     const string _name;
@@ -0,0 +1,129 @@
+//
+// Copyright Contributors to the MaterialX Project
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#include <MaterialXGenShader/SourceCodeCache.h>
+
+#include <MaterialXGenShader/ShaderGenerator.h>
+#include <MaterialXGenShader/Syntax.h>
+
+#include <MaterialXFormat/Util.h>
+
+#include <mutex>
+
+MATERIALX_NAMESPACE_BEGIN
+
+namespace
+{
+
+string getCacheKey(const FilePath& filename, const ShaderGenerator& shadergen)
+{
+    return shadergen.getTarget() + ":" + filename.asString();
+}
+
+} // anonymous namespace
+
+//
+// SourceCodeBlock methods
+//
+
+ConstSourceCodeBlockPtr SourceCodeBlock::create(const string& text, const Syntax& syntax)
+{
+    const string& INCLUDE = syntax.getIncludeStatement();
+    const string& QUOTE = syntax.getStringQuote();
+
+    shared_ptr<SourceCodeBlock> block = std::make_shared<SourceCodeBlock>();
+    block->_text = text;
+
+    size_t lineStart = 0;
+    while (lineStart < text.size())
+    {
+        size_t lineEnd = text.find('\n', lineStart);
+        if (lineEnd == string::npos)
+        {
+            lineEnd = text.size();
+        }
+        string line = text.substr(lineStart, lineEnd - lineStart);
+        lineStart = lineEnd + 1;
+
+        if (line.find(INCLUDE) != string::npos)
+        {
+            // Lines with an include directive are kept only if they name a file.
+            size_t startQuote = line.find_first_of(QUOTE);
+            size_t endQuote = line.find_last_of(QUOTE);
+            if (startQuote != string::npos && endQuote != string::npos && endQuote > startQuote + 1)
+            {
+                block->_lines.push_back(line.substr(startQuote + 1, endQuote - startQuote - 1));
+                block->_includes.push_back(true);
+            }
+        }
+        else
+        {
+            block->_lines.push_back(line);
+            block->_includes.push_back(false);
+        }
+    }
+
+    return block;
+}
+
+ConstSourceCodeBlockPtr SourceCodeBlock::read(const FilePath& filename, const Syntax& syntax)
+{
+    string text = readFile(filename);
+    return text.empty() ? nullptr : create(text, syntax);
+}
+
+//
+// SourceCodeCache methods
+//
+
+ConstSourceCodeBlockPtr SourceCodeCache::get(const FilePath& filename, const ShaderGenerator& shadergen)
+{
+    const string key = getCacheKey(filename, shadergen);
+    const bool validate = _validateModificationTimes;
+    const int64_t modificationTime = validate ? filename.getModificationTime() : 0;
+    {
+        std::shared_lock<std::shared_mutex> lock(_mutex);
+        auto it = _entries.find(key);
+        if (it != _entries.end() && (!validate || it->second.modificationTime == modificationTime))
+        {
+            return it->second.block;
+        }
+    }
+
+    // Read the file outside of the lock, so that other files may be
+    // accessed concurrently.
+    Entry entry;
+    entry.modificationTime = validate ? modificationTime : filename.getModificationTime();
+    entry.block = SourceCodeBlock::read(filename, shadergen.getSyntax());
+    if (!entry.block)
+    {
+        return nullptr;
+    }
+
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _entries[key] = entry;
+    return entry.block;
+}
+
+ConstSourceCodeBlockPtr SourceCodeCache::find(const FilePath& filename, const ShaderGenerator& shadergen) const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    auto it = _entries.find(getCacheKey(filename, shadergen));
+    return it != _entries.end() ? it->second.block : nullptr;
+}
+
+size_t SourceCodeCache::size() const
+{
+    std::shared_lock<std::shared_mutex> lock(_mutex);
+    return _entries.size();
+}
+
+void SourceCodeCache::clear()
+{
+    std::unique_lock<std::shared_mutex> lock(_mutex);
+    _entries.clear();
+}
+
+MATERIALX_NAMESPACE_END
@@ -0,0 +1,143 @@
+//
+// Copyright Contributors to the MaterialX Project
+// SPDX-License-Identifier: Apache-2.0
+//
+
+#ifndef MATERIALX_SOURCECODECACHE_H
+#define MATERIALX_SOURCECODECACHE_H
+
+/// @file
+/// Cache of source code files used in shader generation
+
+#include <MaterialXGenShader/Export.h>
+#include <MaterialXGenShader/Library.h>
+
+#include <MaterialXFormat/File.h>
+
+#include <atomic>
+#include <shared_mutex>
+#include <unordered_map>
+
+MATERIALX_NAMESPACE_BEGIN
+
+class SourceCodeBlock;
+class Syntax;
+
+/// Shared pointer to a constant SourceCodeBlock
+using ConstSourceCodeBlockPtr = shared_ptr<const SourceCodeBlock>;
+
+/// Shared pointer to a SourceCodeCache
+using SourceCodeCachePtr = shared_ptr<class SourceCodeCache>;
+
+/// @class SourceCodeBlock
+/// A block of source code split into lines, with the include directives
+/// of a shading language syntax parsed out.
+class MX_GENSHADER_API SourceCodeBlock
+{
+  public:
+    /// Create a block from the given source code, recognizing the include
+    /// directives of the given syntax.
+    static ConstSourceCodeBlockPtr create(const string& text, const Syntax& syntax);
+
+    /// Read a block from the given source code file, recognizing the include
+    /// directives of the given syntax.
+    /// @return The new block, or nullptr if the file could not be read or
+    ///    was empty.
+    static ConstSourceCodeBlockPtr read(const FilePath& filename, const Syntax& syntax);
+
+    /// Return the source code of the block.
+    const string& getText() const
+    {
+        return _text;
+    }
+
+    /// Return the lines of the block.  Lines holding an include directive
+    /// are replaced by the filename that they include.
+    const StringVec& getLines() const
+    {
+        return _lines;
+    }
+
+    /// Return true if the line with the given index holds an include directive.
+    bool isInclude(size_t index) const
+    {
+        return _includes[index];
+    }
+
+  private:
+    string _text;
+    StringVec _lines;
+    vector<bool> _includes;
+};
+
+/// @class SourceCodeCache
+/// A thread-safe cache of the source code files read during shader generation.
+///
+/// A cache may be attached to a shader generator, so that each implementation
+/// and include file is read and split into lines once, rather than for every
+/// shader in which it is used.  Files are stored under their resolved paths
+/// and the target of the generator that reads them, so a single cache may be
+/// shared by generators for different targets.
+class MX_GENSHADER_API SourceCodeCache
+{
+  public:
+    SourceCodeCache() :
+        _validateModificationTimes(false)
+    {
+    }
+    ~SourceCodeCache() { }
+
+    /// Create a new source code cache.
+    static SourceCodeCachePtr create()
+    {
+        return std::make_shared<SourceCodeCache>();
+    }
+
+    /// Set whether cached files are validated against the modification times
+    /// of the files on disk, causing changed files to be read again.
+    /// Defaults to false.
+    void setValidateModificationTimes(bool validate)
+    {
+        _validateModificationTimes = validate;
+    }
+
+    /// Return true if cached files are validated against the modification
+    /// times of the files on disk.
+    bool getValidateModificationTimes() const
+    {
+        return _validateModificationTimes;
+    }
+
+    /// Return the contents of the given resolved file, as read by the given
+    /// shader generator, reading the file and caching its contents if needed.
+    /// @return The contents of the file, or nullptr if the file could not be
+    ///    read or was empty.
+    ConstSourceCodeBlockPtr get(const FilePath& filename, const ShaderGenerator& shadergen);
+
+    /// Return the cached contents of the given resolved file, as read by the
+    /// given shader generator, without accessing the file system.
+    /// @return The cached contents of the file, or nullptr if the file is not
+    ///    present in the cache.
+    ConstSourceCodeBlockPtr find(const FilePath& filename, const ShaderGenerator& shadergen) const;
+
+    /// Return the number of files in the cache.
+    size_t size() const;
+
+    /// Remove all files from the cache.
+    void clear();
+
+  private:
+    struct Entry
+    {
+        ConstSourceCodeBlockPtr block;
+        int64_t modificationTime;
+    };
+
+    std::atomic<bool> _validateModificationTimes;
+    mutable std::shared_mutex _mutex;
+    std::unordered_map<string, Entry> _entries;
+};
+
+MATERIALX_NAMESPACE_END
+
+#endif
@@ -201,14 +201,14 @@ ShaderPtr SlangShaderGenerator::generate(const string& name, ElementPtr element,
         }
     }
     emitVertexStage(shader->getGraph(), context, vs);
-    replaceTokens(_tokenSubstitutions, vs);
+    replaceTokens(context.getTokenSubstitutions(), vs);
     SlangSyntaxFromGlsl(vs);
 
     // Emit code for pixel shader stage
     ShaderStage& ps = shader->getStage(Stage::PIXEL);
     setDataSemantics(ps.getInputBlock(HW::VERTEX_DATA));
     emitPixelStage(shader->getGraph(), context, ps);
-    replaceTokens(_tokenSubstitutions, ps);
+    replaceTokens(context.getTokenSubstitutions(), ps);
     SlangSyntaxFromGlsl(ps);
 
     return shader;
@@ -518,14 +518,14 @@ void SlangShaderGenerator::emitPixelStage(const ShaderGraph& graph, GenContext&
     // depending on the vertical flip flag.
     if (context.getOptions().fileTextureVerticalFlip)
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "mx_transform_uv_vflip.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "mx_transform_uv_vflip.glsl");
     }
     else
     {
-        _tokenSubstitutions[ShaderGenerator::T_FILE_TRANSFORM_UV] = "mx_transform_uv.glsl";
+        context.setTokenSubstitution(ShaderGenerator::T_FILE_TRANSFORM_UV, "mx_transform_uv.glsl");
     }
 
-    _tokenSubstitutions[HW::T_TEX_SAMPLER_SIGNATURE] = "SamplerTexture2D tex_sampler";
+    context.setTokenSubstitution(HW::T_TEX_SAMPLER_SIGNATURE, "SamplerTexture2D tex_sampler");
 
     emitLightFunctionDefinitions(graph, context, stage);
 
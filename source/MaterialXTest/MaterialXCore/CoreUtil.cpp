@@ -51,6 +51,55 @@ TEST_CASE("String utilities", "[coreutil]")
     REQUIRE(!mx::stringEndsWith("testName", "test"));
 }
 
+TEST_CASE("String interning", "[coreutil]")
+{
+    const std::string& interned = mx::internString("nodename");
+    REQUIRE(interned == "nodename");
+    REQUIRE(&mx::internString(std::string("node") + "name") == &interned);
+    REQUIRE(&mx::internString("nodegraph") != &interned);
+
+    // Categories and attribute names are interned, while element names and
+    // attribute values are owned by their elements.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodePtr node1 = doc->addNode("image", "image1");
+    mx::NodePtr node2 = doc->addNode("image", "image2");
+    REQUIRE(&node1->getCategory() == &node2->getCategory());
+    node1->setAttribute("custom", "value1");
+    node2->setAttribute("custom", "value2");
+    REQUIRE(node1->getAttributeNames() == node2->getAttributeNames());
+    REQUIRE(node1->getAttribute(mx::internString("custom")) == "value1");
+    node2->setName("image1_copy");
+    REQUIRE(node2->getName() == "image1_copy");
+    REQUIRE(&node2->getName() != &mx::internString("image1_copy"));
+}
+
+TEST_CASE("Parallel utilities", "[coreutil]")
+{
+    for (unsigned int threadCount : { 0u, 1u, 4u })
+    {
+        std::vector<int> results(1000, 0);
+        mx::parallelFor(results.size(), threadCount, [&results](size_t i)
+        {
+            results[i] = (int) i * 2;
+        });
+        for (size_t i = 0; i < results.size(); i++)
+        {
+            REQUIRE(results[i] == (int) i * 2);
+        }
+    }
+
+    // Exceptions are propagated to the calling thread.
+    auto throwingFunc = [](size_t i)
+    {
+        if (i == 10)
+        {
+            throw mx::Exception("Parallel exception");
+        }
+    };
+    REQUIRE_THROWS_AS(mx::parallelFor(100, 4, throwingFunc), mx::Exception);
+    REQUIRE_THROWS_AS(mx::parallelFor(100, 1, throwingFunc), mx::Exception);
+}
+
 TEST_CASE("Print utilities", "[coreutil]")
 {
     // Create a document.
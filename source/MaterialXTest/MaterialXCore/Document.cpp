@@ -6,6 +6,7 @@
 #include <MaterialXTest/External/Catch/catch.hpp>
 
 #include <MaterialXCore/Document.h>
+#include <MaterialXCore/Util.h>
 #include <MaterialXFormat/File.h>
 #include <MaterialXFormat/Util.h>
 #include <MaterialXFormat/XmlIo.h>
@@ -272,6 +273,84 @@ TEST_CASE("Document equivalence", "[document]")
     REQUIRE(!equivalent);
 }
 
+TEST_CASE("Content hashing", "[document]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodeGraphPtr graph = doc->addNodeGraph("graph1");
+    mx::NodePtr constant = graph->addNode("constant", "constant1", "color3");
+    constant->setInputValue("value", mx::Color3(0.5f, 0.25f, 1.0f));
+    mx::NodePtr image = graph->addNode("image", "image1", "color3");
+    mx::NodePtr multiply = graph->addNode("multiply", "multiply1", "color3");
+    multiply->setConnectedNode("in1", constant);
+    multiply->setConnectedNode("in2", image);
+    graph->addOutput("out", "color3")->setConnectedNode(multiply);
+
+    // Copies of a document have equal hashes, at every level of the tree.
+    mx::DocumentPtr doc2 = doc->copy();
+    const uint64_t docHash = doc->getContentHash();
+    REQUIRE(docHash == doc2->getContentHash());
+    REQUIRE(constant->getContentHash() == doc2->getDescendant("graph1/constant1")->getContentHash());
+    REQUIRE(constant->getContentHash() != image->getContentHash());
+
+    // Hashes are independent of attribute order and of the order of the
+    // children of compound graphs, but depend on names.
+    mx::NodePtr constant2 = doc2->getDescendant("graph1/constant1")->asA<mx::Node>();
+    constant2->setType("color3");
+    constant2->getInput("value")->setValueString("0.5, 0.25, 1");
+    doc2->getNodeGraph("graph1")->setChildIndex("image1", 0);
+    REQUIRE(doc->isEquivalent(doc2, mx::ElementEquivalenceOptions()));
+    REQUIRE(doc2->getContentHash() == docHash);
+    constant2->setName("constant2");
+    REQUIRE(doc2->getContentHash() != docHash);
+    constant2->setName("constant1");
+    REQUIRE(doc2->getContentHash() == docHash);
+
+    // Edits invalidate the cached hashes of the edited element and its
+    // ancestors, leaving those of unrelated elements intact.
+    const uint64_t imageHash = image->getContentHash();
+    constant->setInputValue("value", mx::Color3(1.0f));
+    REQUIRE(doc->getContentHash() != docHash);
+    REQUIRE(image->getContentHash() == imageHash);
+    constant->setInputValue("value", mx::Color3(0.5f, 0.25f, 1.0f));
+    REQUIRE(doc->getContentHash() == docHash);
+    mx::NodePtr added = graph->addNode("add", "add1", "color3");
+    REQUIRE(doc->getContentHash() != docHash);
+    graph->removeNode(added->getName());
+    REQUIRE(doc->getContentHash() == docHash);
+
+    // Values are hashed in their formatted form when performing value
+    // comparisons, with the given float precision.
+    mx::InputPtr value1 = graph->addInput("value1", "vector2");
+    value1->setValueString("  1.0,   0.012345608 ");
+    value1->setAttribute(mx::ValueElement::UI_MIN_ATTRIBUTE, " 00.0, 0.0");
+    mx::InputPtr value2 = doc2->getNodeGraph("graph1")->addInput("value1", "vector2");
+    value2->setAttribute(mx::ValueElement::UI_MIN_ATTRIBUTE, "0, 0");
+    value2->setValueString("1, 0.012345611");
+    mx::ElementEquivalenceOptions options;
+    REQUIRE(value1->getContentHash(options) == value2->getContentHash(options));
+    REQUIRE(doc->getContentHash(options) == doc2->getContentHash(options));
+    options.floatPrecision = 8;
+    REQUIRE(!value1->isEquivalent(value2, options));
+    REQUIRE(value1->getContentHash(options) != value2->getContentHash(options));
+    options.performValueComparisons = false;
+    REQUIRE(value1->getContentHash(options) != value2->getContentHash(options));
+    graph->removeInput("value1");
+    doc2->getNodeGraph("graph1")->removeInput("value1");
+    REQUIRE(doc->getContentHash() == docHash);
+
+    // Comments do not contribute to hashes.
+    doc->addChildOfCategory(mx::CommentElement::CATEGORY)->setDocString("Comment");
+    REQUIRE(doc->getContentHash() == docHash);
+
+    // Excluded attributes do not contribute to hashes.
+    options = mx::ElementEquivalenceOptions();
+    options.attributeExclusionList = { mx::Element::XPOS_ATTRIBUTE, mx::Element::YPOS_ATTRIBUTE };
+    const uint64_t layoutHash = doc->getContentHash(options);
+    multiply->setAttribute(mx::Element::XPOS_ATTRIBUTE, "10");
+    REQUIRE(doc->getContentHash(options) == layoutHash);
+    REQUIRE(doc->getContentHash() != docHash);
+}
+
 TEST_CASE("Document createValidChildName", "[document]")
 {
     // Create a custom library.
@@ -359,3 +438,506 @@ TEST_CASE("Document createValidChildName", "[document]")
         REQUIRE(!doc->createValidChildName("").empty());
     }
 }
+
+TEST_CASE("Frozen documents", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+
+    // Load the data libraries twice, freezing the second copy.
+    mx::DocumentPtr library = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, library);
+    mx::DocumentPtr frozenLibrary = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, frozenLibrary);
+    REQUIRE(!frozenLibrary->isFrozen());
+    frozenLibrary->freeze();
+    REQUIRE(frozenLibrary->isFrozen());
+
+    // Verify that nodedef resolution is unchanged by freezing.
+    std::vector<mx::NodePtr> nodes;
+    for (mx::NodeGraphPtr graph : library->getNodeGraphs())
+    {
+        for (mx::NodePtr node : graph->getNodes())
+        {
+            nodes.push_back(node);
+        }
+    }
+    REQUIRE(!nodes.empty());
+    auto getName = [](mx::NodeDefPtr nodeDef)
+    {
+        return nodeDef ? nodeDef->getName() : std::string();
+    };
+    for (mx::NodePtr node : nodes)
+    {
+        mx::NodePtr frozenNode = frozenLibrary->getDescendant(node->getNamePath())->asA<mx::Node>();
+        REQUIRE(frozenNode);
+        for (const std::string& target : { std::string(), std::string("genglsl") })
+        {
+            REQUIRE(getName(frozenNode->getNodeDef(target)) == getName(node->getNodeDef(target)));
+            REQUIRE(getName(frozenNode->getNodeDef(target, true)) == getName(node->getNodeDef(target, true)));
+        }
+    }
+    REQUIRE(frozenLibrary->getMatchingNodeDefs("image").size() == library->getMatchingNodeDefs("image").size());
+    REQUIRE(frozenLibrary->getMatchingImplementations("ND_image_color3").size() ==
+            library->getMatchingImplementations("ND_image_color3").size());
+
+    // Matching definitions are returned as views of cached vectors.
+    mx::DocumentPtr doc = mx::createDocument();
+    doc->setDataLibrary(frozenLibrary);
+    REQUIRE(&doc->getMatchingNodeDefs("image") == &frozenLibrary->getMatchingNodeDefs("image"));
+    REQUIRE(&doc->getMatchingImplementations("ND_image_color3") == &frozenLibrary->getMatchingImplementations("ND_image_color3"));
+    REQUIRE(doc->getMatchingNodeDefs("custom").empty());
+
+    // Resolve nodedefs concurrently through a shared frozen data library.
+    mx::NodePtr image = doc->addNode("image", "image1", "color3");
+    mx::NodePtr mix = doc->addNode("mix", "mix1", "float");
+    std::vector<mx::NodeDefPtr> results(64);
+    mx::parallelFor(results.size(), 4, [&](size_t i)
+    {
+        results[i] = (i % 2 ? mix : image)->getNodeDef();
+    });
+    for (size_t i = 0; i < results.size(); i++)
+    {
+        REQUIRE(results[i] == frozenLibrary->getNodeDef(i % 2 ? "ND_mix_float" : "ND_image_color3"));
+    }
+
+    // Verify that frozen documents cannot be modified.
+    mx::NodeDefPtr nodeDef = frozenLibrary->getNodeDef("ND_image_color3");
+    REQUIRE_THROWS_AS(frozenLibrary->addNodeDef("ND_custom", "float", "custom"), mx::Exception);
+    REQUIRE_THROWS_AS(nodeDef->setAttribute("custom", "value"), mx::Exception);
+    REQUIRE_THROWS_AS(nodeDef->removeChild("file"), mx::Exception);
+    REQUIRE(nodeDef->getInput("file"));
+    REQUIRE(!frozenLibrary->getNodeDef("ND_custom"));
+
+    // Copies of frozen documents may be modified.
+    mx::DocumentPtr copy = frozenLibrary->copy();
+    REQUIRE(!copy->isFrozen());
+    copy->addNodeDef("ND_custom", "float", "custom");
+    REQUIRE(copy->getMatchingNodeDefs("custom").size() == 1);
+
+    // Definitions in both a document and its data library are merged, with
+    // those of the data library first, until either document is modified.
+    mx::NodeDefPtr localNodeDef = doc->addNodeDef("ND_image_local", "float", "image");
+    const std::vector<mx::NodeDefPtr>& merged = doc->getMatchingNodeDefs("image");
+    REQUIRE(merged.size() == frozenLibrary->getMatchingNodeDefs("image").size() + 1);
+    REQUIRE(merged.back() == localNodeDef);
+    REQUIRE(&doc->getMatchingNodeDefs("image") == &merged);
+    doc->removeNodeDef(localNodeDef->getName());
+    REQUIRE(&doc->getMatchingNodeDefs("image") == &frozenLibrary->getMatchingNodeDefs("image"));
+    doc->addNodeDef("ND_image_local2", "float", "image");
+    REQUIRE(doc->getMatchingNodeDefs("image").back()->getName() == "ND_image_local2");
+}
+
+TEST_CASE("Incremental cache updates", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+
+    // Verify that incremental cache results match those of a full rebuild.
+    const std::vector<std::string> nodeNames = { "image", "custom", "ns:custom", "add" };
+    const std::vector<std::string> nodeDefNames = { "ND_image_color3", "ND_custom", "ns:ND_custom" };
+    const std::vector<std::string> portNames = { "image1", "add1", "ns:add1" };
+    auto verifyCache = [&]()
+    {
+        std::vector<std::vector<mx::ElementPtr>> incremental, rebuilt;
+        for (int pass = 0; pass < 2; pass++)
+        {
+            std::vector<std::vector<mx::ElementPtr>>& results = pass ? rebuilt : incremental;
+            for (const std::string& name : nodeNames)
+            {
+                auto nodeDefs = doc->getMatchingNodeDefs(name);
+                results.emplace_back(nodeDefs.begin(), nodeDefs.end());
+            }
+            for (const std::string& name : nodeDefNames)
+            {
+                auto impls = doc->getMatchingImplementations(name);
+                results.emplace_back(impls.begin(), impls.end());
+            }
+            for (const std::string& name : portNames)
+            {
+                auto ports = doc->getMatchingPorts(name);
+                results.emplace_back(ports.begin(), ports.end());
+            }
+            if (!pass)
+            {
+                doc->invalidateCache();
+            }
+        }
+        REQUIRE(incremental == rebuilt);
+    };
+    verifyCache();
+
+    // Add definitions, including one that precedes existing definitions.
+    mx::NodeDefPtr customNodeDef = doc->addNodeDef("ND_custom", "float", "custom");
+    REQUIRE(doc->getMatchingNodeDefs("custom").size() == 1);
+    mx::NodeDefPtr imageNodeDef = doc->addNodeDef("ND_image_custom", "float", "image");
+    doc->setChildIndex(imageNodeDef->getName(), 0);
+    REQUIRE(doc->getMatchingNodeDefs("image")[0] == imageNodeDef);
+    mx::ImplementationPtr impl = doc->addImplementation("IM_custom");
+    impl->setNodeDef(customNodeDef);
+    REQUIRE(doc->getMatchingImplementations("ND_custom").size() == 1);
+    verifyCache();
+
+    // Modify keys and namespaces.
+    customNodeDef->addInput("in", "float");
+    imageNodeDef->setNodeString("custom");
+    REQUIRE(doc->getMatchingNodeDefs("custom").size() == 2);
+    customNodeDef->setNamespace("ns");
+    impl->setNamespace("ns");
+    REQUIRE(doc->getMatchingNodeDefs("ns:custom").size() == 1);
+    verifyCache();
+
+    // Add and modify connections.
+    mx::NodeGraphPtr graph = doc->addNodeGraph();
+    mx::NodePtr image = graph->addNode("image", "image1", "color3");
+    mx::NodePtr add = graph->addNode("add", "add1", "color3");
+    mx::InputPtr input = add->addInput("in1", "color3");
+    input->setNodeName("image1");
+    REQUIRE(doc->getMatchingPorts("image1").size() == 1);
+    mx::OutputPtr output = graph->addOutput("out", "color3");
+    output->setNodeName("add1");
+    verifyCache();
+    input->setNodeName("add1");
+    graph->setNamespace("ns");
+    REQUIRE(doc->getMatchingPorts("ns:add1").size() == 2);
+    verifyCache();
+
+    // Copy and clear content.
+    mx::NodeGraphPtr graphCopy = doc->addNodeGraph();
+    graphCopy->copyContentFrom(graph);
+    REQUIRE(doc->getMatchingPorts("ns:add1").size() == 4);
+    verifyCache();
+    graphCopy->clearContent();
+    REQUIRE(doc->getMatchingPorts("ns:add1").size() == 2);
+    verifyCache();
+
+    // Remove elements, and modify a removed element.
+    doc->removeNodeGraph(graph->getName());
+    doc->removeNodeDef(customNodeDef->getName());
+    REQUIRE(doc->getMatchingPorts("ns:add1").empty());
+    REQUIRE(doc->getMatchingNodeDefs("ns:custom").empty());
+    customNodeDef->setNodeString("image");
+    REQUIRE(doc->getMatchingNodeDefs("image")[0] != customNodeDef);
+    verifyCache();
+}
+
+TEST_CASE("Name path index", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    REQUIRE(!doc->isNamePathIndexEnabled());
+
+    // Verify that every element resolves through its name path.
+    auto verifyIndex = [&doc]()
+    {
+        mx::StringVec namePaths;
+        mx::ElementVec elements;
+        for (mx::ElementPtr elem : doc->traverseTree())
+        {
+            if (elem != doc)
+            {
+                namePaths.push_back(elem->getNamePath());
+                elements.push_back(elem);
+                REQUIRE(doc->getDescendant(namePaths.back()) == elem);
+            }
+        }
+        REQUIRE(doc->getDescendants(namePaths) == elements);
+    };
+
+    // Enable the index on a populated document.
+    doc->setNamePathIndexEnabled(true);
+    REQUIRE(doc->isNamePathIndexEnabled());
+    verifyIndex();
+
+    // Add elements and subtrees.
+    mx::NodeGraphPtr graph = doc->addNodeGraph("graph1");
+    mx::NodePtr image = graph->addNode("image", "image1", "color3");
+    image->setInputValue("uaddressmode", std::string("periodic"));
+    REQUIRE(doc->getDescendant("graph1/image1/uaddressmode") == image->getInput("uaddressmode"));
+    mx::DocumentPtr imported = mx::createDocument();
+    mx::readFromXmlFile(imported, "resources/Materials/Examples/StandardSurface/standard_surface_marble_solid.mtlx", searchPath);
+    doc->importLibrary(imported);
+    verifyIndex();
+
+    // Rename an element with descendants.
+    graph->setName("graph2");
+    REQUIRE(!doc->getDescendant("graph1"));
+    REQUIRE(!doc->getDescendant("graph1/image1/uaddressmode"));
+    REQUIRE(doc->getDescendant("graph2/image1/uaddressmode") == image->getInput("uaddressmode"));
+    verifyIndex();
+
+    // Change categories and reorder children.
+    mx::ElementPtr changed = graph->changeChildCategory(image, "constant");
+    REQUIRE(doc->getDescendant("graph2/image1") == changed);
+    graph->addNode("noise3d", "noise1", "float");
+    graph->setChildIndex("noise1", 0);
+    verifyIndex();
+
+    // Remove elements and clear content.
+    doc->removeNodeGraph("graph2");
+    REQUIRE(!doc->getDescendant("graph2"));
+    REQUIRE(!doc->getDescendant("graph2/noise1"));
+    mx::NodeDefPtr nodeDef = doc->getNodeDef("ND_image_color3");
+    nodeDef->clearContent();
+    REQUIRE(doc->getDescendant("ND_image_color3") == nodeDef);
+    REQUIRE(!doc->getDescendant("ND_image_color3/file"));
+    verifyIndex();
+
+    // Resolve relative, empty, non-canonical and missing paths.
+    mx::NodeDefPtr mixNodeDef = doc->getNodeDef("ND_mix_float");
+    mx::StringVec namePaths = { "fg", "", "/fg", "missing", "fg/missing" };
+    mx::ElementVec expected = { mixNodeDef->getInput("fg"), mixNodeDef, mixNodeDef->getInput("fg"), nullptr, nullptr };
+    REQUIRE(mixNodeDef->getDescendants(namePaths) == expected);
+    REQUIRE(doc->getDescendant("") == doc);
+    REQUIRE(doc->getDescendant("/ND_mix_float//fg/") == mixNodeDef->getInput("fg"));
+
+    // Disabled indices resolve paths by traversal.
+    doc->setNamePathIndexEnabled(false);
+    REQUIRE(mixNodeDef->getDescendants(namePaths) == expected);
+    verifyIndex();
+}
+
+TEST_CASE("Validation diagnostics", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+
+    // Create a valid node graph.
+    mx::NodeGraphPtr graph = doc->addNodeGraph("graph1");
+    mx::NodePtr constant = graph->addNode("constant", "constant1", "color3");
+    mx::OutputPtr output = graph->addOutput("out", "color3");
+    output->setConnectedNode(constant);
+
+    // A valid document generates no diagnostics.
+    std::vector<mx::ValidationDiagnostic> diagnostics;
+    REQUIRE(doc->validate(diagnostics));
+    REQUIRE(diagnostics.empty());
+
+    // Introduce an invalid connection and a type mismatch.
+    mx::NodePtr multiply = graph->addNode("multiply", "multiply1", "color3");
+    multiply->setConnectedNode("in1", constant);
+    multiply->getInput("in1")->setNodeName("missing1");
+    mx::NodePtr image = doc->addNode("image", "image1", "float");
+    image->setType("unknowntype");
+
+    std::string message;
+    REQUIRE(!doc->validate(&message));
+    REQUIRE(!doc->validate(diagnostics));
+    REQUIRE(!diagnostics.empty());
+
+    // Diagnostics carry rule identifiers and element paths.
+    bool foundConnection = false;
+    bool foundType = false;
+    for (const mx::ValidationDiagnostic& diagnostic : diagnostics)
+    {
+        REQUIRE(!diagnostic.ruleId.empty());
+        REQUIRE(doc->getDescendant(diagnostic.elementPath));
+        if (diagnostic.ruleId == "port.connection")
+        {
+            REQUIRE(diagnostic.elementPath == "graph1/multiply1/in1");
+            REQUIRE(diagnostic.severity == mx::ValidationDiagnostic::SeverityError);
+            foundConnection = true;
+        }
+        if (diagnostic.elementPath == "image1")
+        {
+            foundType = true;
+        }
+    }
+    REQUIRE(foundConnection);
+    REQUIRE(foundType);
+
+    // The message form of validation is a concatenation of diagnostics.
+    std::string expected;
+    for (const mx::ValidationDiagnostic& diagnostic : diagnostics)
+    {
+        expected += diagnostic.asString() + "\n";
+    }
+    REQUIRE(message == expected);
+
+    // Parallel validation returns diagnostics in document order.
+    for (unsigned int threadCount : { 0u, 2u, 4u })
+    {
+        std::vector<mx::ValidationDiagnostic> parallelDiagnostics;
+        REQUIRE(!doc->validate(parallelDiagnostics, threadCount));
+        REQUIRE(parallelDiagnostics.size() == diagnostics.size());
+        for (size_t i = 0; i < diagnostics.size(); i++)
+        {
+            REQUIRE(parallelDiagnostics[i].asString() == diagnostics[i].asString());
+            REQUIRE(parallelDiagnostics[i].ruleId == diagnostics[i].ruleId);
+        }
+    }
+
+    // Element-level validation is unaffected.
+    REQUIRE(!multiply->validate());
+    REQUIRE(constant->validate());
+}
+
+TEST_CASE("Arena allocation", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr heapDoc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, heapDoc);
+    REQUIRE(!heapDoc->getElementArena());
+
+    // Elements of an arena document are allocated from its arena.
+    mx::ElementArenaPtr arena = std::make_shared<mx::ElementArena>();
+    mx::DocumentPtr doc = mx::createDocument(arena);
+    REQUIRE(doc->getElementArena() == arena);
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    REQUIRE(*doc == *heapDoc);
+    REQUIRE(doc->validate());
+    REQUIRE(doc->getNodeDefs().front()->getElementArena() == arena);
+    REQUIRE(arena->getAllocatedBytes() > 0);
+    REQUIRE(arena->getReservedBytes() >= arena->getAllocatedBytes());
+
+    // Copies of an arena document share its arena.
+    mx::DocumentPtr docCopy = doc->copy();
+    REQUIRE(docCopy->getElementArena() == arena);
+    REQUIRE(*docCopy == *doc);
+    docCopy = nullptr;
+
+    // Storage released by removed elements is reused.
+    mx::NodeGraphPtr graph = doc->addNodeGraph("graph1");
+    for (int i = 0; i < 100; i++)
+    {
+        graph->addNode("image", "image" + std::to_string(i), "color3");
+    }
+    size_t allocatedBytes = arena->getAllocatedBytes();
+    size_t reservedBytes = arena->getReservedBytes();
+    graph = nullptr;
+    doc->removeNodeGraph("graph1");
+    REQUIRE(arena->getAllocatedBytes() < allocatedBytes);
+    graph = doc->addNodeGraph("graph1");
+    for (int i = 0; i < 100; i++)
+    {
+        graph->addNode("image", "image" + std::to_string(i), "color3");
+    }
+    REQUIRE(arena->getAllocatedBytes() == allocatedBytes);
+    REQUIRE(arena->getReservedBytes() == reservedBytes);
+
+    // Elements that outlive their document keep the arena alive.
+    mx::NodePtr image = graph->getNode("image0");
+    std::weak_ptr<mx::ElementArena> weakArena = arena;
+    arena = nullptr;
+    graph = nullptr;
+    doc = nullptr;
+    REQUIRE(!weakArena.expired());
+    REQUIRE(image->getName() == "image0");
+    REQUIRE_THROWS_AS(image->getDocument(), mx::ExceptionOrphanedElement);
+    image = nullptr;
+    REQUIRE(weakArena.expired());
+}
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Document cache performance", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    mx::NodeGraphPtr graph = doc->addNodeGraph();
+
+    BENCHMARK("Interleaved edits and nodedef lookups")
+    {
+        size_t matchCount = 0;
+        for (int i = 0; i < 100; i++)
+        {
+            mx::NodePtr node = graph->addNode("image", mx::EMPTY_STRING, "color3");
+            node->setInputValue("uaddressmode", std::string("periodic"));
+            matchCount += doc->getMatchingNodeDefs(node->getCategory()).size();
+        }
+        for (mx::NodePtr node : graph->getNodes())
+        {
+            graph->removeNode(node->getName());
+        }
+        return matchCount;
+    };
+}
+
+TEST_CASE("Content hash performance", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    mx::DocumentPtr doc2 = doc->copy();
+    mx::ElementEquivalenceOptions options;
+    mx::NodeDefPtr nodeDef = doc->getNodeDefs().back();
+    int editIndex = 0;
+
+    BENCHMARK("Equivalence comparison")
+    {
+        return doc->isEquivalent(doc2, options);
+    };
+    BENCHMARK("Content hash comparison")
+    {
+        return doc->getContentHash(options) == doc2->getContentHash(options);
+    };
+    BENCHMARK("Content hash after local edit")
+    {
+        nodeDef->setDocString("Edit " + std::to_string(editIndex++));
+        return doc->getContentHash(options);
+    };
+}
+
+TEST_CASE("Validation performance", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+
+    BENCHMARK("Serial validation")
+    {
+        std::vector<mx::ValidationDiagnostic> diagnostics;
+        return doc->validate(diagnostics, 1);
+    };
+    BENCHMARK("Parallel validation")
+    {
+        std::vector<mx::ValidationDiagnostic> diagnostics;
+        return doc->validate(diagnostics, 0);
+    };
+}
+
+TEST_CASE("Name path performance", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    mx::StringVec namePaths;
+    for (mx::ElementPtr elem : doc->traverseTree())
+    {
+        namePaths.push_back(elem->getNamePath());
+    }
+    mx::DocumentPtr indexedDoc = doc->copy();
+    indexedDoc->setNamePathIndexEnabled(true);
+
+    BENCHMARK("Resolve name paths by traversal")
+    {
+        return doc->getDescendants(namePaths).size();
+    };
+    BENCHMARK("Resolve name paths through index")
+    {
+        return indexedDoc->getDescendants(namePaths).size();
+    };
+}
+
+TEST_CASE("Arena allocation performance", "[document]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    BENCHMARK("Copy and release with heap allocation")
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        doc->copyContentFrom(libraries);
+        return doc->getChildren().size();
+    };
+    BENCHMARK("Copy and release with arena allocation")
+    {
+        mx::DocumentPtr doc = mx::createDocument(std::make_shared<mx::ElementArena>());
+        doc->copyContentFrom(libraries);
+        return doc->getChildren().size();
+    };
+}
+#endif
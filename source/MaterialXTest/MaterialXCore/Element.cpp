@@ -6,6 +6,7 @@
 #include <MaterialXTest/External/Catch/catch.hpp>
 
 #include <MaterialXCore/Document.h>
+#include <MaterialXCore/Util.h>
 #include <MaterialXFormat/Util.h>
 
 namespace mx = MaterialX;
@@ -101,3 +102,136 @@ TEST_CASE("Element", "[element]")
     }
     REQUIRE_THROWS_AS(orphan->getDocument(), mx::ExceptionOrphanedElement);
 }
+
+TEST_CASE("Element attributes", "[element]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::ElementPtr elem = doc->addChildOfCategory("generic", "elem");
+
+    // Add enough attributes to exceed both inline storage and the hashing
+    // threshold, verifying lookups and ordering at each step.
+    mx::StringVec names;
+    for (int i = 0; i < 40; i++)
+    {
+        std::string name = "attr" + std::to_string(i);
+        elem->setAttribute(name, "value" + std::to_string(i));
+        names.push_back(name);
+        REQUIRE(elem->getAttributeNames() == names);
+        for (int j = 0; j <= i; j++)
+        {
+            REQUIRE(elem->getAttribute("attr" + std::to_string(j)) == "value" + std::to_string(j));
+        }
+        REQUIRE(!elem->hasAttribute("missing"));
+    }
+
+    // Overwrite attributes, including from a value stored on the same element.
+    elem->setAttribute("attr3", "newValue");
+    elem->setAttribute("copy", elem->getAttribute("attr0"));
+    names.push_back("copy");
+    REQUIRE(elem->getAttribute("attr3") == "newValue");
+    REQUIRE(elem->getAttribute("copy") == "value0");
+    REQUIRE(elem->getAttributeNames() == names);
+
+    // Copy and compare elements.
+    mx::DocumentPtr doc2 = doc->copy();
+    REQUIRE(*doc2 == *doc);
+    doc2->getChild("elem")->setAttribute("attr5", "changed");
+    REQUIRE(*doc2 != *doc);
+
+    // Remove attributes, dropping below the hashing threshold.
+    for (int i = 0; i < 40; i += 2)
+    {
+        std::string name = "attr" + std::to_string(i);
+        elem->removeAttribute(name);
+        names.erase(std::find(names.begin(), names.end(), name));
+        REQUIRE(!elem->hasAttribute(name));
+        REQUIRE(elem->getAttributeNames() == names);
+    }
+    REQUIRE(elem->getAttribute("attr39") == "value39");
+    REQUIRE(elem->getAttribute("copy") == "value0");
+
+    // Move attribute stores with inline and heap storage.
+    static_assert(std::is_nothrow_move_constructible<mx::AttributeStore>::value, "AttributeStore move must be noexcept");
+    static_assert(std::is_nothrow_move_assignable<mx::AttributeStore>::value, "AttributeStore move must be noexcept");
+    for (int count : { 2, 30 })
+    {
+        mx::AttributeStore store;
+        for (int i = 0; i < count; i++)
+        {
+            store.set("attr" + std::to_string(i), "value" + std::to_string(i));
+        }
+        mx::AttributeStore moved(std::move(store));
+        REQUIRE(store.empty());
+        REQUIRE(moved.size() == (size_t) count);
+        REQUIRE(*moved.find("attr1") == "value1");
+
+        mx::AttributeStore assigned;
+        assigned.set("other", "value");
+        assigned = std::move(moved);
+        REQUIRE(moved.empty());
+        REQUIRE(assigned.size() == (size_t) count);
+        REQUIRE(*assigned.find("attr" + std::to_string(count - 1)) == "value" + std::to_string(count - 1));
+        REQUIRE(!assigned.find("other"));
+
+        // Moved-from stores remain usable.
+        moved.set("attr0", "reused");
+        REQUIRE(*moved.find("attr0") == "reused");
+    }
+}
+
+TEST_CASE("Typed value cache", "[element]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodePtr node = doc->addNode("constant", "constant1", "color3");
+    mx::InputPtr input = node->setInputValue("value", mx::Color3(0.1f, 0.2f, 0.3f));
+
+    // Repeated lookups share a single parsed value.
+    mx::ConstValuePtr value = input->getCachedValue();
+    REQUIRE(value->asA<mx::Color3>() == mx::Color3(0.1f, 0.2f, 0.3f));
+    REQUIRE(input->getCachedValue() == value);
+
+    // Other lookups return values owned by the caller, whose modification
+    // does not affect the element.
+    mx::ValuePtr copy = input->getValue();
+    REQUIRE(copy != value);
+    REQUIRE(copy->getValueString() == value->getValueString());
+    REQUIRE(input->getResolvedValue() != value);
+    std::static_pointer_cast<mx::TypedValue<mx::Color3>>(copy)->setData(mx::Color3(1.0f));
+    REQUIRE(copy->asA<mx::Color3>() == mx::Color3(1.0f));
+    REQUIRE(input->getCachedValue()->asA<mx::Color3>() == mx::Color3(0.1f, 0.2f, 0.3f));
+    REQUIRE(input->getValue()->asA<mx::Color3>() == mx::Color3(0.1f, 0.2f, 0.3f));
+
+    // The cache is invalidated by changes to the value or type.
+    input->setValueString("0.5, 0.5, 0.5");
+    REQUIRE(input->getCachedValue() != value);
+    REQUIRE(input->getValue()->asA<mx::Color3>() == mx::Color3(0.5f));
+    input->setType("vector3");
+    REQUIRE(input->getValue()->asA<mx::Vector3>() == mx::Vector3(0.5f));
+    input->removeAttribute(mx::ValueElement::VALUE_ATTRIBUTE);
+    REQUIRE(!input->getValue());
+    input->setValue(2.0f);
+    REQUIRE(input->getValue()->asA<float>() == 2.0f);
+
+    // Copied and cleared content is reflected in the cache.
+    mx::InputPtr other = node->addInput("other", "integer");
+    other->setValue(1);
+    REQUIRE(other->getValue()->asA<int>() == 1);
+    other->copyContentFrom(input);
+    REQUIRE(other->getValue()->asA<float>() == 2.0f);
+
+    // Values of unregistered types are not cached.
+    mx::InputPtr filename = node->addInput("file", "filename");
+    filename->setValueString("image.png");
+    REQUIRE(filename->getValue() != filename->getValue());
+
+    // Concurrent readers observe the same value.
+    std::vector<mx::ConstValuePtr> results(64);
+    mx::parallelFor(results.size(), 4, [&](size_t i)
+    {
+        results[i] = input->getCachedValue();
+    });
+    for (mx::ConstValuePtr result : results)
+    {
+        REQUIRE(result->asA<float>() == 2.0f);
+    }
+}
@@ -118,3 +118,149 @@ TEST_CASE("GeomPropDef", "[geom]")
     REQUIRE(input->getDefaultGeomProp() == worldNormal);
     REQUIRE(doc->validate());
 }
+
+TEST_CASE("Geom matchers", "[geom]")
+{
+    // Compiled path sets match geometry strings with the same rules as
+    // geomStringsMatch.
+    mx::StringVec geomStrings =
+    {
+        "",
+        "/",
+        "/robot1",
+        "/robot1/left_arm",
+        "/robot1/left_arm/hand",
+        "/robot2, /robot1/right_arm",
+        "/robot10",
+        "robot1//left_arm",
+        "/robot3/left_arm, /robot1"
+    };
+    for (const std::string& geom1 : geomStrings)
+    {
+        mx::GeomPathSet pathSet(geom1);
+        REQUIRE(pathSet.isEmpty() == geom1.empty());
+        for (const std::string& geom2 : geomStrings)
+        {
+            REQUIRE(pathSet.matchesGeomString(geom2) == mx::geomStringsMatch(geom1, geom2));
+            REQUIRE(pathSet.matchesGeomString(geom2, true) == mx::geomStringsMatch(geom1, geom2, true));
+        }
+    }
+
+    // Create a chain of collections.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::CollectionPtr collection1 = doc->addCollection("collection1");
+    collection1->setIncludeGeom("/scene1");
+    collection1->setExcludeGeom("/scene1/sphere2");
+    mx::CollectionPtr collection2 = doc->addCollection("collection2");
+    collection2->setIncludeGeom("/scene2, /scene3/cube1");
+    mx::CollectionPtr collection3 = doc->addCollection("collection3");
+    collection3->setIncludeCollections({ collection1, collection2 });
+    collection3->setExcludeGeom("/scene2/cube2");
+
+    mx::StringVec queries =
+    {
+        "/scene1/sphere1",
+        "/scene1/sphere2",
+        "/scene1/sphere2/part1",
+        "/scene2/cube1",
+        "/scene2/cube2",
+        "/scene3",
+        "/scene3/cube2",
+        "/scene4, /scene3/cube1"
+    };
+    std::vector<bool> expected = { true, false, false, true, false, true, false, true };
+
+    // Test a compiled matcher for the collection.
+    mx::GeomMatcher matcher(collection3);
+    REQUIRE(!matcher.hasIncludeCycle());
+    REQUIRE(matcher.matchesGeomStrings(queries) == expected);
+    for (size_t i = 0; i < queries.size(); i++)
+    {
+        REQUIRE(collection3->matchesGeomString(queries[i]) == expected[i]);
+    }
+
+    // The cached matcher of a collection is rebuilt after edits.
+    mx::ConstGeomMatcherPtr cachedMatcher = collection3->getGeomMatcher();
+    REQUIRE(collection3->getGeomMatcher() == cachedMatcher);
+    collection2->setIncludeGeom("/scene4");
+    REQUIRE(collection3->getGeomMatcher() != cachedMatcher);
+    REQUIRE(!collection3->matchesGeomString("/scene2/cube1"));
+    REQUIRE(collection3->matchesGeomString("/scene4/cube1"));
+    REQUIRE(matcher.matchesGeomString("/scene2/cube1"));
+
+    // Test a compiled matcher for a material assignment.
+    mx::LookPtr look = doc->addLook();
+    mx::MaterialAssignPtr matAssign = look->addMaterialAssign();
+    matAssign->setGeom("/scene5");
+    matAssign->setCollection(collection1);
+    mx::GeomMatcher assignMatcher(matAssign);
+    REQUIRE(assignMatcher.matchesGeomString("/scene5/sphere1"));
+    REQUIRE(!assignMatcher.matchesGeomString("/scene6"));
+    REQUIRE(assignMatcher.matchesGeomString("/scene1/sphere1"));
+    REQUIRE(!assignMatcher.matchesGeomString("/scene1/sphere2"));
+    REQUIRE(!assignMatcher.matchesGeomString("/scene2"));
+    REQUIRE(!mx::GeomMatcher().matchesGeomString("/"));
+
+    // Include cycles are reported when included collections are tested.
+    collection1->setIncludeCollection(collection3);
+    mx::GeomMatcher cycleMatcher(collection3);
+    REQUIRE(cycleMatcher.hasIncludeCycle());
+    REQUIRE(!cycleMatcher.matchesGeomString("/scene2/cube2"));
+    REQUIRE_THROWS_AS(cycleMatcher.matchesGeomString("/scene1/sphere1"), mx::ExceptionFoundCycle);
+    REQUIRE(collection3->hasIncludeCycle());
+}
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Geom matching performance", "[geom]")
+{
+    // Create a collection that includes a set of other collections.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::CollectionPtr rootCollection = doc->addCollection("root");
+    std::vector<mx::ConstCollectionPtr> includes;
+    for (size_t i = 0; i < 20; i++)
+    {
+        mx::CollectionPtr collection = doc->addCollection("collection" + std::to_string(i));
+        collection->setIncludeGeom("/scene/group" + std::to_string(i) + ", /props/prop" + std::to_string(i));
+        if (i % 4 == 0)
+        {
+            collection->setExcludeGeom("/scene/group" + std::to_string(i) + "/mesh0");
+        }
+        includes.push_back(collection);
+    }
+    rootCollection->setIncludeCollections(includes);
+
+    // Generate a large set of geometry names.
+    mx::StringVec geoms;
+    for (size_t i = 0; i < 10000; i++)
+    {
+        geoms.push_back("/scene/group" + std::to_string(i % 40) + "/mesh" + std::to_string(i % 7) + "/shape");
+    }
+
+    BENCHMARK("Collection matches with compiled matcher")
+    {
+        return rootCollection->getGeomMatcher()->matchesGeomStrings(geoms).size();
+    };
+
+    BENCHMARK("Collection matches with geometry strings")
+    {
+        size_t matchCount = 0;
+        for (const std::string& geom : geoms)
+        {
+            if (mx::geomStringsMatch(rootCollection->getActiveExcludeGeom(), geom, true))
+            {
+                continue;
+            }
+            for (mx::ConstCollectionPtr collection : includes)
+            {
+                if (!mx::geomStringsMatch(collection->getActiveExcludeGeom(), geom, true) &&
+                    mx::geomStringsMatch(collection->getActiveIncludeGeom(), geom))
+                {
+                    matchCount++;
+                    break;
+                }
+            }
+        }
+        return matchCount;
+    };
+}
+#endif
@@ -123,3 +123,136 @@ TEST_CASE("LookGroup", "[look]")
     lookGroups = doc->getLookGroups();
     REQUIRE(lookGroups.size() == 0);
 }
+
+TEST_CASE("Look bindings", "[look]")
+{
+    mx::DocumentPtr doc = mx::createDocument();
+
+    // Create two materials.
+    mx::NodePtr shaderNode = doc->addNode("standard_surface", "", mx::SURFACE_SHADER_TYPE_STRING);
+    mx::NodePtr material1 = doc->addMaterialNode("material1", shaderNode);
+    mx::NodePtr material2 = doc->addMaterialNode("material2", shaderNode);
+
+    // Create a look with assignments of each type.
+    mx::LookPtr look = doc->addLook("look1");
+    mx::MaterialAssignPtr matAssign1 = look->addMaterialAssign("matAssign1", material1->getName());
+    matAssign1->setGeom("/robot1, /robot2");
+    mx::MaterialAssignPtr matAssign2 = look->addMaterialAssign("matAssign2", material2->getName());
+    mx::CollectionPtr collection = doc->addCollection();
+    collection->setIncludeGeom("/robot2");
+    collection->setExcludeGeom("/robot2/left_arm");
+    matAssign2->setCollection(collection);
+    mx::VariantAssignPtr matVariantAssign = matAssign2->addVariantAssign();
+    mx::PropertyAssignPtr propertyAssign = look->addPropertyAssign();
+    propertyAssign->setProperty("twosided");
+    propertyAssign->setCollection(collection);
+    propertyAssign->setValue(true);
+    mx::PropertySetAssignPtr propertySetAssign = look->addPropertySetAssign();
+    propertySetAssign->setGeom("/robot1");
+    mx::VisibilityPtr visibility = look->addVisibility();
+    visibility->setGeom("/robot3");
+    mx::VariantAssignPtr lookVariantAssign = look->addVariantAssign();
+
+    // Resolve the look against a list of geometry names.
+    mx::StringVec geoms = { "/robot1/head", "/robot2/left_arm", "/robot2/right_arm", "/robot3", "/robot4" };
+    for (unsigned int threadCount : { 1u, 4u })
+    {
+        mx::LookBindings bindings = look->resolveGeomBindings(geoms, threadCount);
+        REQUIRE(bindings.getGeomCount() == geoms.size());
+        REQUIRE(bindings.getMaterialAssigns().size() == 2);
+        REQUIRE(bindings.getVariantAssigns().size() == 1);
+
+        REQUIRE(bindings.getBoundMaterialAssign(0) == matAssign1);
+        REQUIRE(bindings.getBoundMaterialAssign(1) == matAssign1);
+        REQUIRE(bindings.getBoundMaterialAssign(2) == matAssign2);
+        REQUIRE(bindings.getBoundMaterialAssign(3) == nullptr);
+        REQUIRE(bindings.getMaterialAssigns(2).size() == 2);
+        REQUIRE(bindings.hasMaterialAssign(2, 0));
+        REQUIRE(!bindings.hasMaterialAssign(1, 1));
+
+        REQUIRE(bindings.getPropertyAssigns(2).size() == 1);
+        REQUIRE(bindings.getPropertyAssigns(1).empty());
+        REQUIRE(bindings.hasPropertySetAssign(0, 0));
+        REQUIRE(!bindings.hasPropertySetAssign(2, 0));
+        REQUIRE(bindings.getVisibilities(3).size() == 1);
+        REQUIRE(bindings.getVisibilities(4).empty());
+
+        REQUIRE(bindings.getVariantAssigns(0) == std::vector<mx::VariantAssignPtr>{ lookVariantAssign });
+        REQUIRE(bindings.getVariantAssigns(2) == (std::vector<mx::VariantAssignPtr>{ lookVariantAssign, matVariantAssign }));
+
+        // Compare with the bindings for each material.
+        for (size_t i = 0; i < geoms.size(); i++)
+        {
+            for (mx::NodePtr material : { material1, material2 })
+            {
+                bool bound = false;
+                for (mx::MaterialAssignPtr matAssign : bindings.getMaterialAssigns(i))
+                {
+                    bound = bound || matAssign->getReferencedMaterial() == material;
+                }
+                REQUIRE(bound == !mx::getGeometryBindings(material, geoms[i]).empty());
+            }
+        }
+    }
+
+    // Resolve the active look of a look group.
+    mx::LookPtr look2 = doc->addLook("look2");
+    look2->addMaterialAssign("matAssign3", material2->getName())->setGeom("/robot4");
+    mx::LookGroupPtr lookGroup = doc->addLookGroup("lookgroup1");
+    lookGroup->setLooks("look1, look2");
+    REQUIRE(lookGroup->resolveGeomBindings(geoms).getBoundMaterialAssign(0) == matAssign1);
+    lookGroup->setActiveLook("look2");
+    mx::LookBindings groupBindings = lookGroup->resolveGeomBindings(geoms);
+    REQUIRE(groupBindings.getBoundMaterialAssign(0) == nullptr);
+    REQUIRE(groupBindings.getBoundMaterialAssign(4)->getMaterial() == "material2");
+    lookGroup->setActiveLook("look3");
+    REQUIRE(lookGroup->resolveGeomBindings(geoms).getMaterialAssigns().empty());
+}
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Look binding performance", "[look]")
+{
+    // Create a look with a material assignment per geometry group.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodePtr shaderNode = doc->addNode("standard_surface", "", mx::SURFACE_SHADER_TYPE_STRING);
+    mx::NodePtr material = doc->addMaterialNode("material1", shaderNode);
+    mx::LookPtr look = doc->addLook();
+    for (size_t i = 0; i < 50; i++)
+    {
+        mx::MaterialAssignPtr matAssign = look->addMaterialAssign("", material->getName());
+        if (i % 2)
+        {
+            matAssign->setGeom("/scene/group" + std::to_string(i));
+        }
+        else
+        {
+            mx::CollectionPtr collection = doc->addCollection();
+            collection->setIncludeGeom("/scene/group" + std::to_string(i));
+            collection->setExcludeGeom("/scene/group" + std::to_string(i) + "/mesh0");
+            matAssign->setCollection(collection);
+        }
+    }
+
+    // Generate a set of geometry names.
+    mx::StringVec geoms;
+    for (size_t i = 0; i < 2000; i++)
+    {
+        geoms.push_back("/scene/group" + std::to_string(i % 60) + "/mesh" + std::to_string(i % 7) + "/shape");
+    }
+
+    BENCHMARK("Resolve look bindings")
+    {
+        return look->resolveGeomBindings(geoms).getGeomCount();
+    };
+
+    BENCHMARK("Resolve geometry bindings per material")
+    {
+        size_t boundCount = 0;
+        for (const std::string& geom : geoms)
+        {
+            boundCount += mx::getGeometryBindings(material, geom).size();
+        }
+        return boundCount;
+    };
+}
+#endif
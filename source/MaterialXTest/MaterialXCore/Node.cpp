@@ -32,6 +32,55 @@ bool isTopologicalOrder(const std::vector<mx::ElementPtr>& elems)
     return true;
 }
 
+// Create a document in which the root scope and each of the given number of
+// node graphs contain a chain of instances of a graph-defined node, whose
+// implementation itself contains nested graph-defined nodes.
+mx::DocumentPtr createInstanceChains(size_t graphCount, size_t instanceCount, bool loadLibraries)
+{
+    mx::DocumentPtr doc = mx::createDocument();
+    if (loadLibraries)
+    {
+        mx::loadLibraries({ "libraries" }, mx::getDefaultDataSearchPath(), doc);
+    }
+
+    mx::NodeDefPtr doubleDef = doc->addNodeDef("ND_double_float", "float", "double");
+    doubleDef->setInputValue("in", 1.0f);
+    mx::NodeGraphPtr doubleGraph = doc->addNodeGraph("NG_double_float");
+    doubleGraph->setNodeDefString(doubleDef->getName());
+    mx::NodePtr multiply = doubleGraph->addNode("multiply", "multiply1", "float");
+    multiply->addInput("in1", "float")->setInterfaceName("in");
+    multiply->setInputValue("in2", 2.0f);
+    doubleGraph->addOutput("out", "float")->setConnectedNode(multiply);
+
+    mx::NodeDefPtr quadDef = doc->addNodeDef("ND_quad_float", "float", "quad");
+    quadDef->setInputValue("in", 1.0f);
+    mx::NodeGraphPtr quadGraph = doc->addNodeGraph("NG_quad_float");
+    quadGraph->setNodeDefString(quadDef->getName());
+    mx::NodePtr double1 = quadGraph->addNodeInstance(doubleDef, "double1");
+    double1->addInput("in", "float")->setInterfaceName("in");
+    mx::NodePtr double2 = quadGraph->addNodeInstance(doubleDef, "double2");
+    double2->setConnectedNode("in", double1);
+    quadGraph->addOutput("out", "float")->setConnectedNode(double2);
+
+    std::vector<mx::GraphElementPtr> graphs = { doc };
+    for (size_t i = 0; i < graphCount; i++)
+    {
+        graphs.push_back(doc->addNodeGraph("graph" + std::to_string(i + 1)));
+    }
+    for (mx::GraphElementPtr graph : graphs)
+    {
+        mx::NodePtr upstream = graph->addNode("constant", "constant1", "float");
+        for (size_t i = 0; i < instanceCount; i++)
+        {
+            mx::NodePtr quad = graph->addNodeInstance(quadDef, "quad" + std::to_string(i + 1));
+            quad->setConnectedNode("in", upstream);
+            upstream = quad;
+        }
+        graph->addOutput("out", "float")->setConnectedNode(upstream);
+    }
+    return doc;
+}
+
 TEST_CASE("Interface Input Validation", "[node]")
 {
     std::string validationErrors;
@@ -314,6 +363,71 @@ TEST_CASE("Flatten", "[nodegraph]")
     REQUIRE(newRootNodes == expectedRootNodes);
 }
 
+TEST_CASE("Flatten instances", "[nodegraph]")
+{
+    const size_t graphCount = 4;
+    const size_t instanceCount = 10;
+
+    // Flatten serially, and verify the structure of each flattened graph.
+    mx::DocumentPtr doc = createInstanceChains(graphCount, instanceCount, true);
+    REQUIRE(doc->validate());
+    doc->flattenAllSubgraphs();
+    REQUIRE(doc->validate());
+    for (size_t i = 0; i <= graphCount; i++)
+    {
+        mx::GraphElementPtr graph = i ? doc->getNodeGraph("graph" + std::to_string(i)) : mx::GraphElementPtr(doc);
+        mx::OutputPtr output = graph->getOutput("out");
+        size_t multiplyCount = 0;
+        mx::NodePtr node = output->getConnectedNode();
+        while (node && node->getCategory() == "multiply")
+        {
+            multiplyCount++;
+            node = node->getConnectedNode("in1");
+        }
+        REQUIRE(multiplyCount == instanceCount * 2);
+        REQUIRE(node == graph->getNode("constant1"));
+        if (i)
+        {
+            // New nodes take the position of the nodes they replace.
+            REQUIRE(graph->getChildren().size() == instanceCount * 2 + 2);
+            REQUIRE(graph->getChildren().front()->getName() == "constant1");
+            REQUIRE(graph->getChildren().back() == output);
+        }
+    }
+
+    // The implementation graphs of custom nodes are also flattened.
+    REQUIRE(!doc->getNodeGraph("NG_quad_float")->getNode("double1"));
+
+    // Flattening concurrently produces an identical document.
+    for (unsigned int threadCount : { 0u, 4u })
+    {
+        mx::DocumentPtr parallelDoc = createInstanceChains(graphCount, instanceCount, true);
+        parallelDoc->flattenAllSubgraphs(mx::EMPTY_STRING, nullptr, threadCount);
+        REQUIRE(*parallelDoc == *doc);
+    }
+
+    // Flatten with a node filter, leaving nested nodes in place.
+    auto filter = [](mx::NodePtr node)
+    {
+        return node->getCategory() != "double";
+    };
+    mx::DocumentPtr filteredDoc = createInstanceChains(graphCount, instanceCount, true);
+    filteredDoc->flattenAllSubgraphs(mx::EMPTY_STRING, filter, 4);
+    REQUIRE(filteredDoc->validate());
+    mx::NodeGraphPtr filteredGraph = filteredDoc->getNodeGraph("graph1");
+    REQUIRE(filteredGraph->getNodes("double").size() == instanceCount * 2);
+    REQUIRE(filteredGraph->getNodes("quad").empty());
+
+    // Flatten individual graphs with a shared implementation.
+    mx::DocumentPtr graphDoc = createInstanceChains(graphCount, instanceCount, true);
+    mx::NodeGraphPtr graph1 = graphDoc->getNodeGraph("graph1");
+    graph1->flattenSubgraphs();
+    REQUIRE(graphDoc->validate());
+    REQUIRE(graph1->getNodes("multiply").size() == instanceCount * 2);
+    REQUIRE(graph1->getNodes("quad").empty());
+    REQUIRE(graphDoc->getNodeGraph("graph2")->getNodes("quad").size() == instanceCount);
+}
+
 TEST_CASE("Inheritance", "[nodedef]")
 {
     mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
@@ -385,6 +499,180 @@ TEST_CASE("Topological sort", "[nodegraph]")
     REQUIRE(isTopologicalOrder(elemOrder));
 }
 
+TEST_CASE("Graph index", "[nodegraph]")
+{
+    // Create a document.
+    mx::DocumentPtr doc = mx::createDocument();
+
+    // Create a node graph with a shared upstream node.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr constant = nodeGraph->addNode("constant");
+    mx::NodePtr image = nodeGraph->addNode("image");
+    mx::NodePtr add = nodeGraph->addNode("add");
+    mx::NodePtr multiply = nodeGraph->addNode("multiply");
+    mx::OutputPtr output = nodeGraph->addOutput();
+    add->setConnectedNode("in1", constant);
+    add->setConnectedNode("in2", image);
+    multiply->setConnectedNode("in1", add);
+    multiply->setConnectedNode("in2", constant);
+    output->setConnectedNode(multiply);
+
+    // Ids follow the child order of the graph.
+    mx::ConstGraphIndexPtr index = nodeGraph->getGraphIndex();
+    REQUIRE(index->getElementCount() == nodeGraph->getChildren().size());
+    for (size_t id = 0; id < index->getElementCount(); id++)
+    {
+        REQUIRE(index->getElement(id) == nodeGraph->getChildren()[id]);
+        REQUIRE(index->getId(index->getElement(id)) == id);
+    }
+    REQUIRE(index->getId(nodeGraph) == mx::GraphIndex::INVALID_ID);
+
+    // Upstream and downstream connections match those of the elements.
+    size_t constantId = index->getId(constant);
+    size_t multiplyId = index->getId(multiply);
+    size_t outputId = index->getId(output);
+    REQUIRE(index->getUpstreamCount(constantId) == 0);
+    REQUIRE(index->getUpstreamCount(multiplyId) == 2);
+    REQUIRE(index->getUpstreamId(multiplyId, 0) == index->getId(add));
+    REQUIRE(index->getUpstreamPort(multiplyId, 1) == multiply->getInput("in2"));
+    REQUIRE(index->getUpstreamCount(outputId) == 1);
+    REQUIRE(index->getUpstreamPort(outputId, 0) == output);
+    for (mx::NodePtr node : nodeGraph->getNodes())
+    {
+        size_t id = index->getId(node);
+        REQUIRE(index->getDownstreamPorts(id) == node->getDownstreamPorts());
+        for (size_t i = 0; i < index->getDownstreamCount(id); i++)
+        {
+            mx::PortElementPtr port = index->getDownstreamPort(id, i);
+            mx::ElementPtr downstreamElem = port->isA<mx::Output>() ? port : port->getParent();
+            REQUIRE(index->getElement(index->getDownstreamId(id, i)) == downstreamElem);
+        }
+    }
+
+    // Downstream ports of graph nodes match those found by name across the
+    // document, including inputs of the graph itself.
+    mx::InputPtr graphInput = nodeGraph->addInput("graphIn", "color3");
+    graphInput->setNodeName(image->getName());
+    for (mx::NodePtr node : nodeGraph->getNodes())
+    {
+        std::vector<mx::PortElementPtr> matchingPorts;
+        for (mx::PortElementPtr port : doc->getMatchingPorts(node->getName()))
+        {
+            if (port->getConnectedNode() == node)
+            {
+                matchingPorts.push_back(port);
+            }
+        }
+        std::sort(matchingPorts.begin(), matchingPorts.end(), [](mx::PortElementPtr a, mx::PortElementPtr b)
+        {
+            return a->getName() > b->getName();
+        });
+        REQUIRE(node->getDownstreamPorts() == matchingPorts);
+    }
+    REQUIRE(image->getDownstreamPorts().back() == graphInput);
+    nodeGraph->removeInput(graphInput->getName());
+    index = nodeGraph->getGraphIndex();
+
+    // The index is reused until the document is modified.
+    REQUIRE(nodeGraph->getGraphIndex() == index);
+    doc->addNode("constant");
+    REQUIRE(nodeGraph->getGraphIndex() != index);
+
+    // Connection edits are reflected in the rebuilt index.
+    index = nodeGraph->getGraphIndex();
+    multiply->setConnectedNode("in2", image);
+    REQUIRE(index->getDownstreamCount(constantId) == 2);
+    index = nodeGraph->getGraphIndex();
+    REQUIRE(index->getDownstreamCount(constantId) == 1);
+    REQUIRE(index->getDownstreamPorts(index->getId(image)) == image->getDownstreamPorts());
+
+    // Removed elements are dropped from the rebuilt index.
+    nodeGraph->removeOutput(output->getName());
+    index = nodeGraph->getGraphIndex();
+    REQUIRE(index->getId(output) == mx::GraphIndex::INVALID_ID);
+    REQUIRE(index->getDownstreamCount(index->getId(multiply)) == 0);
+
+    // Elements within cycles are omitted from the topological order.
+    constant->setConnectedNode("value", multiply);
+    std::vector<mx::ElementPtr> elemOrder = nodeGraph->topologicalSort();
+    REQUIRE(elemOrder.size() == 1);
+    REQUIRE(elemOrder[0] == image);
+}
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Graph index performance", "[nodegraph]")
+{
+    // Create a layered node graph with dense connections.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    const size_t layerSize = 100;
+    std::vector<mx::NodePtr> prevLayer;
+    for (size_t layer = 0; layer < 100; layer++)
+    {
+        std::vector<mx::NodePtr> currentLayer;
+        for (size_t i = 0; i < layerSize; i++)
+        {
+            mx::NodePtr node = nodeGraph->addNode("add", mx::EMPTY_STRING, "float");
+            if (!prevLayer.empty())
+            {
+                node->setConnectedNode("in1", prevLayer[i]);
+                node->setConnectedNode("in2", prevLayer[(i + 1) % layerSize]);
+            }
+            currentLayer.push_back(node);
+        }
+        prevLayer = currentLayer;
+    }
+
+    BENCHMARK("Topological sort with index rebuild")
+    {
+        nodeGraph->setDocString("rebuild");
+        return nodeGraph->topologicalSort().size();
+    };
+
+    BENCHMARK("Topological sort with cached index")
+    {
+        return nodeGraph->topologicalSort().size();
+    };
+}
+#endif
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Flatten performance", "[nodegraph]")
+{
+    mx::DocumentPtr doc = createInstanceChains(8, 100, false);
+
+    BENCHMARK("Copy document")
+    {
+        return doc->copy()->getChildren().size();
+    };
+
+    BENCHMARK("Flatten graphs individually")
+    {
+        mx::DocumentPtr copy = doc->copy();
+        copy->flattenSubgraphs();
+        for (mx::NodeGraphPtr graph : copy->getNodeGraphs())
+        {
+            graph->flattenSubgraphs();
+        }
+        return copy->getChildren().size();
+    };
+
+    BENCHMARK("Flatten all subgraphs")
+    {
+        mx::DocumentPtr copy = doc->copy();
+        copy->flattenAllSubgraphs();
+        return copy->getChildren().size();
+    };
+
+    BENCHMARK("Flatten all subgraphs in parallel")
+    {
+        mx::DocumentPtr copy = doc->copy();
+        copy->flattenAllSubgraphs(mx::EMPTY_STRING, nullptr, 0);
+        return copy->getChildren().size();
+    };
+}
+#endif
+
 TEST_CASE("New nodegraph from output", "[nodegraph]")
 {
     // Create a document.
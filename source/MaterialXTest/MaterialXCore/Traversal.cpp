@@ -191,3 +191,153 @@ TEST_CASE("InterGraph Traversal", "[traversal]")
         }
     }
 }
+
+TEST_CASE("Raw traversal", "[traversal]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+
+    // Raw tree traversal visits the same elements at the same depths.
+    std::vector<std::pair<mx::Element*, size_t>> treeElems, rawTreeElems;
+    for (mx::TreeIterator it = doc->traverseTree().begin(); it != mx::TreeIterator::end(); ++it)
+    {
+        treeElems.emplace_back(it.getElement().get(), it.getElementDepth());
+        if (it.getElement()->isA<mx::NodeDef>())
+        {
+            it.setPruneSubtree(true);
+        }
+    }
+    for (mx::RawTreeIterator it = doc->traverseTreeRaw().begin(); it != mx::RawTreeIterator::end(); ++it)
+    {
+        rawTreeElems.emplace_back(it.getElement(), it.getElementDepth());
+        if (it.getElement()->isA<mx::NodeDef>())
+        {
+            it.setPruneSubtree(true);
+        }
+    }
+    REQUIRE(!treeElems.empty());
+    REQUIRE(treeElems == rawTreeElems);
+
+    // Raw graph traversal visits the same edges in the same order.
+    size_t edgeCount = 0;
+    for (mx::NodeGraphPtr graph : doc->getNodeGraphs())
+    {
+        for (mx::OutputPtr output : graph->getOutputs())
+        {
+            std::vector<std::tuple<mx::Element*, mx::Element*, mx::Element*, size_t, size_t>> edges, rawEdges;
+            for (mx::GraphIterator it = output->traverseGraph().begin(); it != mx::GraphIterator::end(); ++it)
+            {
+                edges.emplace_back(it.getDownstreamElement().get(), it.getConnectingElement().get(),
+                                   it.getUpstreamElement().get(), it.getElementDepth(), it.getNodeDepth());
+            }
+            for (mx::RawGraphIterator it = output->traverseGraphRaw().begin(); it != mx::RawGraphIterator::end(); ++it)
+            {
+                rawEdges.emplace_back(it.getDownstreamElement(), it.getConnectingElement(),
+                                      it.getUpstreamElement(), it.getElementDepth(), it.getNodeDepth());
+            }
+            REQUIRE(edges == rawEdges);
+            edgeCount += edges.size();
+        }
+    }
+    REQUIRE(edgeCount > 0);
+
+    // Create a graph with a shared upstream node.
+    mx::NodeGraphPtr nodeGraph = doc->addNodeGraph();
+    mx::NodePtr constant = nodeGraph->addNode("constant");
+    mx::NodePtr add = nodeGraph->addNode("add");
+    mx::NodePtr multiply = nodeGraph->addNode("multiply");
+    mx::OutputPtr output = nodeGraph->addOutput();
+    add->setConnectedNode("in1", constant);
+    multiply->setConnectedNode("in1", add);
+    multiply->setConnectedNode("in2", constant);
+    output->setConnectedNode(multiply);
+
+    // Prune subgraphs and copy iterators during traversal.
+    size_t nodeCount = 0;
+    for (mx::RawGraphIterator it = output->traverseGraphRaw().begin(); it != mx::RawGraphIterator::end(); ++it)
+    {
+        mx::RawGraphIterator copy = it;
+        REQUIRE(copy == it);
+        nodeCount++;
+        if (it.getUpstreamElement() == add.get())
+        {
+            it.setPruneSubgraph(true);
+        }
+    }
+    REQUIRE(nodeCount == 3);
+
+    // Detect a cycle.
+    constant->setConnectedNode("value", multiply);
+    REQUIRE_THROWS_AS([&output]()
+    {
+        for (mx::Element* elem : output->traverseGraphRaw())
+        {
+            REQUIRE(elem != nullptr);
+        }
+    }(), mx::ExceptionFoundCycle);
+    REQUIRE(output->hasUpstreamCycle());
+}
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Traversal performance", "[traversal]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, doc);
+    std::vector<mx::OutputPtr> outputs;
+    for (mx::NodeGraphPtr graph : doc->getNodeGraphs())
+    {
+        for (mx::OutputPtr output : graph->getOutputs())
+        {
+            outputs.push_back(output);
+        }
+    }
+
+    BENCHMARK("Tree traversal")
+    {
+        size_t count = 0;
+        for (mx::ElementPtr elem : doc->traverseTree())
+        {
+            count += elem->getChildren().size();
+        }
+        return count;
+    };
+
+    BENCHMARK("Raw tree traversal")
+    {
+        size_t count = 0;
+        for (mx::Element* elem : doc->traverseTreeRaw())
+        {
+            count += elem->getChildren().size();
+        }
+        return count;
+    };
+
+    BENCHMARK("Graph traversal")
+    {
+        size_t count = 0;
+        for (mx::OutputPtr output : outputs)
+        {
+            for (mx::GraphIterator it = output->traverseGraph().begin(); it != mx::GraphIterator::end(); ++it)
+            {
+                count += it.getElementDepth();
+            }
+        }
+        return count;
+    };
+
+    BENCHMARK("Raw graph traversal")
+    {
+        size_t count = 0;
+        for (mx::OutputPtr output : outputs)
+        {
+            for (mx::RawGraphIterator it = output->traverseGraphRaw().begin(); it != mx::RawGraphIterator::end(); ++it)
+            {
+                count += it.getElementDepth();
+            }
+        }
+        return count;
+    };
+}
+#endif
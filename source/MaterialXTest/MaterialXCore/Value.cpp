@@ -78,6 +78,20 @@ TEST_CASE("Value strings", "[value]")
     REQUIRE_THROWS_AS(mx::fromValueString<float>("text"), mx::ExceptionTypeError);
     REQUIRE_THROWS_AS(mx::fromValueString<bool>("1"), mx::ExceptionTypeError);
     REQUIRE_THROWS_AS(mx::fromValueString<mx::Color3>("1"), mx::ExceptionTypeError);
+    REQUIRE_THROWS_AS(mx::fromValueString<mx::Color3>("1, 1, text"), mx::ExceptionTypeError);
+    REQUIRE_THROWS_AS(mx::fromValueString<float>("inf"), mx::ExceptionTypeError);
+    REQUIRE_THROWS_AS(mx::fromValueString<mx::IntVec>("1, text"), mx::ExceptionTypeError);
+
+    // Convert value strings with irregular whitespace and separators.
+    REQUIRE(mx::fromValueString<int>(" +2") == 2);
+    REQUIRE(mx::fromValueString<float>("-0.5") == -0.5f);
+    REQUIRE(mx::fromValueString<float>(".25") == 0.25f);
+    REQUIRE(mx::fromValueString<mx::Vector3>("1,2 ,  3") == mx::Vector3(1.0f, 2.0f, 3.0f));
+    REQUIRE(mx::fromValueString<mx::FloatVec>(" 1.5 ,2.5,, 3.5 ") == (mx::FloatVec{ 1.5f, 2.5f, 3.5f }));
+    REQUIRE(mx::fromValueString<mx::BoolVec>("true, false") == (mx::BoolVec{ true, false }));
+    REQUIRE(mx::fromValueString<mx::StringVec>("Item A, Item B") == (mx::StringVec{ "Item A", "Item B" }));
+    REQUIRE(mx::toValueString(mx::FloatVec{ 0.5f, 1.0f }) == "0.5, 1");
+    REQUIRE(mx::toValueString(mx::Matrix33::IDENTITY) == "1, 0, 0, 0, 1, 0, 0, 0, 1");
 
     // Parse value strings using structure syntax features.
     REQUIRE(mx::parseStructValueString("{{1;2;3};4}") == (std::vector<std::string>{"{1;2;3}","4"}));
@@ -131,3 +145,40 @@ TEST_CASE("Typed values", "[value]")
     REQUIRE(value->isA<std::string>());
     REQUIRE(value->asA<std::string>() == "text");
 }
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Value string performance", "[value]")
+{
+    const mx::Matrix44 matrix(0.1f, 0.2f, 0.3f, 0.4f,
+                              0.5f, 0.6f, 0.7f, 0.8f,
+                              0.9f, 1.0f, 1.1f, 1.2f,
+                              1.3f, 1.4f, 1.5f, 1.6f);
+    const mx::FloatVec floats(64, 0.125f);
+    const std::string matrixString = mx::toValueString(matrix);
+    const std::string floatsString = mx::toValueString(floats);
+
+    BENCHMARK("Format value strings")
+    {
+        size_t length = 0;
+        for (int i = 0; i < 100; i++)
+        {
+            length += mx::toValueString(matrix).size();
+            length += mx::toValueString(mx::Color3(0.25f, 0.5f, (float) i)).size();
+            length += mx::toValueString(floats).size();
+        }
+        return length;
+    };
+
+    BENCHMARK("Parse value strings")
+    {
+        float sum = 0.0f;
+        for (int i = 0; i < 100; i++)
+        {
+            sum += mx::fromValueString<mx::Matrix44>(matrixString)[3][3];
+            sum += mx::fromValueString<mx::Color3>("0.25, 0.5, 0.75")[2];
+            sum += mx::fromValueString<mx::FloatVec>(floatsString).back();
+        }
+        return sum;
+    };
+}
+#endif
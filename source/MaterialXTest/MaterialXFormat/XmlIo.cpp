@@ -5,10 +5,14 @@
 
 #include <MaterialXTest/External/Catch/catch.hpp>
 
+#include <MaterialXFormat/BinaryIo.h>
 #include <MaterialXFormat/Environ.h>
 #include <MaterialXFormat/Util.h>
 #include <MaterialXFormat/XmlIo.h>
 
+#include <cstdio>
+#include <sstream>
+
 namespace mx = MaterialX;
 
 TEST_CASE("Load content", "[xmlio]")
@@ -69,14 +73,7 @@ TEST_CASE("Load content", "[xmlio]")
         REQUIRE(*writtenDoc == *doc);
 
         // Flatten all subgraphs.
-        doc->flattenSubgraphs();
-        for (mx::NodeGraphPtr graph : doc->getNodeGraphs())
-        {
-            if (graph->belongsToContentDocument())
-            {
-                graph->flattenSubgraphs();
-            }
-        }
+        doc->flattenAllSubgraphs(mx::EMPTY_STRING, nullptr, 4);
         REQUIRE(doc->validate());
 
         // Verify that all referenced types and nodes are declared.
@@ -239,6 +236,119 @@ TEST_CASE("Load content", "[xmlio]")
     REQUIRE_THROWS_AS(mx::readFromXmlFile(nonExistentDoc, "NonExistent.mtlx", mx::FileSearchPath(), &readOptions), mx::ExceptionFileMissing);
 }
 
+TEST_CASE("Load libraries in parallel", "[xmlio]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+
+    // Load the data libraries serially.
+    mx::DocumentPtr serialDoc = mx::createDocument();
+    mx::StringSet serialFiles = mx::loadLibraries({ "libraries" }, searchPath, serialDoc);
+    REQUIRE(!serialFiles.empty());
+
+    // Load the data libraries in parallel, and verify that the results are identical.
+    mx::DocumentPtr parallelDoc = mx::createDocument();
+    mx::StringSet parallelFiles = mx::loadLibraries({ "libraries" }, searchPath, parallelDoc, mx::StringSet(), nullptr, 4);
+    REQUIRE(parallelFiles == serialFiles);
+    REQUIRE(*parallelDoc == *serialDoc);
+    REQUIRE(parallelDoc->getReferencedSourceUris() == serialDoc->getReferencedSourceUris());
+    for (size_t i = 0; i < serialDoc->getChildren().size(); i++)
+    {
+        REQUIRE(parallelDoc->getChildren()[i]->getSourceUri() == serialDoc->getChildren()[i]->getSourceUri());
+    }
+}
+
+TEST_CASE("Binary snapshots", "[xmlio]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::StringSet libraryFiles = mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    // Round-trip the data libraries through a binary snapshot.
+    std::stringstream stream;
+    mx::writeToBinaryStream(libraries, stream, 42);
+    std::string buffer = stream.str();
+    mx::DocumentPtr snapshotDoc = mx::createDocument();
+    mx::readFromBinaryBuffer(snapshotDoc, buffer.data(), buffer.size());
+    REQUIRE(*snapshotDoc == *libraries);
+    REQUIRE(snapshotDoc->getReferencedSourceUris() == libraries->getReferencedSourceUris());
+    REQUIRE(snapshotDoc->validate());
+
+    // Verify that invalid snapshots are rejected.
+    for (size_t size : { (size_t) 0, (size_t) 16, buffer.size() / 2 })
+    {
+        mx::DocumentPtr truncatedDoc = mx::createDocument();
+        REQUIRE_THROWS_AS(mx::readFromBinaryBuffer(truncatedDoc, buffer.data(), size), mx::ExceptionParseError);
+    }
+    std::string corrupted = buffer;
+    corrupted[corrupted.size() / 2] ^= 0x7f;
+    mx::DocumentPtr corruptedDoc = mx::createDocument();
+    REQUIRE_THROWS_AS(mx::readFromBinaryBuffer(corruptedDoc, corrupted.data(), corrupted.size()), mx::ExceptionParseError);
+
+    // Load the data libraries through a snapshot file, first writing the
+    // snapshot and then reading it back.
+    mx::FilePath snapshotFile = "libraries." + mx::MTLX_SNAPSHOT_EXTENSION;
+    std::remove(snapshotFile.asString().c_str());
+    for (int pass = 0; pass < 2; pass++)
+    {
+        mx::DocumentPtr cachedDoc = mx::createDocument();
+        mx::StringSet cachedFiles = mx::loadCachedLibraries({ "libraries" }, searchPath, cachedDoc, snapshotFile);
+        REQUIRE(snapshotFile.exists());
+        REQUIRE(mx::readBinarySourceHash(snapshotFile) != 0);
+        REQUIRE(cachedFiles == libraryFiles);
+        REQUIRE(*cachedDoc == *libraries);
+    }
+    std::remove(snapshotFile.asString().c_str());
+
+    // Source file lists are stored alongside the snapshot document.
+    mx::StringVec sourceFiles = { "first.mtlx", "second.mtlx" };
+    mx::writeToBinaryFile(libraries, snapshotFile, 42, sourceFiles);
+    REQUIRE(mx::readBinarySourceHash(snapshotFile) == 42);
+    REQUIRE(mx::readBinarySourceFiles(snapshotFile) == sourceFiles);
+    std::remove(snapshotFile.asString().c_str());
+
+    // Edits to XIncluded files invalidate the snapshot, even when the size
+    // of the file is unchanged.
+    mx::FilePath libraryFolder = "snapshot_libraries";
+    libraryFolder.createDirectory();
+    mx::FilePath includeFile = "snapshot_include.mtlx";
+    mx::FilePath topFile = libraryFolder / "top.mtlx";
+    auto writeIncludeFile = [&includeFile](const std::string& nodeName)
+    {
+        mx::DocumentPtr includeDoc = mx::createDocument();
+        includeDoc->addNodeDef("ND_" + nodeName, "float", nodeName);
+        mx::writeToXmlFile(includeDoc, includeFile);
+    };
+    writeIncludeFile("nodeA");
+    mx::DocumentPtr topDoc = mx::createDocument();
+    mx::prependXInclude(topDoc, "../snapshot_include.mtlx");
+    mx::writeToXmlFile(topDoc, topFile);
+    mx::FileSearchPath folderSearchPath(mx::FilePath::getCurrentPath());
+    for (std::string nodeName : { "nodeA", "nodeA", "nodeB" })
+    {
+        if (nodeName == "nodeB")
+        {
+            writeIncludeFile(nodeName);
+        }
+        mx::DocumentPtr cachedDoc = mx::createDocument();
+        mx::loadCachedLibraries({ libraryFolder }, folderSearchPath, cachedDoc, snapshotFile);
+        REQUIRE(cachedDoc->getNodeDef("ND_" + nodeName));
+        REQUIRE(cachedDoc->getNodeDefs().size() == 1);
+        mx::StringVec includeFiles = mx::readBinarySourceFiles(snapshotFile);
+        REQUIRE(includeFiles.size() == 1);
+        REQUIRE(mx::FilePath(includeFiles[0]).getBaseName() == "snapshot_include.mtlx");
+    }
+    std::remove(snapshotFile.asString().c_str());
+
+    // Snapshots that cannot be written are reported.
+    mx::FilePath missingFile = libraryFolder / "missing" / snapshotFile;
+    REQUIRE_THROWS_AS(mx::writeToBinaryFile(libraries, missingFile), mx::ExceptionFileMissing);
+    mx::DocumentPtr uncachedDoc = mx::createDocument();
+    REQUIRE_THROWS(mx::loadCachedLibraries({ libraryFolder }, folderSearchPath, uncachedDoc, missingFile));
+    std::remove(topFile.asString().c_str());
+    std::remove(includeFile.asString().c_str());
+    std::remove(libraryFolder.asString().c_str());
+}
+
 TEST_CASE("Comments and newlines", "[xmlio]")
 {
     mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
@@ -262,6 +372,110 @@ TEST_CASE("Comments and newlines", "[xmlio]")
     REQUIRE(origXml == newXml);
 }
 
+TEST_CASE("Streaming XML reader", "[xmlio]")
+{
+    // Read a document with entities, character data and irregular whitespace.
+    std::string xmlString =
+        "\xEF\xBB\xBF<?xml version=\"1.0\"?>\r\n"
+        "<!DOCTYPE materialx>\r\n"
+        "<materialx version=\"1.39\">\r\n"
+        "  <look name=\"look1\" attr='a&amp;b&lt;&#65;&#x42;'\tother=\"x\r\ny\" />\r\n"
+        "  <look name=\"look1\"><unused name=\"dup\" /></look>\r\n"
+        "  <![CDATA[ <ignored> ]]>\r\n"
+        "</materialx >\r\n";
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::readFromXmlString(doc, xmlString);
+    mx::LookPtr look = doc->getLook("look1");
+    REQUIRE(look);
+    REQUIRE(look->getAttribute("attr") == "a&b<AB");
+    REQUIRE(look->getAttribute("other") == "x y");
+    REQUIRE(look->getChildren().empty());
+
+    // Verify that XIncludes following other elements take precedence over
+    // them, and are ordered ahead of them, as if read before the document.
+    std::string includeString =
+        "<materialx version=\"1.39\">"
+        "  <look name=\"look1\" source=\"include\" />"
+        "  <look name=\"look2\" source=\"include\" />"
+        "</materialx>";
+    mx::XmlReadOptions readOptions;
+    readOptions.readXIncludeFunction = [&includeString](mx::DocumentPtr library, const mx::FilePath&,
+                                                        const mx::FileSearchPath& searchPath, const mx::XmlReadOptions* options)
+    {
+        mx::readFromXmlString(library, includeString, searchPath, options);
+    };
+    xmlString =
+        "<materialx version=\"1.39\">"
+        "  <look name=\"look1\" source=\"document\" />"
+        "  <look name=\"look3\" source=\"document\" />"
+        "  <xi:include href=\"include.mtlx\" />"
+        "</materialx>";
+    doc = mx::createDocument();
+    mx::readFromXmlString(doc, xmlString, mx::FileSearchPath(), &readOptions);
+    std::vector<mx::LookPtr> looks = doc->getLooks();
+    REQUIRE(looks.size() == 3);
+    REQUIRE(looks[0]->getName() == "look1");
+    REQUIRE(looks[0]->getAttribute("source") == "include");
+    REQUIRE(looks[1]->getName() == "look2");
+    REQUIRE(looks[2]->getName() == "look3");
+
+    // Verify that malformed documents are rejected.
+    for (const char* invalidString : { "", "<materialx>", "<materialx></look>", "<materialx><look name=a/></materialx>",
+                                      "<materialx><!-- comment </materialx>", "<other />" })
+    {
+        doc = mx::createDocument();
+        REQUIRE_THROWS_AS(mx::readFromXmlString(doc, invalidString), mx::ExceptionParseError);
+    }
+
+    // Verify that a document is left unchanged when an error is encountered
+    // after elements have been read, including in parallel.
+    doc = mx::createDocument();
+    doc->setColorSpace("lin_rec709");
+    doc->addLook("existing");
+    const std::string previousString = mx::writeToXmlString(doc);
+    for (unsigned int threadCount : { 1u, 4u })
+    {
+        mx::XmlReadOptions errorOptions;
+        errorOptions.threadCount = threadCount;
+        std::string errorString = "<materialx version=\"1.39\" colorspace=\"acescg\" namespace=\"ns\">";
+        for (int i = 0; i < 100; i++)
+        {
+            errorString += "<look name=\"look" + std::to_string(i) + "\"><materialassign name=\"assign\" /></look>";
+        }
+        errorString += "<look name=\"last\"></materialx>";
+        REQUIRE_THROWS_AS(mx::readFromXmlString(doc, errorString, mx::FileSearchPath(), &errorOptions), mx::ExceptionParseError);
+        REQUIRE(mx::writeToXmlString(doc) == previousString);
+        REQUIRE(!doc->getLook("look0"));
+    }
+}
+
+TEST_CASE("Parallel element construction", "[xmlio]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::FilePathVec filenames = { "libraries/stdlib/stdlib_defs.mtlx",
+                                  "libraries/stdlib/genglsl/stdlib_genglsl_impl.mtlx",
+                                  "resources/Materials/Examples/StandardSurface/standard_surface_chess_set.mtlx" };
+    for (const mx::FilePath& filename : filenames)
+    {
+        mx::XmlReadOptions readOptions;
+        readOptions.readComments = true;
+        readOptions.readNewlines = true;
+
+        // Read the document serially.
+        mx::DocumentPtr serialDoc = mx::createDocument();
+        mx::readFromXmlFile(serialDoc, filename, searchPath, &readOptions);
+
+        // Read the document with parallel construction of top-level subtrees,
+        // verifying that the documents are identical.
+        readOptions.threadCount = 4;
+        mx::DocumentPtr parallelDoc = mx::createDocument();
+        mx::readFromXmlFile(parallelDoc, filename, searchPath, &readOptions);
+        REQUIRE(*parallelDoc == *serialDoc);
+        REQUIRE(mx::writeToXmlString(parallelDoc) == mx::writeToXmlString(serialDoc));
+        REQUIRE(parallelDoc->validate() == serialDoc->validate());
+    }
+}
+
 TEST_CASE("Maximum tree depth", "[xmlio]")
 {
     // Create a document that exceeds the maximum tree depth.
@@ -371,3 +585,83 @@ TEST_CASE("Locale region testing", "[xmlio]")
     // Restore the original locale.
     std::locale::global(origLocale);
 }
+
+TEST_CASE("Version upgrades", "[xmlio]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+    // Upgrade each legacy document, and validate the result.
+    mx::FilePath upgradePath = searchPath.find("resources/Materials/TestSuite/stdlib/upgrade");
+    for (const mx::FilePath& filename : upgradePath.getFilesInDirectory(mx::MTLX_EXTENSION))
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        mx::XmlReadOptions readOptions;
+        readOptions.upgradeVersion = false;
+        mx::readFromXmlFile(doc, upgradePath / filename, searchPath, &readOptions);
+        REQUIRE(doc->getVersionIntegers() < mx::createDocument()->getVersionIntegers());
+
+        doc->upgradeVersion();
+        REQUIRE(doc->getVersionIntegers() == mx::createDocument()->getVersionIntegers());
+        doc->importLibrary(libraries);
+        std::string message;
+        bool docValid = doc->validate(&message);
+        if (!docValid)
+        {
+            WARN("[" + filename.asString() + "] " + message);
+        }
+        REQUIRE(docValid);
+    }
+
+    // Upgrading a document with no legacy content leaves its content unchanged.
+    mx::DocumentPtr doc = mx::createDocument();
+    mx::readFromXmlFile(doc, "resources/Materials/TestSuite/stdlib/texture/tiledimage.mtlx", searchPath);
+    mx::DocumentPtr legacyDoc = doc->copy();
+    legacyDoc->setVersionString("1.38");
+    legacyDoc->upgradeVersion();
+    REQUIRE(*legacyDoc == *doc);
+}
+
+#ifdef MATERIALX_BUILD_BENCHMARK_TESTS
+TEST_CASE("Version upgrade performance", "[xmlio]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::FilePath testSuitePath = searchPath.find("resources/Materials/TestSuite");
+
+    // Read the test suite documents without upgrading them.
+    std::vector<mx::DocumentPtr> docs;
+    mx::XmlReadOptions readOptions;
+    readOptions.upgradeVersion = false;
+    for (const mx::FilePath& path : testSuitePath.getSubDirectories())
+    {
+        for (const mx::FilePath& filename : path.getFilesInDirectory(mx::MTLX_EXTENSION))
+        {
+            mx::DocumentPtr doc = mx::createDocument();
+            mx::readFromXmlFile(doc, path / filename, searchPath, &readOptions);
+            docs.push_back(doc);
+        }
+    }
+
+    BENCHMARK("Upgrade current documents")
+    {
+        for (mx::DocumentPtr doc : docs)
+        {
+            doc->upgradeVersion();
+        }
+        return docs.size();
+    };
+
+    // Upgrading from 1.38 exercises the most recent pass, which has no work
+    // to do for documents without legacy content.
+    BENCHMARK("Upgrade documents from 1.38")
+    {
+        for (mx::DocumentPtr doc : docs)
+        {
+            doc->setVersionString("1.38");
+            doc->upgradeVersion();
+        }
+        return docs.size();
+    };
+}
+#endif
@@ -14,11 +14,15 @@
 #include <MaterialXGenHw/HwConstants.h>
 
 #include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/ShaderCache.h>
+#include <MaterialXGenShader/ShaderNodeImpl.h>
 #include <MaterialXGenShader/ShaderTranslator.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
 #include <MaterialXGenShader/Util.h>
 
 #ifdef MATERIALX_BUILD_GEN_GLSL
 #include <MaterialXGenGlsl/GlslShaderGenerator.h>
+#include <MaterialXGenGlsl/VkShaderGenerator.h>
 #endif
 #ifdef MATERIALX_BUILD_GEN_OSL
 #include <MaterialXGenOsl/OslShaderGenerator.h>
@@ -33,8 +37,12 @@
 #include <MaterialXGenSlang/SlangShaderGenerator.h>
 #endif
 
+#include <cstdio>
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
+#include <thread>
+#include <unordered_map>
 #include <vector>
 #include <set>
 
@@ -452,3 +460,799 @@ TEST_CASE("GenShader: Track Application Variables", "[genshader]")
     }
 #endif
 }
+
+// Load the standard surface examples, returning their material nodes.
+std::vector<mx::ElementPtr> loadBatchMaterials(mx::DocumentPtr libraries, std::vector<mx::DocumentPtr>& docs)
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::FilePath examplesPath = searchPath.find("resources/Materials/Examples/StandardSurface");
+    std::vector<mx::ElementPtr> materials;
+    for (const mx::FilePath& filename : examplesPath.getFilesInDirectory(mx::MTLX_EXTENSION))
+    {
+        mx::DocumentPtr doc = mx::createDocument();
+        mx::readFromXmlFile(doc, examplesPath / filename, searchPath);
+        doc->setDataLibrary(libraries);
+        docs.push_back(doc);
+        for (mx::NodePtr material : doc->getMaterialNodes())
+        {
+            materials.push_back(material);
+        }
+    }
+    return materials;
+}
+
+mx::StringVec getStageSources(mx::ShaderPtr shader)
+{
+    mx::StringVec sources;
+    for (size_t i = 0; i < shader->numStages(); i++)
+    {
+        sources.push_back(shader->getStage(i).getSourceCode());
+    }
+    return sources;
+}
+
+void testBatchGeneration(mx::DocumentPtr libraries, mx::GenContext& context)
+{
+    std::vector<mx::DocumentPtr> docs;
+    std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+    REQUIRE(materials.size() > 1);
+    mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+
+    // Generate the expected shaders serially.
+    std::vector<mx::StringVec> expected;
+    for (mx::ElementPtr material : materials)
+    {
+        expected.push_back(getStageSources(shadergen.generate(material->getName(), material, context)));
+    }
+
+    // Token substitutions set during generation are local to each context.
+    mx::GenContext flippedContext(context);
+    flippedContext.getOptions().fileTextureVerticalFlip = !context.getOptions().fileTextureVerticalFlip;
+    shadergen.generate(materials[0]->getName(), materials[0], flippedContext);
+    REQUIRE(getStageSources(shadergen.generate(materials[0]->getName(), materials[0], context)) == expected[0]);
+
+    // Batch generation matches serial generation, in the order of the given elements.
+    for (unsigned int threadCount : { 1u, 4u })
+    {
+        std::vector<mx::ShaderPtr> shaders = shadergen.generateBatch(materials, context, threadCount);
+        REQUIRE(shaders.size() == materials.size());
+        for (size_t i = 0; i < shaders.size(); i++)
+        {
+            REQUIRE(shaders[i]->getName() == materials[i]->getName());
+            REQUIRE(getStageSources(shaders[i]) == expected[i]);
+        }
+    }
+
+    // Generation errors are reported to the caller.
+    mx::DocumentPtr invalidDoc = mx::createDocument();
+    invalidDoc->setDataLibrary(libraries);
+    materials.push_back(invalidDoc->addNode("unknown_shader", "invalid1", mx::SURFACE_SHADER_TYPE_STRING));
+    REQUIRE_THROWS_AS(shadergen.generateBatch(materials, context, 4), mx::Exception);
+}
+
+TEST_CASE("GenShader: Batch Generation", "[genshader]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+#ifdef MATERIALX_BUILD_GEN_GLSL
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testBatchGeneration(libraries, context);
+
+        // Bound light shaders are instanced privately by each worker.
+        mx::GenContext lightContext(mx::GlslShaderGenerator::create());
+        lightContext.registerSourceCodeSearchPath(searchPath);
+        mx::HwShaderGenerator::bindLightShader(*libraries->getNodeDef("ND_point_light"), 1, lightContext);
+        mx::HwShaderGenerator::bindLightShader(*libraries->getNodeDef("ND_directional_light"), 2, lightContext);
+        testBatchGeneration(libraries, lightContext);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_OSL
+    {
+        mx::GenContext context(mx::OslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testBatchGeneration(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MDL
+    {
+        mx::GenContext context(mx::MdlShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testBatchGeneration(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MSL
+    {
+        mx::GenContext context(mx::MslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testBatchGeneration(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_SLANG
+    {
+        mx::GenContext context(mx::SlangShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testBatchGeneration(libraries, context);
+    }
+#endif
+}
+
+void testImplementationCache(mx::DocumentPtr libraries, mx::GenContext& context)
+{
+    std::vector<mx::DocumentPtr> docs;
+    std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+    REQUIRE(materials.size() > 1);
+    mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+    REQUIRE(!shadergen.getImplementationCache());
+
+    // Generate the expected shaders without a shared cache.
+    std::vector<mx::StringVec> expected;
+    for (mx::ElementPtr material : materials)
+    {
+        expected.push_back(getStageSources(shadergen.generate(material->getName(), material, context)));
+    }
+
+    mx::ShaderNodeImplCachePtr cache = mx::ShaderNodeImplCache::create();
+    shadergen.setImplementationCache(cache);
+
+    // Implementations initialized in one context are reused by another.
+    mx::GenContext context1(context);
+    context1.clearNodeImplementations();
+    REQUIRE(getStageSources(shadergen.generate(materials[0]->getName(), materials[0], context1)) == expected[0]);
+    size_t cacheSize = cache->size();
+    REQUIRE(cacheSize > 0);
+
+    mx::GenContext context2(context);
+    context2.clearNodeImplementations();
+    REQUIRE(getStageSources(shadergen.generate(materials[0]->getName(), materials[0], context2)) == expected[0]);
+    REQUIRE(cache->size() == cacheSize);
+
+    // Compound implementations are shared together with their graphs, so
+    // the second context only requests the implementations at the top level.
+    mx::StringSet implNames;
+    context2.getNodeImplementationNames(implNames);
+    size_t sharedCount = 0;
+    for (const std::string& implName : implNames)
+    {
+        if (context2.findNodeImplementation(implName) == context1.findNodeImplementation(implName))
+        {
+            sharedCount++;
+        }
+    }
+    REQUIRE(sharedCount > 0);
+
+    // Contexts with differing options initialize their own implementations.
+    mx::GenContext reducedContext(context);
+    reducedContext.clearNodeImplementations();
+    reducedContext.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_REDUCED;
+    shadergen.generate(materials[0]->getName(), materials[0], reducedContext);
+    REQUIRE(cache->size() > cacheSize);
+
+    // Shared implementations may be used concurrently.
+    std::vector<mx::ShaderPtr> shaders = shadergen.generateBatch(materials, context, 4);
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        REQUIRE(getStageSources(shaders[i]) == expected[i]);
+    }
+
+    cache->clear();
+    REQUIRE(cache->size() == 0);
+    shadergen.setImplementationCache(nullptr);
+}
+
+TEST_CASE("GenShader: Shared Implementation Cache", "[genshader]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+#ifdef MATERIALX_BUILD_GEN_GLSL
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testImplementationCache(libraries, context);
+
+        // Light shader implementations are modified when bound, so each
+        // context binds its own instance.
+        mx::HwShaderGenerator& shadergen = static_cast<mx::HwShaderGenerator&>(context.getShaderGenerator());
+        shadergen.setImplementationCache(mx::ShaderNodeImplCache::create());
+        mx::NodeDefPtr lightDef = libraries->getNodeDef("ND_point_light");
+        REQUIRE(lightDef);
+        const std::string& lightImplName = lightDef->getImplementation(shadergen.getTarget())->getName();
+        mx::GenContext lightContext1(context);
+        mx::GenContext lightContext2(context);
+        lightContext1.clearNodeImplementations();
+        lightContext2.clearNodeImplementations();
+        shadergen.bindLightShader(*lightDef, 1, lightContext1);
+        shadergen.bindLightShader(*lightDef, 1, lightContext2);
+        REQUIRE(lightContext1.findNodeImplementation(lightImplName));
+        REQUIRE(lightContext1.findNodeImplementation(lightImplName) != lightContext2.findNodeImplementation(lightImplName));
+
+        // Graph implementations with unbound filename inputs are modified
+        // during generation, so each context initializes its own instance.
+        mx::DocumentPtr doc = mx::createDocument();
+        doc->setDataLibrary(libraries);
+        doc->addNodeDef("ND_fixed_image", mx::Type::COLOR3.getName(), "fixed_image");
+        mx::NodeGraphPtr nodeGraph = doc->addNodeGraph("NG_fixed_image");
+        nodeGraph->setNodeDefString("ND_fixed_image");
+        mx::NodePtr image = nodeGraph->addNode("image", "image1", mx::Type::COLOR3.getName());
+        image->setInputValue("file", std::string("fixed.png"), mx::FILENAME_TYPE_STRING);
+        nodeGraph->addOutput("out", mx::Type::COLOR3.getName())->setConnectedNode(image);
+        mx::NodePtr fixedImage = doc->addNode("fixed_image", "fixed_image1", mx::Type::COLOR3.getName());
+        for (int i = 0; i < 2; i++)
+        {
+            mx::GenContext imageContext(context);
+            imageContext.clearNodeImplementations();
+            mx::ShaderPtr shader = shadergen.generate(fixedImage->getName(), fixedImage, imageContext);
+            const mx::VariableBlock& uniforms = shader->getStage(mx::Stage::PIXEL).getUniformBlock(mx::HW::PUBLIC_UNIFORMS);
+            bool foundFilename = false;
+            for (const mx::ShaderPort* port : uniforms.getVariableOrder())
+            {
+                if (port->getType() == mx::Type::FILENAME)
+                {
+                    REQUIRE(port->getValue()->getValueString() == "fixed.png");
+                    foundFilename = true;
+                }
+            }
+            REQUIRE(foundFilename);
+            REQUIRE(imageContext.findNodeImplementation("NG_fixed_image"));
+        }
+
+        // Generators of different classes sharing a target do not share
+        // implementations.
+        mx::GenContext glslContext(context);
+        mx::GenContext vkContext(mx::VkShaderGenerator::create());
+        vkContext.registerSourceCodeSearchPath(searchPath);
+        vkContext.getShaderGenerator().setImplementationCache(shadergen.getImplementationCache());
+        glslContext.clearNodeImplementations();
+        std::vector<mx::DocumentPtr> docs;
+        std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+        shadergen.generate(materials[0]->getName(), materials[0], glslContext);
+        vkContext.getShaderGenerator().generate(materials[0]->getName(), materials[0], vkContext);
+        mx::StringSet implNames;
+        glslContext.getNodeImplementationNames(implNames);
+        REQUIRE(!implNames.empty());
+        for (const std::string& implName : implNames)
+        {
+            REQUIRE(glslContext.findNodeImplementation(implName) != vkContext.findNodeImplementation(implName));
+        }
+        vkContext.getShaderGenerator().setImplementationCache(nullptr);
+        shadergen.setImplementationCache(nullptr);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_OSL
+    {
+        mx::GenContext context(mx::OslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testImplementationCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MDL
+    {
+        mx::GenContext context(mx::MdlShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testImplementationCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MSL
+    {
+        mx::GenContext context(mx::MslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testImplementationCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_SLANG
+    {
+        mx::GenContext context(mx::SlangShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testImplementationCache(libraries, context);
+    }
+#endif
+}
+
+void testSourceCodeCache(mx::DocumentPtr libraries, mx::GenContext& context, bool readsSourceFiles = true)
+{
+    std::vector<mx::DocumentPtr> docs;
+    std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+    REQUIRE(materials.size() > 1);
+    mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+    REQUIRE(!shadergen.getSourceCodeCache());
+
+    // Generate the expected shaders without a cache.
+    std::vector<mx::StringVec> expected;
+    for (mx::ElementPtr material : materials)
+    {
+        expected.push_back(getStageSources(shadergen.generate(material->getName(), material, context)));
+    }
+
+    // Source files are read once, and shared by all contexts and threads.
+    mx::SourceCodeCachePtr cache = mx::SourceCodeCache::create();
+    shadergen.setSourceCodeCache(cache);
+    mx::GenContext cachedContext(context);
+    cachedContext.clearNodeImplementations();
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        REQUIRE(getStageSources(shadergen.generate(materials[i]->getName(), materials[i], cachedContext)) == expected[i]);
+    }
+    size_t cacheSize = cache->size();
+    REQUIRE((cacheSize > 0) == readsSourceFiles);
+
+    std::vector<mx::ShaderPtr> shaders = shadergen.generateBatch(materials, context, 4);
+    for (size_t i = 0; i < shaders.size(); i++)
+    {
+        REQUIRE(getStageSources(shaders[i]) == expected[i]);
+    }
+    REQUIRE(cache->size() == cacheSize);
+
+    cache->clear();
+    REQUIRE(cache->size() == 0);
+    shadergen.setSourceCodeCache(nullptr);
+}
+
+TEST_CASE("GenShader: Source Code Cache", "[genshader]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+#ifdef MATERIALX_BUILD_GEN_GLSL
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testSourceCodeCache(libraries, context);
+
+        // Source code is split into lines, with include directives parsed.
+        const mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+        mx::ConstSourceCodeBlockPtr block = mx::SourceCodeBlock::create("void f()\n{\n#include \"lib/a.glsl\"\n\n}\n", shadergen.getSyntax());
+        REQUIRE(block->getLines() == (mx::StringVec{ "void f()", "{", "lib/a.glsl", "", "}" }));
+        REQUIRE(!block->isInclude(1));
+        REQUIRE(block->isInclude(2));
+
+        // Changed files are read again only if modification times are validated.
+        mx::FilePath filename = mx::FilePath::getCurrentPath() / "sourceCodeCache.glsl";
+        std::ofstream(filename.asString()) << "void f() {}\n";
+        mx::SourceCodeCachePtr cache = mx::SourceCodeCache::create();
+        mx::ConstSourceCodeBlockPtr cached = cache->get(filename, shadergen);
+        REQUIRE(cached);
+        REQUIRE(cache->find(filename, shadergen) == cached);
+        std::remove(filename.asString().c_str());
+        REQUIRE(cache->get(filename, shadergen) == cached);
+        cache->setValidateModificationTimes(true);
+        REQUIRE(!cache->get(filename, shadergen));
+        REQUIRE(!cache->get(searchPath.find("libraries/missing.glsl"), shadergen));
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_OSL
+    {
+        mx::GenContext context(mx::OslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testSourceCodeCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MDL
+    {
+        mx::GenContext context(mx::MdlShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        // MDL implementations hold inline source code that calls into MDL
+        // modules, so no source files are read.
+        testSourceCodeCache(libraries, context, false);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MSL
+    {
+        mx::GenContext context(mx::MslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testSourceCodeCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_SLANG
+    {
+        mx::GenContext context(mx::SlangShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testSourceCodeCache(libraries, context);
+    }
+#endif
+}
+
+void testShaderCache(mx::DocumentPtr libraries, mx::GenContext& context)
+{
+    std::vector<mx::DocumentPtr> docs;
+    std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+    REQUIRE(materials.size() > 2);
+    mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+
+    // Generate the expected shaders without a cache.
+    std::vector<mx::ShaderPtr> expected;
+    for (mx::ElementPtr material : materials)
+    {
+        expected.push_back(shadergen.generate(material->getName(), material, context));
+    }
+
+    mx::FilePath directory = mx::FilePath::getCurrentPath() / ("shaderCache_" + shadergen.getTarget());
+    for (const mx::FilePath& filename : directory.getFilesInDirectory())
+    {
+        std::remove((directory / filename).asString().c_str());
+    }
+
+    // Shaders are generated on a miss, and the most recently used shaders
+    // are held in memory.
+    mx::ShaderCachePtr cache = mx::ShaderCache::create(directory, 2);
+    REQUIRE(directory.isDirectory());
+    std::set<std::string> keys;
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        mx::ShaderPtr shader = cache->generate(materials[i]->getName(), materials[i], context);
+        REQUIRE(getStageSources(shader) == getStageSources(expected[i]));
+        REQUIRE(cache->generate(materials[i]->getName(), materials[i], context) == shader);
+        keys.insert(cache->getKey(materials[i]->getName(), materials[i], context));
+    }
+    REQUIRE(cache->size() == 2);
+    REQUIRE(directory.getFilesInDirectory(mx::ShaderCache::FILE_EXTENSION).size() == keys.size());
+
+    // Keys depend on the content of the material and the generation options,
+    // rather than the documents in which materials are stored.
+    std::vector<mx::DocumentPtr> otherDocs;
+    std::vector<mx::ElementPtr> otherMaterials = loadBatchMaterials(libraries, otherDocs);
+    const std::string key = cache->getKey(materials[0]->getName(), materials[0], context);
+    REQUIRE(cache->getKey(otherMaterials[0]->getName(), otherMaterials[0], context) == key);
+    REQUIRE(cache->getKey(materials[1]->getName(), materials[1], context) != key);
+    REQUIRE(cache->getKey("other", materials[0], context) != key);
+
+    mx::GenContext reducedContext(context);
+    reducedContext.getOptions().shaderInterfaceType = mx::SHADER_INTERFACE_REDUCED;
+    REQUIRE(cache->getKey(materials[0]->getName(), materials[0], reducedContext) != key);
+
+    std::vector<mx::NodePtr> shaderNodes = mx::getShaderNodes(otherMaterials[0]->asA<mx::Node>());
+    REQUIRE(!shaderNodes.empty());
+    shaderNodes[0]->setInputValue("specular_roughness", 0.123f);
+    REQUIRE(cache->getKey(otherMaterials[0]->getName(), otherMaterials[0], context) != key);
+
+    // Shaders restored from disk match the generated shaders, without
+    // constructing a shader graph.
+    mx::ShaderCachePtr diskCache = mx::ShaderCache::create(directory);
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        mx::ShaderPtr shader = diskCache->generate(materials[i]->getName(), materials[i], context);
+        REQUIRE(shader != expected[i]);
+        REQUIRE(shader->getName() == expected[i]->getName());
+        REQUIRE(getStageSources(shader) == getStageSources(expected[i]));
+        REQUIRE(shader->getGraph().getNodes().empty());
+        REQUIRE(shader->getGraph().getClassification() == expected[i]->getGraph().getClassification());
+        REQUIRE(shader->hasAttribute(mx::HW::ATTR_TRANSPARENT) == expected[i]->hasAttribute(mx::HW::ATTR_TRANSPARENT));
+        for (size_t j = 0; j < shader->numStages(); j++)
+        {
+            const mx::ShaderStage& stage = shader->getStage(j);
+            const mx::ShaderStage& expectedStage = expected[i]->getStage(j);
+            REQUIRE(stage.getName() == expectedStage.getName());
+            REQUIRE(stage.getFunctionName() == expectedStage.getFunctionName());
+            REQUIRE(stage.getUniformBlocks().size() == expectedStage.getUniformBlocks().size());
+            for (const auto& it : expectedStage.getUniformBlocks())
+            {
+                const mx::VariableBlock& block = stage.getUniformBlock(it.first);
+                REQUIRE(block.getInstance() == it.second->getInstance());
+                REQUIRE(block.size() == it.second->size());
+                for (size_t k = 0; k < block.size(); k++)
+                {
+                    REQUIRE(block[k]->getType() == (*it.second)[k]->getType());
+                    REQUIRE(block[k]->getVariable() == (*it.second)[k]->getVariable());
+                    REQUIRE(block[k]->getPath() == (*it.second)[k]->getPath());
+                    REQUIRE(block[k]->getFlags() == (*it.second)[k]->getFlags());
+                    REQUIRE(block[k]->getValueString() == (*it.second)[k]->getValueString());
+                }
+            }
+            REQUIRE(stage.getInputBlocks().size() == expectedStage.getInputBlocks().size());
+            REQUIRE(stage.getOutputBlocks().size() == expectedStage.getOutputBlocks().size());
+        }
+    }
+
+    // Invalid files on disk are treated as misses.
+    mx::FilePath filename = directory / (key + "." + mx::ShaderCache::FILE_EXTENSION);
+    std::ofstream(filename.asString(), std::ios::binary) << "MXSC";
+    mx::ShaderCachePtr emptyCache = mx::ShaderCache::create(directory, 0);
+    REQUIRE(getStageSources(emptyCache->generate(materials[0]->getName(), materials[0], context)) == getStageSources(expected[0]));
+    REQUIRE(emptyCache->size() == 0);
+
+    // String sizes beyond the end of the file are treated as misses.
+    {
+        const uint32_t version = 2;
+        const uint32_t fieldCount = 1;
+        const uint64_t stringSize = 1ull << 40;
+        std::ofstream stream(filename.asString(), std::ios::binary);
+        stream << "MXSC";
+        stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+        stream.write(reinterpret_cast<const char*>(&fieldCount), sizeof(fieldCount));
+        stream.write(reinterpret_cast<const char*>(&stringSize), sizeof(stringSize));
+    }
+    REQUIRE(getStageSources(emptyCache->generate(materials[0]->getName(), materials[0], context)) == getStageSources(expected[0]));
+
+    // Files whose stored identity differs from the requested shader are
+    // treated as misses.
+    mx::FilePath otherFilename = directory / (cache->getKey(materials[1]->getName(), materials[1], context) + "." + mx::ShaderCache::FILE_EXTENSION);
+    {
+        std::ifstream source(otherFilename.asString(), std::ios::binary);
+        std::ofstream(filename.asString(), std::ios::binary) << source.rdbuf();
+    }
+    REQUIRE(getStageSources(emptyCache->generate(materials[0]->getName(), materials[0], context)) == getStageSources(expected[0]));
+
+    // Caches may be shared by concurrent threads.
+    cache->clear();
+    REQUIRE(cache->size() == 0);
+    std::vector<mx::ShaderPtr> shaders(materials.size());
+    std::vector<std::thread> threads;
+    for (size_t t = 0; t < 4; t++)
+    {
+        threads.emplace_back([&, t]()
+        {
+            mx::GenContext threadContext(context);
+            for (size_t i = t; i < materials.size(); i += 4)
+            {
+                shaders[i] = cache->generate(materials[i]->getName(), materials[i], threadContext);
+            }
+        });
+    }
+    for (std::thread& thread : threads)
+    {
+        thread.join();
+    }
+    for (size_t i = 0; i < materials.size(); i++)
+    {
+        REQUIRE(getStageSources(shaders[i]) == getStageSources(expected[i]));
+    }
+
+    for (const mx::FilePath& file : directory.getFilesInDirectory())
+    {
+        std::remove((directory / file).asString().c_str());
+    }
+    std::remove(directory.asString().c_str());
+}
+
+TEST_CASE("GenShader: Shader Cache", "[genshader]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+#ifdef MATERIALX_BUILD_GEN_GLSL
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderCache(libraries, context);
+
+        // Generators sharing a target have distinct keys.
+        mx::GenContext vkContext(mx::VkShaderGenerator::create());
+        vkContext.registerSourceCodeSearchPath(searchPath);
+        REQUIRE(vkContext.getShaderGenerator().getTarget() == context.getShaderGenerator().getTarget());
+        std::vector<mx::DocumentPtr> docs;
+        std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+        mx::ShaderCachePtr cache = mx::ShaderCache::create();
+        REQUIRE(cache->getKey(materials[0]->getName(), materials[0], context) !=
+                cache->getKey(materials[0]->getName(), materials[0], vkContext));
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_OSL
+    {
+        mx::GenContext context(mx::OslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MDL
+    {
+        mx::GenContext context(mx::MdlShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MSL
+    {
+        mx::GenContext context(mx::MslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderCache(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_SLANG
+    {
+        mx::GenContext context(mx::SlangShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderCache(libraries, context);
+    }
+#endif
+}
+
+void testShaderInstances(mx::DocumentPtr libraries, mx::GenContext& context)
+{
+    mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+    const mx::StringSet parameterBlocks = shadergen.getParameterBlocks();
+
+    // Materials that differ only in the values of their uniforms have the
+    // same structural hash.
+    std::vector<mx::DocumentPtr> docs;
+    std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+    std::unordered_map<std::string, size_t> hashes;
+    for (mx::ElementPtr material : materials)
+    {
+        mx::ShaderPtr shader = shadergen.generate(material->getName(), material, context);
+        hashes[material->getName()] = shader->getStructuralHash(parameterBlocks);
+        REQUIRE(shadergen.generate(material->getName(), material, context)->getStructuralHash(parameterBlocks) == hashes[material->getName()]);
+    }
+    REQUIRE(hashes.count("Gold"));
+    REQUIRE(hashes.count("Copper"));
+    REQUIRE(hashes.count("Tiled_Brass"));
+    REQUIRE(hashes["Gold"] == hashes["Copper"]);
+    REQUIRE(hashes["Gold"] != hashes["Tiled_Brass"]);
+
+    // Elements with the same structure share a single shader, with the
+    // uniform values of each element assigned to its variables.
+    mx::DocumentPtr doc = mx::createDocument();
+    doc->setDataLibrary(libraries);
+    std::vector<mx::ElementPtr> elements;
+    for (int i = 0; i < 3; i++)
+    {
+        mx::NodePtr shaderNode = doc->addNode("standard_surface", "SR_" + std::to_string(i), mx::SURFACE_SHADER_TYPE_STRING);
+        shaderNode->setInputValue("base", 0.25f * (i + 1));
+        shaderNode->setInputValue("specular_color", mx::Color3(0.5f, 0.5f, 0.25f * i));
+        elements.push_back(doc->addMaterialNode("M_" + std::to_string(i), shaderNode));
+        if (i == 2)
+        {
+            mx::NodePtr add = doc->addNode("add", "add", "color3");
+            add->setInputValue("in1", mx::Color3(0.1f, 0.2f, 0.3f));
+            shaderNode->addInput("base_color", "color3")->setConnectedNode(add);
+        }
+    }
+
+    std::vector<mx::ShaderInstance> instances = shadergen.generateInstances(elements, context, 2);
+    REQUIRE(instances.size() == elements.size());
+    REQUIRE(instances[0].shader->getName() == "M_0");
+    REQUIRE(instances[1].shader == instances[0].shader);
+    REQUIRE(instances[2].shader != instances[0].shader);
+
+    mx::ShaderUniformValueMap values = shadergen.generate("M_1", elements[1], context)->getUniformValues(parameterBlocks);
+    REQUIRE(instances[1].uniformValues.size() == values.size());
+    REQUIRE(instances[1].uniformValues.at("SR_0_base")->getValueString() == values.at("SR_1_base")->getValueString());
+    REQUIRE(instances[1].uniformValues.at("SR_0_base")->getValueString() == "0.5");
+    REQUIRE(instances[0].uniformValues.at("SR_0_base")->getValueString() == "0.25");
+    REQUIRE(instances[1].uniformValues.at("SR_0_specular_color")->getValueString() == "0.5, 0.5, 0.25");
+    REQUIRE(instances[2].uniformValues.at("SR_2_base")->getValueString() == "0.75");
+    REQUIRE(!instances[2].uniformValues.count("SR_2_base_color"));
+}
+
+TEST_CASE("GenShader: Shader Instances", "[genshader]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+
+#ifdef MATERIALX_BUILD_GEN_GLSL
+    {
+        mx::GenContext context(mx::GlslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderInstances(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_OSL
+    {
+        mx::GenContext context(mx::OslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderInstances(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MDL
+    {
+        mx::GenContext context(mx::MdlShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderInstances(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_MSL
+    {
+        mx::GenContext context(mx::MslShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderInstances(libraries, context);
+    }
+#endif
+#ifdef MATERIALX_BUILD_GEN_SLANG
+    {
+        mx::GenContext context(mx::SlangShaderGenerator::create());
+        context.registerSourceCodeSearchPath(searchPath);
+        testShaderInstances(libraries, context);
+    }
+#endif
+}
+
+#if defined(MATERIALX_BUILD_BENCHMARK_TESTS) && defined(MATERIALX_BUILD_GEN_GLSL)
+TEST_CASE("GenShader: Batch Generation Performance", "[genshader]")
+{
+    mx::FileSearchPath searchPath = mx::getDefaultDataSearchPath();
+    mx::DocumentPtr libraries = mx::createDocument();
+    mx::loadLibraries({ "libraries" }, searchPath, libraries);
+    std::vector<mx::DocumentPtr> docs;
+    std::vector<mx::ElementPtr> materials = loadBatchMaterials(libraries, docs);
+    materials.resize(std::min(materials.size(), (size_t) 8));
+
+    mx::ShaderGeneratorPtr generator = mx::GlslShaderGenerator::create();
+    mx::GenContext context(generator);
+    context.registerSourceCodeSearchPath(searchPath);
+    mx::ShaderGenerator& shadergen = context.getShaderGenerator();
+
+    BENCHMARK("Serial generation with a context per material")
+    {
+        size_t count = 0;
+        for (mx::ElementPtr material : materials)
+        {
+            mx::GenContext materialContext(generator);
+            materialContext.registerSourceCodeSearchPath(searchPath);
+            count += shadergen.generate(material->getName(), material, materialContext)->numStages();
+        }
+        return count;
+    };
+    BENCHMARK("Batch generation on one thread")
+    {
+        return shadergen.generateBatch(materials, context, 1).size();
+    };
+    BENCHMARK("Batch generation on all hardware threads")
+    {
+        return shadergen.generateBatch(materials, context, 0).size();
+    };
+
+    shadergen.setImplementationCache(mx::ShaderNodeImplCache::create());
+    BENCHMARK("Serial generation with a context per material and a shared implementation cache")
+    {
+        size_t count = 0;
+        for (mx::ElementPtr material : materials)
+        {
+            mx::GenContext materialContext(generator);
+            materialContext.registerSourceCodeSearchPath(searchPath);
+            count += shadergen.generate(material->getName(), material, materialContext)->numStages();
+        }
+        return count;
+    };
+    shadergen.setSourceCodeCache(mx::SourceCodeCache::create());
+    BENCHMARK("Serial generation with a context per material and shared implementation and source code caches")
+    {
+        size_t count = 0;
+        for (mx::ElementPtr material : materials)
+        {
+            mx::GenContext materialContext(generator);
+            materialContext.registerSourceCodeSearchPath(searchPath);
+            count += shadergen.generate(material->getName(), material, materialContext)->numStages();
+        }
+        return count;
+    };
+    shadergen.setImplementationCache(nullptr);
+    shadergen.setSourceCodeCache(nullptr);
+
+    mx::FilePath directory = mx::FilePath::getCurrentPath() / "shaderCacheBenchmark";
+    mx::ShaderCachePtr shaderCache = mx::ShaderCache::create(directory);
+    for (mx::ElementPtr material : materials)
+    {
+        shaderCache->generate(material->getName(), material, context);
+    }
+    BENCHMARK("Serial generation with a shader cache hit in memory")
+    {
+        size_t count = 0;
+        for (mx::ElementPtr material : materials)
+        {
+            count += shaderCache->generate(material->getName(), material, context)->numStages();
+        }
+        return count;
+    };
+    BENCHMARK("Serial generation with a shader cache hit on disk")
+    {
+        mx::ShaderCachePtr diskCache = mx::ShaderCache::create(directory);
+        size_t count = 0;
+        for (mx::ElementPtr material : materials)
+        {
+            count += diskCache->generate(material->getName(), material, context)->numStages();
+        }
+        return count;
+    };
+    for (const mx::FilePath& file : directory.getFilesInDirectory())
+    {
+        std::remove((directory / file).asString().c_str());
+    }
+    std::remove(directory.asString().c_str());
+}
+#endif
@@ -1375,14 +1375,7 @@ void Viewer::loadDocument(const mx::FilePath& filename, mx::DocumentPtr librarie
         // Flatten subgraphs if requested.
         if (_flattenSubgraphs)
         {
-            doc->flattenSubgraphs();
-            for (mx::NodeGraphPtr graph : doc->getNodeGraphs())
-            {
-                if (graph->belongsToContentDocument())
-                {
-                    graph->flattenSubgraphs();
-                }
-            }
+            doc->flattenAllSubgraphs(mx::EMPTY_STRING, nullptr, 0);
         }
 
         // Validate the document.
@@ -1508,7 +1501,7 @@ void Viewer::loadDocument(const mx::FilePath& filename, mx::DocumentPtr librarie
             {
                 for (mx::MaterialAssignPtr matAssign : look->getActiveMaterialAssigns())
                 {
-                    const std::string& activeGeom = matAssign->getActiveGeom();
+                    mx::GeomMatcher matcher(matAssign);
                     for (mx::MeshPartitionPtr part : _geometryList)
                     {
                         std::string geom = part->getName();
@@ -1516,19 +1509,7 @@ void Viewer::loadDocument(const mx::FilePath& filename, mx::DocumentPtr librarie
                         {
                             geom += mx::ARRAY_PREFERRED_SEPARATOR + id;
                         }
-                        if (mx::geomStringsMatch(activeGeom, geom, true))
-                        {
-                            for (mx::MaterialPtr mat : newMaterials)
-                            {
-                                if (mat->getMaterialNode() == matAssign->getReferencedMaterial())
-                                {
-                                    assignMaterial(part, mat);
-                                    break;
-                                }
-                            }
-                        }
-                        mx::CollectionPtr coll = matAssign->getCollection();
-                        if (coll && coll->matchesGeomString(geom))
+                        if (matcher.matchesGeomString(geom))
                         {
                             for (mx::MaterialPtr mat : newMaterials)
                             {
@@ -24,10 +24,17 @@ class PyBindDocument : public mx::Document
 
 void bindPyDocument(py::module& mod)
 {
-    mod.def("createDocument", &mx::createDocument);
+    mod.def("createDocument", (mx::DocumentPtr (*)()) &mx::createDocument);
+    mod.def("createDocument", (mx::DocumentPtr (*)(mx::ElementArenaPtr)) &mx::createDocument);
 
     py::class_<mx::Document, mx::DocumentPtr, mx::GraphElement>(mod, "Document")
         .def("initialize", &mx::Document::initialize)
+        .def("getValidationDiagnostics", [](const mx::Document& doc, unsigned int threadCount)
+            {
+                std::vector<mx::ValidationDiagnostic> diagnostics;
+                doc.validate(diagnostics, threadCount);
+                return diagnostics;
+            }, py::arg("threadCount") = 1)
         .def("copy", &mx::Document::copy)
         .def("setDataLibrary", &mx::Document::setDataLibrary)
         .def("getDataLibrary", &mx::Document::getDataLibrary)
@@ -81,6 +88,8 @@ void bindPyDocument(py::module& mod)
         .def("getNodeDefs", &mx::Document::getNodeDefs)
         .def("removeNodeDef", &mx::Document::removeNodeDef)
         .def("getMatchingNodeDefs", &mx::Document::getMatchingNodeDefs)
+        .def("getMatchingNodeDef", &mx::Document::getMatchingNodeDef,
+            py::arg("node"), py::arg("target") = mx::EMPTY_STRING, py::arg("allowRoughMatch") = false)
         .def("addAttributeDef", &mx::Document::addAttributeDef)
         .def("getAttributeDef", &mx::Document::getAttributeDef)
         .def("getAttributeDefs", &mx::Document::getAttributeDefs)
@@ -119,5 +128,11 @@ void bindPyDocument(py::module& mod)
         .def("getColorManagementSystem", &mx::Document::getColorManagementSystem)
         .def("setColorManagementConfig", &mx::Document::setColorManagementConfig)
         .def("hasColorManagementConfig", &mx::Document::hasColorManagementConfig)
-        .def("getColorManagementConfig", &mx::Document::getColorManagementConfig);
+        .def("getColorManagementConfig", &mx::Document::getColorManagementConfig)
+        .def("flattenAllSubgraphs", &mx::Document::flattenAllSubgraphs,
+            py::arg("target") = mx::EMPTY_STRING, py::arg("filter") = nullptr, py::arg("threadCount") = 1)
+        .def("freeze", &mx::Document::freeze)
+        .def("isFrozen", &mx::Document::isFrozen)
+        .def("setNamePathIndexEnabled", &mx::Document::setNamePathIndexEnabled)
+        .def("isNamePathIndexEnabled", &mx::Document::isNamePathIndexEnabled);
 }
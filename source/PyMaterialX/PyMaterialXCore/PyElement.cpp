@@ -26,6 +26,11 @@ namespace mx = MaterialX;
 
 void bindPyElement(py::module& mod)
 {
+    py::class_<mx::ElementArena, mx::ElementArenaPtr>(mod, "ElementArena")
+        .def(py::init<size_t>(), py::arg("chunkSize") = mx::ElementArena::DEFAULT_CHUNK_SIZE)
+        .def("getReservedBytes", &mx::ElementArena::getReservedBytes)
+        .def("getAllocatedBytes", &mx::ElementArena::getAllocatedBytes);
+
     py::class_<mx::Element, mx::ElementPtr>(mod, "Element")
         .def(py::self == py::self)
         .def(py::self != py::self)
@@ -35,6 +40,8 @@ void bindPyElement(py::module& mod)
             bool res = elem.isEquivalent(rhs, options, &message);
             return std::pair<bool, std::string>(res, message);
         })        
+        .def("getContentHash", (uint64_t (mx::Element::*)() const) &mx::Element::getContentHash)
+        .def("getContentHash", (uint64_t (mx::Element::*)(const mx::ElementEquivalenceOptions&) const) &mx::Element::getContentHash)
         .def("setCategory", &mx::Element::setCategory)
         .def("getCategory", &mx::Element::getCategory)
         .def("setName", &mx::Element::setName)
@@ -42,6 +49,7 @@ void bindPyElement(py::module& mod)
         .def("getNamePath", &mx::Element::getNamePath,
             py::arg("relativeTo") = nullptr)
         .def("getDescendant", &mx::Element::getDescendant)
+        .def("getDescendants", &mx::Element::getDescendants)
         .def("setFilePrefix", &mx::Element::setFilePrefix)
         .def("hasFilePrefix", &mx::Element::hasFilePrefix)
         .def("getFilePrefix", &mx::Element::getFilePrefix)
@@ -84,6 +92,7 @@ void bindPyElement(py::module& mod)
         .def("getParent", static_cast<mx::ElementPtr(mx::Element::*)()>(&mx::Element::getParent))
         .def("getRoot", static_cast<mx::ElementPtr(mx::Element::*)()>(&mx::Element::getRoot))
         .def("getDocument", static_cast<mx::DocumentPtr(mx::Element::*)()>(&mx::Element::getDocument))
+        .def("getElementArena", &mx::Element::getElementArena)
         .def("traverseTree", &mx::Element::traverseTree)
         .def("traverseGraph", &mx::Element::traverseGraph)
         .def("getUpstreamEdge", &mx::Element::getUpstreamEdge,
@@ -212,6 +221,20 @@ void bindPyElement(py::module& mod)
     py::class_<mx::GenericElement, mx::GenericElementPtr, mx::Element>(mod, "GenericElement")
         .def_readonly_static("CATEGORY", &mx::GenericElement::CATEGORY);
 
+    py::class_<mx::ValidationDiagnostic> validationDiagnostic(mod, "ValidationDiagnostic");
+    validationDiagnostic
+        .def_readwrite("elementPath", &mx::ValidationDiagnostic::elementPath)
+        .def_readwrite("elementString", &mx::ValidationDiagnostic::elementString)
+        .def_readwrite("ruleId", &mx::ValidationDiagnostic::ruleId)
+        .def_readwrite("description", &mx::ValidationDiagnostic::description)
+        .def_readwrite("severity", &mx::ValidationDiagnostic::severity)
+        .def("asString", &mx::ValidationDiagnostic::asString)
+        .def(py::init<>());
+    py::enum_<mx::ValidationDiagnostic::Severity>(validationDiagnostic, "Severity")
+        .value("SeverityWarning", mx::ValidationDiagnostic::SeverityWarning)
+        .value("SeverityError", mx::ValidationDiagnostic::SeverityError)
+        .export_values();
+
     py::class_<mx::ElementEquivalenceOptions>(mod, "ElementEquivalenceOptions")
         .def_readwrite("performValueComparisons", &mx::ElementEquivalenceOptions::performValueComparisons)
         .def_readwrite("floatFormat", &mx::ElementEquivalenceOptions::floatFormat)
@@ -86,8 +86,22 @@ void bindPyGeom(py::module& mod)
         .def("getIncludeCollections", &mx::Collection::getIncludeCollections)
         .def("hasIncludeCycle", &mx::Collection::hasIncludeCycle)
         .def("matchesGeomString", &mx::Collection::matchesGeomString)
+        .def("getGeomMatcher", &mx::Collection::getGeomMatcher)
         .def_readonly_static("CATEGORY", &mx::Collection::CATEGORY);
 
+    py::class_<mx::GeomPathSet>(mod, "GeomPathSet")
+        .def(py::init<>())
+        .def(py::init<const std::string&>())
+        .def("addGeomString", &mx::GeomPathSet::addGeomString)
+        .def("isEmpty", &mx::GeomPathSet::isEmpty)
+        .def("matchesGeomString", &mx::GeomPathSet::matchesGeomString,
+            py::arg("geom"), py::arg("contains") = false);
+
+    py::class_<mx::GeomMatcher, mx::ConstGeomMatcherPtr>(mod, "GeomMatcher")
+        .def("matchesGeomString", &mx::GeomMatcher::matchesGeomString)
+        .def("matchesGeomStrings", &mx::GeomMatcher::matchesGeomStrings)
+        .def("hasIncludeCycle", &mx::GeomMatcher::hasIncludeCycle);
+
     mod.def("geomStringsMatch", &mx::geomStringsMatch);
 
     mod.attr("GEOM_PATH_SEPARATOR") = mx::GEOM_PATH_SEPARATOR;
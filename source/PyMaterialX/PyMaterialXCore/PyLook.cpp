@@ -46,6 +46,8 @@ void bindPyLook(py::module& mod)
         .def("getVisibilities", &mx::Look::getVisibilities)
         .def("getActiveVisibilities", &mx::Look::getActiveVisibilities)
         .def("removeVisibility", &mx::Look::removeVisibility)
+        .def("resolveGeomBindings", &mx::Look::resolveGeomBindings,
+            py::arg("geoms"), py::arg("threadCount") = 1)
         .def_readonly_static("CATEGORY", &mx::Look::CATEGORY);
 
     py::class_<mx::LookGroup, mx::LookGroupPtr, mx::Element>(mod, "LookGroup")
@@ -53,6 +55,8 @@ void bindPyLook(py::module& mod)
         .def("setLooks", &mx::LookGroup::setLooks)
         .def("getActiveLook", &mx::LookGroup::getActiveLook)
         .def("setActiveLook", &mx::LookGroup::setActiveLook)
+        .def("resolveGeomBindings", &mx::LookGroup::resolveGeomBindings,
+            py::arg("geoms"), py::arg("threadCount") = 1)
         .def_readonly_static("CATEGORY", &mx::LookGroup::CATEGORY)
         .def_readonly_static("LOOKS_ATTRIBUTE", &mx::LookGroup::LOOKS_ATTRIBUTE)
         .def_readonly_static("ACTIVE_ATTRIBUTE", &mx::LookGroup::ACTIVE_ATTRIBUTE);
@@ -81,6 +85,24 @@ void bindPyLook(py::module& mod)
         .def("getVisible", &mx::Visibility::getVisible)
         .def_readonly_static("CATEGORY", &mx::Visibility::CATEGORY);
 
+    py::class_<mx::LookBindings>(mod, "LookBindings")
+        .def("getGeomCount", &mx::LookBindings::getGeomCount)
+        .def("getMaterialAssigns", (const std::vector<mx::MaterialAssignPtr>& (mx::LookBindings::*)() const) &mx::LookBindings::getMaterialAssigns)
+        .def("getMaterialAssigns", (std::vector<mx::MaterialAssignPtr> (mx::LookBindings::*)(size_t) const) &mx::LookBindings::getMaterialAssigns)
+        .def("getPropertyAssigns", (const std::vector<mx::PropertyAssignPtr>& (mx::LookBindings::*)() const) &mx::LookBindings::getPropertyAssigns)
+        .def("getPropertyAssigns", (std::vector<mx::PropertyAssignPtr> (mx::LookBindings::*)(size_t) const) &mx::LookBindings::getPropertyAssigns)
+        .def("getPropertySetAssigns", (const std::vector<mx::PropertySetAssignPtr>& (mx::LookBindings::*)() const) &mx::LookBindings::getPropertySetAssigns)
+        .def("getPropertySetAssigns", (std::vector<mx::PropertySetAssignPtr> (mx::LookBindings::*)(size_t) const) &mx::LookBindings::getPropertySetAssigns)
+        .def("getVisibilities", (const std::vector<mx::VisibilityPtr>& (mx::LookBindings::*)() const) &mx::LookBindings::getVisibilities)
+        .def("getVisibilities", (std::vector<mx::VisibilityPtr> (mx::LookBindings::*)(size_t) const) &mx::LookBindings::getVisibilities)
+        .def("getVariantAssigns", (const std::vector<mx::VariantAssignPtr>& (mx::LookBindings::*)() const) &mx::LookBindings::getVariantAssigns)
+        .def("getVariantAssigns", (std::vector<mx::VariantAssignPtr> (mx::LookBindings::*)(size_t) const) &mx::LookBindings::getVariantAssigns)
+        .def("hasMaterialAssign", &mx::LookBindings::hasMaterialAssign)
+        .def("hasPropertyAssign", &mx::LookBindings::hasPropertyAssign)
+        .def("hasPropertySetAssign", &mx::LookBindings::hasPropertySetAssign)
+        .def("hasVisibility", &mx::LookBindings::hasVisibility)
+        .def("getBoundMaterialAssign", &mx::LookBindings::getBoundMaterialAssign);
+
     mod.def("getGeometryBindings", &mx::getGeometryBindings,
         py::arg("materialNode") , py::arg("geom") = mx::UNIVERSAL_GEOM_NAME);
 }
@@ -28,6 +28,20 @@ void bindPyNode(py::module& mod)
         .def("addInputsFromNodeDef", &mx::Node::addInputsFromNodeDef)
         .def_readonly_static("CATEGORY", &mx::Node::CATEGORY);
 
+    py::class_<mx::GraphIndex, mx::ConstGraphIndexPtr>(mod, "GraphIndex")
+        .def("getElementCount", &mx::GraphIndex::getElementCount)
+        .def("getElement", &mx::GraphIndex::getElement)
+        .def("getId", &mx::GraphIndex::getId)
+        .def("getUpstreamCount", &mx::GraphIndex::getUpstreamCount)
+        .def("getUpstreamId", &mx::GraphIndex::getUpstreamId)
+        .def("getUpstreamPort", &mx::GraphIndex::getUpstreamPort)
+        .def("getDownstreamCount", &mx::GraphIndex::getDownstreamCount)
+        .def("getDownstreamId", &mx::GraphIndex::getDownstreamId)
+        .def("getDownstreamPort", &mx::GraphIndex::getDownstreamPort)
+        .def("getDownstreamPorts", &mx::GraphIndex::getDownstreamPorts)
+        .def("getTopologicalOrder", &mx::GraphIndex::getTopologicalOrder)
+        .def_readonly_static("INVALID_ID", &mx::GraphIndex::INVALID_ID);
+
     py::class_<mx::GraphElement, mx::GraphElementPtr, mx::InterfaceElement>(mod, "GraphElement")
         .def("addNode", &mx::GraphElement::addNode,
             py::arg("category"), py::arg("name") = mx::EMPTY_STRING, py::arg("type") = mx::DEFAULT_TYPE_STRING)
@@ -47,6 +61,7 @@ void bindPyNode(py::module& mod)
         .def("removeBackdrop", &mx::GraphElement::removeBackdrop)
         .def("flattenSubgraphs", &mx::GraphElement::flattenSubgraphs,
             py::arg("target") = mx::EMPTY_STRING, py::arg("filter") = nullptr)
+        .def("getGraphIndex", &mx::GraphElement::getGraphIndex)
         .def("topologicalSort", &mx::GraphElement::topologicalSort)
         .def("addGeomNode", &mx::GraphElement::addGeomNode)
         .def("asStringDot", &mx::GraphElement::asStringDot);
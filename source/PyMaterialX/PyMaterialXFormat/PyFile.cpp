@@ -43,6 +43,8 @@ void bindPyFile(py::module& mod)
         .def("getNormalized", &mx::FilePath::getNormalized)        
         .def("exists", &mx::FilePath::exists)
         .def("isDirectory", &mx::FilePath::isDirectory)
+        .def("getModificationTime", &mx::FilePath::getModificationTime)
+        .def("getFileSize", &mx::FilePath::getFileSize)
         .def("getFilesInDirectory", &mx::FilePath::getFilesInDirectory)
         .def("getSubDirectories", &mx::FilePath::getSubDirectories)
         .def("createDirectory", &mx::FilePath::createDirectory,
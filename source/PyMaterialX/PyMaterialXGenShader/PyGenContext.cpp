@@ -21,6 +21,8 @@ void bindPyGenContext(py::module& mod)
         .def("getTypeDesc", &mx::GenContext::getTypeDesc)
         .def("registerSourceCodeSearchPath", static_cast<void (mx::GenContext::*)(const mx::FilePath&)>(&mx::GenContext::registerSourceCodeSearchPath))
         .def("registerSourceCodeSearchPath", static_cast<void (mx::GenContext::*)(const mx::FileSearchPath&)>(&mx::GenContext::registerSourceCodeSearchPath))
+        .def("setTokenSubstitution", &mx::GenContext::setTokenSubstitution)
+        .def("getTokenSubstitutions", &mx::GenContext::getTokenSubstitutions)
         .def("resolveSourceFile", &mx::GenContext::resolveSourceFile)
         .def("pushUserData", &mx::GenContext::pushUserData)
         .def("setApplicationVariableHandler", &mx::GenContext::setApplicationVariableHandler)
@@ -28,5 +28,14 @@ void bindPyShader(py::module& mod)
         .def("hasAttribute", &mx::Shader::hasAttribute)
         .def("getAttribute", &mx::Shader::getAttribute)
         .def("setAttribute", static_cast<void (mx::Shader::*)(const std::string&)>(&mx::Shader::setAttribute))
-        .def("setAttribute", static_cast<void (mx::Shader::*)(const std::string&, mx::ValuePtr)>(&mx::Shader::setAttribute));
+        .def("setAttribute", static_cast<void (mx::Shader::*)(const std::string&, mx::ValuePtr)>(&mx::Shader::setAttribute))
+        .def("getStructuralHash", &mx::Shader::getStructuralHash,
+            py::arg("parameterBlocks") = mx::StringSet())
+        .def("getUniformValues", &mx::Shader::getUniformValues,
+            py::arg("parameterBlocks") = mx::StringSet());
+
+    py::class_<mx::ShaderInstance>(mod, "ShaderInstance")
+        .def(py::init<>())
+        .def_readwrite("shader", &mx::ShaderInstance::shader)
+        .def_readwrite("uniformValues", &mx::ShaderInstance::uniformValues);
 }
@@ -6,21 +6,55 @@
 #include <PyMaterialX/PyMaterialX.h>
 
 #include <MaterialXGenShader/Shader.h>
+#include <MaterialXGenShader/ShaderCache.h>
 #include <MaterialXGenShader/ShaderGenerator.h>
 #include <MaterialXGenShader/GenContext.h>
+#include <MaterialXGenShader/ShaderNodeImpl.h>
+#include <MaterialXGenShader/SourceCodeCache.h>
 
 namespace py = pybind11;
 namespace mx = MaterialX;
 
 void bindPyShaderGenerator(py::module& mod)
 {
+    py::class_<mx::ShaderNodeImplCache, mx::ShaderNodeImplCachePtr>(mod, "ShaderNodeImplCache")
+        .def_static("create", &mx::ShaderNodeImplCache::create)
+        .def("size", &mx::ShaderNodeImplCache::size)
+        .def("clear", &mx::ShaderNodeImplCache::clear);
+
+    py::class_<mx::SourceCodeCache, mx::SourceCodeCachePtr>(mod, "SourceCodeCache")
+        .def_static("create", &mx::SourceCodeCache::create)
+        .def("setValidateModificationTimes", &mx::SourceCodeCache::setValidateModificationTimes)
+        .def("getValidateModificationTimes", &mx::SourceCodeCache::getValidateModificationTimes)
+        .def("size", &mx::SourceCodeCache::size)
+        .def("clear", &mx::SourceCodeCache::clear);
+
+    py::class_<mx::ShaderCache, mx::ShaderCachePtr>(mod, "ShaderCache")
+        .def_static("create", &mx::ShaderCache::create,
+            py::arg("directory") = mx::FilePath(), py::arg("capacity") = mx::ShaderCache::DEFAULT_CAPACITY)
+        .def("getDirectory", &mx::ShaderCache::getDirectory)
+        .def("getCapacity", &mx::ShaderCache::getCapacity)
+        .def("generate", &mx::ShaderCache::generate)
+        .def("getKey", &mx::ShaderCache::getKey)
+        .def("size", &mx::ShaderCache::size)
+        .def("clear", &mx::ShaderCache::clear);
+
     py::class_<mx::ShaderGenerator, mx::ShaderGeneratorPtr>(mod, "ShaderGenerator")
         .def("getTarget", &mx::ShaderGenerator::getTarget)
         .def("generate", &mx::ShaderGenerator::generate)
+        .def("generateBatch", &mx::ShaderGenerator::generateBatch,
+            py::arg("elements"), py::arg("context"), py::arg("threadCount") = 1)
+        .def("generateInstances", &mx::ShaderGenerator::generateInstances,
+            py::arg("elements"), py::arg("context"), py::arg("threadCount") = 1)
+        .def("getParameterBlocks", &mx::ShaderGenerator::getParameterBlocks)
         .def("setColorManagementSystem", &mx::ShaderGenerator::setColorManagementSystem)
         .def("getColorManagementSystem", &mx::ShaderGenerator::getColorManagementSystem)
         .def("setUnitSystem", &mx::ShaderGenerator::setUnitSystem)
         .def("getUnitSystem", &mx::ShaderGenerator::getUnitSystem)
+        .def("setImplementationCache", &mx::ShaderGenerator::setImplementationCache)
+        .def("getImplementationCache", &mx::ShaderGenerator::getImplementationCache)
+        .def("setSourceCodeCache", &mx::ShaderGenerator::setSourceCodeCache)
+        .def("getSourceCodeCache", &mx::ShaderGenerator::getSourceCodeCache)
         .def("getTokenSubstitutions", &mx::ShaderGenerator::getTokenSubstitutions)
         .def("registerTypeDefs", &mx::ShaderGenerator::registerTypeDefs)
         .def("registerShaderMetadata", &mx::ShaderGenerator::registerShaderMetadata);